@@ -0,0 +1,653 @@
+/* mesh3d_bench — offline benchmarks for the CPU hot paths.
+
+   Everything runs on synthetic data (generate_synthetic_terrain(),
+   in-memory HGT and GeoTIFF images), so no network, display or GL context
+   is needed. Results go to stdout as a table and, with --json, to a file
+   whose entries are keyed by a stable "name" so runs from different
+   releases can be diffed directly. */
+
+#include "analysis/viewshed.h"
+#include "analysis/viewshed_engine.h"
+#include "analysis/viewshed_kernel.h"
+#include "analysis/itm.h"
+#include "scene/terrain.h"
+#include "scene/terrain_lod.h"
+#include "tile/composite_elevation.h"
+#include "tile/geotiff.h"
+#include "tile/hgt_provider.h"
+#include "tile/imagery_compositor.h"
+#include "tile/m3dt.h"
+#include "ui/hardware_profiles.h"
+#include "util/log.h"
+#include "util/math_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#ifndef MESH3D_VERSION_STRING
+#define MESH3D_VERSION_STRING "unknown"
+#endif
+
+using namespace mesh3d;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    bool quick = false;
+    double min_time_s = 0.5;   // keep iterating until this much time is spent
+    int min_iters = 3;
+    int max_iters = 50;
+    std::string filter;
+    std::string json_path;
+    std::vector<int> threads;  // engine thread counts to sweep
+};
+
+struct Result {
+    std::string name;          // stable key, e.g. "compute_viewshed/grid=512/nodes=4"
+    int iterations = 0;
+    double min_ms = 0, median_ms = 0, mean_ms = 0;
+    double items = 0;          // work items per iteration (cells, paths, samples)
+    const char* item_unit = "";
+};
+
+Options g_opts;
+std::vector<Result> g_results;
+
+/* Keeps results observable so the optimizer cannot drop the work */
+volatile float g_sink = 0.0f;
+
+bool selected(const std::string& name) {
+    return g_opts.filter.empty() || name.find(g_opts.filter) != std::string::npos;
+}
+
+/* Time fn() after one warm-up call. Iterates at least min_iters times and
+   until min_time_s has elapsed (capped at max_iters). */
+void run(const std::string& name, double items, const char* unit,
+         const std::function<void()>& fn) {
+    if (!selected(name)) return;
+
+    fn(); // warm-up: page faults, lazy pool creation, caches
+
+    std::vector<double> samples;
+    double spent = 0.0;
+    while (static_cast<int>(samples.size()) < g_opts.max_iters &&
+           (static_cast<int>(samples.size()) < g_opts.min_iters || spent < g_opts.min_time_s)) {
+        auto t0 = Clock::now();
+        fn();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        samples.push_back(ms);
+        spent += ms / 1000.0;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    Result r;
+    r.name = name;
+    r.iterations = static_cast<int>(samples.size());
+    r.min_ms = samples.front();
+    r.median_ms = samples[samples.size() / 2];
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    r.mean_ms = sum / samples.size();
+    r.items = items;
+    r.item_unit = unit;
+    g_results.push_back(r);
+
+    double rate = r.median_ms > 0.0 ? items / (r.median_ms / 1000.0) : 0.0;
+    printf("%-52s %5d  %10.3f  %10.3f  %12.3g %s/s\n",
+           name.c_str(), r.iterations, r.min_ms, r.median_ms, rate, unit);
+    fflush(stdout);
+}
+
+/* ── Synthetic inputs ─────────────────────────────────────────────── */
+
+const mesh3d_bounds_t BENCH_BOUNDS = {40.0, 40.25, -105.25, -105.0};
+
+mesh3d_rf_config_t bench_rf() {
+    return {-130.0f, 1.0f, 2.0f, 2.0f, -130.0f, -80.0f};
+}
+
+/* Nodes spread deterministically over the interior of the bounds */
+std::vector<NodeData> make_nodes(int count, const mesh3d_bounds_t& b) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> u(0.15, 0.85);
+    const HardwareProfile& hw = HARDWARE_PROFILES[0];
+
+    std::vector<NodeData> nodes;
+    for (int i = 0; i < count; ++i) {
+        mesh3d_node_t n{};
+        n.id = i;
+        std::snprintf(n.name, sizeof(n.name), "bench%d", i);
+        n.lat = b.min_lat + u(rng) * (b.max_lat - b.min_lat);
+        n.lon = b.min_lon + u(rng) * (b.max_lon - b.min_lon);
+        n.antenna_height_m = 10.0f;
+        n.tx_power_dbm = hw.tx_power_dbm;
+        n.antenna_gain_dbi = hw.antenna_gain_dbi;
+        n.rx_sensitivity_dbm = hw.rx_sensitivity_dbm;
+        n.frequency_mhz = hw.frequency_mhz;
+        n.cable_loss_db = hw.cable_loss_db;
+        NodeData nd;
+        nd.info = n;
+        nd.world_pos = glm::vec3(0.0f);
+        nodes.push_back(nd);
+    }
+    return nodes;
+}
+
+/* Raw big-endian int16 bytes as found in an uncompressed .hgt file */
+std::vector<uint8_t> make_hgt_bytes(int dim) {
+    std::vector<float> elev;
+    generate_synthetic_terrain(elev, dim, dim);
+    std::vector<uint8_t> raw(static_cast<size_t>(dim) * dim * 2);
+    for (size_t i = 0; i < elev.size(); ++i) {
+        int16_t v = static_cast<int16_t>(elev[i]);
+        raw[i * 2] = static_cast<uint8_t>((v >> 8) & 0xFF);
+        raw[i * 2 + 1] = static_cast<uint8_t>(v & 0xFF);
+    }
+    return raw;
+}
+
+void put16(std::vector<uint8_t>& b, size_t at, uint16_t v) {
+    b[at] = v & 0xFF; b[at + 1] = v >> 8;
+}
+void put32(std::vector<uint8_t>& b, size_t at, uint32_t v) {
+    for (int i = 0; i < 4; ++i) b[at + i] = (v >> (8 * i)) & 0xFF;
+}
+
+/* Little-endian single-band float32 GeoTIFF, strip layout, optionally
+   deflate-compressed -- the subset geotiff_read_elevation() handles. */
+std::vector<uint8_t> make_geotiff(int width, int height, int rows_per_strip, bool deflate) {
+    std::vector<float> elev;
+    generate_synthetic_terrain(elev, height, width);
+
+    /* Strip payloads */
+    int strips = (height + rows_per_strip - 1) / rows_per_strip;
+    std::vector<std::vector<uint8_t>> payload(strips);
+    for (int s = 0; s < strips; ++s) {
+        int r0 = s * rows_per_strip;
+        int nrows = std::min(rows_per_strip, height - r0);
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(&elev[static_cast<size_t>(r0) * width]);
+        size_t len = static_cast<size_t>(nrows) * width * sizeof(float);
+        if (deflate) {
+            uLongf out_len = compressBound(static_cast<uLong>(len));
+            payload[s].resize(out_len);
+            compress2(payload[s].data(), &out_len, src, static_cast<uLong>(len), Z_DEFAULT_COMPRESSION);
+            payload[s].resize(out_len);
+        } else {
+            payload[s].assign(src, src + len);
+        }
+    }
+
+    /* Layout: header | IFD | strip offsets | byte counts | tiepoint | scale | data */
+    const int n_entries = 10;
+    size_t ifd = 8;
+    size_t offs_at = ifd + 2 + n_entries * 12 + 4;
+    size_t cnts_at = offs_at + 4 * strips;
+    size_t tie_at = cnts_at + 4 * strips;
+    size_t scale_at = tie_at + 6 * 8;
+    size_t data_at = scale_at + 3 * 8;
+
+    size_t total = data_at;
+    for (auto& p : payload) total += p.size();
+    std::vector<uint8_t> b(total, 0);
+    b[0] = 'I'; b[1] = 'I';
+    put16(b, 2, 42);
+    put32(b, 4, static_cast<uint32_t>(ifd));
+    put16(b, ifd, n_entries);
+
+    size_t e = ifd + 2;
+    auto entry = [&](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        put16(b, e, tag); put16(b, e + 2, type);
+        put32(b, e + 4, count); put32(b, e + 8, value);
+        e += 12;
+    };
+    entry(256, 4, 1, width);
+    entry(257, 4, 1, height);
+    entry(258, 3, 1, 32);
+    entry(259, 3, 1, deflate ? 8 : 1);
+    entry(273, 4, strips, static_cast<uint32_t>(offs_at));
+    entry(278, 4, 1, rows_per_strip);
+    entry(279, 4, strips, static_cast<uint32_t>(cnts_at));
+    entry(339, 3, 1, 3);
+    entry(33550, 12, 3, static_cast<uint32_t>(scale_at));
+    entry(33922, 12, 6, static_cast<uint32_t>(tie_at));
+    put32(b, e, 0); // no next IFD
+
+    double tie[6] = {0, 0, 0, -105.0, 40.01, 0};
+    double scale[3] = {0.01 / width, 0.01 / height, 0};
+    std::memcpy(&b[tie_at], tie, sizeof(tie));
+    std::memcpy(&b[scale_at], scale, sizeof(scale));
+
+    size_t at = data_at;
+    for (int s = 0; s < strips; ++s) {
+        put32(b, offs_at + 4 * s, static_cast<uint32_t>(at));
+        put32(b, cnts_at + 4 * s, static_cast<uint32_t>(payload[s].size()));
+        std::memcpy(&b[at], payload[s].data(), payload[s].size());
+        at += payload[s].size();
+    }
+    return b;
+}
+
+std::string key(const char* base, const std::vector<std::pair<const char*, std::string>>& params) {
+    std::string k = base;
+    for (auto& [name, value] : params) k += std::string("/") + name + "=" + value;
+    return k;
+}
+
+/* ── Benchmarks ───────────────────────────────────────────────────── */
+
+void bench_viewshed() {
+    std::vector<int> grids = g_opts.quick ? std::vector<int>{256, 512}
+                                          : std::vector<int>{256, 512, 1024};
+    std::vector<int> node_counts = {1, 4, 16};
+    auto rf = bench_rf();
+    auto& engine = cpu_viewshed_engine();
+
+    for (int dim : grids) {
+        std::vector<float> elev;
+        generate_synthetic_terrain(elev, dim, dim);
+        double cells = static_cast<double>(dim) * dim;
+
+        for (int nn : node_counts) {
+            if (g_opts.quick && nn > 4) continue;
+            auto nodes = make_nodes(nn, BENCH_BOUNDS);
+            std::string g = std::to_string(dim), n = std::to_string(nn);
+
+            /* Single-threaded reference: one compute_viewshed() per node */
+            run(key("compute_viewshed", {{"grid", g}, {"nodes", n}}), cells * nn, "cell",
+                [&] {
+                    std::vector<uint8_t> vis;
+                    std::vector<float> sig;
+                    for (auto& node : nodes) {
+                        compute_viewshed(elev.data(), dim, dim, BENCH_BOUNDS, node, vis, sig, rf);
+                        g_sink = g_sink + sig[sig.size() / 2];
+                    }
+                });
+
+            /* Engine: model x SIMD level x thread count */
+            struct Variant { mesh3d_prop_model_t model; SimdLevel simd; const char* label; };
+            std::vector<Variant> variants;
+            variants.push_back({MESH3D_PROP_FSPL, SimdLevel::SCALAR, "scalar"});
+            if (viewshed_detect_simd() != SimdLevel::SCALAR)
+                variants.push_back({MESH3D_PROP_FSPL, viewshed_detect_simd(),
+                                    viewshed_simd_name(viewshed_detect_simd())});
+            variants.push_back({MESH3D_PROP_SWEEP, viewshed_detect_simd(), "sweep"});
+
+            for (const auto& v : variants) {
+                for (int t : g_opts.threads) {
+                    engine.set_threads(t);
+                    engine.set_propagation_model(v.model);
+                    viewshed_set_simd(v.simd);
+                    run(key("engine", {{"grid", g}, {"nodes", n}, {"kernel", v.label},
+                                       {"threads", std::to_string(t)}}),
+                        cells * nn, "cell",
+                        [&] {
+                            std::vector<uint8_t> vis, ovl;
+                            std::vector<float> sig;
+                            engine.compute_merged(elev.data(), dim, dim, BENCH_BOUNDS,
+                                                  nodes, rf, vis, sig, &ovl);
+                            g_sink = g_sink + sig[sig.size() / 2];
+                        });
+                }
+            }
+            engine.set_propagation_model(MESH3D_PROP_FSPL);
+            viewshed_set_simd(viewshed_detect_simd());
+        }
+    }
+}
+
+void bench_itm() {
+    const int dim = 1024;
+    std::vector<float> elev;
+    generate_synthetic_terrain(elev, dim, dim);
+    const float cell_m = 30.0f;
+    const auto params = itm_defaults();
+
+    /* Fixed set of random paths, lengths 1..dim cells */
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> u(0, dim - 1);
+    struct Path { int r0, c0, r1, c1; };
+    std::vector<Path> paths(g_opts.quick ? 256 : 1024);
+    for (auto& p : paths) p = {u(rng), u(rng), u(rng), u(rng)};
+
+    for (int max_samples : {128, 512}) {
+        std::string ms = std::to_string(max_samples);
+
+        run(key("extract_profile", {{"grid", "1024"}, {"max_samples", ms}}),
+            static_cast<double>(paths.size()), "path",
+            [&] {
+                float step = 0.0f;
+                for (const auto& p : paths) {
+                    auto prof = extract_profile(elev.data(), dim, dim, p.r0, p.c0, p.r1, p.c1,
+                                                cell_m, max_samples, step);
+                    g_sink = g_sink + prof.back();
+                }
+            });
+
+        /* Profiles built once so this isolates the model itself */
+        std::vector<std::vector<float>> profiles;
+        std::vector<float> steps;
+        for (const auto& p : paths) {
+            float step = 0.0f;
+            profiles.push_back(extract_profile(elev.data(), dim, dim, p.r0, p.c0, p.r1, p.c1,
+                                               cell_m, max_samples, step));
+            steps.push_back(step);
+        }
+        run(key("itm_point_to_point", {{"max_samples", ms}}),
+            static_cast<double>(paths.size()), "path",
+            [&] {
+                for (size_t i = 0; i < profiles.size(); ++i) {
+                    g_sink = g_sink + itm_point_to_point(profiles[i].data(),
+                                                         static_cast<int>(profiles[i].size()),
+                                                         steps[i], 10.0f, 1.0f, 906.875f, params);
+                }
+            });
+    }
+}
+
+void bench_terrain_mesh() {
+    std::vector<int> grids = g_opts.quick ? std::vector<int>{257, 513}
+                                          : std::vector<int>{257, 513, 1201};
+    for (int dim : grids) {
+        std::vector<float> elev;
+        generate_synthetic_terrain(elev, dim, dim);
+        std::vector<uint8_t> vis(static_cast<size_t>(dim) * dim, 1);
+        std::vector<float> sig(static_cast<size_t>(dim) * dim, -100.0f);
+
+        GeoProjection proj;
+        proj.init(BENCH_BOUNDS);
+        TerrainBuildData td{elev.data(), dim, dim, BENCH_BOUNDS, 1.0f, vis.data(), sig.data()};
+
+        /* CPU half of build_terrain_mesh(); the GL upload needs a context */
+        run(key("build_terrain_mesh_data", {{"grid", std::to_string(dim)}}),
+            static_cast<double>(dim) * dim, "vertex",
+            [&] {
+                auto md = build_terrain_mesh_data(td, proj);
+                g_sink = g_sink + md.vertices[md.vertices.size() / 2];
+            });
+
+        /* Chunked LOD vertices + per-level error, as built for tiles by the
+           loader workers (chunk rows across the mesh pool) */
+        for (int t : g_opts.threads) {
+            ThreadPool pool(t);
+            run(key("build_terrain_lod_data", {{"grid", std::to_string(dim)},
+                                               {"threads", std::to_string(t)}}),
+                static_cast<double>(dim) * dim, "sample",
+                [&] {
+                    auto ld = build_terrain_lod_data(td, proj, TerrainLodFormat::VERTICES, &pool);
+                    g_sink = g_sink + ld.chunks.back().error[LOD_LEVELS - 1];
+                });
+
+            /* Same chunks, but only the R16 height texture for GPU displacement */
+            run(key("build_terrain_lod_data", {{"grid", std::to_string(dim)},
+                                               {"format", "heightmap"},
+                                               {"threads", std::to_string(t)}}),
+                static_cast<double>(dim) * dim, "sample",
+                [&] {
+                    auto ld = build_terrain_lod_data(td, proj, TerrainLodFormat::HEIGHTMAP, &pool);
+                    g_sink = g_sink + ld.chunks.back().error[LOD_LEVELS - 1] + ld.heights.back();
+                });
+        }
+    }
+}
+
+void bench_read_hgt() {
+    for (int dim : {1201, 3601}) {
+        if (g_opts.quick && dim == 3601) continue;
+        auto raw = make_hgt_bytes(dim);
+        run(key("read_hgt", {{"dim", std::to_string(dim)}}),
+            static_cast<double>(dim) * dim, "sample",
+            [&] {
+                int rows = 0, cols = 0;
+                auto elev = HgtProvider::read_hgt(raw, rows, cols);
+                g_sink = g_sink + elev[elev.size() / 2];
+            });
+
+        /* Cached-tile path: mmap + decode from a real file */
+        std::string path = (std::filesystem::temp_directory_path() /
+                            ("mesh3d_bench_" + std::to_string(dim) + ".hgt")).string();
+        if (FILE* f = std::fopen(path.c_str(), "wb")) {
+            std::fwrite(raw.data(), 1, raw.size(), f);
+            std::fclose(f);
+            run(key("load_hgt_file", {{"dim", std::to_string(dim)}}),
+                static_cast<double>(dim) * dim, "sample",
+                [&] {
+                    int rows = 0, cols = 0;
+                    auto elev = HgtProvider::load_hgt_file(path, rows, cols);
+                    g_sink = g_sink + elev[elev.size() / 2];
+                });
+            std::remove(path.c_str());
+        }
+    }
+}
+
+void bench_m3dt() {
+    for (int dim : {1201, 3601}) {
+        if (g_opts.quick && dim == 3601) continue;
+        int rows = 0, cols = 0;
+        auto elev = HgtProvider::read_hgt(make_hgt_bytes(dim), rows, cols);
+        mesh3d_bounds_t tb = HgtProvider::hgt_tile_bounds({-1, -106, 40});
+        std::string d = std::to_string(dim);
+
+        std::string name = key("m3dt_encode", {{"dim", d}});
+        auto image = m3dt_encode(elev.data(), dim, dim, tb, 1.0f);
+        run(name, static_cast<double>(dim) * dim, "sample",
+            [&] { g_sink = g_sink + m3dt_encode(elev.data(), dim, dim, tb, 1.0f).size(); });
+        if (selected(name))
+            printf("  %s: %zu bytes, %.2fx smaller than raw .hgt\n", name.c_str(),
+                   image.size(), static_cast<double>(dim) * dim * 2.0 / image.size());
+
+        std::string path = (std::filesystem::temp_directory_path() /
+                            ("mesh3d_bench_" + d + ".m3dt")).string();
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) continue;
+        std::fwrite(image.data(), 1, image.size(), f);
+        std::fclose(f);
+
+        run(key("m3dt_read_all", {{"dim", d}}), static_cast<double>(dim) * dim, "sample",
+            [&] {
+                M3dtReader reader;
+                reader.open(path);
+                auto out = reader.read_all();
+                g_sink = g_sink + out[out.size() / 2];
+            });
+
+        /* A 0.1 degree mosaic corner: only the blocks it touches decode */
+        const int span = dim / 10;
+        std::vector<float> region(static_cast<size_t>(span) * span);
+        run(key("m3dt_read_region", {{"dim", d}, {"region", std::to_string(span)}}),
+            static_cast<double>(span) * span, "sample",
+            [&] {
+                M3dtReader reader;
+                reader.open(path);
+                reader.read_region(dim / 2, dim / 2 + span, dim / 2, dim / 2 + span,
+                                   region.data(), span);
+                g_sink = g_sink + region[region.size() / 2];
+            });
+        std::remove(path.c_str());
+    }
+}
+
+void bench_geotiff() {
+    const int dim = g_opts.quick ? 1000 : 2000;
+    for (bool deflate : {false, true}) {
+        auto tiff = make_geotiff(dim, dim, 16, deflate);
+        run(key("geotiff_read_elevation", {{"dim", std::to_string(dim)},
+                                           {"compression", deflate ? "deflate" : "none"}}),
+            static_cast<double>(dim) * dim, "sample",
+            [&] {
+                GeoTiffInfo info;
+                geotiff_parse(tiff.data(), tiff.size(), info);
+                auto elev = geotiff_read_elevation(tiff.data(), tiff.size(), info);
+                g_sink = g_sink + elev[elev.size() / 2];
+            });
+    }
+}
+
+void bench_composite() {
+    const int dim = 1201; // SRTM3 tiles
+    TileCache cache(16);
+    std::vector<float> elev;
+    generate_synthetic_terrain(elev, dim, dim);
+
+    /* 3x3 block of HGT tiles around N40W106 */
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            TileRenderable tr;
+            tr.coord = {-1, -106 + dx, 40 + dy};
+            tr.bounds = HgtProvider::hgt_tile_bounds(tr.coord);
+            tr.elevation = elev;
+            tr.elev_rows = dim;
+            tr.elev_cols = dim;
+            cache.upload(std::move(tr));
+        }
+    }
+    TileRenderable* center = cache.get({-1, -106, 40});
+
+    run(key("build_composite_elevation", {{"tile", "1201"}, {"neighbors", "8"}}),
+        9.0 * dim * dim, "sample",
+        [&] {
+            auto ce = build_composite_elevation(*center, cache);
+            g_sink = g_sink + ce.data[ce.data.size() / 2];
+        });
+}
+
+/* Composite-and-crop of decoded 256px slippy tiles over one SRTM tile
+   (the CPU part of an imagery job; fetch/decode excluded) */
+void bench_imagery_composite() {
+    mesh3d_bounds_t b = HgtProvider::hgt_tile_bounds({-1, -106, 40});
+    for (int zoom : {11, 12}) {
+        std::vector<TileCoord> coords;
+        int z = imagery_tile_range(b, zoom, MAX_IMAGERY_COMPOSITE_DIM, coords);
+        if (z < 0) continue;
+
+        std::vector<std::optional<TileData>> tiles(coords.size());
+        for (size_t i = 0; i < coords.size(); ++i) {
+            TileData td;
+            td.coord = coords[i];
+            td.img_width = td.img_height = 256;
+            td.imagery.assign(256 * 256 * 4, static_cast<uint8_t>(i * 37));
+            tiles[i] = std::move(td);
+        }
+
+        run(key("composite_imagery", {{"zoom", std::to_string(z)},
+                                      {"tiles", std::to_string(coords.size())}}),
+            static_cast<double>(coords.size()), "tile",
+            [&] {
+                ImageryImage img;
+                composite_imagery(b, z, coords, tiles, img);
+                g_sink = g_sink + img.rgba[img.rgba.size() / 2];
+            });
+    }
+}
+
+bool write_json(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        LOG_ERROR("Cannot write %s", path.c_str());
+        return false;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"version\": \"%s\",\n", MESH3D_VERSION_STRING);
+    fprintf(f, "  \"simd\": \"%s\",\n", viewshed_simd_name(viewshed_detect_simd()));
+    fprintf(f, "  \"hardware_threads\": %d,\n", ThreadPool::hardware_threads());
+    fprintf(f, "  \"quick\": %s,\n", g_opts.quick ? "true" : "false");
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const auto& r = g_results[i];
+        double rate = r.median_ms > 0.0 ? r.items / (r.median_ms / 1000.0) : 0.0;
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %d, \"min_ms\": %.4f, "
+                   "\"median_ms\": %.4f, \"mean_ms\": %.4f, \"items\": %.0f, "
+                   "\"unit\": \"%s\", \"items_per_sec\": %.1f}%s\n",
+                r.name.c_str(), r.iterations, r.min_ms, r.median_ms, r.mean_ms,
+                r.items, r.item_unit, rate, i + 1 < g_results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+    return true;
+}
+
+void print_usage() {
+    printf("Usage: mesh3d_bench [options]\n"
+           "  --quick          Smaller inputs and shorter runs (smoke test)\n"
+           "  --filter STR     Only run benchmarks whose name contains STR\n"
+           "  --threads LIST   Engine thread counts, e.g. 1,2,4,8 (default: 1,all)\n"
+           "  --min-time SEC   Minimum time per benchmark (default 0.5)\n"
+           "  --json FILE      Write results as JSON\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool min_time_set = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            g_opts.quick = true;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            g_opts.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            const char* p = argv[++i];
+            while (*p) {
+                int t = std::atoi(p);
+                if (t > 0) g_opts.threads.push_back(t);
+                const char* comma = std::strchr(p, ',');
+                if (!comma) break;
+                p = comma + 1;
+            }
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            g_opts.min_time_s = std::atof(argv[++i]);
+            min_time_set = true;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            g_opts.json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            print_usage();
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (g_opts.quick) {
+        if (!min_time_set) g_opts.min_time_s = 0.05;
+        g_opts.min_iters = 1;
+    }
+    if (g_opts.threads.empty()) {
+        g_opts.threads.push_back(1);
+        if (ThreadPool::hardware_threads() > 1)
+            g_opts.threads.push_back(ThreadPool::hardware_threads());
+    }
+
+    /* Per-call LOG_INFO lines from the engine would swamp the table */
+    log_set_level(LogLevel::Warn);
+
+    printf("mesh3d %s bench, %d hardware threads, best SIMD %s\n\n",
+           MESH3D_VERSION_STRING, ThreadPool::hardware_threads(),
+           viewshed_simd_name(viewshed_detect_simd()));
+    printf("%-52s %5s  %10s  %10s  %14s\n", "benchmark", "iters", "min ms", "median ms", "throughput");
+
+    bench_viewshed();
+    bench_itm();
+    bench_terrain_mesh();
+    bench_read_hgt();
+    bench_m3dt();
+    bench_geotiff();
+    bench_composite();
+    bench_imagery_composite();
+
+    if (!g_opts.json_path.empty()) {
+        if (!write_json(g_opts.json_path)) return 1;
+        printf("\nWrote %s\n", g_opts.json_path.c_str());
+    }
+    return 0;
+}
@@ -37,10 +37,46 @@ MESH3D_API void mesh3d_rebuild_scene(void);
 /* ── Propagation model ────────────────────────────────────────────── */
 MESH3D_API void mesh3d_set_propagation_model(mesh3d_prop_model_t model);
 MESH3D_API void mesh3d_set_itm_params(mesh3d_itm_params_t params);
+/* ITM and Fresnel on the radial-profile engine: `radials` rays per node,
+   the model run along each ray and cells interpolated between them.
+   0 (default) evaluates every cell. */
+MESH3D_API void mesh3d_set_radial_propagation(int radials);
+/* Tile-mode GPU coverage coarse to fine: a quick low-resolution pass per
+   tile, then refinement near coverage edges. Non-zero (default) on. */
+MESH3D_API void mesh3d_set_progressive_viewshed(int on);
 
 /* ── Receiver / display config ───────────────────────────────────── */
 MESH3D_API void mesh3d_set_rf_config(mesh3d_rf_config_t config);
 
+/* ── Point-to-point path loss ─────────────────────────────────────── */
+/* Path loss, received signal and terrain clearance of `count` paths over
+   the loaded terrain, with the current model and RF config. Endpoint
+   pairs are profiled once and paths run across the CPU worker threads.
+   Returns the number of results written. */
+MESH3D_API int  mesh3d_path_loss_batch(const mesh3d_path_query_t* queries, int count,
+                                       mesh3d_path_result_t* results);
+/* Link between every pair of placed nodes, results[tx * n + rx] with the
+   diagonal zeroed. Returns the node count n; writes nothing unless
+   capacity >= n * n, so call with NULL first to size the buffer. */
+MESH3D_API int  mesh3d_node_link_matrix(mesh3d_path_result_t* results, int capacity);
+
+/* ── Mesh connectivity ─────────────────────────────────────────────── */
+/* Nodes are linked when the link margin is at least the minimum (default
+   0 dB) in both directions. The graph is kept up to date as nodes are
+   added, edited or deleted, re-evaluating only that node's links. */
+MESH3D_API int  mesh3d_link_graph_stats(mesh3d_link_graph_stats_t* out);
+/* Fewest hops between nodes a and b, -1 if they cannot reach each other */
+MESH3D_API int  mesh3d_link_graph_hops(int a, int b);
+/* Partition (group of mutually reachable nodes) of a node, -1 if invalid */
+MESH3D_API int  mesh3d_link_graph_partition(int node);
+/* 1 if removing the node would split its partition */
+MESH3D_API int  mesh3d_link_graph_is_articulation(int node);
+MESH3D_API void mesh3d_set_link_min_margin(float db);
+
+/* ── CPU viewshed engine ─────────────────────────────────────────── */
+/* Worker threads for the CPU viewshed path (0 = all hardware threads) */
+MESH3D_API void mesh3d_set_cpu_threads(int threads);
+
 /* ── DSM data source ──────────────────────────────────────────────── */
 MESH3D_API void mesh3d_set_dsm_dir(const char* dir);
 
@@ -62,10 +62,62 @@ typedef struct {
     float display_max_dbm;      /* -80.0  (top of signal color scale) */
 } mesh3d_rf_config_t;
 
+/* One transmitter -> receiver path for mesh3d_path_loss_batch() */
+typedef struct {
+    double tx_lat, tx_lon;
+    float  tx_height_m;         /* antenna above ground, < 1 = 2.0 */
+    float  tx_power_dbm;        /* <= 0 = 22.0 */
+    float  tx_gain_dbi;
+    float  tx_cable_loss_db;
+    float  frequency_mhz;       /* <= 0 = 906.875 */
+    double rx_lat, rx_lon;
+    float  rx_height_m;         /* antenna above ground, <= 0 = rf_config */
+    float  rx_gain_dbi;
+    float  rx_cable_loss_db;
+    float  rx_sensitivity_dbm;  /* >= 0 = rf_config */
+} mesh3d_path_query_t;
+
+typedef struct {
+    float path_loss_db;         /* propagation model loss, antennas excluded */
+    float signal_dbm;           /* received, after RX gain and cable loss */
+    float link_margin_db;       /* signal_dbm - RX sensitivity */
+    float distance_m;
+    float clearance_m;          /* lowest height of the TX-RX line above the
+                                   terrain (4/3 earth), < 0 = obstructed */
+    float fresnel_clearance;    /* lowest clearance / first Fresnel zone
+                                   radius; >= 0.6 is usually unobstructed */
+    float obstruction_m;        /* distance from TX of that lowest point */
+    int   los;                  /* clearance_m >= 0 */
+    int   terrain_complete;     /* every profile sample had elevation data */
+} mesh3d_path_result_t;
+
+/* Summary of the node-to-node link graph */
+typedef struct {
+    int   nodes;
+    int   links;                /* node pairs linked in both directions */
+    int   partitions;           /* groups of nodes that can reach each other */
+    int   articulation_points;  /* nodes whose loss splits their group */
+    int   max_hops;             /* longest fewest-hop route within a group */
+    float min_margin_db;        /* margin a link needs each way */
+} mesh3d_link_graph_stats_t;
+
 typedef enum {
     MESH3D_PROP_FSPL    = 0,  /* free-space path loss (current) */
     MESH3D_PROP_ITM     = 1,  /* Longley-Rice ITM */
-    MESH3D_PROP_FRESNEL = 2   /* Fresnel-Kirchhoff */
+    MESH3D_PROP_FRESNEL = 2,  /* Fresnel-Kirchhoff */
+    /* FSPL + knife-edge like MESH3D_PROP_FSPL, computed with a radial
+       horizon sweep (each cell visited O(1) times instead of once per ray
+       sample). FSPL is identical; the diffraction edge comes from the sweep
+       ray through the cell rather than the exact node-to-cell ray, so the
+       difference grows with terrain roughness and is not bounded in
+       general. Measured on 801x801 fractal terrain (~30 m posts, -110 dBm,
+       three node placements; tests/viewshed_sweep_test.cpp):
+         moderate (100 m relief): visibility agrees on >=89% of cells,
+           |signal difference| <=0.05 dB median, <=8 dB p90, <=15 dB p99,
+           worst cell 42 dB
+         rugged (1000 m relief): >=91%, <=0.1 / 13 / 25 dB, worst 61 dB
+       Use MESH3D_PROP_FSPL where single cells matter. */
+    MESH3D_PROP_SWEEP   = 3
 } mesh3d_prop_model_t;
 
 typedef enum {
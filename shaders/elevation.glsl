@@ -0,0 +1,28 @@
+/* Elevation access shared by every propagation shader; GpuViewshed
+   inserts this after their #version line. The grid is either one
+   uploaded image (uElevation) or a frame of cached tiles resident in a
+   texture array (GpuViewshed::set_elevation_frame), addressed by their
+   place in the 3x3 neighbourhood of the center tile. */
+
+layout(binding = 0, r32f) uniform readonly image2D      uElevation;
+layout(binding = 6, r32f) uniform readonly image2DArray uElevationTiles;
+
+uniform bool  uUseFrame;
+uniform ivec2 uFrameTile;       // (cols, rows) of one tile
+uniform ivec2 uFrameOffset;     // frame cell of grid cell (0, 0), (col, row)
+uniform int   uFrameStep;       // frame cells per grid cell
+uniform int   uFrameLayers[9];  // row-major from the north-west tile, -1 = none
+
+float elevation_at(ivec2 cell) {
+    if (!uUseFrame)
+        return imageLoad(uElevation, cell).r;
+
+    ivec2 f = cell * uFrameStep + uFrameOffset;
+    ivec2 t = f / uFrameTile;
+    if (any(lessThan(f, ivec2(0))) || any(greaterThan(t, ivec2(2))))
+        return 0.0;
+    int layer = uFrameLayers[t.y * 3 + t.x];
+    if (layer < 0)
+        return 0.0;     // no neighbour there, as in a composite
+    return imageLoad(uElevationTiles, ivec3(f - t * uFrameTile, layer)).r;
+}
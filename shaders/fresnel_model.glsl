@@ -0,0 +1,208 @@
+/* Fresnel / knife-edge propagation over one terrain profile, shared by
+   fresnel.comp (one invocation per cell) and viewshed_radial.comp (one
+   per radial sample). GpuViewshed inserts it after elevation.glsl and
+   viewshed_node.glsl, whose node uniforms fresnel_received_dbm() reads.
+
+   The including shader defines fresnel_terrain(t): the ground elevation
+   at fraction t (0 = node, 1 = receiver) of the path being evaluated. */
+
+uniform float uCellMeters;
+uniform float uEarthCurveFactor;
+uniform float uRxAntennaGainDbi;
+uniform float uRxCableLossDb;
+uniform float uTargetHeight;     // default 2.0m
+
+const float PI = 3.141592653589793;
+const int MAX_PROFILE = 512;
+
+float fresnel_terrain(float t);
+
+/* Received signal (dBm) over a path of dist_cells grid cells ending on
+   ground at target_elev */
+float fresnel_received_dbm(float dist_cells, float target_elev) {
+    float d_total = dist_cells * uCellMeters;
+    float lambda = 299.792458 / uFreqMhz;
+    float rx_h = target_elev + uTargetHeight;
+
+    /* Extract terrain profile */
+    int n_raw = int(dist_cells) + 1;
+    int step = max(1, (n_raw + MAX_PROFILE - 1) / MAX_PROFILE);
+    int n_profile = min((n_raw + step - 1) / step, MAX_PROFILE);
+
+    /* Bullington equivalent construction:
+       1. Find tangent line from TX over profile (highest tangent angle)
+       2. Find tangent line from RX back over profile
+       3. Where they intersect = equivalent knife edge
+       Then apply Deygout correction for secondary obstructions. */
+
+    float max_tan_tx = -1e30;  // max tangent angle from TX
+    int   max_tan_tx_i = 0;
+    float max_tan_rx = -1e30;  // max tangent angle from RX
+    int   max_tan_rx_i = 0;
+
+    for (int i = 1; i < n_profile - 1; ++i) {
+        float t = float(i * step) / dist_cells;
+        t = min(t, 1.0);
+        float elev = fresnel_terrain(t);
+
+        /* Earth curvature correction */
+        float d_along = d_total * t;
+        float d_remain = d_total * (1.0 - t);
+        float earth_curve = d_along * d_remain * uEarthCurveFactor;
+
+        /* Tangent angle from TX */
+        float h_above_tx = (elev - earth_curve) - uObserverHeight;
+        float tan_tx = h_above_tx / d_along;
+        if (tan_tx > max_tan_tx) {
+            max_tan_tx = tan_tx;
+            max_tan_tx_i = i;
+        }
+
+        /* Tangent angle from RX */
+        float h_above_rx = (elev - earth_curve) - rx_h;
+        float tan_rx = h_above_rx / d_remain;
+        if (tan_rx > max_tan_rx) {
+            max_tan_rx = tan_rx;
+            max_tan_rx_i = i;
+        }
+    }
+
+    /* Compute diffraction loss */
+    float diff_loss_db = 0.0;
+
+    /* Check if path is obstructed at all */
+    float los_tan = (rx_h - uObserverHeight) / d_total;
+    bool obstructed = (max_tan_tx > los_tan);
+
+    if (obstructed) {
+        /* Bullington construction: find equivalent knife edge */
+        /* Use the dominant obstruction point (from TX tangent) */
+        float t_edge = float(max_tan_tx_i * step) / dist_cells;
+        float d1 = d_total * t_edge;
+        float d2 = d_total * (1.0 - t_edge);
+
+        /* Get edge elevation with curvature correction */
+        float edge_elev = fresnel_terrain(t_edge);
+        float earth_curve_edge = d1 * d2 * uEarthCurveFactor;
+        float effective_edge_h = edge_elev - earth_curve_edge;
+
+        /* LOS height at edge position */
+        float los_at_edge = uObserverHeight + (rx_h - uObserverHeight) * t_edge;
+
+        /* Knife-edge clearance violation */
+        float violation = effective_edge_h - los_at_edge;
+        if (violation > 0.0) {
+            float d_harmonic = d1 * d2 / (d1 + d2);
+            float v = violation * sqrt(2.0 / (lambda * d_harmonic));
+
+            /* Primary knife-edge loss (ITU-R P.526) */
+            if (v > -0.78) {
+                diff_loss_db = 6.9 + 20.0 * log(sqrt((v - 0.1) * (v - 0.1) + 1.0) + v - 0.1) / log(10.0);
+            }
+
+            /* Deygout correction for secondary obstructions:
+               Check for obstructions on TX-edge and edge-RX sub-paths */
+
+            /* TX to edge sub-path */
+            float max_v2_tx = 0.0;
+            for (int j = 1; j < max_tan_tx_i; ++j) {
+                float t2 = float(j * step) / dist_cells;
+                float e2 = fresnel_terrain(t2);
+
+                float d2_along = d_total * t2;
+                float d2_to_edge = d1 - d2_along;
+                if (d2_to_edge <= 0.0 || d2_along <= 0.0) continue;
+                float ec2 = d2_along * d2_to_edge * uEarthCurveFactor;
+                float eff_e2 = e2 - ec2;
+
+                /* LOS between TX and edge at this point */
+                float t_sub = d2_along / d1;
+                float los_sub = uObserverHeight + (effective_edge_h - uObserverHeight) * t_sub;
+                float viol2 = eff_e2 - los_sub;
+                if (viol2 > 0.0) {
+                    float dh2 = d2_along * d2_to_edge / (d2_along + d2_to_edge);
+                    float v2 = viol2 * sqrt(2.0 / (lambda * dh2));
+                    max_v2_tx = max(max_v2_tx, v2);
+                }
+            }
+
+            /* Edge to RX sub-path */
+            float max_v2_rx = 0.0;
+            int n_after = n_profile - 1 - max_tan_tx_i;
+            for (int j = max_tan_tx_i + 1; j < n_profile - 1; ++j) {
+                float t2 = float(j * step) / dist_cells;
+                float e2 = fresnel_terrain(t2);
+
+                float d2_from_edge = d_total * t2 - d1;
+                float d2_to_rx = d2 - d2_from_edge;
+                if (d2_to_rx <= 0.0 || d2_from_edge <= 0.0) continue;
+                float ec2 = (d1 + d2_from_edge) * d2_to_rx * uEarthCurveFactor;
+                float eff_e2 = e2 - ec2;
+
+                float t_sub = d2_from_edge / d2;
+                float los_sub = effective_edge_h + (rx_h - effective_edge_h) * t_sub;
+                float viol2 = eff_e2 - los_sub;
+                if (viol2 > 0.0) {
+                    float dh2 = d2_from_edge * d2_to_rx / (d2_from_edge + d2_to_rx);
+                    float v2 = viol2 * sqrt(2.0 / (lambda * dh2));
+                    max_v2_rx = max(max_v2_rx, v2);
+                }
+            }
+
+            /* Add secondary knife-edge losses (Deygout correction) */
+            if (max_v2_tx > 0.0) {
+                float sec_loss = 6.9 + 20.0 * log(sqrt((max_v2_tx - 0.1) * (max_v2_tx - 0.1) + 1.0)
+                                                    + max_v2_tx - 0.1) / log(10.0);
+                diff_loss_db += max(sec_loss, 0.0);
+            }
+            if (max_v2_rx > 0.0) {
+                float sec_loss = 6.9 + 20.0 * log(sqrt((max_v2_rx - 0.1) * (max_v2_rx - 0.1) + 1.0)
+                                                    + max_v2_rx - 0.1) / log(10.0);
+                diff_loss_db += max(sec_loss, 0.0);
+            }
+        }
+    } else {
+        /* Unobstructed: check Fresnel zone clearance */
+        /* Find minimum clearance as fraction of 1st Fresnel zone radius */
+        float min_clearance_ratio = 1e30;
+
+        for (int i = 1; i < n_profile - 1; ++i) {
+            float t = float(i * step) / dist_cells;
+            t = min(t, 1.0);
+            float elev = fresnel_terrain(t);
+
+            float d_along = d_total * t;
+            float d_remain = d_total * (1.0 - t);
+            float earth_curve = d_along * d_remain * uEarthCurveFactor;
+
+            float los_h = uObserverHeight + (rx_h - uObserverHeight) * t;
+            float clearance = los_h - (elev - earth_curve);
+
+            float fresnel_radius = sqrt(lambda * d_along * d_remain / (d_along + d_remain));
+            float ratio = clearance / max(fresnel_radius, 0.001);
+            min_clearance_ratio = min(min_clearance_ratio, ratio);
+        }
+
+        /* Sub-Fresnel clearance causes minor diffraction loss */
+        if (min_clearance_ratio < 1.0 && min_clearance_ratio >= 0.0) {
+            /* Gradual loss for partial Fresnel zone obstruction */
+            diff_loss_db = 6.0 * (1.0 - min_clearance_ratio);
+        } else if (min_clearance_ratio < 0.0) {
+            /* Shouldn't happen if path is "unobstructed" but handle gracefully */
+            float v = -min_clearance_ratio;
+            diff_loss_db = 6.9 + 20.0 * log(sqrt((v - 0.1) * (v - 0.1) + 1.0) + v - 0.1) / log(10.0);
+        }
+    }
+
+    /* Free-space path loss */
+    float dist_km = d_total / 1000.0;
+    dist_km = max(dist_km, 0.01);
+    float fspl = 20.0 * log(dist_km) / log(10.0)
+               + 20.0 * log(uFreqMhz) / log(10.0)
+               + 32.44;
+
+    float eirp = uTxPowerDbm + uAntennaGainDbi - uCableLossDb;
+    float received = eirp - fspl - max(diff_loss_db, 0.0) + uRxAntennaGainDbi - uRxCableLossDb;
+
+    return received;
+}
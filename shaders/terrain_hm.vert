@@ -0,0 +1,52 @@
+#version 330 core
+
+/* Heightmap-displaced LOD terrain (TerrainLodFormat::HEIGHTMAP).
+   Same outputs as terrain.vert; positions, normals and uvs are rebuilt
+   from the tile's R16 height texture. */
+
+layout(location = 0) in vec3 aGrid;    // chunk-local col, row, skirt flag
+layout(location = 5) in vec4 aChunk;   // chunk first col, first row, skirt y
+
+uniform mat4 uModel;
+uniform mat4 uView;
+uniform mat4 uProj;
+
+uniform sampler2D uHeightTex;
+uniform ivec2 uGridSize;      // cols, rows
+uniform vec2  uOrigin;        // world x, z of sample (0, 0)
+uniform vec2  uSpacing;       // meters between samples along x, z
+uniform float uHeightMin;
+uniform float uHeightRange;
+
+out vec3 vWorldPos;
+out vec3 vNormal;
+out vec2 vUV;
+out float vViewshed;
+out float vSignalDbm;
+
+float height_at(ivec2 cr) {
+    cr = clamp(cr, ivec2(0), uGridSize - 1);
+    return uHeightMin + texelFetch(uHeightTex, cr, 0).r * uHeightRange;
+}
+
+void main() {
+    /* Clamp padding past the grid edge, as in build_terrain_lod_data() */
+    ivec2 cr = min(ivec2(aChunk.xy + aGrid.xy), uGridSize - 1);
+
+    float y = aGrid.z > 0.5 ? aChunk.z : height_at(cr);
+    vec3 pos = vec3(uOrigin.x + float(cr.x) * uSpacing.x, y,
+                    uOrigin.y + float(cr.y) * uSpacing.y);
+
+    /* Central differences, matching calc_terrain_normal() */
+    float dhdx = (height_at(cr + ivec2(1, 0)) - height_at(cr - ivec2(1, 0))) / (2.0 * uSpacing.x);
+    float dhdz = (height_at(cr + ivec2(0, 1)) - height_at(cr - ivec2(0, 1))) / (2.0 * uSpacing.y);
+    vec3 n = normalize(vec3(-dhdx, 1.0, -dhdz));
+
+    vec4 world = uModel * vec4(pos, 1.0);
+    vWorldPos = world.xyz;
+    vNormal = mat3(transpose(inverse(uModel))) * n;
+    vUV = vec2(cr) / vec2(max(uGridSize - 1, ivec2(1)));
+    vViewshed = 0.0;     // overlay textures in tile mode
+    vSignalDbm = 0.0;
+    gl_Position = uProj * uView * world;
+}
@@ -0,0 +1,90 @@
+/* Per-node inputs and result output shared by the per-cell propagation
+   shaders (viewshed, itm, fresnel). GpuViewshed inserts this after their
+   #version line, after elevation.glsl, with FUSED_NODES defined for the
+   multi-node variant. */
+
+#ifdef FUSED_NODES
+
+/* One entry per node; gl_GlobalInvocationID.z selects the node, so one
+   dispatch covers a whole batch. Mirrors GpuViewshed::NodeParams. */
+struct NodeParams {
+    ivec2 cell;              // (col, row) of the node
+    float observer_height;   // node_elev + antenna_height
+    float tx_power_dbm;
+    float antenna_gain_dbi;
+    float freq_mhz;
+    float cable_loss_db;
+    float rx_sensitivity_dbm;
+};
+
+layout(std430, binding = 0) readonly buffer NodeBuffer {
+    NodeParams uNodes[];
+};
+uniform int uNodeBase;       // first node of this dispatch
+
+#define NODE_PARAMS        uNodes[uNodeBase + int(gl_GlobalInvocationID.z)]
+#define uNodeCell          NODE_PARAMS.cell
+#define uObserverHeight    NODE_PARAMS.observer_height
+#define uTxPowerDbm        NODE_PARAMS.tx_power_dbm
+#define uAntennaGainDbi    NODE_PARAMS.antenna_gain_dbi
+#define uFreqMhz           NODE_PARAMS.freq_mhz
+#define uCableLossDb       NODE_PARAMS.cable_loss_db
+#define uRxSensitivityDbm  NODE_PARAMS.rx_sensitivity_dbm
+
+/* Merged directly with atomics: visible-node count and the best signal
+   as an order-preserving int (see viewshed_resolve.comp) */
+layout(binding = 1, r32ui) uniform uimage2D uOverlapAcc;
+layout(binding = 2, r32i)  uniform iimage2D uSignalAcc;
+
+/* Or, for GpuViewshed::compute_slices(), each node's unmerged result in
+   its own layer (the node's index in uNodes) */
+layout(binding = 3, r8ui) uniform writeonly uimage2DArray uSliceVis;
+layout(binding = 4, r32f) uniform writeonly image2DArray  uSliceSignal;
+uniform bool uWriteSlices;
+
+int signal_to_ordered(float s) {
+    int i = floatBitsToInt(s);
+    return i >= 0 ? i : i ^ 0x7FFFFFFF;
+}
+
+void write_result(ivec2 cell, bool visible, float signal) {
+    if (uWriteSlices) {
+        ivec3 at = ivec3(cell, uNodeBase + int(gl_GlobalInvocationID.z));
+        imageStore(uSliceVis, at, uvec4(visible ? 1u : 0u, 0, 0, 0));
+        imageStore(uSliceSignal, at, vec4(signal, 0.0, 0.0, 0.0));
+        return;
+    }
+    if (!visible) return;
+    imageAtomicAdd(uOverlapAcc, cell, 1u);
+    imageAtomicMax(uSignalAcc, cell, signal_to_ordered(signal));
+}
+
+#else
+
+layout(binding = 1, r8ui)  uniform writeonly uimage2D uVisibility;
+layout(binding = 2, r32f)  uniform writeonly image2D  uSignal;
+
+uniform ivec2 uNodeCell;        // (col, row) of the node
+uniform float uObserverHeight;  // node_elev + antenna_height
+uniform float uTxPowerDbm;
+uniform float uAntennaGainDbi;
+uniform float uFreqMhz;
+uniform float uCableLossDb;
+uniform float uRxSensitivityDbm;
+
+void write_result(ivec2 cell, bool visible, float signal) {
+    imageStore(uVisibility, cell, uvec4(visible ? 1u : 0u, 0, 0, 0));
+    imageStore(uSignal, cell, vec4(signal, 0.0, 0.0, 0.0));
+}
+
+#endif
+
+/* Coarse-to-fine refinement (GpuViewshed::set_refine_mask): one texel per
+   16x16 cell block, 0 = the block keeps the coarser level's result. The
+   blocks line up with workgroups, so a skipped workgroup exits as a whole. */
+layout(binding = 5, r8ui) uniform readonly uimage2D uRefineMask;
+uniform bool uUseRefineMask;
+
+bool refine_skip(ivec2 cell) {
+    return uUseRefineMask && imageLoad(uRefineMask, cell / 16).r == 0u;
+}
@@ -0,0 +1,290 @@
+#include "analysis/coverage_cache.h"
+#include "analysis/coverage_disk_cache.h"
+#include "analysis/gpu_viewshed.h"
+#include "analysis/viewshed_engine.h"
+#include "util/thread_pool.h"
+#include "util/hash.h"
+#include "util/log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mesh3d {
+
+CoverageCache::Key CoverageCache::key(const mesh3d_node_t& node, const CoverageContext& ctx) {
+    uint64_t h = FNV_OFFSET;
+    hash_field(h, RESULTS_VERSION);
+
+    hash_field(h, node.lat);
+    hash_field(h, node.lon);
+    hash_field(h, node.alt);
+    hash_field(h, node.antenna_height_m);
+    hash_field(h, node.tx_power_dbm);
+    hash_field(h, node.antenna_gain_dbi);
+    hash_field(h, node.rx_sensitivity_dbm);
+    hash_field(h, node.frequency_mhz);
+    hash_field(h, node.cable_loss_db);
+
+    hash_field(h, ctx.rows);
+    hash_field(h, ctx.cols);
+    hash_field(h, ctx.bounds.min_lat);
+    hash_field(h, ctx.bounds.max_lat);
+    hash_field(h, ctx.bounds.min_lon);
+    hash_field(h, ctx.bounds.max_lon);
+    hash_field(h, ctx.terrain_hash);
+    hash_field(h, ctx.rf_config.rx_sensitivity_dbm);
+    hash_field(h, ctx.rf_config.rx_height_agl_m);
+    hash_field(h, ctx.rf_config.rx_antenna_gain_dbi);
+    hash_field(h, ctx.rf_config.rx_cable_loss_db);
+    hash_field(h, static_cast<int>(ctx.model));
+    hash_field(h, ctx.gpu);
+    if (ctx.radials > 0) hash_field(h, ctx.radials);
+
+    if ((ctx.gpu || ctx.radials > 0) && ctx.model == MESH3D_PROP_ITM) {
+        const auto& p = ctx.itm_params;
+        hash_field(h, p.climate);
+        hash_field(h, p.ground_dielectric);
+        hash_field(h, p.ground_conductivity);
+        hash_field(h, p.polarization);
+        hash_field(h, p.situation_pct);
+        hash_field(h, p.time_pct);
+        hash_field(h, p.refractivity);
+        hash_field(h, p.location_pct);
+        hash_field(h, p.mdvar);
+    }
+    return h;
+}
+
+CoverageCache::Key CoverageCache::merged_key(const std::vector<Key>& node_keys,
+                                             int row0, int col0, int rows, int cols) {
+    uint64_t h = FNV_OFFSET;
+    hash_field(h, RESULTS_VERSION);
+    hash_field(h, row0);
+    hash_field(h, col0);
+    hash_field(h, rows);
+    hash_field(h, cols);
+    for (Key k : node_keys) hash_field(h, k);
+    return h;
+}
+
+uint64_t CoverageCache::hash_elevation(const float* data, size_t count) {
+    /* Word-at-a-time multiply/xorshift: fast enough to run on every
+       composite, and any changed sample changes the result */
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ count;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        uint64_t w;
+        std::memcpy(&w, data + i, sizeof(w));
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+    }
+    if (i < count) {
+        uint32_t w;
+        std::memcpy(&w, data + i, sizeof(w));
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+    }
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+CoverageContext make_coverage_context(int rows, int cols, const mesh3d_bounds_t& bounds,
+                                      uint64_t terrain_hash,
+                                      const mesh3d_rf_config_t& rf_config,
+                                      const GpuViewshed* gpu) {
+    CoverageContext ctx;
+    ctx.rows = rows;
+    ctx.cols = cols;
+    ctx.bounds = bounds;
+    ctx.terrain_hash = terrain_hash;
+    if (gpu) {
+        ctx.rf_config = gpu->rf_config();
+        ctx.model = gpu->propagation_model();
+        ctx.gpu = true;
+        ctx.itm_params = gpu->itm_params();
+        if (ctx.model == MESH3D_PROP_ITM || ctx.model == MESH3D_PROP_FRESNEL)
+            ctx.radials = gpu->radial_count();
+    } else {
+        const CpuViewshedEngine& engine = cpu_viewshed_engine();
+        ctx.rf_config = rf_config;
+        ctx.model = engine.propagation_model();
+        if (engine.radial_active()) {
+            ctx.radials = engine.radial_count();
+            ctx.itm_params = engine.itm_params();
+        }
+    }
+    return ctx;
+}
+
+CoverageRect CoverageRect::crop(const std::vector<uint8_t>& visibility,
+                                const std::vector<float>& signal, int rows, int cols) {
+    int r0 = rows, r1 = -1, c0 = cols, c1 = -1;
+    for (int r = 0; r < rows; ++r) {
+        const uint8_t* v = &visibility[static_cast<size_t>(r) * cols];
+        int first = -1, last = -1;
+        for (int c = 0; c < cols; ++c) {
+            if (!v[c]) continue;
+            if (first < 0) first = c;
+            last = c;
+        }
+        if (first < 0) continue;
+        r0 = std::min(r0, r);
+        r1 = r;
+        c0 = std::min(c0, first);
+        c1 = std::max(c1, last);
+    }
+
+    CoverageRect rect;
+    if (r1 < 0) return rect;
+    rect.row0 = r0;
+    rect.col0 = c0;
+    rect.rows = r1 - r0 + 1;
+    rect.cols = c1 - c0 + 1;
+    rect.visibility.resize(static_cast<size_t>(rect.rows) * rect.cols);
+    rect.signal.resize(rect.visibility.size());
+    for (int r = 0; r < rect.rows; ++r) {
+        size_t src = static_cast<size_t>(r0 + r) * cols + c0;
+        size_t dst = static_cast<size_t>(r) * rect.cols;
+        std::copy_n(&visibility[src], rect.cols, &rect.visibility[dst]);
+        std::copy_n(&signal[src], rect.cols, &rect.signal[dst]);
+    }
+    return rect;
+}
+
+void CoverageRect::expand(int grid_rows, int grid_cols,
+                          std::vector<uint8_t>& vis, std::vector<float>& sig) const {
+    size_t total = static_cast<size_t>(grid_rows) * grid_cols;
+    vis.assign(total, 0);
+    sig.assign(total, -999.0f);
+    int r_end = std::min(row0 + rows, grid_rows);
+    int c_end = std::min(col0 + cols, grid_cols);
+    if (c_end <= col0) return;
+    for (int r = row0; r < r_end; ++r) {
+        size_t src = static_cast<size_t>(r - row0) * cols;
+        size_t dst = static_cast<size_t>(r) * grid_cols + col0;
+        std::copy_n(&visibility[src], c_end - col0, &vis[dst]);
+        std::copy_n(&signal[src], c_end - col0, &sig[dst]);
+    }
+}
+
+std::vector<size_t> CoverageCache::begin_pass(const std::vector<Key>& keys) {
+    ++m_pass;
+    std::vector<size_t> missing;
+    std::vector<Key> seen;
+    size_t loaded = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto it = m_entries.find(keys[i]);
+        if (it != m_entries.end()) {
+            it->second.last_use = m_pass;
+            continue;
+        }
+        CoverageRect rect;
+        if (coverage_disk_cache().read(keys[i], rect)) {
+            insert(keys[i], std::move(rect));
+            ++loaded;
+        } else if (std::find(seen.begin(), seen.end(), keys[i]) == seen.end()) {
+            seen.push_back(keys[i]);
+            missing.push_back(i);
+        }
+    }
+    if (loaded > 0)
+        LOG_INFO("Coverage cache: loaded %zu node results from disk", loaded);
+    return missing;
+}
+
+void CoverageCache::store(Key key, const std::vector<uint8_t>& visibility,
+                          const std::vector<float>& signal, int rows, int cols) {
+    CoverageRect rect = CoverageRect::crop(visibility, signal, rows, cols);
+    coverage_disk_cache().write(key, rect);
+    insert(key, std::move(rect));
+}
+
+void CoverageCache::insert(Key key, CoverageRect rect) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_bytes -= it->second.rect.bytes();
+        m_entries.erase(it);
+    }
+    Entry e;
+    e.rect = std::move(rect);
+    e.last_use = m_pass;
+    m_bytes += e.rect.bytes();
+    m_entries.emplace(key, std::move(e));
+    evict();
+}
+
+void CoverageCache::evict() {
+    while (m_bytes > m_budget) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->second.last_use >= m_pass) continue;   // needed by this pass
+            if (oldest == m_entries.end() || it->second.last_use < oldest->second.last_use)
+                oldest = it;
+        }
+        if (oldest == m_entries.end()) {
+            LOG_WARN("Coverage cache: %.1f MB in use, over its %.1f MB budget",
+                     m_bytes / (1024.0 * 1024.0), m_budget / (1024.0 * 1024.0));
+            return;
+        }
+        m_bytes -= oldest->second.rect.bytes();
+        m_entries.erase(oldest);
+    }
+}
+
+bool CoverageCache::merge(const std::vector<Key>& keys, int rows, int cols,
+                          std::vector<uint8_t>& visibility,
+                          std::vector<float>& signal,
+                          std::vector<uint8_t>& overlap,
+                          ThreadPool* pool) const {
+    std::vector<const CoverageRect*> entries;
+    entries.reserve(keys.size());
+    for (Key k : keys) {
+        auto it = m_entries.find(k);
+        if (it == m_entries.end()) return false;
+        if (it->second.rect.rows > 0) entries.push_back(&it->second.rect);
+    }
+
+    size_t total = static_cast<size_t>(rows) * cols;
+    visibility.assign(total, 0);
+    signal.assign(total, -999.0f);
+    overlap.assign(total, 0);
+
+    /* Row bands never share output cells */
+    constexpr int BAND_ROWS = 64;
+    const int bands = (rows + BAND_ROWS - 1) / BAND_ROWS;
+    auto merge_band = [&](int band) {
+        int rb = band * BAND_ROWS;
+        int re = std::min(rb + BAND_ROWS, rows);
+        for (const CoverageRect* e : entries) {
+            int r0 = std::max(rb, e->row0);
+            int r1 = std::min(re, e->row0 + e->rows);
+            for (int r = r0; r < r1; ++r) {
+                size_t src = static_cast<size_t>(r - e->row0) * e->cols;
+                size_t dst = static_cast<size_t>(r) * cols + e->col0;
+                const uint8_t* v = &e->visibility[src];
+                const float* s = &e->signal[src];
+                for (int c = 0; c < e->cols; ++c) {
+                    if (!v[c]) continue;
+                    visibility[dst + c] = 1;
+                    overlap[dst + c]++;
+                    if (s[c] > signal[dst + c])
+                        signal[dst + c] = s[c];
+                }
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallel_for(bands, merge_band);
+    } else {
+        for (int b = 0; b < bands; ++b) merge_band(b);
+    }
+    return true;
+}
+
+void CoverageCache::clear() {
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+} // namespace mesh3d
@@ -0,0 +1,122 @@
+#pragma once
+#include <mesh3d/types.h>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh3d {
+
+class ThreadPool;
+class GpuViewshed;
+
+/* Everything besides the node itself that a node's coverage depends on */
+struct CoverageContext {
+    int rows = 0, cols = 0;
+    mesh3d_bounds_t bounds{};
+    uint64_t terrain_hash = 0;        // hash_elevation() of the grid
+    mesh3d_rf_config_t rf_config{};
+    mesh3d_prop_model_t model = MESH3D_PROP_FSPL;
+    bool gpu = false;                 // GPU kernels differ from the CPU ones
+    int radials = 0;                  // radial-profile engine rays, 0 = per cell
+    mesh3d_itm_params_t itm_params{}; // GPU or radial ITM only
+};
+
+/* Context for a rows x cols grid computed by `gpu` (its model, RF and ITM
+   settings) or, if null, by cpu_viewshed_engine() with `rf_config` */
+CoverageContext make_coverage_context(int rows, int cols, const mesh3d_bounds_t& bounds,
+                                      uint64_t terrain_hash,
+                                      const mesh3d_rf_config_t& rf_config,
+                                      const GpuViewshed* gpu);
+
+/* A visibility/signal result cropped to the bounding rectangle of its
+   visible cells; everything outside is invisible (signal -999) */
+struct CoverageRect {
+    int row0 = 0, col0 = 0;
+    int rows = 0, cols = 0;           // 0 when nothing is visible
+    std::vector<uint8_t> visibility;
+    std::vector<float> signal;
+
+    static CoverageRect crop(const std::vector<uint8_t>& visibility,
+                             const std::vector<float>& signal, int rows, int cols);
+    /* Back to a full grid_rows x grid_cols result */
+    void expand(int grid_rows, int grid_cols,
+                std::vector<uint8_t>& visibility, std::vector<float>& signal) const;
+    size_t bytes() const { return visibility.size() * (sizeof(uint8_t) + sizeof(float)); }
+};
+
+/* Per-node visibility/signal results over the scene elevation grid.
+
+   Entries are keyed by a hash of the node's position and RF parameters
+   plus the CoverageContext, so a node keeps its result until something
+   it depends on changes. merge() rebuilds the merged overlay from cached
+   entries alone, which makes adding a node cost one viewshed and removing
+   one cost no ray marching at all.
+
+   Misses fall through to coverage_disk_cache(), and new entries are
+   written to it, so results survive restarts. When memory use grows past
+   the byte budget, entries not used by the current pass are evicted least
+   recently used first. */
+class CoverageCache {
+public:
+    using Key = uint64_t;
+
+    static constexpr size_t DEFAULT_BUDGET = 512u << 20;
+
+    /* Version of the results themselves, hashed into every key so entries
+       on disk from older code are never read back. Bump it with any change
+       to a propagation model, viewshed kernel or shader that alters what
+       they compute. */
+    static constexpr uint32_t RESULTS_VERSION = 1;
+
+    static Key key(const mesh3d_node_t& node, const CoverageContext& ctx);
+
+    /* Key of a merged result over rows x cols cells at (row0, col0) of
+       the grid the nodes were keyed against (e.g. a tile's center window) */
+    static Key merged_key(const std::vector<Key>& node_keys,
+                          int row0, int col0, int rows, int cols);
+
+    /* Content hash of an elevation grid, for CoverageContext::terrain_hash */
+    static uint64_t hash_elevation(const float* data, size_t count);
+
+    /* Start a pass over `keys` (one per node, in node order): marks the
+       cached ones as in use, loads what it can from disk, and returns the
+       indices of the nodes that still need computing, one per distinct key. */
+    std::vector<size_t> begin_pass(const std::vector<Key>& keys);
+
+    bool contains(Key key) const { return m_entries.count(key) != 0; }
+
+    /* Keep one node's rows x cols result (and write it to disk) */
+    void store(Key key, const std::vector<uint8_t>& visibility,
+               const std::vector<float>& signal, int rows, int cols);
+
+    /* Merged coverage of `keys`, with the same rules as
+       CpuViewshedEngine::compute_merged. Returns false (outputs untouched)
+       if any key is missing. Row bands run on `pool` if given. */
+    bool merge(const std::vector<Key>& keys, int rows, int cols,
+               std::vector<uint8_t>& visibility,
+               std::vector<float>& signal,
+               std::vector<uint8_t>& overlap,
+               ThreadPool* pool = nullptr) const;
+
+    void clear();
+    void set_budget(size_t bytes) { m_budget = bytes; }
+    size_t bytes() const { return m_bytes; }
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        CoverageRect rect;
+        uint64_t last_use = 0;
+    };
+
+    std::unordered_map<Key, Entry> m_entries;
+    size_t m_bytes = 0;
+    size_t m_budget = DEFAULT_BUDGET;
+    uint64_t m_pass = 0;
+
+    void insert(Key key, CoverageRect rect);
+    void evict();
+};
+
+} // namespace mesh3d
@@ -0,0 +1,210 @@
+#include "analysis/coverage_disk_cache.h"
+#include "util/log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace mesh3d {
+
+static constexpr uint16_t M3VC_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 28;
+
+/* ── Little-endian field helpers ───────────────────────────────────── */
+
+template<typename T>
+static void put_le(uint8_t* p, T v) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &v, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) p[i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+template<typename T>
+static T get_le(const uint8_t* p) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) bits |= static_cast<uint64_t>(p[i]) << (8 * i);
+    T v;
+    std::memcpy(&v, &bits, sizeof(T));
+    return v;
+}
+
+CoverageDiskCache& coverage_disk_cache() {
+    static CoverageDiskCache cache;
+    return cache;
+}
+
+static std::string default_coverage_dir() {
+    const char* home = std::getenv("HOME");
+    if (home) return std::string(home) + "/.cache/mesh3d/coverage";
+    return "/tmp/mesh3d/coverage";
+}
+
+CoverageDiskCache::CoverageDiskCache(const std::string& cache_dir)
+    : m_cache(cache_dir.empty() ? default_coverage_dir() : cache_dir) {}
+
+std::string CoverageDiskCache::key_name(CoverageCache::Key key) {
+    /* Two-level fan-out keeps directories small */
+    char name[40];
+    std::snprintf(name, sizeof(name), "%02x/%016llx.m3vc",
+                  static_cast<unsigned>(key >> 56), static_cast<unsigned long long>(key));
+    return name;
+}
+
+std::vector<uint8_t> CoverageDiskCache::encode(const CoverageRect& rect) {
+    const size_t cells = rect.visibility.size();
+    uint32_t visible = 0;
+    for (uint8_t v : rect.visibility) visible += v ? 1 : 0;
+
+    /* visibility | signal planes (byte p of every visible cell's float) */
+    std::vector<uint8_t> raw(cells + static_cast<size_t>(visible) * 4);
+    std::memcpy(raw.data(), rect.visibility.data(), cells);
+    uint8_t* planes = raw.data() + cells;
+    size_t k = 0;
+    for (size_t i = 0; i < cells; ++i) {
+        if (!rect.visibility[i]) continue;
+        uint32_t bits;
+        std::memcpy(&bits, &rect.signal[i], 4);
+        for (int p = 0; p < 4; ++p)
+            planes[static_cast<size_t>(p) * visible + k] = static_cast<uint8_t>(bits >> (8 * p));
+        ++k;
+    }
+
+    uLongf len = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> out(HEADER_SIZE + len);
+    uint8_t* h = out.data();
+    std::memcpy(h, "M3VC", 4);
+    put_le<uint16_t>(h + 4, M3VC_VERSION);
+    put_le<uint16_t>(h + 6, 0);
+    put_le<int32_t>(h + 8, rect.row0);
+    put_le<int32_t>(h + 12, rect.col0);
+    put_le<int32_t>(h + 16, rect.rows);
+    put_le<int32_t>(h + 20, rect.cols);
+    put_le<uint32_t>(h + 24, visible);
+    compress2(out.data() + HEADER_SIZE, &len, raw.data(), static_cast<uLong>(raw.size()), 6);
+    out.resize(HEADER_SIZE + len);
+    return out;
+}
+
+bool CoverageDiskCache::decode(const std::vector<uint8_t>& data, CoverageRect& out) {
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), "M3VC", 4) != 0) return false;
+    const uint8_t* h = data.data();
+    if (get_le<uint16_t>(h + 4) != M3VC_VERSION) return false;
+
+    CoverageRect rect;
+    rect.row0 = get_le<int32_t>(h + 8);
+    rect.col0 = get_le<int32_t>(h + 12);
+    rect.rows = get_le<int32_t>(h + 16);
+    rect.cols = get_le<int32_t>(h + 20);
+    uint32_t visible = get_le<uint32_t>(h + 24);
+    if (rect.rows < 0 || rect.cols < 0 || rect.row0 < 0 || rect.col0 < 0) return false;
+
+    size_t cells = static_cast<size_t>(rect.rows) * rect.cols;
+    if (visible > cells) return false;
+    std::vector<uint8_t> raw(cells + static_cast<size_t>(visible) * 4);
+    uLongf len = static_cast<uLongf>(raw.size());
+    if (!raw.empty() &&
+        (uncompress(raw.data(), &len, h + HEADER_SIZE,
+                    static_cast<uLong>(data.size() - HEADER_SIZE)) != Z_OK ||
+         len != raw.size()))
+        return false;
+
+    rect.visibility.assign(raw.begin(), raw.begin() + cells);
+    rect.signal.assign(cells, -999.0f);
+    const uint8_t* planes = raw.data() + cells;
+    size_t k = 0;
+    for (size_t i = 0; i < cells; ++i) {
+        if (!rect.visibility[i]) continue;
+        if (k >= visible) return false;
+        uint32_t bits = 0;
+        for (int p = 0; p < 4; ++p)
+            bits |= static_cast<uint32_t>(planes[static_cast<size_t>(p) * visible + k]) << (8 * p);
+        std::memcpy(&rect.signal[i], &bits, 4);
+        ++k;
+    }
+    if (k != visible) return false;
+
+    out = std::move(rect);
+    return true;
+}
+
+bool CoverageDiskCache::read(CoverageCache::Key key, CoverageRect& out) const {
+    if (!m_enabled) return false;
+    std::string name = key_name(key);
+    std::vector<uint8_t> data = m_cache.read(name);
+    if (data.empty()) return false;
+    if (!decode(data, out)) {
+        LOG_WARN("Coverage cache: discarding corrupt entry %s", name.c_str());
+        return false;
+    }
+
+    /* Recently read entries are the last to be evicted */
+    std::error_code ec;
+    fs::last_write_time(m_cache.path(name), fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+bool CoverageDiskCache::write(CoverageCache::Key key, const CoverageRect& rect) {
+    if (!m_enabled) return false;
+    std::vector<uint8_t> data = encode(rect);
+    std::string name = key_name(key);
+
+    /* An overwritten entry's old bytes leave the count */
+    std::error_code ec;
+    uint64_t old_size = fs::file_size(m_cache.path(name), ec);
+    if (ec) old_size = 0;
+
+    if (!m_cache.write(name, data)) return false;
+
+    m_bytes -= std::min(m_bytes, old_size);
+    m_bytes += data.size();
+    if (!m_scanned || m_bytes > m_budget) trim();
+    return true;
+}
+
+void CoverageDiskCache::set_budget(uint64_t bytes) {
+    m_budget = bytes;
+    if (m_scanned && m_bytes > m_budget) trim();
+}
+
+void CoverageDiskCache::trim() {
+    struct File {
+        fs::file_time_type mtime;
+        uint64_t size;
+        fs::path path;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(m_cache.cache_dir(), ec), end; !ec && it != end;
+         it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().extension() != ".m3vc") continue;
+        File f{it->last_write_time(ec), it->file_size(ec), it->path()};
+        if (ec) { ec.clear(); continue; }
+        total += f.size;
+        files.push_back(std::move(f));
+    }
+    m_scanned = true;
+    m_bytes = total;
+    if (m_bytes <= m_budget) return;
+
+    std::sort(files.begin(), files.end(),
+              [](const File& a, const File& b) { return a.mtime < b.mtime; });
+    const uint64_t target = m_budget / 4 * 3;
+    size_t removed = 0;
+    for (const File& f : files) {
+        if (m_bytes <= target) break;
+        if (fs::remove(f.path, ec)) {
+            m_bytes -= f.size;
+            ++removed;
+        }
+    }
+    LOG_INFO("Coverage cache: evicted %zu entries, %.1f MB on disk",
+             removed, m_bytes / (1024.0 * 1024.0));
+}
+
+} // namespace mesh3d
@@ -0,0 +1,67 @@
+#pragma once
+#include "analysis/coverage_cache.h"
+#include "tile/disk_cache.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* Content-addressed store of coverage results under
+   ~/.cache/mesh3d/coverage/, one file per CoverageCache key (per-node
+   scene-grid results and merged per-tile overlays alike), so reopening
+   the same deployment skips the propagation work.
+
+   File layout (little-endian):
+
+     header  "M3VC" u16 version u16 reserved
+             i32 row0 col0 rows cols u32 visible_count
+     payload deflate( visibility[rows * cols]
+                      | signal of the visible cells, byte-shuffled into 4 planes )
+
+   Only the cropped rectangle and the signal of visible cells are stored;
+   the visibility mask and the shuffled float planes deflate well. Writes
+   go through DiskCache (temp file + rename), so a crash never leaves a
+   partial entry.
+
+   The directory is capped at budget() bytes: a read marks its entry as
+   used (file mtime), and a write that takes the total past the budget
+   deletes the least recently used entries down to 3/4 of it. Safe to call
+   from one thread at a time. */
+class CoverageDiskCache {
+public:
+    explicit CoverageDiskCache(const std::string& cache_dir = "");
+
+    bool read(CoverageCache::Key key, CoverageRect& out) const;
+    bool write(CoverageCache::Key key, const CoverageRect& rect);
+
+    /* Off: read() always misses and write() does nothing */
+    void set_enabled(bool on) { m_enabled = on; }
+    bool enabled() const { return m_enabled; }
+
+    static constexpr uint64_t DEFAULT_BUDGET = 2ull << 30;
+    void set_budget(uint64_t bytes);
+    uint64_t budget() const { return m_budget; }
+
+    const std::string& cache_dir() const { return m_cache.cache_dir(); }
+
+    static std::vector<uint8_t> encode(const CoverageRect& rect);
+    static bool decode(const std::vector<uint8_t>& data, CoverageRect& out);
+
+private:
+    DiskCache m_cache;
+    bool m_enabled = true;
+    uint64_t m_budget = DEFAULT_BUDGET;
+    uint64_t m_bytes = 0;          // entries on disk, once m_scanned
+    bool m_scanned = false;
+
+    static std::string key_name(CoverageCache::Key key);
+    /* Size the directory, and if it is over budget delete the oldest
+       entries down to 3/4 of it */
+    void trim();
+};
+
+/* Process-wide store used by CoverageCache and the tile viewshed paths */
+CoverageDiskCache& coverage_disk_cache();
+
+} // namespace mesh3d
@@ -4,9 +4,23 @@
 #include <algorithm>
 #include <cstring>
 #include <chrono>
+#include <cstdint>
 
 namespace mesh3d {
 
+/* Chebyshev radius from the node cell that reaches every grid corner */
+static int sweep_radius(int nc, int nr, int rows, int cols) {
+    return std::max({std::abs(nr), std::abs(rows - 1 - nr),
+                     std::abs(nc), std::abs(cols - 1 - nc)});
+}
+
+/* Euclidean distance from the node cell to the farthest grid corner */
+static float corner_distance(int nc, int nr, int rows, int cols) {
+    float dr = static_cast<float>(std::max(std::abs(nr), std::abs(rows - 1 - nr)));
+    float dc = static_cast<float>(std::max(std::abs(nc), std::abs(cols - 1 - nc)));
+    return std::sqrt(dr * dr + dc * dc);
+}
+
 GpuViewshed::~GpuViewshed() {
     shutdown();
 }
@@ -24,7 +38,17 @@ bool GpuViewshed::init(const std::string& shader_dir) {
         return false;
     }
 
-    if (!m_viewshed_shader.load(shader_dir + "/viewshed.comp")) {
+    /* Every propagation shader reads elevation through a shared prelude,
+       and the per-cell ones take their node inputs from a second one */
+    const std::vector<std::string> elev_glsl = {shader_dir + "/elevation.glsl"};
+    const std::vector<std::string> node_glsl = {shader_dir + "/elevation.glsl",
+                                                shader_dir + "/viewshed_node.glsl"};
+    std::vector<std::string> itm_glsl = node_glsl;
+    itm_glsl.push_back(shader_dir + "/itm_model.glsl");
+    std::vector<std::string> fresnel_glsl = node_glsl;
+    fresnel_glsl.push_back(shader_dir + "/fresnel_model.glsl");
+
+    if (!m_viewshed_shader.load(shader_dir + "/viewshed.comp", node_glsl)) {
         LOG_ERROR("GPU viewshed: failed to load viewshed.comp");
         return false;
     }
@@ -35,24 +59,62 @@ bool GpuViewshed::init(const std::string& shader_dir) {
     }
 
     /* ITM and Fresnel shaders are optional */
-    m_has_itm = m_itm_shader.load(shader_dir + "/itm.comp");
+    m_has_itm = m_itm_shader.load(shader_dir + "/itm.comp", itm_glsl);
     if (!m_has_itm) {
         LOG_WARN("GPU viewshed: itm.comp not found, ITM model unavailable");
     }
 
-    m_has_fresnel = m_fresnel_shader.load(shader_dir + "/fresnel.comp");
+    m_has_fresnel = m_fresnel_shader.load(shader_dir + "/fresnel.comp", fresnel_glsl);
     if (!m_has_fresnel) {
         LOG_WARN("GPU viewshed: fresnel.comp not found, Fresnel model unavailable");
     }
 
+    m_has_sweep = m_sweep_shader.load(shader_dir + "/viewshed_sweep.comp", elev_glsl);
+    if (!m_has_sweep) {
+        LOG_WARN("GPU viewshed: viewshed_sweep.comp not found, sweep model unavailable");
+    }
+
+    /* Fused multi-node variants; models without one run per node */
+    const char* fused_def = "#define FUSED_NODES 1\n";
+    m_has_fused = m_resolve_shader.load(shader_dir + "/viewshed_resolve.comp") &&
+                  m_viewshed_fused.load(shader_dir + "/viewshed.comp", node_glsl, fused_def);
+    if (m_has_fused) {
+        if (m_has_itm) m_itm_fused.load(shader_dir + "/itm.comp", itm_glsl, fused_def);
+        if (m_has_fresnel) m_fresnel_fused.load(shader_dir + "/fresnel.comp", fresnel_glsl, fused_def);
+    } else {
+        LOG_WARN("GPU viewshed: fused shaders unavailable, dispatching one node at a time");
+    }
+
+    /* Radial-profile variants; without one the model evaluates every cell */
+    if (m_has_itm)
+        m_itm_radial.load(shader_dir + "/viewshed_radial.comp", itm_glsl, "#define RADIAL_ITM 1\n");
+    if (m_has_fresnel)
+        m_fresnel_radial.load(shader_dir + "/viewshed_radial.comp", fresnel_glsl);
+
+    GLint max_layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    m_max_layers = std::clamp(static_cast<int>(max_layers), 1, 256);
+
     m_initialized = true;
-    LOG_INFO("GPU viewshed compute shaders initialized (ITM=%s, Fresnel=%s)",
-             m_has_itm ? "yes" : "no", m_has_fresnel ? "yes" : "no");
+    LOG_INFO("GPU viewshed compute shaders initialized (ITM=%s, Fresnel=%s, Sweep=%s, Fused=%s)",
+             m_has_itm ? "yes" : "no", m_has_fresnel ? "yes" : "no",
+             m_has_sweep ? "yes" : "no", m_has_fused ? "yes" : "no");
     return true;
 }
 
 void GpuViewshed::shutdown() {
     destroy_textures();
+    if (m_node_ssbo) { glDeleteBuffers(1, &m_node_ssbo); m_node_ssbo = 0; }
+    if (m_refine_tex) { glDeleteTextures(1, &m_refine_tex); m_refine_tex = 0; }
+    m_refine = false;
+    if (m_radial_profile_ssbo) { glDeleteBuffers(1, &m_radial_profile_ssbo); m_radial_profile_ssbo = 0; }
+    if (m_radial_signal_ssbo) { glDeleteBuffers(1, &m_radial_signal_ssbo); m_radial_signal_ssbo = 0; }
+    m_radial_bytes = 0;
+    if (m_fence) { glDeleteSync(m_fence); m_fence = nullptr; }
+    if (m_readback_pbo) { glDeleteBuffers(1, &m_readback_pbo); m_readback_pbo = 0; }
+    m_readback_bytes = 0;
+    m_readback_staged = false;
+    m_state = ComputeState::IDLE;
     m_initialized = false;
 }
 
@@ -65,11 +127,23 @@ void GpuViewshed::set_propagation_model(mesh3d_prop_model_t model) {
         LOG_WARN("Fresnel propagation model not available, keeping current model");
         return;
     }
+    if (model == MESH3D_PROP_SWEEP && !m_has_sweep) {
+        LOG_WARN("Sweep propagation model not available, keeping current model");
+        return;
+    }
     m_prop_model = model;
-    const char* names[] = {"FSPL", "ITM", "Fresnel"};
+    const char* names[] = {"FSPL", "ITM", "Fresnel", "Sweep"};
     LOG_INFO("Propagation model: %s", names[static_cast<int>(model)]);
 }
 
+void GpuViewshed::set_radial_count(int radials) {
+    m_radials = radials > 0 ? std::clamp(radials, MIN_RADIALS, MAX_RADIALS) : 0;
+    if (m_radials > 0)
+        LOG_INFO("Propagation engine: radial profiles, %d rays per node", m_radials);
+    else
+        LOG_INFO("Propagation engine: per cell");
+}
+
 void GpuViewshed::set_itm_params(const mesh3d_itm_params_t& params) {
     m_itm_params = params;
 }
@@ -78,8 +152,19 @@ void GpuViewshed::set_rf_config(const mesh3d_rf_config_t& config) {
     m_rf_config = config;
 }
 
+float ElevationFrame::elevation(int row, int col) const {
+    int r = row * step + row_offset;
+    int c = col * step + col_offset;
+    if (r < 0 || c < 0 || tile_rows <= 0 || tile_cols <= 0) return 0.0f;
+    int tr = r / tile_rows, tc = c / tile_cols;
+    if (tr > 2 || tc > 2) return 0.0f;
+    const float* tile = tiles[tr * 3 + tc];
+    if (!tile) return 0.0f;
+    return tile[static_cast<size_t>(r - tr * tile_rows) * tile_cols + (c - tc * tile_cols)];
+}
+
 void GpuViewshed::create_textures(int rows, int cols) {
-    if (m_rows == rows && m_cols == cols && m_elevation_tex != 0)
+    if (m_rows == rows && m_cols == cols && m_node_vis_tex != 0)
         return; // already allocated at correct size
 
     destroy_textures();
@@ -106,24 +191,42 @@ void GpuViewshed::create_textures(int rows, int cols) {
         return tex;
     };
 
-    m_elevation_tex  = make_r32f();
     m_node_vis_tex   = make_r8ui();
     m_node_sig_tex   = make_r32f();
     m_merged_vis_tex = make_r8ui();
     m_merged_sig_tex = make_r32f();
     m_overlap_tex    = make_r8ui();
 
+    if (m_has_fused) {
+        auto make_r32 = [&](GLenum format) -> GLuint {
+            GLuint tex;
+            glGenTextures(1, &tex);
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glTexStorage2D(GL_TEXTURE_2D, 1, format, cols, rows);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            return tex;
+        };
+        m_overlap_acc_tex = make_r32(GL_R32UI);
+        m_signal_acc_tex  = make_r32(GL_R32I);
+    }
+
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void GpuViewshed::destroy_textures() {
     GLuint textures[] = {
         m_elevation_tex, m_node_vis_tex, m_node_sig_tex,
-        m_merged_vis_tex, m_merged_sig_tex, m_overlap_tex
+        m_merged_vis_tex, m_merged_sig_tex, m_overlap_tex,
+        m_overlap_acc_tex, m_signal_acc_tex, m_slice_vis_tex, m_slice_sig_tex
     };
-    for (auto& t : textures) {
-        if (t) { glDeleteTextures(1, &t); t = 0; }
-    }
+    for (auto& t : textures)
+        if (t) glDeleteTextures(1, &t);
+    m_elevation_tex = m_node_vis_tex = m_node_sig_tex = 0;
+    m_merged_vis_tex = m_merged_sig_tex = m_overlap_tex = 0;
+    m_overlap_acc_tex = m_signal_acc_tex = 0;
+    m_slice_vis_tex = m_slice_sig_tex = 0;
+    m_slice_layers = 0;
     m_rows = 0;
     m_cols = 0;
 }
@@ -166,15 +269,95 @@ void GpuViewshed::clear_merge_textures() {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+/* -----------------------------------------------------------------------
+ * Slice arrays for compute_slices(): layer i holds node i's visibility and
+ * signal as the per-node scratch textures would. Reallocated only when the
+ * layer count or grid changes.
+ * ----------------------------------------------------------------------- */
+int GpuViewshed::max_slices() const {
+    size_t cells = static_cast<size_t>(std::max(m_rows, 1)) * std::max(m_cols, 1);
+    size_t fit = SLICE_BUDGET / (cells * (sizeof(float) + 1));
+    return static_cast<int>(std::clamp<size_t>(fit, 1, static_cast<size_t>(m_max_layers)));
+}
+
+void GpuViewshed::create_slices(int layers) {
+    if (layers != m_slice_layers) {
+        if (m_slice_vis_tex) glDeleteTextures(1, &m_slice_vis_tex);
+        if (m_slice_sig_tex) glDeleteTextures(1, &m_slice_sig_tex);
+        auto make = [&](GLenum format) -> GLuint {
+            GLuint tex;
+            glGenTextures(1, &tex);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+            glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, format, m_cols, m_rows, layers);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            return tex;
+        };
+        m_slice_vis_tex = make(GL_R8UI);
+        m_slice_sig_tex = make(GL_R32F);
+        m_slice_layers = layers;
+    }
+
+    /* Cells a shader skips (refinement, out of range) read as invisible */
+    uint8_t zero_u8 = 0;
+    float neg999 = -999.0f;
+    if (GLAD_GL_ARB_clear_texture) {
+        glClearTexImage(m_slice_vis_tex, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &zero_u8);
+        glClearTexImage(m_slice_sig_tex, 0, GL_RED, GL_FLOAT, &neg999);
+    } else {
+        size_t total = static_cast<size_t>(m_rows) * m_cols * layers;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_vis_tex);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, m_cols, m_rows, layers,
+                        GL_RED_INTEGER, GL_UNSIGNED_BYTE, std::vector<uint8_t>(total, zero_u8).data());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_sig_tex);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, m_cols, m_rows, layers,
+                        GL_RED, GL_FLOAT, std::vector<float>(total, neg999).data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void GpuViewshed::copy_to_slice(int layer) {
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glCopyImageSubData(m_node_vis_tex, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       m_slice_vis_tex, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+                       m_cols, m_rows, 1);
+    glCopyImageSubData(m_node_sig_tex, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       m_slice_sig_tex, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+                       m_cols, m_rows, 1);
+}
+
 void GpuViewshed::upload_elevation(const float* data, int rows, int cols) {
     create_textures(rows, cols);
+    m_use_frame = false;
 
+    if (!m_elevation_tex) {
+        glGenTextures(1, &m_elevation_tex);
+        glBindTexture(GL_TEXTURE_2D, m_elevation_tex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, cols, rows);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
     glBindTexture(GL_TEXTURE_2D, m_elevation_tex);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cols, rows,
                     GL_RED, GL_FLOAT, data);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void GpuViewshed::set_elevation_frame(const ElevationFrame& frame, int rows, int cols) {
+    create_textures(rows, cols);
+
+    /* The tiles are already resident; a grid-sized copy would only take
+       memory */
+    if (m_elevation_tex) {
+        glDeleteTextures(1, &m_elevation_tex);
+        m_elevation_tex = 0;
+    }
+    m_frame = frame;
+    m_use_frame = true;
+}
+
 void GpuViewshed::set_grid_params(const mesh3d_bounds_t& bounds, int rows, int cols) {
     m_bounds = bounds;
 
@@ -186,6 +369,34 @@ void GpuViewshed::set_grid_params(const mesh3d_bounds_t& bounds, int rows, int c
     float cell_m_lat = static_cast<float>(lat_res * m_per_deg_lat);
     float cell_m_lon = static_cast<float>(lon_res * m_per_deg_lon);
     m_cell_meters = (cell_m_lat + cell_m_lon) * 0.5f;
+    m_refine = false;
+}
+
+void GpuViewshed::set_refine_mask(const std::vector<uint8_t>* mask) {
+    m_refine = false;
+    if (!mask || !m_initialized) return;
+
+    int br = refine_block_rows(), bc = refine_block_cols();
+    if (mask->size() != static_cast<size_t>(br) * bc) {
+        LOG_WARN("GPU viewshed: refine mask is %zu blocks, grid needs %dx%d; ignoring",
+                 mask->size(), bc, br);
+        return;
+    }
+
+    if (!m_refine_tex || br != m_refine_rows || bc != m_refine_cols) {
+        if (m_refine_tex) glDeleteTextures(1, &m_refine_tex);
+        glGenTextures(1, &m_refine_tex);
+        glBindTexture(GL_TEXTURE_2D, m_refine_tex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, bc, br);
+        m_refine_rows = br;
+        m_refine_cols = bc;
+    }
+    glBindTexture(GL_TEXTURE_2D, m_refine_tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bc, br, GL_RED_INTEGER, GL_UNSIGNED_BYTE, mask->data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_refine = true;
 }
 
 /* -----------------------------------------------------------------------
@@ -200,11 +411,32 @@ void GpuViewshed::set_environment_uniforms(ComputeShader* shader) {
     shader->set_float("uCellMeters", m_cell_meters);
     shader->set_float("uEarthCurveFactor", 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f));
 
+    /* Max range = grid diagonal (the propagation model + FSPL early-out
+       naturally limit coverage; no artificial radius cutoff). */
+    int grid_diag = static_cast<int>(
+        std::sqrt(static_cast<float>(m_rows * m_rows + m_cols * m_cols)));
+    shader->set_int("uMaxRangeCells", grid_diag);
+
     /* RX config (same receiver assumed at every pixel) */
     shader->set_float("uRxAntennaGainDbi", m_rf_config.rx_antenna_gain_dbi);
     shader->set_float("uRxCableLossDb", m_rf_config.rx_cable_loss_db);
     shader->set_float("uTargetHeight", m_rf_config.rx_height_agl_m);
 
+    /* Elevation source: the uploaded grid (unit 0) or a tile frame (unit 6) */
+    shader->set_int("uUseFrame", m_use_frame ? 1 : 0);
+    if (m_use_frame) {
+        shader->set_ivec2("uFrameTile", m_frame.tile_cols, m_frame.tile_rows);
+        shader->set_ivec2("uFrameOffset", m_frame.col_offset, m_frame.row_offset);
+        shader->set_int("uFrameStep", m_frame.step);
+        shader->set_int_array("uFrameLayers", m_frame.layers, 9);
+        glBindImageTexture(6, m_frame.texture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_R32F);
+    }
+
+    /* Coarse-to-fine refinement mask (set_refine_mask) */
+    shader->set_int("uUseRefineMask", m_refine ? 1 : 0);
+    if (m_refine)
+        glBindImageTexture(5, m_refine_tex, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8UI);
+
     /* ITM terrain / climate / statistical parameters */
     if (m_prop_model == MESH3D_PROP_ITM && m_has_itm) {
         shader->set_int("uClimate", m_itm_params.climate);
@@ -219,36 +451,149 @@ void GpuViewshed::set_environment_uniforms(ComputeShader* shader) {
     }
 }
 
+float GpuViewshed::node_elevation(int row, int col, const float* cpu_elevation) const {
+    if (m_use_frame) return m_frame.elevation(row, col);
+    if (cpu_elevation) return cpu_elevation[row * m_cols + col];
+
+    float elev = 0.0f;
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, m_elevation_tex, 0);
+    glReadPixels(col, row, 1, 1, GL_RED, GL_FLOAT, &elev);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    return elev;
+}
+
 /* -----------------------------------------------------------------------
  * Per-node TX uniforms: hardware-profile-dependent values that differ
  * between e.g. a Heltec V3 (22 dBm, 2 dBi) and a Station G2 (30 dBm,
  * 3 dBi).  These change on every loop iteration.
  * ----------------------------------------------------------------------- */
+GpuViewshed::NodeParams GpuViewshed::node_params(const NodeData& nd, int nc, int nr,
+                                                 float observer_height) const {
+    /* Per-node TX hardware profile — each node type has its own values */
+    NodeParams p;
+    p.col = nc;
+    p.row = nr;
+    p.observer_height = observer_height;
+
+    p.tx_power_dbm = nd.info.tx_power_dbm;
+    if (p.tx_power_dbm <= 0) p.tx_power_dbm = 22.0f;
+
+    p.freq_mhz = nd.info.frequency_mhz;
+    if (p.freq_mhz <= 0) p.freq_mhz = 906.875f;
+
+    p.rx_sensitivity_dbm = nd.info.rx_sensitivity_dbm;
+    if (p.rx_sensitivity_dbm >= 0) p.rx_sensitivity_dbm = m_rf_config.rx_sensitivity_dbm;
+
+    p.antenna_gain_dbi = nd.info.antenna_gain_dbi;
+    p.cable_loss_db = nd.info.cable_loss_db;
+    return p;
+}
+
 void GpuViewshed::set_node_uniforms(ComputeShader* shader, const NodeData& nd,
                                      int nc, int nr, float observer_height) {
-    /* Per-node TX hardware profile — each node type has its own values */
-    float tx_power_dbm = nd.info.tx_power_dbm;
-    if (tx_power_dbm <= 0) tx_power_dbm = 22.0f;
+    NodeParams p = node_params(nd, nc, nr, observer_height);
+    shader->set_ivec2("uNodeCell", p.col, p.row);
+    shader->set_float("uObserverHeight", p.observer_height);
+    shader->set_float("uTxPowerDbm", p.tx_power_dbm);
+    shader->set_float("uAntennaGainDbi", p.antenna_gain_dbi);
+    shader->set_float("uFreqMhz", p.freq_mhz);
+    shader->set_float("uCableLossDb", p.cable_loss_db);
+    shader->set_float("uRxSensitivityDbm", p.rx_sensitivity_dbm);
+    shader->set_int("uSweepRadius", sweep_radius(nc, nr, m_rows, m_cols));
+}
 
-    float freq_mhz = nd.info.frequency_mhz;
-    if (freq_mhz <= 0) freq_mhz = 906.875f;
+ComputeShader* GpuViewshed::select_shader() {
+    if (m_prop_model == MESH3D_PROP_ITM && m_has_itm)
+        return m_radials > 0 && m_itm_radial.id() ? &m_itm_radial : &m_itm_shader;
+    if (m_prop_model == MESH3D_PROP_FRESNEL && m_has_fresnel)
+        return m_radials > 0 && m_fresnel_radial.id() ? &m_fresnel_radial : &m_fresnel_shader;
+    if (m_prop_model == MESH3D_PROP_SWEEP && m_has_sweep)
+        return &m_sweep_shader;
+    return &m_viewshed_shader;
+}
 
-    float rx_sens = nd.info.rx_sensitivity_dbm;
-    if (rx_sens >= 0) rx_sens = m_rf_config.rx_sensitivity_dbm;
+ComputeShader* GpuViewshed::select_fused_shader() {
+    if (!fused_dispatch() || is_radial(select_shader())) return nullptr;
+    ComputeShader* fused = nullptr;
+    if (m_prop_model == MESH3D_PROP_ITM && m_has_itm)
+        fused = &m_itm_fused;
+    else if (m_prop_model == MESH3D_PROP_FRESNEL && m_has_fresnel)
+        fused = &m_fresnel_fused;
+    else if (m_prop_model == MESH3D_PROP_SWEEP && m_has_sweep)
+        return nullptr;      // one invocation per ray, per node
+    else
+        fused = &m_viewshed_fused;
+    return fused->id() ? fused : nullptr;
+}
 
-    shader->set_ivec2("uNodeCell", nc, nr);
-    shader->set_float("uObserverHeight", observer_height);
-    shader->set_float("uTxPowerDbm", tx_power_dbm);
-    shader->set_float("uAntennaGainDbi", nd.info.antenna_gain_dbi);
-    shader->set_float("uFreqMhz", freq_mhz);
-    shader->set_float("uCableLossDb", nd.info.cable_loss_db);
-    shader->set_float("uRxSensitivityDbm", rx_sens);
+void GpuViewshed::dispatch_sweep(int nc, int nr) {
+    int rays = 4 * (2 * sweep_radius(nc, nr, m_rows, m_cols) + 1);
+    m_sweep_shader.dispatch((rays + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
 
-    /* Max range = grid diagonal (the propagation model + FSPL early-out
-       naturally limit coverage; no artificial radius cutoff). */
+/* -----------------------------------------------------------------------
+ * Radial-profile engine: rays x samples tables of ground elevation and
+ * received signal in two SSBOs, filled by the profile and evaluate passes,
+ * then interpolated onto the node's scratch textures. The caller has the
+ * radial shader in use with the node's uniforms set.
+ * ----------------------------------------------------------------------- */
+void GpuViewshed::dispatch_radial(ComputeShader* shader, int nc, int nr) {
+    /* Enough samples for the farthest grid corner to interpolate between
+       two; no more rays than the outermost ring has cells */
     int grid_diag = static_cast<int>(
         std::sqrt(static_cast<float>(m_rows * m_rows + m_cols * m_cols)));
-    shader->set_int("uMaxRangeCells", grid_diag);
+    float reach = std::min(corner_distance(nc, nr, m_rows, m_cols),
+                           static_cast<float>(grid_diag));
+    int samples = static_cast<int>(std::ceil(reach)) + 2;
+    int rays = std::clamp(static_cast<int>(std::ceil(2.0 * M_PI * reach)), 8, m_radials);
+
+    size_t bytes = static_cast<size_t>(rays) * samples * sizeof(float);
+    if (bytes > m_radial_bytes) {
+        if (!m_radial_profile_ssbo) glGenBuffers(1, &m_radial_profile_ssbo);
+        if (!m_radial_signal_ssbo) glGenBuffers(1, &m_radial_signal_ssbo);
+        for (GLuint buf : {m_radial_profile_ssbo, m_radial_signal_ssbo}) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buf);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_radial_bytes = bytes;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_radial_profile_ssbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_radial_signal_ssbo);
+
+    shader->set_int("uRadials", rays);
+    shader->set_int("uRadialSamples", samples);
+
+    shader->set_int("uRadialPass", 0);
+    shader->set_int("uRayOffset", 0);
+    shader->dispatch((samples + 15) / 16, (rays + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    /* Evaluate in bands of rays, each submitted on its own */
+    shader->set_int("uRadialPass", 1);
+    for (int ray0 = 0; ray0 < rays; ray0 += RAYS_PER_CHUNK) {
+        int band = std::min(RAYS_PER_CHUNK, rays - ray0);
+        shader->set_int("uRayOffset", ray0);
+        shader->dispatch((samples + 15) / 16, (band + 15) / 16, 1);
+        glFlush();
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    shader->set_int("uRadialPass", 2);
+    shader->dispatch((m_cols + 15) / 16, (m_rows + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuViewshed::dispatch_single_pass(ComputeShader* shader, int nc, int nr) {
+    if (is_radial(shader))
+        dispatch_radial(shader, nc, nr);
+    else
+        dispatch_sweep(nc, nr);
 }
 
 /* -----------------------------------------------------------------------
@@ -269,10 +614,98 @@ void GpuViewshed::dispatch_merge(GLuint groups_x, GLuint groups_y) {
     glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 }
 
+/* -----------------------------------------------------------------------
+ * Fused dispatch: gl_GlobalInvocationID.z picks a node from the SSBO and
+ * each invocation merges straight into the R32 accumulators with image
+ * atomics (count of visible nodes, max signal). One resolve pass then
+ * writes the same merged textures the per-node merge passes produce.
+ * ----------------------------------------------------------------------- */
+void GpuViewshed::upload_node_params(const std::vector<ChunkNode>& nodes) {
+    std::vector<NodeParams> params;
+    params.reserve(nodes.size());
+    for (auto& n : nodes)
+        params.push_back(node_params(n.data, n.col, n.row, n.observer_height));
+
+    if (!m_node_ssbo) glGenBuffers(1, &m_node_ssbo);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_node_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, params.size() * sizeof(NodeParams),
+                 params.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuViewshed::clear_fused_accumulators() {
+    uint32_t zero = 0;
+    int32_t lowest = INT32_MIN;     // below every encoded signal
+
+    if (GLAD_GL_ARB_clear_texture) {
+        glClearTexImage(m_overlap_acc_tex, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glClearTexImage(m_signal_acc_tex, 0, GL_RED_INTEGER, GL_INT, &lowest);
+        return;
+    }
+
+    size_t total = static_cast<size_t>(m_rows) * m_cols;
+    glBindTexture(GL_TEXTURE_2D, m_overlap_acc_tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_cols, m_rows, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                    std::vector<uint32_t>(total, zero).data());
+    glBindTexture(GL_TEXTURE_2D, m_signal_acc_tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_cols, m_rows, GL_RED_INTEGER, GL_INT,
+                    std::vector<int32_t>(total, lowest).data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GpuViewshed::dispatch_fused(ComputeShader* shader, size_t first, size_t count,
+                                 int row0, int rows) {
+    shader->set_int("uNodeBase", static_cast<int>(first));
+    shader->set_int("uRowOffset", row0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_node_ssbo);
+    glBindImageTexture(0, m_elevation_tex,   0, GL_FALSE, 0, GL_READ_ONLY,  GL_R32F);
+    glBindImageTexture(1, m_overlap_acc_tex, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindImageTexture(2, m_signal_acc_tex,  0, GL_FALSE, 0, GL_READ_WRITE, GL_R32I);
+    if (m_slices) {
+        glBindImageTexture(3, m_slice_vis_tex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8UI);
+        glBindImageTexture(4, m_slice_sig_tex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+    }
+
+    shader->dispatch((m_cols + 15) / 16, (rows + 15) / 16, static_cast<GLuint>(count));
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+void GpuViewshed::dispatch_resolve() {
+    m_resolve_shader.use();
+    m_resolve_shader.set_ivec2("uGridSize", m_cols, m_rows);
+
+    glBindImageTexture(0, m_overlap_acc_tex, 0, GL_FALSE, 0, GL_READ_ONLY,  GL_R32UI);
+    glBindImageTexture(1, m_signal_acc_tex,  0, GL_FALSE, 0, GL_READ_ONLY,  GL_R32I);
+    glBindImageTexture(2, m_merged_vis_tex,  0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+    glBindImageTexture(3, m_merged_sig_tex,  0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glBindImageTexture(4, m_overlap_tex,     0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+
+    m_resolve_shader.dispatch((m_cols + 15) / 16, (m_rows + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
 void GpuViewshed::compute_all(const std::vector<NodeData>& nodes) {
+    compute_nodes(nodes, false);
+}
+
+void GpuViewshed::compute_slices(const std::vector<NodeData>& nodes) {
+    compute_nodes(nodes, true);
+}
+
+void GpuViewshed::compute_nodes(const std::vector<NodeData>& nodes, bool slices) {
     if (!m_initialized || m_rows == 0 || m_cols == 0) return;
+    if (slices && static_cast<int>(nodes.size()) > max_slices()) {
+        LOG_ERROR("GPU viewshed: %zu nodes exceed the %d slice layers", nodes.size(), max_slices());
+        return;
+    }
 
-    clear_merge_textures();
+    discard_async();
+    m_slices = slices;
+    if (slices)
+        create_slices(static_cast<int>(nodes.size()));
+    else
+        clear_merge_textures();
 
     GLuint groups_x = (m_cols + 15) / 16;
     GLuint groups_y = (m_rows + 15) / 16;
@@ -280,34 +713,29 @@ void GpuViewshed::compute_all(const std::vector<NodeData>& nodes) {
     double lat_res = (m_bounds.max_lat - m_bounds.min_lat) / (m_rows - 1);
     double lon_res = (m_bounds.max_lon - m_bounds.min_lon) / (m_cols - 1);
 
-    ComputeShader* active_shader = &m_viewshed_shader;
-    if (m_prop_model == MESH3D_PROP_ITM && m_has_itm)
-        active_shader = &m_itm_shader;
-    else if (m_prop_model == MESH3D_PROP_FRESNEL && m_has_fresnel)
-        active_shader = &m_fresnel_shader;
+    ComputeShader* active_shader = select_shader();
+    bool single_pass = (active_shader == &m_sweep_shader) || is_radial(active_shader);
+    ComputeShader* fused_shader = select_fused_shader();
+    std::vector<ChunkNode> fused_nodes;
 
-    for (auto& nd : nodes) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const NodeData& nd = nodes[i];
         int nr = static_cast<int>((m_bounds.max_lat - nd.info.lat) / lat_res);
         int nc = static_cast<int>((nd.info.lon - m_bounds.min_lon) / lon_res);
 
         int nr_elev = std::clamp(nr, 0, m_rows - 1);
         int nc_elev = std::clamp(nc, 0, m_cols - 1);
 
-        float node_elev = 0.0f;
-        {
-            GLuint fbo;
-            glGenFramebuffers(1, &fbo);
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                                   GL_TEXTURE_2D, m_elevation_tex, 0);
-            glReadPixels(nc_elev, nr_elev, 1, 1, GL_RED, GL_FLOAT, &node_elev);
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            glDeleteFramebuffers(1, &fbo);
-        }
+        float node_elev = node_elevation(nr_elev, nc_elev, nullptr);
 
         float antenna_h = nd.info.antenna_height_m;
         if (antenna_h < 1.0f) antenna_h = 2.0f;
 
+        if (fused_shader) {
+            fused_nodes.push_back({nd, nc, nr, node_elev + antenna_h});
+            continue;
+        }
+
         /* --- Viewshed pass --- */
         active_shader->use();
         set_environment_uniforms(active_shader);
@@ -317,26 +745,61 @@ void GpuViewshed::compute_all(const std::vector<NodeData>& nodes) {
         glBindImageTexture(1, m_node_vis_tex,  0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
         glBindImageTexture(2, m_node_sig_tex,  0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
 
-        active_shader->dispatch(groups_x, groups_y, 1);
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        if (single_pass) {
+            dispatch_single_pass(active_shader, nc, nr);
+        } else {
+            active_shader->dispatch(groups_x, groups_y, 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        }
 
         /* --- Merge: OR visibility, MAX signal, increment overlap --- */
-        dispatch_merge(groups_x, groups_y);
+        if (slices)
+            copy_to_slice(static_cast<int>(i));
+        else
+            dispatch_merge(groups_x, groups_y);
+    }
+
+    if (!fused_nodes.empty()) {
+        upload_node_params(fused_nodes);
+        if (!slices) clear_fused_accumulators();
+        fused_shader->use();
+        set_environment_uniforms(fused_shader);
+        fused_shader->set_int("uWriteSlices", slices ? 1 : 0);
+        for (size_t i = 0; i < fused_nodes.size(); i += NODES_PER_DISPATCH) {
+            size_t count = std::min<size_t>(NODES_PER_DISPATCH, fused_nodes.size() - i);
+            dispatch_fused(fused_shader, i, count, 0, m_rows);
+        }
+        if (!slices) dispatch_resolve();
     }
 }
 
 void GpuViewshed::compute_all_async(const std::vector<NodeData>& nodes,
                                       const float* cpu_elevation) {
+    start_async(nodes, cpu_elevation, false);
+}
+
+void GpuViewshed::compute_slices_async(const std::vector<NodeData>& nodes,
+                                       const float* cpu_elevation) {
+    start_async(nodes, cpu_elevation, true);
+}
+
+void GpuViewshed::start_async(const std::vector<NodeData>& nodes,
+                              const float* cpu_elevation, bool slices) {
     if (!m_initialized || m_rows == 0 || m_cols == 0) return;
+    if (slices && static_cast<int>(nodes.size()) > max_slices()) {
+        LOG_ERROR("GPU viewshed: %zu nodes exceed the %d slice layers", nodes.size(), max_slices());
+        return;
+    }
 
-    clear_merge_textures();
+    discard_async();   // a restart discards any unread results
+    m_slices = slices;
+    if (slices)
+        create_slices(static_cast<int>(nodes.size()));
+    else
+        clear_merge_textures();
 
     /* Select propagation shader */
-    ComputeShader* active_shader = &m_viewshed_shader;
-    if (m_prop_model == MESH3D_PROP_ITM && m_has_itm)
-        active_shader = &m_itm_shader;
-    else if (m_prop_model == MESH3D_PROP_FRESNEL && m_has_fresnel)
-        active_shader = &m_fresnel_shader;
+    ComputeShader* active_shader = select_shader();
 
     double lat_res = (m_bounds.max_lat - m_bounds.min_lat) / (m_rows - 1);
     double lon_res = (m_bounds.max_lon - m_bounds.min_lon) / (m_cols - 1);
@@ -345,13 +808,14 @@ void GpuViewshed::compute_all_async(const std::vector<NodeData>& nodes,
     m_chunk = {};
     m_chunk.active_shader = active_shader;
     m_chunk.groups_x = (m_cols + 15) / 16;
+    m_chunk.single_pass = (active_shader == &m_sweep_shader) || is_radial(active_shader);
 
     for (auto& nd : nodes) {
         int nr = static_cast<int>((m_bounds.max_lat - nd.info.lat) / lat_res);
         int nc = static_cast<int>((nd.info.lon - m_bounds.min_lon) / lon_res);
         int nr_elev = std::clamp(nr, 0, m_rows - 1);
         int nc_elev = std::clamp(nc, 0, m_cols - 1);
-        float node_elev = cpu_elevation[nr_elev * m_cols + nc_elev];
+        float node_elev = node_elevation(nr_elev, nc_elev, cpu_elevation);
         float antenna_h = nd.info.antenna_height_m;
         if (antenna_h < 1.0f) antenna_h = 2.0f;
         m_chunk.nodes.push_back({nd, nc, nr, node_elev + antenna_h});
@@ -364,6 +828,26 @@ void GpuViewshed::compute_all_async(const std::vector<NodeData>& nodes,
     m_chunk.current_row = 0;
     m_chunk.merge_pending = false;
 
+    if (ComputeShader* fused = select_fused_shader()) {
+        /* All nodes in batches per row-band, merged by atomics */
+        m_chunk.fused = true;
+        m_chunk.active_shader = fused;
+        upload_node_params(m_chunk.nodes);
+        if (!slices) clear_fused_accumulators();
+        fused->use();
+        set_environment_uniforms(fused);
+        fused->set_int("uWriteSlices", slices ? 1 : 0);
+
+        dispatch_viewshed_band();
+        place_fence();
+        m_state = ComputeState::DISPATCHED;
+
+        LOG_INFO("compute_all_async: started fused dispatch for %zu nodes on %dx%d grid "
+                 "(%d nodes x %d rows per dispatch)",
+                 nodes.size(), m_cols, m_rows, NODES_PER_DISPATCH, ROWS_PER_CHUNK);
+        return;
+    }
+
     auto& first = m_chunk.nodes[0];
     active_shader->use();
     set_environment_uniforms(active_shader);
@@ -387,9 +871,24 @@ void GpuViewshed::compute_all_async(const std::vector<NodeData>& nodes,
  * The shader uses uRowOffset to map gl_GlobalInvocationID.y to actual rows.
  * ----------------------------------------------------------------------- */
 void GpuViewshed::dispatch_viewshed_band() {
+    if (m_chunk.single_pass) {
+        auto& node = m_chunk.nodes[m_chunk.current_node];
+        dispatch_single_pass(m_chunk.active_shader, node.col, node.row);
+        return;
+    }
+
     int row_start = m_chunk.current_row;
     int row_end = std::min(row_start + ROWS_PER_CHUNK, m_rows);
     int chunk_rows = row_end - row_start;
+
+    if (m_chunk.fused) {
+        size_t count = std::min<size_t>(NODES_PER_DISPATCH,
+                                        m_chunk.nodes.size() - m_chunk.current_node);
+        dispatch_fused(m_chunk.active_shader, m_chunk.current_node, count,
+                       row_start, chunk_rows);
+        return;
+    }
+
     GLuint chunk_groups_y = (chunk_rows + 15) / 16;
 
     m_chunk.active_shader->set_int("uRowOffset", row_start);
@@ -406,11 +905,49 @@ void GpuViewshed::place_fence() {
     glFlush();
 }
 
+void GpuViewshed::discard_async() {
+    if (m_fence) { glDeleteSync(m_fence); m_fence = nullptr; }
+    m_chunk = {};
+    m_readback_staged = false;
+    m_state = ComputeState::IDLE;
+}
+
 /* -----------------------------------------------------------------------
  * Advance the chunked dispatch state machine.
  * Called from poll_state() when the current fence is signaled.
  * ----------------------------------------------------------------------- */
 void GpuViewshed::advance_chunk() {
+    if (m_chunk.fused) {
+        if (m_chunk.merge_pending) {
+            /* Resolve done: stage the results for a non-blocking readback */
+            m_chunk.nodes.clear();
+            begin_read_back();
+            return;
+        }
+
+        /* Next row-band of this batch, else first band of the next batch */
+        m_chunk.current_row += ROWS_PER_CHUNK;
+        if (m_chunk.current_row >= m_rows) {
+            m_chunk.current_row = 0;
+            m_chunk.current_node += NODES_PER_DISPATCH;
+        }
+
+        if (m_chunk.current_node < m_chunk.nodes.size()) {
+            m_chunk.active_shader->use();
+            dispatch_viewshed_band();
+        } else if (m_slices) {
+            /* Every node is in its layer already; nothing to resolve */
+            m_chunk.nodes.clear();
+            begin_read_back();
+            return;
+        } else {
+            dispatch_resolve();
+            m_chunk.merge_pending = true;
+        }
+        place_fence();
+        return;
+    }
+
     if (m_chunk.merge_pending) {
         /* Merge just completed — move to next node */
         m_chunk.merge_pending = false;
@@ -418,9 +955,9 @@ void GpuViewshed::advance_chunk() {
         m_chunk.current_row = 0;
 
         if (m_chunk.current_node >= m_chunk.nodes.size()) {
-            /* All nodes done */
+            /* All nodes done: stage the results for a non-blocking readback */
             m_chunk.nodes.clear();
-            m_state = ComputeState::READY;
+            begin_read_back();
             return;
         }
 
@@ -438,7 +975,8 @@ void GpuViewshed::advance_chunk() {
         place_fence();
     } else {
         /* Viewshed band completed — advance to next band or merge */
-        m_chunk.current_row += ROWS_PER_CHUNK;
+        m_chunk.current_row = m_chunk.single_pass ? m_rows
+                                                  : m_chunk.current_row + ROWS_PER_CHUNK;
 
         if (m_chunk.current_row < m_rows) {
             /* More row-bands to dispatch for this node */
@@ -446,10 +984,14 @@ void GpuViewshed::advance_chunk() {
             dispatch_viewshed_band();
             place_fence();
         } else {
-            /* All bands done for this node — dispatch merge pass */
+            /* All bands done for this node — dispatch merge pass, or copy
+               it into its slice layer */
             GLuint groups_x = (m_cols + 15) / 16;
             GLuint groups_y = (m_rows + 15) / 16;
-            dispatch_merge(groups_x, groups_y);
+            if (m_slices)
+                copy_to_slice(static_cast<int>(m_chunk.current_node));
+            else
+                dispatch_merge(groups_x, groups_y);
             m_chunk.merge_pending = true;
             place_fence();
         }
@@ -457,7 +999,8 @@ void GpuViewshed::advance_chunk() {
 }
 
 ComputeState GpuViewshed::poll_state() {
-    if (m_state != ComputeState::DISPATCHED) return m_state;
+    if (m_state != ComputeState::DISPATCHED && m_state != ComputeState::READING_BACK)
+        return m_state;
 
     GLenum result = glClientWaitSync(m_fence, 0, 0); // timeout=0 -> non-blocking
     if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
@@ -466,6 +1009,12 @@ ComputeState GpuViewshed::poll_state() {
     glDeleteSync(m_fence);
     m_fence = nullptr;
 
+    /* Results are in the readback PBO */
+    if (m_state == ComputeState::READING_BACK) {
+        m_state = ComputeState::READY;
+        return m_state;
+    }
+
     /* If chunked dispatch is active, advance state machine */
     if (!m_chunk.nodes.empty()) {
         advance_chunk();
@@ -480,10 +1029,139 @@ ComputeState GpuViewshed::poll_state() {
 void GpuViewshed::read_back_async(std::vector<uint8_t>& vis,
                                     std::vector<float>& signal,
                                     std::vector<uint8_t>& overlap) {
-    read_back(vis, signal, overlap);
+    if (!map_read_back(vis, signal, overlap))
+        read_back(vis, signal, overlap);
     m_state = ComputeState::IDLE;
 }
 
+/* -----------------------------------------------------------------------
+ * Async readback: glGetTexImage into a pixel pack buffer only queues the
+ * copy, so the frame does not wait on it. poll_state() reports READY once
+ * its fence signals, and read_back_async() maps the finished buffer.
+ * Signal goes first so the float data stays 4-byte aligned.
+ * ----------------------------------------------------------------------- */
+void GpuViewshed::begin_read_back() {
+    size_t total = static_cast<size_t>(m_rows) * m_cols;
+    m_readback_slices = m_slices ? m_slice_layers : 0;
+    size_t bytes = m_slices ? total * m_slice_layers * (sizeof(float) + 1)
+                            : total * (sizeof(float) + 2);
+
+    if (!m_readback_pbo) glGenBuffers(1, &m_readback_pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback_pbo);
+    if (bytes != m_readback_bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        m_readback_bytes = bytes;
+    }
+
+    /* Image stores from the merge pass must be visible to texture reads */
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    if (m_slices) {
+        /* Every signal layer, then every visibility layer */
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_sig_tex);
+        glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RED, GL_FLOAT, reinterpret_cast<void*>(0));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_vis_tex);
+        glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                      reinterpret_cast<void*>(total * m_slice_layers * sizeof(float)));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, m_merged_sig_tex);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, reinterpret_cast<void*>(0));
+        glBindTexture(GL_TEXTURE_2D, m_merged_vis_tex);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                      reinterpret_cast<void*>(total * sizeof(float)));
+        glBindTexture(GL_TEXTURE_2D, m_overlap_tex);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                      reinterpret_cast<void*>(total * (sizeof(float) + 1)));
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    place_fence();
+    m_readback_staged = true;
+    m_state = ComputeState::READING_BACK;
+}
+
+bool GpuViewshed::map_read_back(std::vector<uint8_t>& vis,
+                                std::vector<float>& signal,
+                                std::vector<uint8_t>& overlap) {
+    if (!m_readback_staged || m_readback_slices) return false;
+    m_readback_staged = false;
+
+    size_t total = static_cast<size_t>(m_rows) * m_cols;
+    if (total * (sizeof(float) + 2) != m_readback_bytes) return false;  // grid changed
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback_pbo);
+    auto* src = static_cast<const uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_readback_bytes, GL_MAP_READ_BIT));
+    if (!src) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        LOG_WARN("GPU viewshed: readback map failed, falling back to glGetTexImage");
+        return false;
+    }
+
+    signal.resize(total);
+    vis.resize(total);
+    overlap.resize(total);
+    std::memcpy(signal.data(), src, total * sizeof(float));
+    std::memcpy(vis.data(), src + total * sizeof(float), total);
+    std::memcpy(overlap.data(), src + total * (sizeof(float) + 1), total);
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void GpuViewshed::read_back_slices(std::vector<std::vector<uint8_t>>& vis,
+                                   std::vector<std::vector<float>>& signal) {
+    const size_t total = static_cast<size_t>(m_rows) * m_cols;
+    const int layers = m_slice_layers;
+    vis.assign(layers, std::vector<uint8_t>(total));
+    signal.assign(layers, std::vector<float>(total));
+    if (layers == 0) return;
+
+    /* The staged copy of an async run, else straight from the arrays */
+    const uint8_t* src = nullptr;
+    if (m_readback_staged && m_readback_slices == layers &&
+        total * layers * (sizeof(float) + 1) == m_readback_bytes) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback_pbo);
+        src = static_cast<const uint8_t*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_readback_bytes, GL_MAP_READ_BIT));
+        if (!src) glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    if (m_readback_staged) {
+        m_readback_staged = false;
+        m_state = ComputeState::IDLE;
+    }
+
+    std::vector<uint8_t> direct;
+    if (!src) {
+        direct.resize(total * layers * (sizeof(float) + 1));
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_sig_tex);
+        glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RED, GL_FLOAT, direct.data());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_slice_vis_tex);
+        glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                      direct.data() + total * layers * sizeof(float));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    }
+
+    const uint8_t* base = src ? src : direct.data();
+    for (int i = 0; i < layers; ++i) {
+        std::memcpy(signal[i].data(), base + total * i * sizeof(float), total * sizeof(float));
+        std::memcpy(vis[i].data(), base + total * (layers * sizeof(float) + i), total);
+    }
+
+    if (src) {
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
 void GpuViewshed::read_back(std::vector<uint8_t>& vis,
                               std::vector<float>& signal,
                               std::vector<uint8_t>& overlap) {
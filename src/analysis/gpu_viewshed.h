@@ -10,8 +10,28 @@
 
 namespace mesh3d {
 
-/* Async compute state for non-blocking GPU viewshed */
-enum class ComputeState { IDLE, DISPATCHED, READY };
+/* Async compute state for non-blocking GPU viewshed.
+   READING_BACK: compute finished, results are being copied into a pixel
+   pack buffer; READY once that copy's fence has signaled. */
+enum class ComputeState { IDLE, DISPATCHED, READING_BACK, READY };
+
+/* An elevation grid read in place from up to 3x3 same-sized tiles kept in
+   a texture array, instead of copied into one uploaded composite. Grid
+   cell (row, col) is frame cell (row * step + row_offset, col * step +
+   col_offset); frame cell (r, c) is cell (r % tile_rows, c % tile_cols)
+   of the tile at (r / tile_rows, c / tile_cols) of the 3x3 neighbourhood.
+   Cells of missing tiles read as 0, like a composite's unfilled cells. */
+struct ElevationFrame {
+    GLuint texture = 0;                 // GL_TEXTURE_2D_ARRAY, R32F
+    int tile_rows = 0, tile_cols = 0;
+    int layers[9] = {-1, -1, -1, -1, -1, -1, -1, -1, -1};  // row-major from north-west
+    const float* tiles[9] = {};         // CPU copies of the same tiles
+    int row_offset = 0, col_offset = 0;
+    int step = 1;
+
+    /* CPU lookup of grid cell (row, col), for node heights */
+    float elevation(int row, int col) const;
+};
 
 class GpuViewshed {
 public:
@@ -24,18 +44,57 @@ public:
     /* Upload elevation grid to GPU texture */
     void upload_elevation(const float* data, int rows, int cols);
 
-    /* Set grid parameters for coordinate mapping */
+    /* Use a rows x cols grid read from `frame` (see ElevationFrame) in
+       place of an uploaded one, until the next upload_elevation(). The
+       frame's texture and CPU tiles must outlive the computation. */
+    void set_elevation_frame(const ElevationFrame& frame, int rows, int cols);
+
+    /* Set grid parameters for coordinate mapping. Also drops any refine mask. */
     void set_grid_params(const mesh3d_bounds_t& bounds, int rows, int cols);
 
-    /* Set propagation model (FSPL, ITM, or Fresnel) */
+    /* Coarse-to-fine refinement: only cells of REFINE_BLOCK x REFINE_BLOCK
+       blocks whose mask byte is non-zero are computed; the rest come out
+       invisible (-999) for the caller to fill from a coarser level. `mask`
+       is row-major, refine_block_rows() x refine_block_cols() of the grid
+       last passed to upload_elevation() or set_elevation_frame(); null turns refinement off. The
+       sweep model ignores it. */
+    static constexpr int REFINE_BLOCK = 16;
+    void set_refine_mask(const std::vector<uint8_t>* mask);
+    int refine_block_rows() const { return (m_rows + REFINE_BLOCK - 1) / REFINE_BLOCK; }
+    int refine_block_cols() const { return (m_cols + REFINE_BLOCK - 1) / REFINE_BLOCK; }
+
+    /* Set propagation model (FSPL, ITM, Fresnel, or radial sweep) */
     void set_propagation_model(mesh3d_prop_model_t model);
     mesh3d_prop_model_t propagation_model() const { return m_prop_model; }
 
     /* Set ITM parameters for ITM propagation model */
     void set_itm_params(const mesh3d_itm_params_t& params);
+    const mesh3d_itm_params_t& itm_params() const { return m_itm_params; }
 
     /* Set receiver / display config */
     void set_rf_config(const mesh3d_rf_config_t& config);
+    const mesh3d_rf_config_t& rf_config() const { return m_rf_config; }
+
+    /* Fused dispatch: run up to NODES_PER_DISPATCH nodes per dispatch,
+       reading their parameters from an SSBO and merging with image
+       atomics, instead of one scratch pass plus merge pass per node.
+       On by default when the fused shaders load; the sweep model always
+       runs per node. */
+    void set_fused_dispatch(bool on) { m_fused = on; }
+    bool fused_dispatch() const { return m_fused && m_has_fused; }
+
+    /* Radial-profile engine for the ITM and Fresnel models: with a
+       non-zero count, each node casts that many rays (fewer on small
+       grids), runs the model once per cell-spaced sample along each ray on
+       the prefix of the ray's profile, and interpolates cells between the
+       nearest samples (viewshed_radial.comp). Far fewer model evaluations
+       than one per cell, at the cost of angular resolution far from the
+       node. 0 (default) evaluates every cell; other counts are clamped to
+       [MIN_RADIALS, MAX_RADIALS]. Runs per node, like sweep. */
+    static constexpr int MIN_RADIALS = 8;
+    static constexpr int MAX_RADIALS = 8192;
+    void set_radial_count(int radials);
+    int radial_count() const { return m_radials; }
 
     /* Compute viewshed for all nodes, merging results on GPU (blocking) */
     void compute_all(const std::vector<NodeData>& nodes);
@@ -43,7 +102,8 @@ public:
     /* Async compute: dispatch GPU work and place a fence (non-blocking).
        cpu_elevation is the same data passed to upload_elevation(), used to
        look up node heights on the CPU side and avoid per-node glReadPixels
-       stalls that would serialize the dispatch loop. */
+       stalls that would serialize the dispatch loop. With an elevation
+       frame it may be null; the frame's CPU tiles are used instead. */
     void compute_all_async(const std::vector<NodeData>& nodes,
                            const float* cpu_elevation);
 
@@ -55,11 +115,29 @@ public:
                    std::vector<float>& signal,
                    std::vector<uint8_t>& overlap);
 
-    /* Read back after async compute completes, resets state to IDLE */
+    /* Read back after async compute completes, resets state to IDLE.
+       Copies out of the already-filled pixel pack buffer, so it does not
+       wait on the GPU. */
     void read_back_async(std::vector<uint8_t>& vis,
                          std::vector<float>& signal,
                          std::vector<uint8_t>& overlap);
 
+    /* Per-node results, for caching each node on its own: the nodes run
+       as in compute_all() (fused batches, or one at a time for sweep and
+       radial), but each writes its own layer of a slice array instead of
+       being merged. At most max_slices() nodes per call. */
+    int max_slices() const;
+    void compute_slices(const std::vector<NodeData>& nodes);
+    void compute_slices_async(const std::vector<NodeData>& nodes,
+                              const float* cpu_elevation);
+
+    /* One rows x cols result per node of the last compute_slices*() call.
+       After the async one, copies out of the staged buffer and resets the
+       state to IDLE like read_back_async(); otherwise reads the slice
+       array directly (blocking). */
+    void read_back_slices(std::vector<std::vector<uint8_t>>& vis,
+                          std::vector<std::vector<float>>& signal);
+
     /* Current async state */
     ComputeState state() const { return m_state; }
 
@@ -74,18 +152,48 @@ private:
     ComputeShader m_merge_shader;
     ComputeShader m_itm_shader;       // Longley-Rice ITM
     ComputeShader m_fresnel_shader;   // Fresnel-Kirchhoff
+    ComputeShader m_sweep_shader;     // FSPL + diffraction, radial horizon sweep
+
+    /* FUSED_NODES variants of the per-cell shaders, and the pass that
+       turns their accumulators into the merged textures */
+    ComputeShader m_viewshed_fused;
+    ComputeShader m_itm_fused;
+    ComputeShader m_fresnel_fused;
+    ComputeShader m_resolve_shader;
+
+    /* Radial-profile engine (set_radial_count) */
+    ComputeShader m_itm_radial;
+    ComputeShader m_fresnel_radial;
 
     /* GPU textures */
-    GLuint m_elevation_tex = 0;   // R32F  (input)
+    GLuint m_elevation_tex = 0;   // R32F  (input; not allocated while a frame is in use)
     GLuint m_node_vis_tex  = 0;   // R8UI  (per-node scratch)
     GLuint m_node_sig_tex  = 0;   // R32F  (per-node scratch)
     GLuint m_merged_vis_tex = 0;  // R8UI  (accumulated)
     GLuint m_merged_sig_tex = 0;  // R32F  (accumulated)
     GLuint m_overlap_tex   = 0;   // R8UI  (accumulated)
+    GLuint m_overlap_acc_tex = 0; // R32UI (fused: visible-node count)
+    GLuint m_signal_acc_tex  = 0; // R32I  (fused: best signal, order-preserving bits)
+    GLuint m_node_ssbo = 0;       // NodeParams[] for fused dispatch
+    GLuint m_refine_tex = 0;      // R8UI  (per 16x16 block: compute it?)
+    GLuint m_slice_vis_tex = 0;   // R8UI array (compute_slices: a layer per node)
+    GLuint m_slice_sig_tex = 0;   // R32F array
+    int m_slice_layers = 0;
+    int m_max_layers = 256;       // GL_MAX_ARRAY_TEXTURE_LAYERS, capped
+    bool m_slices = false;        // the computation in progress writes slices
+    GLuint m_radial_profile_ssbo = 0;  // float[rays][samples]: ground elevation
+    GLuint m_radial_signal_ssbo = 0;   // float[rays][samples]: received signal
+    size_t m_radial_bytes = 0;         // size of each radial buffer
+    int m_refine_rows = 0, m_refine_cols = 0;
+    bool m_refine = false;
 
     /* Grid dimensions */
     int m_rows = 0, m_cols = 0;
 
+    /* set_elevation_frame(): the grid is read from m_frame */
+    ElevationFrame m_frame;
+    bool m_use_frame = false;
+
     /* Geographic params for coordinate mapping */
     mesh3d_bounds_t m_bounds{};
     float m_cell_meters = 30.0f;
@@ -100,15 +208,50 @@ private:
     bool m_initialized = false;
     bool m_has_itm = false;
     bool m_has_fresnel = false;
+    bool m_has_sweep = false;
+    bool m_has_fused = false;
+    bool m_fused = true;
+    int m_radials = 0;
 
     /* Async compute state */
     ComputeState m_state = ComputeState::IDLE;
     GLsync m_fence = nullptr;
 
+    /* Async readback staging: merged signal | vis | overlap, filled by
+       glGetTexImage into a pixel pack buffer once compute is done */
+    GLuint m_readback_pbo = 0;
+    size_t m_readback_bytes = 0;
+    bool m_readback_staged = false;
+    int m_readback_slices = 0;    // slice layers staged instead of merged results
+
     /* Chunked dispatch: breaks each node's viewshed into row-bands so the
        GPU can interleave render work between chunks. */
     static constexpr int ROWS_PER_CHUNK = 128;
 
+    /* Rays per dispatch of the radial evaluate pass, which runs the model
+       over a profile prefix per sample; like ROWS_PER_CHUNK it keeps each
+       dispatch short of the driver watchdog */
+    static constexpr int RAYS_PER_CHUNK = 64;
+
+    /* Nodes per fused dispatch (gl_GlobalInvocationID.z); bounds the work
+       between fences like ROWS_PER_CHUNK does */
+    static constexpr int NODES_PER_DISPATCH = 8;
+
+    /* Memory the slice arrays may take, which bounds max_slices() */
+    static constexpr size_t SLICE_BUDGET = 256u << 20;
+
+    /* std430 layout of NodeParams in viewshed_node.glsl */
+    struct NodeParams {
+        int32_t col, row;
+        float observer_height;
+        float tx_power_dbm;
+        float antenna_gain_dbi;
+        float freq_mhz;
+        float cable_loss_db;
+        float rx_sensitivity_dbm;
+    };
+    static_assert(sizeof(NodeParams) == 32, "NodeParams must match the std430 layout");
+
     struct ChunkNode {
         NodeData data;
         int col, row;
@@ -122,23 +265,69 @@ private:
         bool merge_pending = false;
         ComputeShader* active_shader = nullptr;
         GLuint groups_x = 0;
+        bool single_pass = false;    // sweep / radial cover the whole grid in one go
+        bool fused = false;          // current_node is the first node of a batch
     };
 
     ChunkState m_chunk;
 
+    /* Shader for the current propagation model */
+    ComputeShader* select_shader();
+    /* Its FUSED_NODES variant, or nullptr if fused dispatch is off or
+       unavailable for the model */
+    ComputeShader* select_fused_shader();
+
+    /* Dispatch the sweep shader for one node (one invocation per ray) */
+    void dispatch_sweep(int nc, int nr);
+
+    /* Whether `shader` is one of the radial-profile variants */
+    bool is_radial(const ComputeShader* shader) const {
+        return shader == &m_itm_radial || shader == &m_fresnel_radial;
+    }
+    /* Run the profile, evaluate and rasterise passes of the radial shader
+       in use for one node */
+    void dispatch_radial(ComputeShader* shader, int nc, int nr);
+    /* Sweep or radial pass of a single_pass shader for one node */
+    void dispatch_single_pass(ComputeShader* shader, int nc, int nr);
+
     void create_textures(int rows, int cols);
     void destroy_textures();
     void clear_merge_textures();
 
+    /* Blocking and async runs, merged or into slice layers */
+    void compute_nodes(const std::vector<NodeData>& nodes, bool slices);
+    void start_async(const std::vector<NodeData>& nodes, const float* cpu_elevation,
+                     bool slices);
+
+    /* Slice arrays with `layers` layers, cleared to invisible (-999) */
+    void create_slices(int layers);
+    /* Copy the per-node scratch textures into slice `layer` */
+    void copy_to_slice(int layer);
+
     /* Set uniforms that are constant across all nodes (grid, environment, RX).
        Must be called after active_shader->use(). */
     void set_environment_uniforms(ComputeShader* shader);
 
+    /* Height of grid cell (row, col) from the frame or `cpu_elevation`,
+       else read back from the elevation texture */
+    float node_elevation(int row, int col, const float* cpu_elevation) const;
+
     /* Set per-node TX uniforms from node hardware profile.
        Must be called after set_environment_uniforms(). */
     void set_node_uniforms(ComputeShader* shader, const NodeData& nd,
                            int nc, int nr, float observer_height);
 
+    /* TX parameters of one node, with the same defaults as the uniforms */
+    NodeParams node_params(const NodeData& nd, int nc, int nr, float observer_height) const;
+
+    /* Fused path: fill the node SSBO, zero the accumulators, dispatch
+       nodes [first, first + count) over rows [row0, row0 + rows), and
+       resolve the accumulators into the merged textures */
+    void upload_node_params(const std::vector<ChunkNode>& nodes);
+    void clear_fused_accumulators();
+    void dispatch_fused(ComputeShader* shader, size_t first, size_t count, int row0, int rows);
+    void dispatch_resolve();
+
     /* Dispatch merge pass after each node's viewshed pass. */
     void dispatch_merge(GLuint groups_x, GLuint groups_y);
 
@@ -150,6 +339,17 @@ private:
 
     /* Place a GPU fence and flush. */
     void place_fence();
+
+    /* Drop the async run in flight or staged for readback (IDLE), so a
+       blocking run that reuses the textures never reads back its results */
+    void discard_async();
+
+    /* Queue the merged textures' copy into m_readback_pbo (READING_BACK) */
+    void begin_read_back();
+    /* Map the filled PBO into the output arrays; false if nothing staged */
+    bool map_read_back(std::vector<uint8_t>& vis,
+                       std::vector<float>& signal,
+                       std::vector<uint8_t>& overlap);
 };
 
 } // namespace mesh3d
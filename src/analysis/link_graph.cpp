@@ -0,0 +1,250 @@
+#include "analysis/link_graph.h"
+#include "scene/scene.h"
+#include "util/hash.h"
+#include "util/log.h"
+#include <algorithm>
+
+namespace mesh3d {
+
+static uint64_t links_key(uint64_t terrain_key, const PathLossSettings& s) {
+    uint64_t h = FNV_OFFSET;
+    hash_field(h, terrain_key);
+    hash_field(h, static_cast<int>(s.model));
+    hash_field(h, s.rf_config.rx_sensitivity_dbm);
+    hash_field(h, s.rf_config.rx_height_agl_m);
+    if (s.model == MESH3D_PROP_ITM) {
+        const auto& p = s.itm_params;
+        hash_field(h, p.climate);
+        hash_field(h, p.ground_dielectric);
+        hash_field(h, p.ground_conductivity);
+        hash_field(h, p.polarization);
+        hash_field(h, p.situation_pct);
+        hash_field(h, p.time_pct);
+        hash_field(h, p.refractivity);
+        hash_field(h, p.location_pct);
+        hash_field(h, p.mdvar);
+    }
+    return h;
+}
+
+bool LinkGraph::stale(uint64_t terrain_key, const PathLossSettings& settings) const {
+    return m_key != links_key(terrain_key, settings);
+}
+
+void LinkGraph::rebuild(const std::vector<NodeData>& nodes, const PathTerrain& terrain,
+                        uint64_t terrain_key, const PathLossSettings& settings, ThreadPool* pool) {
+    const int n = static_cast<int>(nodes.size());
+    m_n = n;
+    m_key = links_key(terrain_key, settings);
+    m_grids_key = terrain.key();
+    m_links.assign(static_cast<size_t>(n) * n, mesh3d_path_result_t{});
+
+    std::vector<mesh3d_path_query_t> queries;
+    std::vector<size_t> slots;
+    queries.reserve(static_cast<size_t>(n) * n);
+    for (int tx = 0; tx < n; ++tx) {
+        for (int rx = 0; rx < n; ++rx) {
+            if (tx == rx) continue;
+            queries.push_back(path_query(nodes[tx].info, nodes[rx].info));
+            slots.push_back(static_cast<size_t>(tx) * n + rx);
+        }
+    }
+    std::vector<mesh3d_path_result_t> results(queries.size());
+    path_loss_batch(terrain, settings, queries.data(), queries.size(), results.data(), pool);
+    for (size_t i = 0; i < results.size(); ++i) m_links[slots[i]] = results[i];
+
+    if (n > 1) LOG_INFO("Link graph: %d links over %d nodes", n * (n - 1), n);
+    analyse();
+}
+
+void LinkGraph::refresh_incomplete(const std::vector<NodeData>& nodes,
+                                   const PathTerrain& terrain,
+                                   const PathLossSettings& settings, ThreadPool* pool) {
+    if (terrain.key() == m_grids_key) return;
+    m_grids_key = terrain.key();
+    if (m_incomplete == 0 || static_cast<int>(nodes.size()) != m_n) return;
+
+    const int n = m_n;
+    std::vector<mesh3d_path_query_t> queries;
+    std::vector<size_t> slots;
+    for (int tx = 0; tx < n; ++tx) {
+        for (int rx = 0; rx < n; ++rx) {
+            size_t i = static_cast<size_t>(tx) * n + rx;
+            if (tx == rx || m_links[i].terrain_complete) continue;
+            queries.push_back(path_query(nodes[tx].info, nodes[rx].info));
+            slots.push_back(i);
+        }
+    }
+    std::vector<mesh3d_path_result_t> results(queries.size());
+    path_loss_batch(terrain, settings, queries.data(), queries.size(), results.data(), pool);
+    for (size_t i = 0; i < results.size(); ++i) m_links[slots[i]] = results[i];
+
+    LOG_DEBUG("Link graph: re-evaluated %zu links with incomplete terrain", queries.size());
+    analyse();
+}
+
+void LinkGraph::compute_node_links(const std::vector<NodeData>& nodes, int idx,
+                                   const PathTerrain& terrain, const PathLossSettings& settings,
+                                   ThreadPool* pool) {
+    const int n = m_n;
+    std::vector<mesh3d_path_query_t> queries;
+    std::vector<size_t> slots;
+    queries.reserve(2 * static_cast<size_t>(n));
+    for (int j = 0; j < n; ++j) {
+        if (j == idx) continue;
+        queries.push_back(path_query(nodes[idx].info, nodes[j].info));
+        slots.push_back(static_cast<size_t>(idx) * n + j);
+        queries.push_back(path_query(nodes[j].info, nodes[idx].info));
+        slots.push_back(static_cast<size_t>(j) * n + idx);
+    }
+    std::vector<mesh3d_path_result_t> results(queries.size());
+    path_loss_batch(terrain, settings, queries.data(), queries.size(), results.data(), pool);
+    for (size_t i = 0; i < results.size(); ++i) m_links[slots[i]] = results[i];
+    m_links[static_cast<size_t>(idx) * n + idx] = mesh3d_path_result_t{};
+}
+
+void LinkGraph::update_node(const std::vector<NodeData>& nodes, int idx,
+                            const PathTerrain& terrain, uint64_t terrain_key,
+                            const PathLossSettings& settings, ThreadPool* pool) {
+    const int n = static_cast<int>(nodes.size());
+    bool appended = idx == m_n && n == m_n + 1;
+    bool moved = idx >= 0 && idx < m_n && n == m_n;
+    if (stale(terrain_key, settings) || (!appended && !moved)) {
+        rebuild(nodes, terrain, terrain_key, settings, pool);
+        return;
+    }
+
+    if (appended) {
+        std::vector<mesh3d_path_result_t> grown(static_cast<size_t>(n) * n, mesh3d_path_result_t{});
+        for (int tx = 0; tx < m_n; ++tx)
+            std::copy_n(&m_links[static_cast<size_t>(tx) * m_n], m_n, &grown[static_cast<size_t>(tx) * n]);
+        m_links.swap(grown);
+        m_n = n;
+    }
+    compute_node_links(nodes, idx, terrain, settings, pool);
+    analyse();
+}
+
+void LinkGraph::remove_node(const std::vector<NodeData>& nodes, int idx,
+                            const PathTerrain& terrain, uint64_t terrain_key,
+                            const PathLossSettings& settings, ThreadPool* pool) {
+    const int n = static_cast<int>(nodes.size());
+    if (stale(terrain_key, settings) || n != m_n - 1 || idx < 0 || idx >= m_n) {
+        rebuild(nodes, terrain, terrain_key, settings, pool);
+        return;
+    }
+
+    /* No path loss to run: drop the node's row and column */
+    std::vector<mesh3d_path_result_t> shrunk;
+    shrunk.reserve(static_cast<size_t>(n) * n);
+    for (int tx = 0; tx < m_n; ++tx) {
+        if (tx == idx) continue;
+        for (int rx = 0; rx < m_n; ++rx)
+            if (rx != idx) shrunk.push_back(m_links[static_cast<size_t>(tx) * m_n + rx]);
+    }
+    m_links.swap(shrunk);
+    m_n = n;
+    analyse();
+}
+
+void LinkGraph::set_min_margin(float db) {
+    m_min_margin_db = db;
+    analyse();
+}
+
+void LinkGraph::clear() {
+    m_n = 0;
+    m_key = 0;
+    m_grids_key = 0;
+    m_links.clear();
+    analyse();
+}
+
+void LinkGraph::analyse() {
+    const int n = m_n;
+    const size_t nn = static_cast<size_t>(n) * n;
+    m_adjacent.assign(nn, 0);
+    m_hops.assign(nn, -1);
+    m_partition.assign(n, -1);
+    m_articulation.assign(n, 0);
+    m_stats = mesh3d_link_graph_stats_t{};
+    m_stats.nodes = n;
+    m_stats.min_margin_db = m_min_margin_db;
+
+    m_incomplete = 0;
+    for (int a = 0; a < n; ++a)
+        for (int b = 0; b < n; ++b)
+            if (a != b && !link(a, b).terrain_complete) ++m_incomplete;
+
+    std::vector<std::vector<int>> adj(n);
+    for (int a = 0; a < n; ++a) {
+        for (int b = a + 1; b < n; ++b) {
+            if (link(a, b).link_margin_db < m_min_margin_db ||
+                link(b, a).link_margin_db < m_min_margin_db)
+                continue;
+            m_adjacent[static_cast<size_t>(a) * n + b] = 1;
+            m_adjacent[static_cast<size_t>(b) * n + a] = 1;
+            adj[a].push_back(b);
+            adj[b].push_back(a);
+            ++m_stats.links;
+        }
+    }
+
+    /* Hop counts: breadth-first from every node, which also labels the
+       partitions */
+    std::vector<int> queue(n);
+    for (int s = 0; s < n; ++s) {
+        int* hops = &m_hops[static_cast<size_t>(s) * n];
+        if (m_partition[s] < 0) m_partition[s] = m_stats.partitions++;
+        int head = 0, tail = 0;
+        hops[s] = 0;
+        queue[tail++] = s;
+        while (head < tail) {
+            int v = queue[head++];
+            for (int w : adj[v]) {
+                if (hops[w] >= 0) continue;
+                hops[w] = hops[v] + 1;
+                m_partition[w] = m_partition[s];
+                m_stats.max_hops = std::max(m_stats.max_hops, hops[w]);
+                queue[tail++] = w;
+            }
+        }
+    }
+
+    /* Articulation points: iterative Tarjan over each partition */
+    std::vector<int> disc(n, -1), low(n, 0), parent(n, -1);
+    std::vector<std::pair<int, size_t>> stack;
+    int time = 0;
+    for (int root = 0; root < n; ++root) {
+        if (disc[root] >= 0) continue;
+        int root_children = 0;
+        disc[root] = low[root] = time++;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            int v = stack.back().first;
+            size_t i = stack.back().second;
+            if (i < adj[v].size()) {
+                stack.back().second = i + 1;
+                int w = adj[v][i];
+                if (disc[w] < 0) {
+                    parent[w] = v;
+                    disc[w] = low[w] = time++;
+                    if (v == root) ++root_children;
+                    stack.emplace_back(w, 0);
+                } else if (w != parent[v]) {
+                    low[v] = std::min(low[v], disc[w]);
+                }
+                continue;
+            }
+            stack.pop_back();
+            int p = parent[v];
+            if (p < 0) continue;
+            low[p] = std::min(low[p], low[v]);
+            if (p != root && low[v] >= disc[p]) m_articulation[p] = 1;
+        }
+        if (root_children > 1) m_articulation[root] = 1;
+    }
+    for (uint8_t a : m_articulation) m_stats.articulation_points += a;
+}
+
+} // namespace mesh3d
@@ -0,0 +1,87 @@
+#pragma once
+#include "analysis/path_loss.h"
+#include <mesh3d/types.h>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+struct NodeData;
+class ThreadPool;
+
+/* Node-to-node link graph of the mesh.
+
+   Holds the path_loss_batch() result for every ordered pair of nodes
+   (tx-major, n x n) and derives from it the graph of usable links: nodes
+   i and j are linked when the margin is at least min_margin_db in both
+   directions. Hop counts, partitions and articulation points (nodes whose
+   loss splits a partition) are recomputed from that graph after every
+   change; that is O(n^2) integer work against the path loss runs, which
+   dominate.
+
+   Adding, moving or removing one node re-evaluates only the 2(n - 1)
+   links that node is part of. The links are tied to the settings and
+   terrain source (`terrain_key`: the scene grid's hash, or the tile set as
+   a whole) they were computed with: if either has changed since, the next
+   update recomputes every pair instead. Tiles arriving or leaving do not
+   count as a change. Links whose profile ran off the loaded elevation
+   (terrain_complete == 0) are re-evaluated by refresh_incomplete() once
+   the grids change, and the rest are kept. */
+class LinkGraph {
+public:
+    /* Recompute every link */
+    void rebuild(const std::vector<NodeData>& nodes, const PathTerrain& terrain,
+                 uint64_t terrain_key, const PathLossSettings& settings, ThreadPool* pool);
+
+    /* nodes[idx] was appended or moved; every other node is unchanged */
+    void update_node(const std::vector<NodeData>& nodes, int idx, const PathTerrain& terrain,
+                     uint64_t terrain_key, const PathLossSettings& settings, ThreadPool* pool);
+
+    /* Node idx was erased from `nodes` */
+    void remove_node(const std::vector<NodeData>& nodes, int idx, const PathTerrain& terrain,
+                     uint64_t terrain_key, const PathLossSettings& settings, ThreadPool* pool);
+
+    /* True if links were computed with other settings or terrain */
+    bool stale(uint64_t terrain_key, const PathLossSettings& settings) const;
+
+    /* If `terrain` holds other grids than when the links were last
+       evaluated, re-evaluate the links with incomplete terrain */
+    void refresh_incomplete(const std::vector<NodeData>& nodes, const PathTerrain& terrain,
+                            const PathLossSettings& settings, ThreadPool* pool);
+
+    /* Margin a link needs in both directions (dB); re-derives the graph */
+    void set_min_margin(float db);
+    float min_margin() const { return m_min_margin_db; }
+
+    void clear();
+
+    int size() const { return m_n; }
+    const mesh3d_path_result_t& link(int tx, int rx) const { return m_links[tx * m_n + rx]; }
+    bool linked(int a, int b) const { return m_adjacent[a * m_n + b] != 0; }
+    /* Fewest hops from a to b, -1 if they are in different partitions */
+    int hops(int a, int b) const { return m_hops[a * m_n + b]; }
+    int partition(int node) const { return m_partition[node]; }
+    bool articulation(int node) const { return m_articulation[node] != 0; }
+    const mesh3d_link_graph_stats_t& stats() const { return m_stats; }
+
+private:
+    int m_n = 0;
+    uint64_t m_key = 0;                        // settings + terrain of m_links
+    uint64_t m_grids_key = 0;                  // PathTerrain::key() last evaluated on
+    int m_incomplete = 0;                      // links with terrain_complete == 0
+    float m_min_margin_db = 0.0f;
+    std::vector<mesh3d_path_result_t> m_links; // n x n, tx-major
+    std::vector<uint8_t> m_adjacent;           // n x n
+    std::vector<int> m_hops;                   // n x n
+    std::vector<int> m_partition;
+    std::vector<uint8_t> m_articulation;
+    mesh3d_link_graph_stats_t m_stats{};
+
+    /* Evaluate the links to and from node idx (both directions) */
+    void compute_node_links(const std::vector<NodeData>& nodes, int idx,
+                            const PathTerrain& terrain, const PathLossSettings& settings,
+                            ThreadPool* pool);
+    void analyse();
+};
+
+} // namespace mesh3d
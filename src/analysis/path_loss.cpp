@@ -0,0 +1,276 @@
+#include "analysis/path_loss.h"
+#include "analysis/viewshed_kernel.h"
+#include "analysis/itm.h"
+#include "util/thread_pool.h"
+#include "util/math_util.h"
+#include "util/hash.h"
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+namespace mesh3d {
+
+static const float EARTH_CURVE_FACTOR = 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f);
+/* Profile samples per path; at 30 m posts this covers ~120 km at full
+   resolution, longer paths are sampled more coarsely */
+static const int MAX_PATH_SAMPLES = 4096;
+/* Longest profile handed to itm_point_to_point(), as in the ITM shader */
+static const int MAX_ITM_PROFILE = 512;
+
+void PathTerrain::add_grid(const float* elevation, int rows, int cols,
+                           const mesh3d_bounds_t& bounds, uint64_t hash) {
+    if (!elevation || rows < 2 || cols < 2) return;
+    Grid g;
+    g.data = elevation;
+    g.rows = rows;
+    g.cols = cols;
+    g.bounds = bounds;
+    m_grids.push_back(g);
+
+    uint64_t h = FNV_OFFSET;
+    hash_field(h, hash);
+    hash_field(h, bounds.min_lat);
+    hash_field(h, bounds.max_lat);
+    hash_field(h, bounds.min_lon);
+    hash_field(h, bounds.max_lon);
+    m_key += h * 0x9e3779b97f4a7c15ull + 1;
+
+    double lat_res = (bounds.max_lat - bounds.min_lat) / (rows - 1);
+    double lon_res = (bounds.max_lon - bounds.min_lon) / (cols - 1);
+    double center_lat = (bounds.min_lat + bounds.max_lat) * 0.5;
+    float spacing = static_cast<float>((lat_res * meters_per_deg_lat() +
+                                        lon_res * meters_per_deg_lon(center_lat * M_PI / 180.0)) * 0.5);
+    if (m_spacing_m <= 0.0f || spacing < m_spacing_m) m_spacing_m = spacing;
+}
+
+bool PathTerrain::sample(const Grid& g, double lat, double lon, float& out) {
+    const mesh3d_bounds_t& b = g.bounds;
+    if (lat < b.min_lat || lat > b.max_lat || lon < b.min_lon || lon > b.max_lon)
+        return false;
+
+    /* Bilinear, as TileManager::get_elevation_at() */
+    double u = (lon - b.min_lon) / (b.max_lon - b.min_lon);
+    double v = (b.max_lat - lat) / (b.max_lat - b.min_lat);
+    float gc = static_cast<float>(u * (g.cols - 1));
+    float gr = static_cast<float>(v * (g.rows - 1));
+    int c0 = std::clamp(static_cast<int>(gc), 0, g.cols - 2);
+    int r0 = std::clamp(static_cast<int>(gr), 0, g.rows - 2);
+    float fc = gc - c0;
+    float fr = gr - r0;
+
+    const float* row0 = g.data + static_cast<size_t>(r0) * g.cols;
+    const float* row1 = row0 + g.cols;
+    float h0 = row0[c0] + (row0[c0 + 1] - row0[c0]) * fc;
+    float h1 = row1[c0] + (row1[c0 + 1] - row1[c0]) * fc;
+    out = h0 + (h1 - h0) * fr;
+    return true;
+}
+
+bool PathTerrain::elevation(double lat, double lon, float& out, int& hint) const {
+    if (hint >= 0 && hint < static_cast<int>(m_grids.size()) &&
+        sample(m_grids[hint], lat, lon, out))
+        return true;
+    for (int i = 0; i < static_cast<int>(m_grids.size()); ++i) {
+        if (i == hint) continue;
+        if (sample(m_grids[i], lat, lon, out)) {
+            hint = i;
+            return true;
+        }
+    }
+    out = 0.0f;
+    return false;
+}
+
+mesh3d_path_query_t path_query(const mesh3d_node_t& tx, const mesh3d_node_t& rx) {
+    mesh3d_path_query_t q{};
+    q.tx_lat = tx.lat;
+    q.tx_lon = tx.lon;
+    q.tx_height_m = tx.antenna_height_m;
+    q.tx_power_dbm = tx.tx_power_dbm;
+    q.tx_gain_dbi = tx.antenna_gain_dbi;
+    q.tx_cable_loss_db = tx.cable_loss_db;
+    q.frequency_mhz = tx.frequency_mhz;
+    q.rx_lat = rx.lat;
+    q.rx_lon = rx.lon;
+    q.rx_height_m = rx.antenna_height_m < 1.0f ? 2.0f : rx.antenna_height_m;
+    q.rx_gain_dbi = rx.antenna_gain_dbi;
+    q.rx_cable_loss_db = rx.cable_loss_db;
+    q.rx_sensitivity_dbm = rx.rx_sensitivity_dbm;
+    return q;
+}
+
+/* Path distance (m), equirectangular at the mid latitude like the grids'
+   cell size */
+static double path_distance_m(double lat0, double lon0, double lat1, double lon1) {
+    double mid_lat = (lat0 + lat1) * 0.5;
+    double dy = (lat1 - lat0) * meters_per_deg_lat();
+    double dx = (lon1 - lon0) * meters_per_deg_lon(mid_lat * M_PI / 180.0);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+/* Ground elevation at n evenly spaced points from (lat0, lon0) to
+   (lat1, lon1); false if any point had no elevation data */
+static bool sample_profile(const PathTerrain& terrain, double lat0, double lon0,
+                           double lat1, double lon1, int n, float* prof) {
+    bool complete = true;
+    int hint = -1;
+    for (int i = 0; i < n; ++i) {
+        double t = static_cast<double>(i) / (n - 1);
+        complete &= terrain.elevation(lat0 + (lat1 - lat0) * t, lon0 + (lon1 - lon0) * t,
+                                      prof[i], hint);
+    }
+    return complete;
+}
+
+/* Model, signal and clearance for one query over its profile prof[0..n-1]
+   (TX end first), samples d_total / (n - 1) apart */
+static void evaluate_path(const PathLossSettings& settings, const mesh3d_path_query_t& q,
+                          const float* prof, int n, float d_total,
+                          mesh3d_path_result_t& out) {
+    const mesh3d_rf_config_t& rf = settings.rf_config;
+    float freq = q.frequency_mhz > 0.0f ? q.frequency_mhz : 906.875f;
+    float tx_power = q.tx_power_dbm > 0.0f ? q.tx_power_dbm : 22.0f;
+    float tx_h = q.tx_height_m < 1.0f ? 2.0f : q.tx_height_m;
+    float rx_h = q.rx_height_m > 0.0f ? q.rx_height_m : rf.rx_height_agl_m;
+    float rx_sens = q.rx_sensitivity_dbm < 0.0f ? q.rx_sensitivity_dbm : rf.rx_sensitivity_dbm;
+    float lambda = 299.792458f / freq;
+
+    /* Clearance of the straight TX-RX line over the terrain plus the 4/3
+       earth bulge, and against the first Fresnel zone */
+    const float h_tx = prof[0] + tx_h;
+    const float h_rx = prof[n - 1] + rx_h;
+    float min_clear = std::min(tx_h, rx_h);
+    float min_ratio = FLT_MAX;
+    float worst_t = 0.0f;
+    for (int i = 1; i < n - 1; ++i) {
+        float t = static_cast<float>(i) / (n - 1);
+        float d1 = d_total * t;
+        float d2 = d_total - d1;
+        float terrain_h = prof[i] + d1 * d2 * EARTH_CURVE_FACTOR;
+        float clear = h_tx + (h_rx - h_tx) * t - terrain_h;
+        float r1 = std::sqrt(lambda * d1 * d2 / d_total);
+        if (clear < min_clear) {
+            min_clear = clear;
+            worst_t = t;
+        }
+        if (r1 > 0.0f) min_ratio = std::min(min_ratio, clear / r1);
+    }
+
+    float dist_km = std::max(d_total / 1000.0f, 0.01f);
+    float fspl = 20.0f * std::log10(dist_km) + 20.0f * std::log10(freq) + 32.44f;
+
+    float loss;
+    if (settings.model == MESH3D_PROP_ITM && n >= 2 && d_total > 0.0f) {
+        int step = (n + MAX_ITM_PROFILE - 1) / MAX_ITM_PROFILE;
+        int n_profile = std::max(std::min((n + step - 1) / step, MAX_ITM_PROFILE), 2);
+        float path[MAX_ITM_PROFILE];
+        for (int i = 0; i < n_profile; ++i)
+            path[i] = prof[static_cast<size_t>(i) * (n - 1) / (n_profile - 1)];
+        loss = itm_point_to_point(path, n_profile, d_total / (n_profile - 1),
+                                  tx_h, std::max(rx_h, 1.0f), freq, settings.itm_params);
+    } else if (settings.model == MESH3D_PROP_FRESNEL && n >= 2 && d_total > 0.0f) {
+        ViewshedSetup vs;
+        vs.cell_m = d_total / (n - 1);
+        vs.obs_h = h_tx;
+        vs.rx_height = rx_h;
+        vs.freq_mhz = freq;
+        loss = fresnel_path_loss_db(vs, prof, n - 1);
+    } else {
+        /* FSPL / SWEEP: free space plus the worst knife edge (ITU-R P.526),
+           as viewshed_block() */
+        loss = fspl;
+        if (min_clear < 0.0f) {
+            float d1 = d_total * worst_t;
+            float d2 = d_total - d1;
+            float v = -min_clear * std::sqrt(2.0f / (lambda * (d1 * d2 / (d1 + d2))));
+            if (v > -0.78f)
+                loss += 6.9f + 20.0f * std::log10(std::sqrt((v - 0.1f) * (v - 0.1f) + 1.0f) + v - 0.1f);
+        }
+    }
+
+    out.path_loss_db = loss;
+    out.signal_dbm = tx_power + q.tx_gain_dbi - q.tx_cable_loss_db - loss
+                   + q.rx_gain_dbi - q.rx_cable_loss_db;
+    out.link_margin_db = out.signal_dbm - rx_sens;
+    out.distance_m = d_total;
+    out.clearance_m = min_clear;
+    out.fresnel_clearance = min_ratio == FLT_MAX ? 1.0f : min_ratio;
+    out.obstruction_m = d_total * worst_t;
+    out.los = min_clear >= 0.0f ? 1 : 0;
+}
+
+/* Endpoints in a fixed order, so both directions of a pair compare equal */
+static bool tx_first(const mesh3d_path_query_t& q) {
+    return q.tx_lat < q.rx_lat || (q.tx_lat == q.rx_lat && q.tx_lon <= q.rx_lon);
+}
+
+static void canonical_endpoints(const mesh3d_path_query_t& q, double e[4]) {
+    if (tx_first(q)) {
+        e[0] = q.tx_lat; e[1] = q.tx_lon; e[2] = q.rx_lat; e[3] = q.rx_lon;
+    } else {
+        e[0] = q.rx_lat; e[1] = q.rx_lon; e[2] = q.tx_lat; e[3] = q.tx_lon;
+    }
+}
+
+void path_loss_batch(const PathTerrain& terrain, const PathLossSettings& settings,
+                     const mesh3d_path_query_t* queries, size_t count,
+                     mesh3d_path_result_t* results, ThreadPool* pool) {
+    if (count == 0) return;
+
+    /* Group queries over the same pair of endpoints */
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    auto less = [&](size_t a, size_t b) {
+        double ea[4], eb[4];
+        canonical_endpoints(queries[a], ea);
+        canonical_endpoints(queries[b], eb);
+        return std::lexicographical_compare(ea, ea + 4, eb, eb + 4);
+    };
+    std::sort(order.begin(), order.end(), less);
+    std::vector<size_t> group_start;
+    for (size_t i = 0; i < count; ++i)
+        if (i == 0 || less(order[i - 1], order[i])) group_start.push_back(i);
+    group_start.push_back(count);
+
+    const float spacing = terrain.post_spacing_m();
+    auto run_group = [&](int g) {
+        thread_local std::vector<float> forward;
+        thread_local std::vector<float> reverse;
+
+        double e[4];
+        canonical_endpoints(queries[order[group_start[g]]], e);
+        float d_total = static_cast<float>(path_distance_m(e[0], e[1], e[2], e[3]));
+        int n = 2;
+        if (spacing > 0.0f)
+            n = std::clamp(static_cast<int>(std::ceil(d_total / spacing)) + 1, 2, MAX_PATH_SAMPLES);
+
+        forward.resize(n);
+        bool complete = sample_profile(terrain, e[0], e[1], e[2], e[3], n, forward.data());
+        bool reversed = false;
+
+        for (size_t i = group_start[g]; i < group_start[g + 1]; ++i) {
+            const mesh3d_path_query_t& q = queries[order[i]];
+            const float* prof = forward.data();
+            if (!tx_first(q)) {
+                if (!reversed) {
+                    reverse.assign(forward.rbegin(), forward.rend());
+                    reversed = true;
+                }
+                prof = reverse.data();
+            }
+            mesh3d_path_result_t& out = results[order[i]];
+            evaluate_path(settings, q, prof, n, d_total, out);
+            out.terrain_complete = complete ? 1 : 0;
+        }
+    };
+
+    int groups = static_cast<int>(group_start.size()) - 1;
+    if (pool) {
+        pool->parallel_for(groups, run_group);
+    } else {
+        for (int g = 0; g < groups; ++g) run_group(g);
+    }
+}
+
+} // namespace mesh3d
@@ -0,0 +1,72 @@
+#pragma once
+#include <mesh3d/types.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh3d {
+
+class ThreadPool;
+
+/* Elevation for point-to-point paths: a set of row-major grids (the
+   scene's grid, or each cached tile's), referenced rather than copied, so
+   it must not outlive them. Grids are searched in the order added. */
+class PathTerrain {
+public:
+    /* `hash` identifies the grid's content (e.g. its elevation hash) */
+    void add_grid(const float* elevation, int rows, int cols, const mesh3d_bounds_t& bounds,
+                  uint64_t hash = 0);
+    bool empty() const { return m_grids.empty(); }
+
+    /* Order-independent key of the grids added (hashes and bounds), so a
+       caller can tell when a tile arrived or left */
+    uint64_t key() const { return m_key; }
+
+    /* Bilinear elevation at (lat, lon), false (and 0) where no grid covers
+       it. `hint` is the grid that served the previous lookup (-1 = none);
+       successive samples along a path almost always share a grid. */
+    bool elevation(double lat, double lon, float& out, int& hint) const;
+
+    /* Finest post spacing over all grids (m); paths are sampled at this */
+    float post_spacing_m() const { return m_spacing_m; }
+
+private:
+    struct Grid {
+        const float* data = nullptr;
+        int rows = 0, cols = 0;
+        mesh3d_bounds_t bounds{};
+    };
+    std::vector<Grid> m_grids;
+    float m_spacing_m = 0.0f;
+    uint64_t m_key = 0;
+
+    static bool sample(const Grid& g, double lat, double lon, float& out);
+};
+
+/* Model and receiver defaults a batch is evaluated with */
+struct PathLossSettings {
+    mesh3d_prop_model_t model = MESH3D_PROP_FSPL;
+    mesh3d_itm_params_t itm_params{};
+    mesh3d_rf_config_t rf_config{};
+};
+
+/* Query for the link from `tx` to `rx`, each node's radio on its side */
+mesh3d_path_query_t path_query(const mesh3d_node_t& tx, const mesh3d_node_t& rx);
+
+/* Path loss, received signal and terrain clearance for `count` paths.
+
+   Queries are grouped by unordered endpoint pair, and each pair's terrain
+   profile is sampled once into per-thread buffers and shared by every
+   query over it (A -> B and B -> A, other radios or frequencies), so an
+   N x N link matrix samples N(N-1)/2 profiles. Pairs run in parallel on
+   `pool` (serially if null).
+
+   FSPL and SWEEP use free space plus the worst knife edge, as the ray
+   march does; ITM uses itm_point_to_point() and Fresnel
+   fresnel_path_loss_db(). Unlike the coverage grids, the RX antenna height
+   is applied for every model. */
+void path_loss_batch(const PathTerrain& terrain, const PathLossSettings& settings,
+                     const mesh3d_path_query_t* queries, size_t count,
+                     mesh3d_path_result_t* results, ThreadPool* pool);
+
+} // namespace mesh3d
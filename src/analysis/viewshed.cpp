@@ -1,5 +1,8 @@
 #include "analysis/viewshed.h"
+#include "analysis/viewshed_kernel.h"
+#include "analysis/viewshed_engine.h"
 #include "analysis/gpu_viewshed.h"
+#include "analysis/coverage_cache.h"
 #include "util/log.h"
 #include <cmath>
 #include <algorithm>
@@ -7,30 +10,29 @@
 
 namespace mesh3d {
 
-void compute_viewshed(const float* elevation, int rows, int cols,
-                      const mesh3d_bounds_t& bounds,
-                      const NodeData& node,
-                      std::vector<uint8_t>& visibility,
-                      std::vector<float>& signal,
-                      const mesh3d_rf_config_t& rf_config) {
-    int total = rows * cols;
-    visibility.assign(total, 0);
-    signal.assign(total, -999.0f);
+ViewshedSetup viewshed_setup(const float* elevation, int rows, int cols,
+                             const mesh3d_bounds_t& bounds,
+                             const NodeData& node,
+                             const mesh3d_rf_config_t& rf_config) {
+    ViewshedSetup vs;
+    vs.elevation = elevation;
+    vs.rows = rows;
+    vs.cols = cols;
 
     /* Map node lat/lon to grid cell */
     double lat_res = (bounds.max_lat - bounds.min_lat) / (rows - 1);
     double lon_res = (bounds.max_lon - bounds.min_lon) / (cols - 1);
 
-    int nr = static_cast<int>((bounds.max_lat - node.info.lat) / lat_res);
-    int nc = static_cast<int>((node.info.lon - bounds.min_lon) / lon_res);
+    vs.nr = static_cast<int>((bounds.max_lat - node.info.lat) / lat_res);
+    vs.nc = static_cast<int>((node.info.lon - bounds.min_lon) / lon_res);
 
     /* Node may be off-grid (on an adjacent tile); use nearest edge cell for elevation */
-    int nr_elev = std::clamp(nr, 0, rows - 1);
-    int nc_elev = std::clamp(nc, 0, cols - 1);
+    int nr_elev = std::clamp(vs.nr, 0, rows - 1);
+    int nc_elev = std::clamp(vs.nc, 0, cols - 1);
     float node_elev = elevation[nr_elev * cols + nc_elev];
     float antenna_h = node.info.antenna_height_m;
     if (antenna_h < 1.0f) antenna_h = 2.0f;
-    float obs_h = node_elev + antenna_h;
+    vs.obs_h = node_elev + antenna_h;
 
     /* Approximate cell size in meters (~30m for SRTM1 at mid-latitudes) */
     double center_lat = (bounds.min_lat + bounds.max_lat) * 0.5;
@@ -38,40 +40,91 @@ void compute_viewshed(const float* elevation, int rows, int cols,
     double m_per_deg_lon = 111320.0 * std::cos(center_lat * M_PI / 180.0);
     float cell_m_lat = static_cast<float>(lat_res * m_per_deg_lat);
     float cell_m_lon = static_cast<float>(lon_res * m_per_deg_lon);
-    float cell_m = (cell_m_lat + cell_m_lon) * 0.5f;
+    vs.cell_m = (cell_m_lat + cell_m_lon) * 0.5f;
 
     /* TX power for signal calculation */
-    float tx_power_dbm = node.info.tx_power_dbm;
-    if (tx_power_dbm <= 0) tx_power_dbm = 22.0f; // default heltec
-    float antenna_gain = node.info.antenna_gain_dbi;
+    vs.tx_power_dbm = node.info.tx_power_dbm;
+    if (vs.tx_power_dbm <= 0) vs.tx_power_dbm = 22.0f; // default heltec
+    vs.antenna_gain = node.info.antenna_gain_dbi;
+    vs.freq_mhz = node.info.frequency_mhz;
+    if (vs.freq_mhz <= 0) vs.freq_mhz = 906.875f;
+    vs.cable_loss = node.info.cable_loss_db;
+    vs.rx_sens = node.info.rx_sensitivity_dbm;
+    if (vs.rx_sens >= 0) vs.rx_sens = rf_config.rx_sensitivity_dbm;
+    vs.rx_antenna_gain = rf_config.rx_antenna_gain_dbi;
+    vs.rx_cable_loss = rf_config.rx_cable_loss_db;
+    vs.rx_height = rf_config.rx_height_agl_m;
+
+    /* Max range: full grid diagonal — let signal attenuation handle clipping */
+    vs.max_range_cells = static_cast<int>(
+        std::sqrt(static_cast<float>(rows * rows + cols * cols)));
+    return vs;
+}
+
+float node_link_range_m(const NodeData& node, const mesh3d_rf_config_t& rf_config) {
+    float tx_power = node.info.tx_power_dbm;
+    if (tx_power <= 0) tx_power = 22.0f;
     float freq_mhz = node.info.frequency_mhz;
     if (freq_mhz <= 0) freq_mhz = 906.875f;
-    float cable_loss = node.info.cable_loss_db;
     float rx_sens = node.info.rx_sensitivity_dbm;
     if (rx_sens >= 0) rx_sens = rf_config.rx_sensitivity_dbm;
 
-    /* Max range: full grid diagonal — let signal attenuation handle clipping */
-    float eirp = tx_power_dbm + antenna_gain - cable_loss;
-    int max_range_cells = static_cast<int>(
-        std::sqrt(static_cast<float>(rows * rows + cols * cols)));
+    float budget_db = tx_power + node.info.antenna_gain_dbi - node.info.cable_loss_db
+                    + rf_config.rx_antenna_gain_dbi - rf_config.rx_cable_loss_db - rx_sens;
+
+    /* Invert FSPL(d_km) = 20 log10(d_km) + 20 log10(f_mhz) + 32.44 */
+    float log_d_km = (budget_db - 32.44f - 20.0f * std::log10(freq_mhz)) / 20.0f;
+    return 1000.0f * std::pow(10.0f, log_d_km);
+}
+
+bool node_reaches_bounds(const NodeData& node, float range_m,
+                         const mesh3d_bounds_t& bounds, int rows, int cols,
+                         float margin) {
+    if (rows < 2 || cols < 2) return false;
+    double lat_res = (bounds.max_lat - bounds.min_lat) / (rows - 1);
+    double lon_res = (bounds.max_lon - bounds.min_lon) / (cols - 1);
+    double center_lat = (bounds.min_lat + bounds.max_lat) * 0.5;
+    double cell_m = (lat_res * meters_per_deg_lat() +
+                     lon_res * meters_per_deg_lon(center_lat * M_PI / 180.0)) * 0.5;
+
+    /* Nearest point of the box in cell units; the kernels' metric is a
+       per-axis scaling of lat/lon, so clamping per axis finds it */
+    double dlat = node.info.lat - std::clamp(node.info.lat, bounds.min_lat, bounds.max_lat);
+    double dlon = node.info.lon - std::clamp(node.info.lon, bounds.min_lon, bounds.max_lon);
+    double dist_m = std::hypot(dlat / lat_res, dlon / lon_res) * cell_m;
+    return dist_m <= static_cast<double>(range_m) * margin;
+}
 
-    /* Earth curvature factor: 1 / (2 * k * Re) where k=4/3, Re=6371000m */
-    const float earth_curve_factor = 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f);
+void viewshed_block(const ViewshedSetup& vs,
+                    int r0, int r1, int c0, int c1,
+                    uint8_t* visibility, float* signal, int out_stride) {
+    const float* elevation = vs.elevation;
+    const int cols = vs.cols;
+    const int nr = vs.nr;
+    const int nc = vs.nc;
+    const float cell_m = vs.cell_m;
+    const float freq_mhz = vs.freq_mhz;
+    const RayMarchFn march = viewshed_ray_march();
+
+    for (int r = r0; r < r1; ++r) {
+        uint8_t* vis_row = visibility + (r - r0) * out_stride;
+        float* sig_row = signal + (r - r0) * out_stride;
+        for (int c = c0; c < c1; ++c) {
+            vis_row[c - c0] = 0;
+            sig_row[c - c0] = -999.0f;
 
-    for (int r = 0; r < rows; ++r) {
-        for (int c = 0; c < cols; ++c) {
             int dr = r - nr;
             int dc = c - nc;
             float dist_cells = std::sqrt(static_cast<float>(dr * dr + dc * dc));
 
             if (dist_cells < 0.5f) {
                 /* Node's own cell */
-                visibility[r * cols + c] = 1;
-                signal[r * cols + c] = -60.0f;
+                vis_row[c - c0] = 1;
+                sig_row[c - c0] = -60.0f;
                 continue;
             }
 
-            if (dist_cells > max_range_cells) continue;
+            if (dist_cells > vs.max_range_cells) continue;
 
             /* Walk along the ray with earth curvature and diffraction */
             int steps = static_cast<int>(dist_cells * 1.5f) + 1;
@@ -79,30 +132,8 @@ void compute_viewshed(const float* elevation, int rows, int cols,
             float d_total = dist_cells * cell_m;
 
             /* Find maximum obstruction above LOS line (Deygout method) */
-            float max_violation = 0.0f;
-            float best_t = 0.0f;
-
-            for (int s = 1; s < steps; ++s) {
-                float t = static_cast<float>(s) / steps;
-                float sr = nr + dr * t;
-                float sc = nc + dc * t;
-                int si = static_cast<int>(sr);
-                int sj = static_cast<int>(sc);
-
-                if (si < 0 || si >= rows || sj < 0 || sj >= cols) continue;
-
-                /* LOS height with 4/3 earth curvature correction */
-                float d_along = d_total * t;
-                float d_remain = d_total * (1.0f - t);
-                float earth_curve = d_along * d_remain * earth_curve_factor;
-                float needed_h = obs_h + (target_elev - obs_h) * t - earth_curve;
-                float terrain_h = elevation[si * cols + sj];
-                float violation = terrain_h - needed_h;
-                if (violation > max_violation) {
-                    max_violation = violation;
-                    best_t = t;
-                }
-            }
+            float max_violation, best_t;
+            march(vs, dr, dc, steps, target_elev, d_total, max_violation, best_t);
 
             /* Free-space path loss */
             float dist_km = d_total / 1000.0f;
@@ -112,7 +143,7 @@ void compute_viewshed(const float* elevation, int rows, int cols,
                        + 32.44f;
 
             /* EIRP with cable loss */
-            float eirp = tx_power_dbm + antenna_gain - cable_loss;
+            float eirp = vs.tx_power_dbm + vs.antenna_gain - vs.cable_loss;
 
             /* Knife-edge diffraction loss (ITU-R P.526) */
             float diff_loss_db = 0.0f;
@@ -128,57 +159,154 @@ void compute_viewshed(const float* elevation, int rows, int cols,
                 }
             }
 
-            float received = eirp - fspl - diff_loss_db + rf_config.rx_antenna_gain_dbi - rf_config.rx_cable_loss_db;
+            float received = eirp - fspl - diff_loss_db + vs.rx_antenna_gain - vs.rx_cable_loss;
 
             /* Visibility based on RX sensitivity threshold */
-            if (received >= rx_sens) {
-                visibility[r * cols + c] = 1;
+            if (received >= vs.rx_sens) {
+                vis_row[c - c0] = 1;
             }
-            signal[r * cols + c] = received;
+            sig_row[c - c0] = received;
         }
     }
 }
 
-void recompute_all_viewsheds(Scene& scene, const GeoProjection& proj) {
-    /* Scene-level elevation grid path */
-    if (!scene.elevation.empty() && scene.grid_rows >= 2 && scene.grid_cols >= 2) {
-        int rows = scene.grid_rows;
-        int cols = scene.grid_cols;
-        int total = rows * cols;
+void compute_viewshed(const float* elevation, int rows, int cols,
+                      const mesh3d_bounds_t& bounds,
+                      const NodeData& node,
+                      std::vector<uint8_t>& visibility,
+                      std::vector<float>& signal,
+                      const mesh3d_rf_config_t& rf_config) {
+    int total = rows * cols;
+    visibility.resize(total);
+    signal.resize(total);
 
-        scene.viewshed_vis.assign(total, 0);
-        scene.signal_strength.assign(total, -999.0f);
-        scene.overlap_count.assign(total, 0);
+    ViewshedSetup vs = viewshed_setup(elevation, rows, cols, bounds, node, rf_config);
+    viewshed_block(vs, 0, rows, 0, cols, visibility.data(), signal.data(), cols);
+}
+
+/* -----------------------------------------------------------------------
+ * Scene-grid coverage goes through scene.coverage_cache: each recompute
+ * computes only the nodes whose key (position, RF, model, terrain) has no
+ * cached result in memory or on disk, then re-merges every node from the
+ * cache.
+ * ----------------------------------------------------------------------- */
+static bool has_scene_grid(const Scene& scene) {
+    return !scene.elevation.empty() && scene.grid_rows >= 2 && scene.grid_cols >= 2;
+}
 
+/* Key every node and start a cache pass; returns the nodes to compute */
+static std::vector<size_t> plan_coverage(Scene& scene, const GpuViewshed* gpu) {
+    CoverageContext ctx = make_coverage_context(scene.grid_rows, scene.grid_cols, scene.bounds,
+                                                scene.terrain_hash, scene.rf_config, gpu);
+    scene.coverage_keys.clear();
+    for (auto& nd : scene.nodes)
+        scene.coverage_keys.push_back(CoverageCache::key(nd.info, ctx));
+    return scene.coverage_cache.begin_pass(scene.coverage_keys);
+}
+
+/* Compute scene.nodes[i] for each i in `missing` on the GPU and cache
+   them: fused batches of up to max_slices() nodes, one readback each */
+static void compute_missing_gpu(Scene& scene, const std::vector<size_t>& missing,
+                                GpuViewshed* gpu) {
+    if (missing.empty()) return;
+    int rows = scene.grid_rows;
+    int cols = scene.grid_cols;
+    gpu->upload_elevation(scene.elevation.data(), rows, cols);
+    gpu->set_grid_params(scene.bounds, rows, cols);
+
+    const size_t batch = static_cast<size_t>(gpu->max_slices());
+    std::vector<NodeData> nodes;
+    std::vector<std::vector<uint8_t>> vis;
+    std::vector<std::vector<float>> sig;
+    for (size_t b = 0; b < missing.size(); b += batch) {
+        size_t end = std::min(b + batch, missing.size());
+        nodes.clear();
+        for (size_t j = b; j < end; ++j) nodes.push_back(scene.nodes[missing[j]]);
+        gpu->compute_slices(nodes);
+        gpu->read_back_slices(vis, sig);
+        for (size_t j = b; j < end && j - b < vis.size(); ++j)
+            scene.coverage_cache.store(scene.coverage_keys[missing[j]],
+                                       vis[j - b], sig[j - b], rows, cols);
+    }
+}
+
+/* Merge the cached coverage of every node into the scene overlay. If an
+   entry went missing since it was computed, it is computed again with the
+   same engine (`gpu`, or the CPU if null) so the keys stay valid. */
+static void finish_coverage(Scene& scene, const char* label, GpuViewshed* gpu = nullptr) {
+    int rows = scene.grid_rows;
+    int cols = scene.grid_cols;
+    int total = rows * cols;
+
+    auto merge = [&]() {
+        return scene.coverage_cache.merge(scene.coverage_keys, rows, cols,
+                                          scene.viewshed_vis, scene.signal_strength,
+                                          scene.overlap_count, &cpu_viewshed_engine().pool());
+    };
+    if (!merge()) {
+        if (gpu) {
+            LOG_WARN("%s: coverage cache lost a node, recomputing it on the GPU", label);
+            compute_missing_gpu(scene, scene.coverage_cache.begin_pass(scene.coverage_keys), gpu);
+            if (!merge()) {
+                /* Cache budget below one pass: merge on the GPU uncached */
+                LOG_WARN("%s: coverage cache cannot hold every node, merging on the GPU", label);
+                gpu->upload_elevation(scene.elevation.data(), rows, cols);
+                gpu->set_grid_params(scene.bounds, rows, cols);
+                gpu->compute_all(scene.nodes);
+                gpu->read_back(scene.viewshed_vis, scene.signal_strength, scene.overlap_count);
+            }
+        } else {
+            LOG_WARN("%s: coverage cache lost a node, recomputing all on the CPU", label);
+            cpu_viewshed_engine().compute_merged(
+                scene.elevation.data(), rows, cols, scene.bounds,
+                scene.nodes, scene.rf_config,
+                scene.viewshed_vis, scene.signal_strength, &scene.overlap_count);
+        }
+    }
+    scene.build_terrain();
+
+    int vis_count = 0;
+    for (auto v : scene.viewshed_vis) vis_count += v;
+    float pct = 100.0f * vis_count / total;
+    LOG_INFO("%s computed for %zu nodes (%.1f MB cached): %.1f%% coverage",
+             label, scene.nodes.size(),
+             scene.coverage_cache.bytes() / (1024.0 * 1024.0), pct);
+}
+
+static void clear_coverage(Scene& scene) {
+    int total = scene.grid_rows * scene.grid_cols;
+    scene.viewshed_vis.assign(total, 0);
+    scene.signal_strength.assign(total, -999.0f);
+    scene.overlap_count.assign(total, 0);
+    scene.coverage_keys.clear();
+    scene.coverage_queue.clear();
+    scene.build_terrain();
+    LOG_INFO("Viewshed cleared (no nodes)");
+}
+
+void recompute_all_viewsheds(Scene& scene, const GeoProjection& proj) {
+    /* Scene-level elevation grid path */
+    if (has_scene_grid(scene)) {
         if (scene.nodes.empty()) {
-            scene.build_terrain();
-            LOG_INFO("Viewshed cleared (no nodes)");
+            clear_coverage(scene);
             return;
         }
 
-        for (auto& nd : scene.nodes) {
-            std::vector<uint8_t> vis;
-            std::vector<float> sig;
-            compute_viewshed(scene.elevation.data(), rows, cols,
-                             scene.bounds, nd, vis, sig, scene.rf_config);
-
-            for (int i = 0; i < total; ++i) {
-                if (vis[i]) {
-                    scene.viewshed_vis[i] = 1;
-                    scene.overlap_count[i]++;
-                    if (sig[i] > scene.signal_strength[i])
-                        scene.signal_strength[i] = sig[i];
-                }
-            }
+        int rows = scene.grid_rows;
+        int cols = scene.grid_cols;
+        std::vector<size_t> missing = plan_coverage(scene, nullptr);
+        LOG_INFO("Viewshed: %zu of %zu nodes uncached", missing.size(), scene.nodes.size());
+
+        std::vector<uint8_t> vis;
+        std::vector<float> sig;
+        for (size_t i : missing) {
+            cpu_viewshed_engine().compute_merged(
+                scene.elevation.data(), rows, cols, scene.bounds,
+                {scene.nodes[i]}, scene.rf_config, vis, sig, nullptr);
+            scene.coverage_cache.store(scene.coverage_keys[i], vis, sig, rows, cols);
         }
 
-        scene.build_terrain();
-
-        int vis_count = 0;
-        for (auto v : scene.viewshed_vis) vis_count += v;
-        float pct = 100.0f * vis_count / total;
-        LOG_INFO("Viewshed computed for %zu nodes: %.1f%% coverage",
-                 scene.nodes.size(), pct);
+        finish_coverage(scene, "Viewshed");
         return;
     }
 
@@ -200,33 +328,17 @@ void recompute_all_viewsheds_gpu(Scene& scene, const GeoProjection& proj,
     }
 
     /* Scene-level elevation grid path */
-    if (!scene.elevation.empty() && scene.grid_rows >= 2 && scene.grid_cols >= 2) {
-        int rows = scene.grid_rows;
-        int cols = scene.grid_cols;
-        int total = rows * cols;
-
+    if (has_scene_grid(scene)) {
         if (scene.nodes.empty()) {
-            scene.viewshed_vis.assign(total, 0);
-            scene.signal_strength.assign(total, -999.0f);
-            scene.overlap_count.assign(total, 0);
-            scene.build_terrain();
-            LOG_INFO("Viewshed cleared (no nodes)");
+            clear_coverage(scene);
             return;
         }
 
-        /* Upload elevation and compute on GPU */
-        gpu->upload_elevation(scene.elevation.data(), rows, cols);
-        gpu->set_grid_params(scene.bounds, rows, cols);
-        gpu->compute_all(scene.nodes);
-        gpu->read_back(scene.viewshed_vis, scene.signal_strength, scene.overlap_count);
-
-        scene.build_terrain();
+        std::vector<size_t> missing = plan_coverage(scene, gpu);
+        LOG_INFO("GPU viewshed: %zu of %zu nodes uncached", missing.size(), scene.nodes.size());
 
-        int vis_count = 0;
-        for (auto v : scene.viewshed_vis) vis_count += v;
-        float pct = 100.0f * vis_count / total;
-        LOG_INFO("GPU viewshed computed for %zu nodes: %.1f%% coverage",
-                 scene.nodes.size(), pct);
+        compute_missing_gpu(scene, missing, gpu);
+        finish_coverage(scene, "GPU viewshed", gpu);
         return;
     }
 
@@ -239,6 +351,16 @@ void recompute_all_viewsheds_gpu(Scene& scene, const GeoProjection& proj,
     LOG_WARN("No elevation data available for viewshed computation");
 }
 
+/* Start the async GPU job for the front of scene.coverage_queue, as many
+   nodes as fit in one slice array */
+static void kick_coverage_batch(Scene& scene, GpuViewshed* gpu) {
+    size_t count = std::min(scene.coverage_queue.size(),
+                            static_cast<size_t>(gpu->max_slices()));
+    std::vector<NodeData> nodes;
+    for (size_t i = 0; i < count; ++i) nodes.push_back(scene.coverage_queue[i].node);
+    gpu->compute_slices_async(nodes, scene.elevation.data());
+}
+
 void kick_viewshed_recompute(Scene& scene, const GeoProjection& proj,
                               GpuViewshed* gpu) {
     /* Fall back to blocking CPU path if GPU not available */
@@ -254,25 +376,37 @@ void kick_viewshed_recompute(Scene& scene, const GeoProjection& proj,
     }
 
     /* Scene-level elevation grid path */
-    if (!scene.elevation.empty() && scene.grid_rows >= 2 && scene.grid_cols >= 2) {
+    if (has_scene_grid(scene)) {
+        if (scene.nodes.empty()) {
+            clear_coverage(scene);
+            return;
+        }
+
         int rows = scene.grid_rows;
         int cols = scene.grid_cols;
-        int total = rows * cols;
-
-        if (scene.nodes.empty()) {
-            scene.viewshed_vis.assign(total, 0);
-            scene.signal_strength.assign(total, -999.0f);
-            scene.overlap_count.assign(total, 0);
-            scene.build_terrain();
-            LOG_INFO("Viewshed cleared (no nodes)");
+        std::vector<size_t> missing = plan_coverage(scene, gpu);
+
+        /* Everything cached (e.g. a node was removed): merge right away.
+           A job still in flight from an earlier kick is read back and
+           dropped by poll_viewshed_recompute. */
+        scene.coverage_queue.clear();
+        if (missing.empty()) {
+            LOG_INFO("kick_viewshed: all %zu nodes cached", scene.nodes.size());
+            finish_coverage(scene, "Viewshed", gpu);
             return;
         }
 
-        LOG_INFO("kick_viewshed: GPU async scene-level (%dx%d, %zu nodes)",
-                 cols, rows, scene.nodes.size());
+        /* Uncached nodes go through the GPU as fused async jobs that keep
+           each node's result in its own slice, so every one can be read
+           back and cached on its own */
+        for (size_t i : missing)
+            scene.coverage_queue.push_back({scene.coverage_keys[i], scene.nodes[i]});
+
+        LOG_INFO("kick_viewshed: GPU async scene-level (%dx%d, %zu of %zu nodes uncached)",
+                 cols, rows, missing.size(), scene.nodes.size());
         gpu->upload_elevation(scene.elevation.data(), rows, cols);
         gpu->set_grid_params(scene.bounds, rows, cols);
-        gpu->compute_all_async(scene.nodes, scene.elevation.data());
+        kick_coverage_batch(scene, gpu);
         return;
     }
 
@@ -292,19 +426,28 @@ void poll_viewshed_recompute(Scene& scene, const GeoProjection& proj,
     if (!gpu) return;
 
     /* Scene-level grid path */
-    if (!scene.elevation.empty() && scene.grid_rows >= 2 && scene.grid_cols >= 2) {
+    if (has_scene_grid(scene)) {
         if (gpu->poll_state() != ComputeState::READY) return;
 
-        gpu->read_back_async(scene.viewshed_vis, scene.signal_strength,
-                              scene.overlap_count);
-        scene.build_terrain();
+        std::vector<std::vector<uint8_t>> vis;
+        std::vector<std::vector<float>> sig;
+        gpu->read_back_slices(vis, sig);
+        if (scene.coverage_queue.empty()) return;   // superseded by a later kick
+
+        size_t done = std::min(vis.size(), scene.coverage_queue.size());
+        for (size_t i = 0; i < done; ++i)
+            scene.coverage_cache.store(scene.coverage_queue[i].key, vis[i], sig[i],
+                                       scene.grid_rows, scene.grid_cols);
+        scene.coverage_queue.erase(scene.coverage_queue.begin(),
+                                   scene.coverage_queue.begin() + done);
+
+        /* Next batch of uncached nodes, if any */
+        if (!scene.coverage_queue.empty()) {
+            kick_coverage_batch(scene, gpu);
+            return;
+        }
 
-        int vis_count = 0;
-        for (auto v : scene.viewshed_vis) vis_count += v;
-        int total = scene.grid_rows * scene.grid_cols;
-        float pct = 100.0f * vis_count / total;
-        LOG_INFO("Async GPU viewshed computed for %zu nodes: %.1f%% coverage",
-                 scene.nodes.size(), pct);
+        finish_coverage(scene, "Async GPU viewshed", gpu);
         return;
     }
 
@@ -26,6 +26,33 @@ void compute_viewshed(const float* elevation, int rows, int cols,
                       std::vector<float>& signal,
                       const mesh3d_rf_config_t& rf_config);
 
+/* Same outputs as compute_viewshed(), computed with the radial horizon
+   sweep (MESH3D_PROP_SWEEP). Each cell is visited O(1) times instead of
+   once per ray sample. FSPL is identical to compute_viewshed(); the
+   knife-edge term uses the maximum-violation sample along the sweep ray
+   through the cell rather than the exact node-to-cell ray, so results
+   agree within the tolerance documented on MESH3D_PROP_SWEEP. */
+void compute_viewshed_sweep(const float* elevation, int rows, int cols,
+                            const mesh3d_bounds_t& bounds,
+                            const NodeData& node,
+                            std::vector<uint8_t>& visibility,
+                            std::vector<float>& signal,
+                            const mesh3d_rf_config_t& rf_config);
+
+/* Distance (m) beyond which no propagation model can deliver `node`'s
+   signal above the receiver sensitivity: free-space loss alone exceeds
+   the link budget there, and every model only adds loss on top of FSPL.
+   TX/RX defaults match viewshed_setup(). */
+float node_link_range_m(const NodeData& node, const mesh3d_rf_config_t& rf_config);
+
+/* Whether `node` may reach any cell of a rows x cols grid over `bounds`
+   within range_m. Distance is measured like the viewshed kernels do
+   (cells x average cell size), with `margin` slack for grids of nearby
+   latitude and spacing (e.g. a composite around the tile). */
+bool node_reaches_bounds(const NodeData& node, float range_m,
+                         const mesh3d_bounds_t& bounds, int rows, int cols,
+                         float margin = 1.05f);
+
 /* Recompute merged viewshed/signal for all nodes in the scene,
    then rebuild the terrain mesh. Uses scene.elevation grid.
    For tile-based scenes, does nothing (no scene-level grid). */
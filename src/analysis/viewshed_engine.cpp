@@ -0,0 +1,199 @@
+#include "analysis/viewshed_engine.h"
+#include "analysis/viewshed_kernel.h"
+#include "util/log.h"
+#include <algorithm>
+#include <chrono>
+
+namespace mesh3d {
+
+CpuViewshedEngine& cpu_viewshed_engine() {
+    static CpuViewshedEngine engine;
+    return engine;
+}
+
+void CpuViewshedEngine::set_threads(int threads) {
+    if (threads < 0) threads = 0;
+    if (threads == m_threads && m_pool) return;
+    m_threads = threads;
+    m_pool.reset();
+    LOG_INFO("CPU viewshed threads: %d", this->threads());
+}
+
+int CpuViewshedEngine::threads() const {
+    if (m_pool) return m_pool->size();
+    return m_threads > 0 ? m_threads : ThreadPool::hardware_threads();
+}
+
+void CpuViewshedEngine::set_radial_count(int radials) {
+    m_radials = radials > 0 ? std::max(radials, RADIAL_MIN_RAYS) : 0;
+}
+
+ThreadPool& CpuViewshedEngine::pool() {
+    if (!m_pool) m_pool = std::make_unique<ThreadPool>(m_threads);
+    return *m_pool;
+}
+
+void CpuViewshedEngine::compute_merged(const float* elevation, int rows, int cols,
+                                       const mesh3d_bounds_t& bounds,
+                                       const std::vector<NodeData>& nodes,
+                                       const mesh3d_rf_config_t& rf_config,
+                                       std::vector<uint8_t>& visibility,
+                                       std::vector<float>& signal,
+                                       std::vector<uint8_t>* overlap) {
+    GridWindow full;
+    full.rows = rows;
+    full.cols = cols;
+    compute_merged(elevation, rows, cols, bounds, nodes, rf_config,
+                   full, visibility, signal, overlap);
+}
+
+void CpuViewshedEngine::compute_merged(const float* elevation, int rows, int cols,
+                                       const mesh3d_bounds_t& bounds,
+                                       const std::vector<NodeData>& nodes,
+                                       const mesh3d_rf_config_t& rf_config,
+                                       const GridWindow& window,
+                                       std::vector<uint8_t>& visibility,
+                                       std::vector<float>& signal,
+                                       std::vector<uint8_t>* overlap) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    const int out_rows = window.rows;
+    const int out_cols = window.cols;
+    const int total = out_rows * out_cols;
+    visibility.assign(total, 0);
+    signal.assign(total, -999.0f);
+    if (overlap) overlap->assign(total, 0);
+    if (total == 0 || nodes.empty()) return;
+
+    /* Per-node constants are resolved once, up front */
+    std::vector<ViewshedSetup> setups;
+    setups.reserve(nodes.size());
+    for (auto& nd : nodes)
+        setups.push_back(viewshed_setup(elevation, rows, cols, bounds, nd, rf_config));
+
+    uint8_t* out_vis = visibility.data();
+    float* out_sig = signal.data();
+    uint8_t* out_ovl = overlap ? overlap->data() : nullptr;
+
+    /* Fold one node's window-sized result into the merged outputs */
+    auto merge_rows = [&](const uint8_t* v, const float* s, int row_begin, int row_end) {
+        for (int i = row_begin * out_cols; i < row_end * out_cols; ++i) {
+            if (!v[i]) continue;
+            out_vis[i] = 1;
+            if (out_ovl) out_ovl[i]++;
+            if (s[i] > out_sig[i])
+                out_sig[i] = s[i];
+        }
+    };
+
+    if (m_prop_model == MESH3D_PROP_SWEEP) {
+        /* A sweep writes a whole window and a cell may be hit by several
+           of its rays (last one wins), so each node needs a private
+           buffer; bound how many exist at once */
+        const size_t slot_bytes = static_cast<size_t>(total) * (sizeof(uint8_t) + sizeof(float));
+        const int budget_slots = static_cast<int>(std::max<size_t>(SWEEP_SCRATCH_BUDGET / slot_bytes, 1));
+        const int slots = std::min({pool().size(), static_cast<int>(setups.size()), budget_slots});
+        std::vector<std::vector<uint8_t>> slot_vis(slots);
+        std::vector<std::vector<float>> slot_sig(slots);
+        const int row_bands = (out_rows + BLOCK_DIM - 1) / BLOCK_DIM;
+
+        for (size_t first = 0; first < setups.size(); first += slots) {
+            int batch = std::min<int>(slots, static_cast<int>(setups.size() - first));
+
+            pool().parallel_for(batch, [&](int i) {
+                slot_vis[i].assign(total, 0);
+                slot_sig[i].assign(total, -999.0f);
+                viewshed_sweep(setups[first + i],
+                               window.row0, window.row0 + out_rows,
+                               window.col0, window.col0 + out_cols,
+                               slot_vis[i].data(), slot_sig[i].data(), out_cols);
+            });
+
+            /* Merge in node order; row bands are independent */
+            pool().parallel_for(row_bands, [&](int band) {
+                int rb = band * BLOCK_DIM;
+                int re = std::min(rb + BLOCK_DIM, out_rows);
+                for (int i = 0; i < batch; ++i)
+                    merge_rows(slot_vis[i].data(), slot_sig[i].data(), rb, re);
+            });
+        }
+
+        m_last_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        LOG_INFO("CPU viewshed (sweep): %zu nodes, %dx%d cells on %d threads: %.1f ms",
+                 nodes.size(), out_cols, out_rows, pool().size(), m_last_ms);
+        return;
+    }
+
+    if (radial_active()) {
+        const int r0 = window.row0, r1 = window.row0 + out_rows;
+        const int c0 = window.col0, c1 = window.col0 + out_cols;
+        const int row_bands = (out_rows + BLOCK_DIM - 1) / BLOCK_DIM;
+        std::vector<uint8_t> node_vis(total);
+        std::vector<float> node_sig(total);
+        RadialTable table;
+
+        for (auto& vs : setups) {
+            radial_table_init(vs, r0, r1, c0, c1, m_radials, table);
+            pool().parallel_for(table.rays, [&](int ray) {
+                radial_evaluate_ray(vs, m_prop_model, m_itm_params, r0, r1, c0, c1, table, ray);
+            });
+            pool().parallel_for(row_bands, [&](int band) {
+                int rb = band * BLOCK_DIM;
+                int re = std::min(rb + BLOCK_DIM, out_rows);
+                size_t off = static_cast<size_t>(rb) * out_cols;
+                radial_rasterise(vs, table, r0 + rb, r0 + re, c0, c1,
+                                 &node_vis[off], &node_sig[off], out_cols);
+                merge_rows(node_vis.data(), node_sig.data(), rb, re);
+            });
+        }
+
+        m_last_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        LOG_INFO("CPU viewshed (radial, %d rays): %zu nodes, %dx%d cells on %d threads: %.1f ms",
+                 m_radials, nodes.size(), out_cols, out_rows, pool().size(), m_last_ms);
+        return;
+    }
+
+    const int blocks_y = (out_rows + BLOCK_DIM - 1) / BLOCK_DIM;
+    const int blocks_x = (out_cols + BLOCK_DIM - 1) / BLOCK_DIM;
+    pool().parallel_for(blocks_y * blocks_x, [&](int b) {
+        thread_local std::vector<uint8_t> blk_vis;
+        thread_local std::vector<float> blk_sig;
+        blk_vis.resize(BLOCK_DIM * BLOCK_DIM);
+        blk_sig.resize(BLOCK_DIM * BLOCK_DIM);
+
+        int wr0 = (b / blocks_x) * BLOCK_DIM;
+        int wc0 = (b % blocks_x) * BLOCK_DIM;
+        int bh = std::min(BLOCK_DIM, out_rows - wr0);
+        int bw = std::min(BLOCK_DIM, out_cols - wc0);
+        int r0 = window.row0 + wr0;
+        int c0 = window.col0 + wc0;
+
+        for (auto& vs : setups) {
+            viewshed_block(vs, r0, r0 + bh, c0, c0 + bw,
+                           blk_vis.data(), blk_sig.data(), bw);
+
+            for (int r = 0; r < bh; ++r) {
+                int dst = (wr0 + r) * out_cols + wc0;
+                const uint8_t* v = &blk_vis[r * bw];
+                const float* s = &blk_sig[r * bw];
+                for (int c = 0; c < bw; ++c) {
+                    if (!v[c]) continue;
+                    out_vis[dst + c] = 1;
+                    if (out_ovl) out_ovl[dst + c]++;
+                    if (s[c] > out_sig[dst + c])
+                        out_sig[dst + c] = s[c];
+                }
+            }
+        }
+    });
+
+    m_last_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    LOG_INFO("CPU viewshed: %zu nodes, %dx%d cells, %d blocks on %d threads: %.1f ms",
+             nodes.size(), out_cols, out_rows, blocks_y * blocks_x,
+             pool().size(), m_last_ms);
+}
+
+} // namespace mesh3d
@@ -0,0 +1,105 @@
+#pragma once
+#include "scene/scene.h"
+#include "analysis/itm.h"
+#include "util/thread_pool.h"
+#include <mesh3d/types.h>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* Sub-rectangle of an elevation grid for which results are wanted */
+struct GridWindow {
+    int row0 = 0, col0 = 0;
+    int rows = 0, cols = 0;
+};
+
+/* Multithreaded CPU viewshed engine.
+
+   The output window is split into BLOCK_DIM x BLOCK_DIM cell blocks and
+   the node x block work is spread across a work-stealing ThreadPool. Each
+   task evaluates every node for one block (in node order) and merges into
+   the output in place, so blocks never share output cells and the merged
+   result is bit-identical to running compute_viewshed() node by node.
+
+   The sweep model walks whole rays per node, so it parallelises across
+   nodes instead: nodes are swept into private window buffers, then
+   merged in node order. At most threads() buffers are live, and fewer
+   when a window is large, so that all of them fit in
+   SWEEP_SCRATCH_BUDGET. The radial-profile
+   engine runs one node at a time, spreading its rays and then its row
+   bands across the pool. */
+class CpuViewshedEngine {
+public:
+    static constexpr int BLOCK_DIM = 64;
+    static constexpr size_t SWEEP_SCRATCH_BUDGET = 256u << 20;
+
+    /* MESH3D_PROP_SWEEP selects the radial horizon sweep. ITM and Fresnel
+       run on the radial-profile engine when a radial count is set; every
+       other case uses the ray-march kernel (FSPL + knife-edge). */
+    void set_propagation_model(mesh3d_prop_model_t model) { m_prop_model = model; }
+    mesh3d_prop_model_t propagation_model() const { return m_prop_model; }
+
+    /* Rays per node for the radial-profile engine (see RadialTable);
+       0 (default) turns it off, and other values are raised to at least
+       RADIAL_MIN_RAYS */
+    void set_radial_count(int radials);
+    int radial_count() const { return m_radials; }
+
+    /* ITM parameters for the radial-profile engine */
+    void set_itm_params(const mesh3d_itm_params_t& params) { m_itm_params = params; }
+    const mesh3d_itm_params_t& itm_params() const { return m_itm_params; }
+
+    /* Whether the current model and radial count use the radial engine */
+    bool radial_active() const {
+        return m_radials > 0 &&
+               (m_prop_model == MESH3D_PROP_ITM || m_prop_model == MESH3D_PROP_FRESNEL);
+    }
+
+    /* Worker thread count; 0 = one per hardware thread (default) */
+    void set_threads(int threads);
+    int threads() const;
+
+    /* Merged coverage of all nodes over `window` of the elevation grid.
+       visibility/signal (and overlap, if non-null) are resized to
+       window.rows x window.cols. Merge rules match recompute_all_viewsheds:
+       visibility = any node, signal = max over visible nodes (-999 when
+       none), overlap = number of nodes that see the cell. */
+    void compute_merged(const float* elevation, int rows, int cols,
+                        const mesh3d_bounds_t& bounds,
+                        const std::vector<NodeData>& nodes,
+                        const mesh3d_rf_config_t& rf_config,
+                        const GridWindow& window,
+                        std::vector<uint8_t>& visibility,
+                        std::vector<float>& signal,
+                        std::vector<uint8_t>* overlap);
+
+    /* Full-grid convenience overload */
+    void compute_merged(const float* elevation, int rows, int cols,
+                        const mesh3d_bounds_t& bounds,
+                        const std::vector<NodeData>& nodes,
+                        const mesh3d_rf_config_t& rf_config,
+                        std::vector<uint8_t>& visibility,
+                        std::vector<float>& signal,
+                        std::vector<uint8_t>* overlap);
+
+    /* Wall time of the last compute_merged call */
+    double last_ms() const { return m_last_ms; }
+
+    /* Worker pool, also used for merging cached per-node coverage */
+    ThreadPool& pool();
+
+private:
+    int m_threads = 0;
+    std::unique_ptr<ThreadPool> m_pool;
+    double m_last_ms = 0.0;
+    mesh3d_prop_model_t m_prop_model = MESH3D_PROP_FSPL;
+    int m_radials = 0;
+    mesh3d_itm_params_t m_itm_params = itm_defaults();
+};
+
+/* Process-wide engine used by the CPU viewshed paths */
+CpuViewshedEngine& cpu_viewshed_engine();
+
+} // namespace mesh3d
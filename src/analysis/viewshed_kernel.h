@@ -0,0 +1,113 @@
+#pragma once
+#include "scene/scene.h"
+#include <mesh3d/types.h>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* Per-node constants for the CPU ray-march viewshed, resolved once from
+   NodeData + grid geometry. Shared by compute_viewshed() and the
+   multithreaded engine so both evaluate exactly the same math. */
+struct ViewshedSetup {
+    const float* elevation = nullptr;
+    int rows = 0, cols = 0;
+    int nr = 0, nc = 0;            // node cell (may be off-grid)
+    float obs_h = 0.0f;            // node ground + antenna height (m)
+    float cell_m = 0.0f;           // approximate cell size (m)
+    float tx_power_dbm = 0.0f;
+    float antenna_gain = 0.0f;
+    float cable_loss = 0.0f;
+    float freq_mhz = 0.0f;
+    float rx_sens = 0.0f;
+    float rx_antenna_gain = 0.0f;
+    float rx_cable_loss = 0.0f;
+    float rx_height = 0.0f;        // receiver height above ground (m)
+    int max_range_cells = 0;
+};
+
+ViewshedSetup viewshed_setup(const float* elevation, int rows, int cols,
+                             const mesh3d_bounds_t& bounds,
+                             const NodeData& node,
+                             const mesh3d_rf_config_t& rf_config);
+
+/* Ray-march inner loop: walks samples s = 1..steps-1 from the node towards
+   target cell offset (dr, dc) and returns the largest terrain violation of
+   the curvature-corrected LOS line (first sample wins ties) and its t.
+   All implementations perform the same IEEE operations per sample, so
+   the SIMD variants are bit-identical to the scalar one. */
+using RayMarchFn = void (*)(const ViewshedSetup& vs, int dr, int dc, int steps,
+                            float target_elev, float d_total,
+                            float& max_violation, float& best_t);
+
+enum class SimdLevel { SCALAR, SSE42, AVX2 };
+
+/* Best level supported by this CPU (checked once at runtime) */
+SimdLevel viewshed_detect_simd();
+
+/* Force a level (clamped to what the CPU supports); used by benchmarks */
+void viewshed_set_simd(SimdLevel level);
+SimdLevel viewshed_simd();
+const char* viewshed_simd_name(SimdLevel level);
+
+/* Currently selected ray-march implementation */
+RayMarchFn viewshed_ray_march();
+
+/* Evaluate grid cells [r0,r1) x [c0,c1) for one node.
+   Results go to vis/sig at (r - r0) * out_stride + (c - c0). */
+void viewshed_block(const ViewshedSetup& vs,
+                    int r0, int r1, int c0, int c1,
+                    uint8_t* vis, float* sig, int out_stride);
+
+/* Radial horizon sweep (R2-style) for one node: casts one ray to every cell
+   on the perimeter of the Chebyshev square around the node that covers the
+   grid, carrying the running curvature-corrected horizon outward so every
+   cell is evaluated from a single pass. Writes cells inside
+   [r0,r1) x [c0,c1) with the same layout as viewshed_block(); cells beyond
+   max_range_cells are not written, so callers pre-fill with 0 / -999. */
+void viewshed_sweep(const ViewshedSetup& vs,
+                    int r0, int r1, int c0, int c1,
+                    uint8_t* vis, float* sig, int out_stride);
+
+/* Radial-profile engine (SPLAT!/Signal-Server style) for the ITM and
+   Fresnel models, matching viewshed_radial.comp: rays are cast from the
+   node, the model runs once per cell-spaced sample along each ray on the
+   prefix of that ray's profile, and cells are interpolated bilinearly in
+   (angle, distance) between the four surrounding samples. Samples hold
+   -999 where the model was not run (out of FSPL reach for ITM, or too far
+   outside the window for any cell to use them). */
+struct RadialTable {
+    int rays = 0;
+    int samples = 0;                // per ray; sample k is k cells out
+    std::vector<float> profile;     // rays x samples ground elevation
+    std::vector<float> signal;      // rays x samples received signal (dBm)
+};
+
+/* Fewest rays a non-zero radial count means; small windows cast no fewer */
+constexpr int RADIAL_MIN_RAYS = 8;
+
+/* Size `table` for one node over window [r0,r1) x [c0,c1): enough
+   samples to reach its farthest corner, at most max_rays rays */
+void radial_table_init(const ViewshedSetup& vs, int r0, int r1, int c0, int c1,
+                       int max_rays, RadialTable& table);
+
+/* Sample and evaluate one ray. `model` is MESH3D_PROP_ITM (CPU reference
+   itm_point_to_point) or MESH3D_PROP_FRESNEL. Rays are independent. */
+void radial_evaluate_ray(const ViewshedSetup& vs, mesh3d_prop_model_t model,
+                         const mesh3d_itm_params_t& itm_params,
+                         int r0, int r1, int c0, int c1,
+                         RadialTable& table, int ray);
+
+/* Interpolate cells [r0,r1) x [c0,c1) from an evaluated table, with the
+   same layout as viewshed_block() */
+void radial_rasterise(const ViewshedSetup& vs, const RadialTable& table,
+                      int r0, int r1, int c0, int c1,
+                      uint8_t* vis, float* sig, int out_stride);
+
+/* Fresnel model path loss (free space + Bullington / Deygout diffraction
+   or Fresnel-clearance loss) over profile samples prof[0..k] spaced
+   vs.cell_m apart, from vs.obs_h to vs.rx_height above prof[k]. The CPU
+   port of fresnel_received_dbm() in fresnel_model.glsl. */
+float fresnel_path_loss_db(const ViewshedSetup& vs, const float* prof, int k);
+
+} // namespace mesh3d
@@ -0,0 +1,271 @@
+#include "analysis/viewshed_kernel.h"
+#include "analysis/itm.h"
+#include <cmath>
+#include <algorithm>
+
+namespace mesh3d {
+
+/* Radial-profile engine
+   ---------------------
+   The per-cell models extract a new profile and run the full model for
+   every cell. Along one ray from the node, the profile to sample k is the
+   prefix of the profile to sample k + 1, so SPLAT! and Signal-Server
+   sample each ray once and evaluate the model at every sample of it:
+   rays x range evaluations rather than one per cell, with the cells then
+   filled in between rays. This mirrors viewshed_radial.comp (same ray
+   geometry, sampling and interpolation); the ITM results differ from the
+   GPU because the CPU side uses the itm_point_to_point() reference. */
+
+static const float EARTH_CURVE_FACTOR = 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f);
+static const float NO_SAMPLE = -999.0f;
+static const double TWO_PI = 6.283185307179586;
+static const int MAX_PROFILE = 512;
+
+/* Ground cell k cells out along `ray` (may be off-grid) */
+static void ray_cell(const ViewshedSetup& vs, int rays, int ray, int k, int& r, int& c) {
+    double a = TWO_PI * ray / rays;
+    c = vs.nc + static_cast<int>(std::floor(std::cos(a) * k + 0.5));
+    r = vs.nr + static_cast<int>(std::floor(std::sin(a) * k + 0.5));
+}
+
+/* ITU-R P.526 single knife-edge loss for diffraction parameter v */
+static float knife_edge_db(float v) {
+    return 6.9f + 20.0f * std::log10(std::sqrt((v - 0.1f) * (v - 0.1f) + 1.0f) + v - 0.1f);
+}
+
+float fresnel_path_loss_db(const ViewshedSetup& vs, const float* prof, int k) {
+    const float dist_cells = static_cast<float>(k);
+    const float d_total = dist_cells * vs.cell_m;
+    const float lambda = 299.792458f / vs.freq_mhz;
+    const float obs_h = vs.obs_h;
+    const float rx_h = prof[k] + vs.rx_height;
+    auto terrain = [&](float t) {
+        return prof[std::min(static_cast<int>(t * dist_cells + 0.5f), k)];
+    };
+
+    int n_raw = k + 1;
+    int step = std::max(1, (n_raw + MAX_PROFILE - 1) / MAX_PROFILE);
+    int n_profile = std::min((n_raw + step - 1) / step, MAX_PROFILE);
+
+    float max_tan_tx = -1e30f;
+    int max_tan_tx_i = 0;
+    for (int i = 1; i < n_profile - 1; ++i) {
+        float t = std::min(static_cast<float>(i * step) / dist_cells, 1.0f);
+        float d_along = d_total * t;
+        float d_remain = d_total * (1.0f - t);
+        float earth_curve = d_along * d_remain * EARTH_CURVE_FACTOR;
+        float tan_tx = ((terrain(t) - earth_curve) - obs_h) / d_along;
+        if (tan_tx > max_tan_tx) {
+            max_tan_tx = tan_tx;
+            max_tan_tx_i = i;
+        }
+    }
+
+    float diff_loss_db = 0.0f;
+    float los_tan = (rx_h - obs_h) / d_total;
+
+    if (max_tan_tx > los_tan) {
+        /* Dominant edge, then the worst secondary edge on either side */
+        float t_edge = static_cast<float>(max_tan_tx_i * step) / dist_cells;
+        float d1 = d_total * t_edge;
+        float d2 = d_total * (1.0f - t_edge);
+        float effective_edge_h = terrain(t_edge) - d1 * d2 * EARTH_CURVE_FACTOR;
+        float los_at_edge = obs_h + (rx_h - obs_h) * t_edge;
+
+        float violation = effective_edge_h - los_at_edge;
+        if (violation > 0.0f) {
+            float v = violation * std::sqrt(2.0f / (lambda * (d1 * d2 / (d1 + d2))));
+            if (v > -0.78f) diff_loss_db = knife_edge_db(v);
+
+            float max_v2_tx = 0.0f;
+            for (int j = 1; j < max_tan_tx_i; ++j) {
+                float t2 = static_cast<float>(j * step) / dist_cells;
+                float d2_along = d_total * t2;
+                float d2_to_edge = d1 - d2_along;
+                if (d2_to_edge <= 0.0f || d2_along <= 0.0f) continue;
+                float eff_e2 = terrain(t2) - d2_along * d2_to_edge * EARTH_CURVE_FACTOR;
+                float los_sub = obs_h + (effective_edge_h - obs_h) * (d2_along / d1);
+                float viol2 = eff_e2 - los_sub;
+                if (viol2 > 0.0f) {
+                    float dh2 = d2_along * d2_to_edge / (d2_along + d2_to_edge);
+                    max_v2_tx = std::max(max_v2_tx, viol2 * std::sqrt(2.0f / (lambda * dh2)));
+                }
+            }
+
+            float max_v2_rx = 0.0f;
+            for (int j = max_tan_tx_i + 1; j < n_profile - 1; ++j) {
+                float t2 = static_cast<float>(j * step) / dist_cells;
+                float d2_from_edge = d_total * t2 - d1;
+                float d2_to_rx = d2 - d2_from_edge;
+                if (d2_to_rx <= 0.0f || d2_from_edge <= 0.0f) continue;
+                float eff_e2 = terrain(t2) - (d1 + d2_from_edge) * d2_to_rx * EARTH_CURVE_FACTOR;
+                float los_sub = effective_edge_h + (rx_h - effective_edge_h) * (d2_from_edge / d2);
+                float viol2 = eff_e2 - los_sub;
+                if (viol2 > 0.0f) {
+                    float dh2 = d2_from_edge * d2_to_rx / (d2_from_edge + d2_to_rx);
+                    max_v2_rx = std::max(max_v2_rx, viol2 * std::sqrt(2.0f / (lambda * dh2)));
+                }
+            }
+
+            if (max_v2_tx > 0.0f) diff_loss_db += std::max(knife_edge_db(max_v2_tx), 0.0f);
+            if (max_v2_rx > 0.0f) diff_loss_db += std::max(knife_edge_db(max_v2_rx), 0.0f);
+        }
+    } else {
+        /* Unobstructed: loss from the tightest first-Fresnel-zone clearance */
+        float min_clearance_ratio = 1e30f;
+        for (int i = 1; i < n_profile - 1; ++i) {
+            float t = std::min(static_cast<float>(i * step) / dist_cells, 1.0f);
+            float d_along = d_total * t;
+            float d_remain = d_total * (1.0f - t);
+            float earth_curve = d_along * d_remain * EARTH_CURVE_FACTOR;
+            float los_h = obs_h + (rx_h - obs_h) * t;
+            float clearance = los_h - (terrain(t) - earth_curve);
+            float fresnel_radius = std::sqrt(lambda * d_along * d_remain / (d_along + d_remain));
+            min_clearance_ratio = std::min(min_clearance_ratio,
+                                           clearance / std::max(fresnel_radius, 0.001f));
+        }
+        if (min_clearance_ratio < 1.0f && min_clearance_ratio >= 0.0f)
+            diff_loss_db = 6.0f * (1.0f - min_clearance_ratio);
+        else if (min_clearance_ratio < 0.0f)
+            diff_loss_db = knife_edge_db(-min_clearance_ratio);
+    }
+
+    float dist_km = std::max(d_total / 1000.0f, 0.01f);
+    float fspl = 20.0f * std::log10(dist_km) + 20.0f * std::log10(vs.freq_mhz) + 32.44f;
+    return fspl + std::max(diff_loss_db, 0.0f);
+}
+
+/* ITM over profile samples prof[0..k], resampled to at most MAX_PROFILE
+   points like the per-cell GPU shader */
+static float itm_received(const ViewshedSetup& vs, const mesh3d_itm_params_t& params,
+                          const float* prof, int k) {
+    const float d_total = k * vs.cell_m;
+    const float eirp = vs.tx_power_dbm + vs.antenna_gain - vs.cable_loss;
+
+    /* FSPL early-out: ITM never loses less than free space */
+    float fspl = 32.45f + 20.0f * std::log10(vs.freq_mhz) + 20.0f * std::log10(d_total / 1000.0f);
+    if (eirp - fspl + vs.rx_antenna_gain - vs.rx_cable_loss < vs.rx_sens)
+        return NO_SAMPLE;
+
+    int n_raw = k + 1;
+    int step = (n_raw + MAX_PROFILE - 1) / MAX_PROFILE;
+    int n_profile = std::min((n_raw + step - 1) / step, MAX_PROFILE);
+    float path[MAX_PROFILE];
+    for (int i = 0; i < n_profile; ++i)
+        path[i] = prof[i * k / (n_profile - 1)];
+
+    float tx_height = std::max(vs.obs_h - prof[0], 1.0f);
+    float rx_height = std::max(vs.rx_height, 1.0f);
+    float loss = itm_point_to_point(path, n_profile, d_total / (n_profile - 1),
+                                    tx_height, rx_height, vs.freq_mhz, params);
+    return eirp - loss + vs.rx_antenna_gain - vs.rx_cable_loss;
+}
+
+void radial_table_init(const ViewshedSetup& vs, int r0, int r1, int c0, int c1,
+                       int max_rays, RadialTable& table) {
+    float dr = static_cast<float>(std::max(std::abs(r0 - vs.nr), std::abs(r1 - 1 - vs.nr)));
+    float dc = static_cast<float>(std::max(std::abs(c0 - vs.nc), std::abs(c1 - 1 - vs.nc)));
+    float reach = std::min(std::sqrt(dr * dr + dc * dc), static_cast<float>(vs.max_range_cells));
+
+    table.samples = static_cast<int>(std::ceil(reach)) + 2;
+    table.rays = std::clamp(static_cast<int>(std::ceil(TWO_PI * reach)), RADIAL_MIN_RAYS,
+                            std::max(max_rays, RADIAL_MIN_RAYS));
+    size_t total = static_cast<size_t>(table.rays) * table.samples;
+    table.profile.assign(total, 0.0f);
+    table.signal.assign(total, NO_SAMPLE);
+}
+
+void radial_evaluate_ray(const ViewshedSetup& vs, mesh3d_prop_model_t model,
+                         const mesh3d_itm_params_t& itm_params,
+                         int r0, int r1, int c0, int c1,
+                         RadialTable& table, int ray) {
+    const int samples = table.samples;
+    float* prof = &table.profile[static_cast<size_t>(ray) * samples];
+    float* sig = &table.signal[static_cast<size_t>(ray) * samples];
+
+    for (int k = 0; k < samples; ++k) {
+        int r, c;
+        ray_cell(vs, table.rays, ray, k, r, c);
+        int rc = std::clamp(r, 0, vs.rows - 1);
+        int cc = std::clamp(c, 0, vs.cols - 1);
+        prof[k] = vs.elevation[static_cast<size_t>(rc) * vs.cols + cc];
+    }
+
+    sig[0] = -60.0f;
+    for (int k = 1; k < samples; ++k) {
+        /* A cell interpolates samples at most one ray spacing (plus
+           rounding) away, so samples further outside are unused */
+        int margin = static_cast<int>(std::ceil(k * TWO_PI / table.rays)) + 1;
+        int r, c;
+        ray_cell(vs, table.rays, ray, k, r, c);
+        if (r < r0 - margin || r >= r1 + margin || c < c0 - margin || c >= c1 + margin) {
+            sig[k] = NO_SAMPLE;
+            continue;
+        }
+        if (model == MESH3D_PROP_ITM) {
+            sig[k] = itm_received(vs, itm_params, prof, k);
+        } else {
+            float eirp = vs.tx_power_dbm + vs.antenna_gain - vs.cable_loss;
+            sig[k] = eirp - fresnel_path_loss_db(vs, prof, k) + vs.rx_antenna_gain - vs.rx_cable_loss;
+        }
+    }
+}
+
+void radial_rasterise(const ViewshedSetup& vs, const RadialTable& table,
+                      int r0, int r1, int c0, int c1,
+                      uint8_t* visibility, float* signal, int out_stride) {
+    const int rays = table.rays;
+    const int samples = table.samples;
+    auto at = [&](int ray, int k) {
+        return table.signal[static_cast<size_t>(ray) * samples + k];
+    };
+
+    for (int r = r0; r < r1; ++r) {
+        for (int c = c0; c < c1; ++c) {
+            int out = (r - r0) * out_stride + (c - c0);
+            float dy = static_cast<float>(r - vs.nr);
+            float dx = static_cast<float>(c - vs.nc);
+            float dist_cells = std::sqrt(dx * dx + dy * dy);
+
+            if (dist_cells < 0.5f) {
+                visibility[out] = 1;
+                signal[out] = -60.0f;
+                continue;
+            }
+            if (dist_cells > static_cast<float>(vs.max_range_cells)) {
+                visibility[out] = 0;
+                signal[out] = -999.0f;
+                continue;
+            }
+
+            double a = std::atan2(dy, dx);
+            if (a < 0.0) a += TWO_PI;
+            double fa = a * rays / TWO_PI;
+            int j0 = static_cast<int>(std::floor(fa));
+            float wa = static_cast<float>(fa - j0);
+            j0 %= rays;
+            int j1 = (j0 + 1) % rays;
+
+            float fk = std::min(dist_cells, static_cast<float>(samples - 1));
+            int k0 = static_cast<int>(fk);
+            float wk = fk - k0;
+            int k1 = std::min(k0 + 1, samples - 1);
+
+            float s00 = at(j0, k0), s01 = at(j0, k1);
+            float s10 = at(j1, k0), s11 = at(j1, k1);
+
+            /* Blending with NO_SAMPLE would be meaningless: take the nearest sample */
+            float received;
+            if (std::min({s00, s01, s10, s11}) <= NO_SAMPLE)
+                received = wa < 0.5f ? (wk < 0.5f ? s00 : s01) : (wk < 0.5f ? s10 : s11);
+            else
+                received = (s00 + (s01 - s00) * wk) * (1.0f - wa) +
+                           (s10 + (s11 - s10) * wk) * wa;
+
+            visibility[out] = (received > NO_SAMPLE && received >= vs.rx_sens) ? 1 : 0;
+            signal[out] = received;
+        }
+    }
+}
+
+} // namespace mesh3d
@@ -0,0 +1,266 @@
+#include "analysis/viewshed_kernel.h"
+#include "util/log.h"
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MESH3D_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace mesh3d {
+
+/* Earth curvature factor: 1 / (2 * k * Re) where k=4/3, Re=6371000m */
+static const float EARTH_CURVE_FACTOR = 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f);
+
+/* ---- Scalar reference ---------------------------------------------------- */
+
+static void ray_march_scalar(const ViewshedSetup& vs, int dr, int dc, int steps,
+                             float target_elev, float d_total,
+                             float& max_violation, float& best_t) {
+    const float* elevation = vs.elevation;
+    const int rows = vs.rows;
+    const int cols = vs.cols;
+    const int nr = vs.nr;
+    const int nc = vs.nc;
+    const float obs_h = vs.obs_h;
+
+    max_violation = 0.0f;
+    best_t = 0.0f;
+
+    for (int s = 1; s < steps; ++s) {
+        float t = static_cast<float>(s) / steps;
+        float sr = nr + dr * t;
+        float sc = nc + dc * t;
+        int si = static_cast<int>(sr);
+        int sj = static_cast<int>(sc);
+
+        if (si < 0 || si >= rows || sj < 0 || sj >= cols) continue;
+
+        /* LOS height with 4/3 earth curvature correction */
+        float d_along = d_total * t;
+        float d_remain = d_total * (1.0f - t);
+        float earth_curve = d_along * d_remain * EARTH_CURVE_FACTOR;
+        float needed_h = obs_h + (target_elev - obs_h) * t - earth_curve;
+        float terrain_h = elevation[si * cols + sj];
+        float violation = terrain_h - needed_h;
+        if (violation > max_violation) {
+            max_violation = violation;
+            best_t = t;
+        }
+    }
+}
+
+#ifdef MESH3D_X86_SIMD
+
+/* The vector kernels evaluate consecutive samples s..s+W-1 per iteration.
+   Each lane keeps its own running max (strict >, so the earliest sample in
+   the lane wins); the horizontal reduction then picks the largest value
+   and, among equal values, the smallest sample index. That reproduces the
+   scalar "first maximum" exactly. Only mul/add/sub/div are used, in the
+   same order as the scalar code, so results are bit-identical as long as
+   the scalar path is not FMA-contracted (see CMakeLists.txt). */
+
+static inline void reduce_lanes(const float* lane_max, const int* lane_s, int width,
+                                int steps, float& max_violation, float& best_t) {
+    float best = 0.0f;
+    int best_s = 0;
+    for (int i = 0; i < width; ++i) {
+        if (lane_max[i] > best || (lane_max[i] == best && best > 0.0f && lane_s[i] < best_s)) {
+            best = lane_max[i];
+            best_s = lane_s[i];
+        }
+    }
+    max_violation = best;
+    best_t = best > 0.0f ? static_cast<float>(best_s) / steps : 0.0f;
+}
+
+/* ---- AVX2: 8 samples per iteration, hardware gather ---------------------- */
+
+__attribute__((target("avx2")))
+static void ray_march_avx2(const ViewshedSetup& vs, int dr, int dc, int steps,
+                           float target_elev, float d_total,
+                           float& max_violation, float& best_t) {
+    const __m256i lane_iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 v_steps  = _mm256_set1_ps(static_cast<float>(steps));
+    const __m256 v_nr     = _mm256_set1_ps(static_cast<float>(vs.nr));
+    const __m256 v_nc     = _mm256_set1_ps(static_cast<float>(vs.nc));
+    const __m256 v_dr     = _mm256_set1_ps(static_cast<float>(dr));
+    const __m256 v_dc     = _mm256_set1_ps(static_cast<float>(dc));
+    const __m256 v_dtotal = _mm256_set1_ps(d_total);
+    const __m256 v_one    = _mm256_set1_ps(1.0f);
+    const __m256 v_curve  = _mm256_set1_ps(EARTH_CURVE_FACTOR);
+    const __m256 v_obs    = _mm256_set1_ps(vs.obs_h);
+    const __m256 v_rise   = _mm256_set1_ps(target_elev - vs.obs_h);
+    const __m256i v_rows  = _mm256_set1_epi32(vs.rows);
+    const __m256i v_cols  = _mm256_set1_epi32(vs.cols);
+    const __m256i v_nsteps = _mm256_set1_epi32(steps);
+    const __m256i v_neg1  = _mm256_set1_epi32(-1);
+
+    __m256 lane_max = _mm256_setzero_ps();
+    __m256i lane_s  = _mm256_setzero_si256();
+
+    for (int s0 = 1; s0 < steps; s0 += 8) {
+        __m256i s  = _mm256_add_epi32(_mm256_set1_epi32(s0), lane_iota);
+        __m256 t   = _mm256_div_ps(_mm256_cvtepi32_ps(s), v_steps);
+        __m256 sr  = _mm256_add_ps(v_nr, _mm256_mul_ps(v_dr, t));
+        __m256 sc  = _mm256_add_ps(v_nc, _mm256_mul_ps(v_dc, t));
+        __m256i si = _mm256_cvttps_epi32(sr);
+        __m256i sj = _mm256_cvttps_epi32(sc);
+
+        /* valid = s < steps && 0 <= si < rows && 0 <= sj < cols */
+        __m256i valid = _mm256_cmpgt_epi32(v_nsteps, s);
+        valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(si, v_neg1));
+        valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(v_rows, si));
+        valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(sj, v_neg1));
+        valid = _mm256_and_si256(valid, _mm256_cmpgt_epi32(v_cols, sj));
+
+        __m256 d_along  = _mm256_mul_ps(v_dtotal, t);
+        __m256 d_remain = _mm256_mul_ps(v_dtotal, _mm256_sub_ps(v_one, t));
+        __m256 earth    = _mm256_mul_ps(_mm256_mul_ps(d_along, d_remain), v_curve);
+        __m256 needed   = _mm256_sub_ps(_mm256_add_ps(v_obs, _mm256_mul_ps(v_rise, t)), earth);
+
+        __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(si, v_cols), sj);
+        idx = _mm256_and_si256(idx, valid); // keep masked-off lanes in bounds
+        __m256 terrain = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), vs.elevation, idx,
+                                                  _mm256_castsi256_ps(valid), 4);
+        __m256 viol = _mm256_sub_ps(terrain, needed);
+
+        __m256 upd = _mm256_and_ps(_mm256_castsi256_ps(valid),
+                                   _mm256_cmp_ps(viol, lane_max, _CMP_GT_OQ));
+        lane_max = _mm256_blendv_ps(lane_max, viol, upd);
+        lane_s = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(lane_s),
+                                                      _mm256_castsi256_ps(s), upd));
+    }
+
+    alignas(32) float m[8];
+    alignas(32) int ls[8];
+    _mm256_store_ps(m, lane_max);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(ls), lane_s);
+    reduce_lanes(m, ls, 8, steps, max_violation, best_t);
+}
+
+/* ---- SSE4.2: 4 samples per iteration, scalar loads ----------------------- */
+
+__attribute__((target("sse4.2")))
+static void ray_march_sse42(const ViewshedSetup& vs, int dr, int dc, int steps,
+                            float target_elev, float d_total,
+                            float& max_violation, float& best_t) {
+    const __m128i lane_iota = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128 v_steps  = _mm_set1_ps(static_cast<float>(steps));
+    const __m128 v_nr     = _mm_set1_ps(static_cast<float>(vs.nr));
+    const __m128 v_nc     = _mm_set1_ps(static_cast<float>(vs.nc));
+    const __m128 v_dr     = _mm_set1_ps(static_cast<float>(dr));
+    const __m128 v_dc     = _mm_set1_ps(static_cast<float>(dc));
+    const __m128 v_dtotal = _mm_set1_ps(d_total);
+    const __m128 v_one    = _mm_set1_ps(1.0f);
+    const __m128 v_curve  = _mm_set1_ps(EARTH_CURVE_FACTOR);
+    const __m128 v_obs    = _mm_set1_ps(vs.obs_h);
+    const __m128 v_rise   = _mm_set1_ps(target_elev - vs.obs_h);
+    const __m128i v_rows  = _mm_set1_epi32(vs.rows);
+    const __m128i v_cols  = _mm_set1_epi32(vs.cols);
+    const __m128i v_nsteps = _mm_set1_epi32(steps);
+    const __m128i v_neg1  = _mm_set1_epi32(-1);
+
+    __m128 lane_max = _mm_setzero_ps();
+    __m128i lane_s  = _mm_setzero_si128();
+    alignas(16) int idx[4];
+    alignas(16) int ok[4];
+    alignas(16) float h[4];
+
+    for (int s0 = 1; s0 < steps; s0 += 4) {
+        __m128i s  = _mm_add_epi32(_mm_set1_epi32(s0), lane_iota);
+        __m128 t   = _mm_div_ps(_mm_cvtepi32_ps(s), v_steps);
+        __m128 sr  = _mm_add_ps(v_nr, _mm_mul_ps(v_dr, t));
+        __m128 sc  = _mm_add_ps(v_nc, _mm_mul_ps(v_dc, t));
+        __m128i si = _mm_cvttps_epi32(sr);
+        __m128i sj = _mm_cvttps_epi32(sc);
+
+        __m128i valid = _mm_cmpgt_epi32(v_nsteps, s);
+        valid = _mm_and_si128(valid, _mm_cmpgt_epi32(si, v_neg1));
+        valid = _mm_and_si128(valid, _mm_cmplt_epi32(si, v_rows));
+        valid = _mm_and_si128(valid, _mm_cmpgt_epi32(sj, v_neg1));
+        valid = _mm_and_si128(valid, _mm_cmplt_epi32(sj, v_cols));
+
+        __m128 d_along  = _mm_mul_ps(v_dtotal, t);
+        __m128 d_remain = _mm_mul_ps(v_dtotal, _mm_sub_ps(v_one, t));
+        __m128 earth    = _mm_mul_ps(_mm_mul_ps(d_along, d_remain), v_curve);
+        __m128 needed   = _mm_sub_ps(_mm_add_ps(v_obs, _mm_mul_ps(v_rise, t)), earth);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx),
+                        _mm_add_epi32(_mm_mullo_epi32(si, v_cols), sj));
+        _mm_store_si128(reinterpret_cast<__m128i*>(ok), valid);
+        for (int i = 0; i < 4; ++i)
+            h[i] = ok[i] ? vs.elevation[idx[i]] : 0.0f;
+        __m128 viol = _mm_sub_ps(_mm_load_ps(h), needed);
+
+        __m128 upd = _mm_and_ps(_mm_castsi128_ps(valid), _mm_cmpgt_ps(viol, lane_max));
+        lane_max = _mm_blendv_ps(lane_max, viol, upd);
+        lane_s = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(lane_s),
+                                                _mm_castsi128_ps(s), upd));
+    }
+
+    alignas(16) float m[4];
+    alignas(16) int ls[4];
+    _mm_store_ps(m, lane_max);
+    _mm_store_si128(reinterpret_cast<__m128i*>(ls), lane_s);
+    reduce_lanes(m, ls, 4, steps, max_violation, best_t);
+}
+
+#endif // MESH3D_X86_SIMD
+
+/* ---- Runtime dispatch ---------------------------------------------------- */
+
+SimdLevel viewshed_detect_simd() {
+#ifdef MESH3D_X86_SIMD
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return SimdLevel::SSE42;
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const char* viewshed_simd_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:  return "avx2";
+    case SimdLevel::SSE42: return "sse4.2";
+    default:               return "scalar";
+    }
+}
+
+static RayMarchFn ray_march_for(SimdLevel level) {
+#ifdef MESH3D_X86_SIMD
+    if (level == SimdLevel::AVX2)  return ray_march_avx2;
+    if (level == SimdLevel::SSE42) return ray_march_sse42;
+#endif
+    (void)level;
+    return ray_march_scalar;
+}
+
+static std::atomic<int> s_simd_level{-1}; // -1 = not yet detected
+
+void viewshed_set_simd(SimdLevel level) {
+    SimdLevel best = viewshed_detect_simd();
+    if (static_cast<int>(level) > static_cast<int>(best)) level = best;
+    s_simd_level.store(static_cast<int>(level));
+    LOG_INFO("CPU viewshed ray march: %s", viewshed_simd_name(level));
+}
+
+SimdLevel viewshed_simd() {
+    int lv = s_simd_level.load();
+    if (lv < 0) {
+        lv = static_cast<int>(viewshed_detect_simd());
+        s_simd_level.store(lv);
+    }
+    return static_cast<SimdLevel>(lv);
+}
+
+RayMarchFn viewshed_ray_march() {
+    return ray_march_for(viewshed_simd());
+}
+
+} // namespace mesh3d
@@ -0,0 +1,184 @@
+#include "analysis/viewshed.h"
+#include "analysis/viewshed_kernel.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+namespace mesh3d {
+
+/* Horizon sweep
+   -------------
+   With the 4/3-earth correction used by the ray-march kernel, a terrain
+   sample at distance d and height h sits above the LOS line to a target at
+   distance D and height H by
+
+       violation = d * (a - s),   a = (h - obs_h) / d - d * k,
+                                  s = (H - obs_h) / D - D * k
+
+   where k is the curvature factor. Writing y = h - obs_h - d^2 * k, the
+   violation is y - s * d: a linear function over the points (d, y) seen so
+   far along the ray, so its maximum lies on their upper convex hull. The
+   sweep keeps that hull (points arrive in increasing d, so it is a
+   monotone-chain stack) and answers each cell with a binary search over
+   hull edge slopes. That gives the same maximum-violation edge the ray
+   march finds, for the samples on the sweep ray, with one outward walk.
+
+   Rays go from the node to every cell on the perimeter of the Chebyshev
+   square of radius R that covers the grid. At step k along a ray the
+   minor-axis offsets of neighbouring rays differ by k/R <= 1 cell, so after
+   rounding down (as the ray march does) every cell in the square is hit by
+   at least one ray. A cell is written only by the first ray that hits it,
+   the one passing closest to the exact node-to-cell line, and the
+   diagonals only by the row-major sides, so the result does not depend on
+   ray order. */
+
+static const float EARTH_CURVE_FACTOR = 1.0f / (2.0f * (4.0f / 3.0f) * 6371000.0f);
+
+/* floor(a / b) for b > 0 */
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+void viewshed_sweep(const ViewshedSetup& vs,
+                    int r0, int r1, int c0, int c1,
+                    uint8_t* visibility, float* signal, int out_stride) {
+    const float* elevation = vs.elevation;
+    const int rows = vs.rows;
+    const int cols = vs.cols;
+    const int nr = vs.nr;
+    const int nc = vs.nc;
+    const float obs_h = vs.obs_h;
+    const float cell_m = vs.cell_m;
+    const float freq_mhz = vs.freq_mhz;
+    const float lambda = 299.792458f / freq_mhz;
+    const float eirp = vs.tx_power_dbm + vs.antenna_gain - vs.cable_loss;
+    const float fspl_freq = 20.0f * std::log10(freq_mhz);
+
+    auto in_window = [&](int r, int c) {
+        return r >= r0 && r < r1 && c >= c0 && c < c1;
+    };
+
+    /* Node's own cell */
+    if (in_window(nr, nc)) {
+        visibility[(nr - r0) * out_stride + (nc - c0)] = 1;
+        signal[(nr - r0) * out_stride + (nc - c0)] = -60.0f;
+    }
+
+    /* Chebyshev radius that reaches every grid corner */
+    int R = std::max({std::abs(nr), std::abs(rows - 1 - nr),
+                      std::abs(nc), std::abs(cols - 1 - nc)});
+    if (R == 0) return;
+
+    struct HullPoint { float d, y; };
+    std::vector<HullPoint> hull;
+    hull.reserve(R);
+
+    /* side 0/1: major axis = +/- rows; side 2/3: major axis = +/- cols */
+    static const int MAJOR[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+    for (int side = 0; side < 4; ++side) {
+        const int mr = MAJOR[side][0];
+        const int mc = MAJOR[side][1];
+        const int pr = mc != 0 ? 1 : 0; // minor axis is perpendicular to major
+        const int pc = mr != 0 ? 1 : 0;
+
+        for (int m = -R; m <= R; ++m) {
+            hull.clear();
+            bool entered = false;
+
+            for (int k = 1; k <= R; ++k) {
+                int q = floor_div(m * k, R);
+                int dr = mr * k + pr * q;
+                int dc = mc * k + pc * q;
+                int r = nr + dr;
+                int c = nc + dc;
+
+                if (r < 0 || r >= rows || c < 0 || c >= cols) {
+                    if (entered) break; // rays leave the grid only once
+                    continue;
+                }
+                entered = true;
+
+                float dist_cells = std::sqrt(static_cast<float>(dr * dr + dc * dc));
+                float d_total = dist_cells * cell_m;
+                float h = elevation[r * cols + c];
+                float y = h - obs_h - d_total * d_total * EARTH_CURVE_FACTOR;
+
+                bool owner = (m == -R || floor_div((m - 1) * k, R) < q) &&
+                             (side < 2 || std::abs(q) < k);
+                if (owner && in_window(r, c) && dist_cells <= vs.max_range_cells) {
+                    float s = (h - obs_h) / d_total - d_total * EARTH_CURVE_FACTOR;
+
+                    /* Maximum of y - s*d over the hull: first vertex whose
+                       outgoing edge is flatter than s */
+                    float max_violation = 0.0f;
+                    float edge_d = 0.0f;
+                    if (!hull.empty()) {
+                        size_t lo = 0, hi = hull.size() - 1;
+                        while (lo < hi) {
+                            size_t mid = (lo + hi) / 2;
+                            float slope = (hull[mid + 1].y - hull[mid].y) /
+                                          (hull[mid + 1].d - hull[mid].d);
+                            if (slope > s) lo = mid + 1;
+                            else hi = mid;
+                        }
+                        max_violation = hull[lo].y - s * hull[lo].d;
+                        edge_d = hull[lo].d;
+                    }
+
+                    /* Knife-edge diffraction loss (ITU-R P.526) */
+                    float diff_loss_db = 0.0f;
+                    if (max_violation > 0.0f) {
+                        float d1 = edge_d;
+                        float d2 = d_total - edge_d;
+                        float d_harmonic = d1 * d2 / (d1 + d2);
+                        float v = max_violation * std::sqrt(2.0f / (lambda * d_harmonic));
+                        if (v > -0.78f) {
+                            diff_loss_db = 6.9f + 20.0f * std::log10(
+                                std::sqrt((v - 0.1f) * (v - 0.1f) + 1.0f) + v - 0.1f);
+                        }
+                    }
+
+                    /* Free-space path loss (same distance as the ray march) */
+                    float dist_km = d_total / 1000.0f;
+                    if (dist_km < 0.01f) dist_km = 0.01f;
+                    float fspl = 20.0f * std::log10(dist_km) + fspl_freq + 32.44f;
+
+                    float received = eirp - fspl - diff_loss_db + vs.rx_antenna_gain - vs.rx_cable_loss;
+                    int o = (r - r0) * out_stride + (c - c0);
+                    visibility[o] = received >= vs.rx_sens ? 1 : 0;
+                    signal[o] = received;
+                }
+
+                /* This cell becomes a potential obstruction for cells beyond it */
+                HullPoint p{d_total, y};
+                while (hull.size() >= 2) {
+                    const HullPoint& a = hull[hull.size() - 2];
+                    const HullPoint& b = hull.back();
+                    /* pop b unless a -> b -> p turns clockwise */
+                    if ((b.d - a.d) * (p.y - a.y) - (b.y - a.y) * (p.d - a.d) >= 0.0f)
+                        hull.pop_back();
+                    else
+                        break;
+                }
+                hull.push_back(p);
+            }
+        }
+    }
+}
+
+void compute_viewshed_sweep(const float* elevation, int rows, int cols,
+                            const mesh3d_bounds_t& bounds,
+                            const NodeData& node,
+                            std::vector<uint8_t>& visibility,
+                            std::vector<float>& signal,
+                            const mesh3d_rf_config_t& rf_config) {
+    int total = rows * cols;
+    visibility.assign(total, 0);
+    signal.assign(total, -999.0f);
+
+    ViewshedSetup vs = viewshed_setup(elevation, rows, cols, bounds, node, rf_config);
+    viewshed_sweep(vs, 0, rows, 0, cols, visibility.data(), signal.data(), cols);
+}
+
+} // namespace mesh3d
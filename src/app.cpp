@@ -4,6 +4,7 @@
 #include "tile/dsm_provider.h"
 #include "ui/hardware_profiles.h"
 #include "analysis/viewshed.h"
+#include "analysis/viewshed_engine.h"
 #include "util/math_util.h"
 #include "util/color.h"
 #include "util/log.h"
@@ -84,7 +85,8 @@ bool App::init(int width, int height, const char* title) {
     GLint gl_major = 0, gl_minor = 0;
     glGetIntegerv(GL_MAJOR_VERSION, &gl_major);
     glGetIntegerv(GL_MINOR_VERSION, &gl_minor);
-    m_has_compute = (gl_major > 4) || (gl_major == 4 && gl_minor >= 3);
+    m_has_gl43 = (gl_major > 4) || (gl_major == 4 && gl_minor >= 3);
+    m_has_compute = m_has_gl43;
     LOG_INFO("Compute shader support: %s (GL %d.%d)",
              m_has_compute ? "yes" : "no", gl_major, gl_minor);
 
@@ -107,6 +109,8 @@ bool App::init(int width, int height, const char* title) {
         return false;
     }
 
+    set_heightmap_terrain(true);
+
     /* Initialize GPU viewshed compute shaders (optional, falls back to CPU) */
     if (m_has_compute) {
         if (!m_gpu_viewshed.init(m_shader_dir)) {
@@ -177,9 +181,12 @@ bool App::set_terrain(const mesh3d_grid_f32_t& grid, const mesh3d_bounds_t& boun
     scene.grid_rows = grid.rows;
     scene.grid_cols = grid.cols;
     scene.elevation.assign(grid.data, grid.data + grid.rows * grid.cols);
+    scene.terrain_hash = CoverageCache::hash_elevation(scene.elevation.data(),
+                                                       scene.elevation.size());
     m_proj.init(bounds);
     scene.build_terrain();
     scene.build_flat_plane();
+    update_link_graph();
     return true;
 }
 
@@ -191,6 +198,7 @@ int App::add_node(const mesh3d_node_t& node) {
     auto lc = proj.project(node.lat, node.lon);
     nd.world_pos = glm::vec3(lc.x, static_cast<float>(node.alt + node.antenna_height_m), lc.z);
     scene.nodes.push_back(nd);
+    update_link_graph(static_cast<int>(scene.nodes.size() - 1));
     return static_cast<int>(scene.nodes.size() - 1);
 }
 
@@ -243,10 +251,24 @@ void App::cycle_imagery_source() {
 
 void App::set_propagation_model(mesh3d_prop_model_t model) {
     m_gpu_viewshed.set_propagation_model(model);
+    cpu_viewshed_engine().set_propagation_model(model);
+    update_link_graph();
+}
+
+void App::set_radial_propagation(int radials) {
+    m_gpu_viewshed.set_radial_count(radials);
+    cpu_viewshed_engine().set_radial_count(radials);
+}
+
+void App::set_progressive_viewshed(bool on) {
+    scene.tile_manager.set_progressive_viewshed(on);
+    LOG_INFO("Tile viewshed: %s", on ? "progressive" : "full resolution only");
 }
 
 void App::set_itm_params(const mesh3d_itm_params_t& params) {
     m_gpu_viewshed.set_itm_params(params);
+    cpu_viewshed_engine().set_itm_params(params);
+    update_link_graph();
 }
 
 void App::set_rf_config(const mesh3d_rf_config_t& config) {
@@ -256,6 +278,99 @@ void App::set_rf_config(const mesh3d_rf_config_t& config) {
              config.rx_sensitivity_dbm, config.rx_height_agl_m,
              config.rx_antenna_gain_dbi, config.rx_cable_loss_db,
              config.display_min_dbm, config.display_max_dbm);
+    update_link_graph();
+}
+
+void App::set_cpu_threads(int threads) {
+    cpu_viewshed_engine().set_threads(threads);
+}
+
+PathTerrain App::path_terrain(uint64_t& terrain_key) const {
+    PathTerrain terrain;
+    if (scene.use_tile_system) {
+        /* The tile set as a whole: tiles coming and going change only
+           terrain.key(), which the link graph follows link by link */
+        terrain_key = 0x74696c6573ull;
+        scene.tile_manager.for_each_elevation([&](const TileRenderable& tr) {
+            terrain.add_grid(tr.elevation.data(), tr.elev_rows, tr.elev_cols, tr.bounds,
+                             tr.elevation_hash);
+        });
+        if (!terrain.empty()) return terrain;
+    } else {
+        terrain_key = scene.terrain_hash;
+    }
+    terrain.add_grid(scene.elevation.data(), scene.grid_rows, scene.grid_cols, scene.bounds,
+                     scene.terrain_hash);
+    return terrain;
+}
+
+PathLossSettings App::path_settings() const {
+    const CpuViewshedEngine& engine = cpu_viewshed_engine();
+    PathLossSettings settings;
+    settings.model = engine.propagation_model();
+    settings.itm_params = engine.itm_params();
+    settings.rf_config = scene.rf_config;
+    return settings;
+}
+
+int App::path_loss_batch(const mesh3d_path_query_t* queries, int count,
+                         mesh3d_path_result_t* results) {
+    if (!queries || !results || count <= 0) return 0;
+    uint64_t terrain_key;
+    PathTerrain terrain = path_terrain(terrain_key);
+    if (terrain.empty())
+        LOG_WARN("Path loss: no elevation loaded, paths are over flat ground");
+    mesh3d::path_loss_batch(terrain, path_settings(), queries, static_cast<size_t>(count),
+                            results, &cpu_viewshed_engine().pool());
+    return count;
+}
+
+int App::node_link_matrix(mesh3d_path_result_t* results, int capacity) {
+    const LinkGraph& graph = link_graph();
+    const int n = graph.size();
+    if (!results || capacity < n * n) return n;
+    for (int tx = 0; tx < n; ++tx)
+        for (int rx = 0; rx < n; ++rx)
+            results[tx * n + rx] = graph.link(tx, rx);
+    return n;
+}
+
+void App::update_link_graph(int changed, int removed) {
+    uint64_t terrain_key;
+    PathTerrain terrain = path_terrain(terrain_key);
+    PathLossSettings settings = path_settings();
+    ThreadPool* pool = &cpu_viewshed_engine().pool();
+    LinkGraph& graph = scene.link_graph;
+
+    if (removed >= 0) {
+        graph.remove_node(scene.nodes, removed, terrain, terrain_key, settings, pool);
+    } else if (changed >= 0) {
+        graph.update_node(scene.nodes, changed, terrain, terrain_key, settings, pool);
+    } else if (graph.stale(terrain_key, settings) ||
+               graph.size() != static_cast<int>(scene.nodes.size())) {
+        graph.rebuild(scene.nodes, terrain, terrain_key, settings, pool);
+    }
+    graph.refresh_incomplete(scene.nodes, terrain, settings, pool);
+}
+
+const LinkGraph& App::link_graph() {
+    update_link_graph();
+    return scene.link_graph;
+}
+
+void App::set_link_min_margin(float db) {
+    scene.link_graph.set_min_margin(db);
+}
+
+void App::set_io_threads(int threads) {
+    scene.tile_manager.set_loader_workers(AsyncLoader::DEFAULT_LOCAL_WORKERS, threads);
+}
+
+void App::set_heightmap_terrain(bool on) {
+    bool use = on && m_has_gl43 && renderer.has_heightmap_terrain();
+    scene.tile_manager.builder().format = use ? TerrainLodFormat::HEIGHTMAP
+                                              : TerrainLodFormat::VERTICES;
+    LOG_INFO("Tile terrain: %s", use ? "GPU heightmap displacement" : "baked vertices");
 }
 
 void App::set_dsm_dir(const std::string& dir) {
@@ -263,6 +378,7 @@ void App::set_dsm_dir(const std::string& dir) {
     auto dsm = std::make_unique<DSMProvider>();
     dsm->set_data_dir(dir);
     scene.tile_manager.set_dsm_provider(std::move(dsm));
+    scene.link_graph.clear();   // same tiles, other elevation
     LOG_INFO("DSM data directory: %s", dir.c_str());
 }
 
@@ -343,6 +459,7 @@ void App::handle_menu_input() {
     if (m_input.consume_arrow_right()) m_hud.menu_device_right();
 
     if (m_input.consume_enter()) {
+        int device_node = m_hud.menu().device_select_node;
         int result = m_hud.menu_activate(scene, camera, m_proj);
         if (result == 1) {
             // Resume
@@ -362,11 +479,13 @@ void App::handle_menu_input() {
             SDL_PushEvent(&quit_ev);
         } else if (result == 4) {
             // Kick async viewshed recompute
+            update_link_graph(device_node);
             kick_viewshed_recompute(scene, m_proj, m_has_compute ? &m_gpu_viewshed : nullptr);
             m_viewshed_pending = true;
         } else if (result == 5) {
             // Apply RF config + kick viewshed
             m_gpu_viewshed.set_rf_config(scene.rf_config);
+            update_link_graph();
             kick_viewshed_recompute(scene, m_proj, m_has_compute ? &m_gpu_viewshed : nullptr);
             m_viewshed_pending = true;
         }
@@ -379,6 +498,7 @@ void App::handle_menu_input() {
         if (m_hud.is_node_field(menu.focused_field, scene, node_idx)) {
             if (node_idx >= 0 && node_idx < (int)scene.nodes.size()) {
                 scene.nodes.erase(scene.nodes.begin() + node_idx);
+                update_link_graph(-1, node_idx);
                 scene.build_markers();
                 scene.build_spheres();
                 kick_viewshed_recompute(scene, m_proj, m_has_compute ? &m_gpu_viewshed : nullptr);
@@ -553,13 +673,15 @@ void App::place_node_at(const glm::vec3& world_pos) {
     kick_viewshed_recompute(scene, m_proj, m_has_compute ? &m_gpu_viewshed : nullptr);
     auto t3 = std::chrono::steady_clock::now();
     m_viewshed_pending = true;
+    update_link_graph(idx);
+    auto t4 = std::chrono::steady_clock::now();
 
     auto ms = [](auto a, auto b) {
         return std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
     };
-    LOG_INFO("place_node_at: markers=%lldms spheres=%lldms kick=%lldms total=%lldms",
+    LOG_INFO("place_node_at: markers=%lldms spheres=%lldms kick=%lldms links=%lldms total=%lldms",
              (long long)ms(t0,t1), (long long)ms(t1,t2), (long long)ms(t2,t3),
-             (long long)ms(t_place_start,t3));
+             (long long)ms(t3,t4), (long long)ms(t_place_start,t4));
     LOG_INFO("Placed node '%s' at (%.4f, %.4f, %.0fm)", node.name, ll.lat, ll.lon, world_pos.y);
 }
 
@@ -581,6 +703,7 @@ void App::delete_nearest_node(const glm::vec3& world_pos) {
     if (nearest >= 0 && min_dist < 500.0f) {
         LOG_INFO("Deleted node '%s'", scene.nodes[nearest].info.name);
         scene.nodes.erase(scene.nodes.begin() + nearest);
+        update_link_graph(-1, nearest);
         scene.build_markers();
         scene.build_spheres();
         kick_viewshed_recompute(scene, m_proj, m_has_compute ? &m_gpu_viewshed : nullptr);
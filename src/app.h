@@ -8,6 +8,7 @@
 #include "camera/input.h"
 #include "ui/hud.h"
 #include "analysis/gpu_viewshed.h"
+#include "analysis/path_loss.h"
 #include "util/math_util.h"
 #include <mesh3d/types.h>
 
@@ -36,9 +37,30 @@ public:
     void rebuild_scene();
     void cycle_imagery_source();
     void set_propagation_model(mesh3d_prop_model_t model);
+    /* Rays per node for ITM / Fresnel on the radial-profile engine, 0 = per cell */
+    void set_radial_propagation(int radials);
+    /* Coarse-to-fine GPU tile viewshed (TileManager::set_progressive_viewshed) */
+    void set_progressive_viewshed(bool on);
     void set_itm_params(const mesh3d_itm_params_t& params);
     void set_rf_config(const mesh3d_rf_config_t& config);
     void set_dsm_dir(const std::string& dir);
+    void set_cpu_threads(int threads);
+    /* Concurrent tile downloads (disk-cache hits use their own worker) */
+    void set_io_threads(int threads);
+    /* Draw tiles from GPU-displaced height textures instead of baked
+       vertices. On by default when supported; off forces the vertex path. */
+    void set_heightmap_terrain(bool on);
+
+    /* Point-to-point paths over the loaded terrain with the current model
+       and RF config; returns the number of results written */
+    int path_loss_batch(const mesh3d_path_query_t* queries, int count,
+                        mesh3d_path_result_t* results);
+    /* Link from every node to every other, results[tx * n + rx] (the
+       diagonal zeroed). Returns n; nothing is written if capacity < n * n. */
+    int node_link_matrix(mesh3d_path_result_t* results, int capacity);
+    /* Node link graph, brought up to date first */
+    const LinkGraph& link_graph();
+    void set_link_min_margin(float db);
 
     /* Main loop */
     void run();
@@ -60,6 +82,7 @@ private:
     GeoProjection m_proj;
     bool m_hgt_mode = false;
     bool m_has_compute = false;
+    bool m_has_gl43 = false;
     GpuViewshed m_gpu_viewshed;
     bool m_viewshed_pending = false;
 
@@ -80,6 +103,14 @@ private:
     /* Delete nearest node to a world position */
     void delete_nearest_node(const glm::vec3& world_pos);
 
+    /* Elevation and settings for path_loss_batch() */
+    PathTerrain path_terrain(uint64_t& terrain_key) const;
+    PathLossSettings path_settings() const;
+    /* Update scene.link_graph after node `changed` was appended or
+       modified, or node `removed` was erased; with neither, recompute it
+       only if the settings or terrain changed */
+    void update_link_graph(int changed = -1, int removed = -1);
+
     /* Find font path (search relative to exe) */
     std::string find_font_path();
 };
@@ -0,0 +1,407 @@
+/* mesh3d_batch — headless coverage planning.
+
+   Loads HGT (and optionally DSM) elevation for a bounds box through the
+   tile providers, runs the multithreaded CPU viewshed engine for a list of
+   nodes, and writes the merged grids plus a JSON manifest. Never touches
+   SDL or OpenGL, so it runs on servers without a display. */
+
+#include "analysis/viewshed_engine.h"
+#include "analysis/viewshed_kernel.h"
+#include "tile/elevation_mosaic.h"
+#include "tile/hgt_provider.h"
+#include "tile/dsm_provider.h"
+#include "ui/hardware_profiles.h"
+#include "util/log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace mesh3d;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+const HardwareProfile* find_profile(const std::string& id) {
+    for (int i = 0; i < HARDWARE_PROFILE_COUNT; ++i)
+        if (id == HARDWARE_PROFILES[i].id) return &HARDWARE_PROFILES[i];
+    return nullptr;
+}
+
+/* Node list CSV, one node per line:
+     lat,lon[,antenna_height_m[,profile_id[,name]]]
+   Blank lines and lines starting with '#' are skipped; a first line that
+   does not start with a number is taken as a header. profile_id is one of
+   HARDWARE_PROFILES (default heltec_v3). */
+bool load_nodes_csv(const char* path, std::vector<NodeData>& nodes) {
+    std::ifstream in(path);
+    if (!in) {
+        LOG_ERROR("Cannot open node list %s", path);
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    bool first_row = true;
+    while (std::getline(in, line)) {
+        ++line_no;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ','))
+            f.push_back(trim(field));
+
+        char* end = nullptr;
+        double lat = f.size() >= 2 ? std::strtod(f[0].c_str(), &end) : 0.0;
+        bool numeric = f.size() >= 2 && end != f[0].c_str();
+        if (!numeric && first_row) {
+            first_row = false;
+            continue; // header
+        }
+        first_row = false;
+        if (!numeric) {
+            LOG_ERROR("%s:%d: expected lat,lon", path, line_no);
+            return false;
+        }
+        double lon = std::strtod(f[1].c_str(), nullptr);
+
+        const HardwareProfile* hw = &HARDWARE_PROFILES[0];
+        if (f.size() >= 4 && !f[3].empty()) {
+            hw = find_profile(f[3]);
+            if (!hw) {
+                LOG_ERROR("%s:%d: unknown hardware profile '%s'", path, line_no, f[3].c_str());
+                return false;
+            }
+        }
+
+        mesh3d_node_t n{};
+        n.id = static_cast<int>(nodes.size());
+        std::snprintf(n.name, sizeof(n.name), "%s",
+                      f.size() >= 5 ? f[4].c_str() : ("node" + std::to_string(n.id)).c_str());
+        n.lat = lat;
+        n.lon = lon;
+        n.antenna_height_m = f.size() >= 3 && !f[2].empty()
+            ? static_cast<float>(std::atof(f[2].c_str())) : 2.0f;
+        n.max_range_km = hw->max_range_km;
+        n.tx_power_dbm = hw->tx_power_dbm;
+        n.antenna_gain_dbi = hw->antenna_gain_dbi;
+        n.rx_sensitivity_dbm = hw->rx_sensitivity_dbm;
+        n.frequency_mhz = hw->frequency_mhz;
+        n.cable_loss_db = hw->cable_loss_db;
+        n.bandwidth_khz = hw->bandwidth_khz;
+        n.spreading_factor = hw->spreading_factor;
+
+        NodeData nd;
+        nd.info = n;
+        nd.world_pos = glm::vec3(0.0f);
+        nodes.push_back(nd);
+    }
+
+    if (nodes.empty()) {
+        LOG_ERROR("Node list %s contains no nodes", path);
+        return false;
+    }
+    return true;
+}
+
+std::string json_escape(const char* s) {
+    std::string out;
+    for (; *s; ++s) {
+        unsigned char ch = static_cast<unsigned char>(*s);
+        if (ch == '"' || ch == '\\') { out += '\\'; out += *s; }
+        else if (ch < 0x20) { char buf[8]; std::snprintf(buf, sizeof(buf), "\\u%04x", ch); out += buf; }
+        else out += *s;
+    }
+    return out;
+}
+
+bool write_raw(const std::filesystem::path& path, const void* data, size_t bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("Cannot write %s", path.string().c_str());
+        return false;
+    }
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    return static_cast<bool>(out);
+}
+
+struct StageTimes {
+    double nodes_ms = 0.0;
+    double fetch_ms = 0.0;
+    double mosaic_ms = 0.0;
+    double viewshed_ms = 0.0;
+    double write_ms = 0.0;
+    double total_ms = 0.0;
+};
+
+void print_usage() {
+    printf("Usage: mesh3d_batch --nodes FILE --bounds S,W,N,E --out DIR [options]\n"
+           "  --nodes FILE        Node list CSV: lat,lon[,antenna_m[,profile[,name]]]\n"
+           "  --bounds S,W,N,E    Output box (min_lat,min_lon,max_lat,max_lon)\n"
+           "  --out DIR           Output directory (created if missing)\n"
+           "  --margin DEG        Extra terrain loaded around the box so rays can\n"
+           "                      cross ridges outside it (default 0)\n"
+           "  --dsm-dir DIR       Overlay LiDAR DSM GeoTIFFs from DIR on top of HGT\n"
+           "  --hgt-url URL       HGT server root holding <lat>/<tile>.hgt.gz\n"
+           "                      (default: AWS elevation-tiles-prod/skadi)\n"
+           "  --resolution N      Grid posts per degree (default: from HGT, 3600 for SRTM1)\n"
+           "  --model NAME        fspl (ray march, default), sweep, or itm / fresnel\n"
+           "                      (radial-profile engine)\n"
+           "  --radials N         Rays per node for itm / fresnel (default 720)\n"
+           "  --threads N         Worker threads (default: all cores)\n"
+           "  --rx-sens DBM       Receiver sensitivity fallback (default -130)\n"
+           "  --write-elevation   Also write the elevation mosaic (elevation.f32)\n"
+           "  --debug             Enable debug logging\n"
+           "\nOutputs (row-major, row 0 = north, little-endian):\n"
+           "  visibility.u8  1 = seen by any node\n"
+           "  signal.f32     best received signal in dBm (-999 = none)\n"
+           "  overlap.u8     number of nodes that see the cell\n"
+           "  coverage.json  grid size, bounds, nodes, stats and stage timings\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* nodes_path = nullptr;
+    const char* out_dir = nullptr;
+    const char* dsm_dir = nullptr;
+    const char* hgt_url = nullptr;
+    mesh3d_bounds_t bounds{};
+    bool have_bounds = false;
+    double margin_deg = 0.0;
+    int resolution = 0;
+    int threads = 0;
+    bool write_elevation = false;
+    mesh3d_prop_model_t model = MESH3D_PROP_FSPL;
+    int radials = 720;
+    mesh3d_rf_config_t rf{-130.0f, 1.0f, 2.0f, 2.0f, -130.0f, -80.0f};
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) {
+            nodes_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--bounds") == 0 && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf", &bounds.min_lat, &bounds.min_lon,
+                            &bounds.max_lat, &bounds.max_lon) != 4 ||
+                bounds.max_lat <= bounds.min_lat || bounds.max_lon <= bounds.min_lon) {
+                fprintf(stderr, "Invalid --bounds, expected MIN_LAT,MIN_LON,MAX_LAT,MAX_LON\n");
+                return 1;
+            }
+            have_bounds = true;
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--margin") == 0 && i + 1 < argc) {
+            margin_deg = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--dsm-dir") == 0 && i + 1 < argc) {
+            dsm_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--hgt-url") == 0 && i + 1 < argc) {
+            hgt_url = argv[++i];
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            resolution = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "fspl") == 0) {
+                model = MESH3D_PROP_FSPL;
+            } else if (std::strcmp(name, "sweep") == 0) {
+                model = MESH3D_PROP_SWEEP;
+            } else if (std::strcmp(name, "itm") == 0) {
+                model = MESH3D_PROP_ITM;
+            } else if (std::strcmp(name, "fresnel") == 0) {
+                model = MESH3D_PROP_FRESNEL;
+            } else {
+                fprintf(stderr, "Unknown --model '%s' (CPU models: fspl, sweep, itm, fresnel)\n",
+                        name);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--radials") == 0 && i + 1 < argc) {
+            radials = std::atoi(argv[++i]);
+            if (radials < 8) {
+                fprintf(stderr, "--radials must be at least 8\n");
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rx-sens") == 0 && i + 1 < argc) {
+            rf.rx_sensitivity_dbm = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--write-elevation") == 0) {
+            write_elevation = true;
+        } else if (std::strcmp(argv[i], "--debug") == 0) {
+            log_set_level(LogLevel::Debug);
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            print_usage();
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (!nodes_path || !have_bounds || !out_dir) {
+        print_usage();
+        return 1;
+    }
+
+    StageTimes times;
+    auto t_start = Clock::now();
+
+    /* 1. Nodes */
+    auto t = Clock::now();
+    std::vector<NodeData> nodes;
+    if (!load_nodes_csv(nodes_path, nodes)) return 1;
+    times.nodes_ms = ms_since(t);
+
+    /* 2. Elevation: HGT base, DSM overlay */
+    mesh3d_bounds_t terrain_bounds = bounds;
+    terrain_bounds.min_lat -= margin_deg;
+    terrain_bounds.max_lat += margin_deg;
+    terrain_bounds.min_lon -= margin_deg;
+    terrain_bounds.max_lon += margin_deg;
+
+    HgtProvider hgt;
+    if (hgt_url) hgt.set_base_url(hgt_url);
+    DSMProvider dsm;
+    std::vector<TileProvider*> providers = {&hgt};
+    if (dsm_dir) {
+        dsm.set_data_dir(dsm_dir);
+        providers.push_back(&dsm);
+    }
+
+    ElevationMosaic mosaic;
+    if (!build_elevation_mosaic(terrain_bounds, resolution, providers, mosaic)) return 1;
+    times.fetch_ms = mosaic.fetch_ms;
+    times.mosaic_ms = mosaic.resample_ms;
+
+    /* Output window = requested box inside the (margin-expanded) mosaic */
+    GridWindow window;
+    window.row0 = std::max(mosaic.lat_to_row(bounds.max_lat), 0);
+    window.col0 = std::max(mosaic.lon_to_col(bounds.min_lon), 0);
+    window.rows = std::min(mosaic.lat_to_row(bounds.min_lat), mosaic.rows - 1) - window.row0 + 1;
+    window.cols = std::min(mosaic.lon_to_col(bounds.max_lon), mosaic.cols - 1) - window.col0 + 1;
+    mesh3d_bounds_t out_bounds;
+    out_bounds.max_lat = mosaic.bounds.max_lat - static_cast<double>(window.row0) / mosaic.cells_per_degree;
+    out_bounds.min_lat = out_bounds.max_lat - static_cast<double>(window.rows - 1) / mosaic.cells_per_degree;
+    out_bounds.min_lon = mosaic.bounds.min_lon + static_cast<double>(window.col0) / mosaic.cells_per_degree;
+    out_bounds.max_lon = out_bounds.min_lon + static_cast<double>(window.cols - 1) / mosaic.cells_per_degree;
+
+    /* 3. Viewshed */
+    auto& engine = cpu_viewshed_engine();
+    if (threads > 0) engine.set_threads(threads);
+    engine.set_propagation_model(model);
+    engine.set_radial_count(radials);
+    const char* model_name = model == MESH3D_PROP_SWEEP   ? "sweep"
+                           : model == MESH3D_PROP_ITM     ? "itm"
+                           : model == MESH3D_PROP_FRESNEL ? "fresnel" : "fspl";
+
+    LOG_INFO("Computing %zu node(s) over %dx%d cells (terrain %dx%d, %d threads, %s)",
+             nodes.size(), window.rows, window.cols, mosaic.rows, mosaic.cols,
+             engine.threads(),
+             model == MESH3D_PROP_FSPL ? viewshed_simd_name(viewshed_simd()) : model_name);
+
+    std::vector<uint8_t> vis, overlap;
+    std::vector<float> sig;
+    t = Clock::now();
+    engine.compute_merged(mosaic.data.data(), mosaic.rows, mosaic.cols, mosaic.bounds,
+                          nodes, rf, window, vis, sig, &overlap);
+    times.viewshed_ms = ms_since(t);
+
+    /* 4. Outputs */
+    t = Clock::now();
+    namespace fs = std::filesystem;
+    fs::path dir(out_dir);
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        LOG_ERROR("Cannot create output directory %s: %s", out_dir, ec.message().c_str());
+        return 1;
+    }
+
+    size_t total = vis.size();
+    bool ok = write_raw(dir / "visibility.u8", vis.data(), total) &&
+              write_raw(dir / "signal.f32", sig.data(), total * sizeof(float)) &&
+              write_raw(dir / "overlap.u8", overlap.data(), total);
+    if (ok && write_elevation)
+        ok = write_raw(dir / "elevation.f32", mosaic.data.data(),
+                       mosaic.data.size() * sizeof(float));
+    if (!ok) return 1;
+
+    size_t visible = 0;
+    for (uint8_t v : vis) visible += v ? 1 : 0;
+    times.write_ms = ms_since(t);
+    times.total_ms = ms_since(t_start);
+
+    /* Manifest (written last so its timings include the grid writes) */
+    std::string manifest = (dir / "coverage.json").string();
+    FILE* f = std::fopen(manifest.c_str(), "w");
+    if (!f) {
+        LOG_ERROR("Cannot write %s", manifest.c_str());
+        return 1;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"rows\": %d,\n  \"cols\": %d,\n", window.rows, window.cols);
+    fprintf(f, "  \"bounds\": {\"min_lat\": %.9f, \"max_lat\": %.9f, \"min_lon\": %.9f, \"max_lon\": %.9f},\n",
+            out_bounds.min_lat, out_bounds.max_lat, out_bounds.min_lon, out_bounds.max_lon);
+    fprintf(f, "  \"cells_per_degree\": %d,\n", mosaic.cells_per_degree);
+    fprintf(f, "  \"model\": \"%s\",\n", model_name);
+    if (engine.radial_active()) fprintf(f, "  \"radials\": %d,\n", radials);
+    fprintf(f, "  \"threads\": %d,\n", engine.threads());
+    fprintf(f, "  \"files\": {\"visibility\": \"visibility.u8\", \"signal\": \"signal.f32\", "
+               "\"overlap\": \"overlap.u8\"");
+    if (write_elevation)
+        fprintf(f, ", \"elevation\": {\"file\": \"elevation.f32\", \"rows\": %d, \"cols\": %d, "
+                   "\"min_lat\": %.9f, \"max_lat\": %.9f, \"min_lon\": %.9f, \"max_lon\": %.9f}",
+                mosaic.rows, mosaic.cols, mosaic.bounds.min_lat, mosaic.bounds.max_lat,
+                mosaic.bounds.min_lon, mosaic.bounds.max_lon);
+    fprintf(f, "},\n");
+    fprintf(f, "  \"tiles\": {\"loaded\": %d, \"missing\": %d},\n",
+            mosaic.tiles_loaded, mosaic.tiles_missing);
+    fprintf(f, "  \"visible_cells\": %zu,\n", visible);
+    fprintf(f, "  \"nodes\": [\n");
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const auto& n = nodes[i].info;
+        fprintf(f, "    {\"name\": \"%s\", \"lat\": %.7f, \"lon\": %.7f, \"antenna_height_m\": %.2f, "
+                   "\"tx_power_dbm\": %.2f, \"frequency_mhz\": %.3f}%s\n",
+                json_escape(n.name).c_str(), n.lat, n.lon, n.antenna_height_m,
+                n.tx_power_dbm, n.frequency_mhz, i + 1 < nodes.size() ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+    fprintf(f, "  \"timing_ms\": {\"nodes\": %.3f, \"fetch\": %.3f, \"mosaic\": %.3f, "
+               "\"viewshed\": %.3f, \"write\": %.3f, \"total\": %.3f}\n",
+            times.nodes_ms, times.fetch_ms, times.mosaic_ms,
+            times.viewshed_ms, times.write_ms, times.total_ms);
+    fprintf(f, "}\n");
+    std::fclose(f);
+
+    printf("Coverage: %zu / %zu cells visible (%.1f%%)\n", visible, total,
+           total ? 100.0 * visible / total : 0.0);
+    printf("Timing (ms):\n"
+           "  nodes     %10.1f\n"
+           "  fetch     %10.1f\n"
+           "  mosaic    %10.1f\n"
+           "  viewshed  %10.1f\n"
+           "  write     %10.1f\n"
+           "  total     %10.1f\n",
+           times.nodes_ms, times.fetch_ms, times.mosaic_ms,
+           times.viewshed_ms, times.write_ms, times.total_ms);
+    printf("Wrote %s\n", manifest.c_str());
+    return 0;
+}
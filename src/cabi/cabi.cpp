@@ -51,6 +51,14 @@ void mesh3d_set_propagation_model(mesh3d_prop_model_t model) {
     app().set_propagation_model(model);
 }
 
+void mesh3d_set_radial_propagation(int radials) {
+    app().set_radial_propagation(radials);
+}
+
+void mesh3d_set_progressive_viewshed(int on) {
+    app().set_progressive_viewshed(on != 0);
+}
+
 void mesh3d_set_itm_params(mesh3d_itm_params_t params) {
     app().set_itm_params(params);
 }
@@ -59,6 +67,47 @@ void mesh3d_set_rf_config(mesh3d_rf_config_t config) {
     app().set_rf_config(config);
 }
 
+int mesh3d_path_loss_batch(const mesh3d_path_query_t* queries, int count,
+                           mesh3d_path_result_t* results) {
+    return app().path_loss_batch(queries, count, results);
+}
+
+int mesh3d_node_link_matrix(mesh3d_path_result_t* results, int capacity) {
+    return app().node_link_matrix(results, capacity);
+}
+
+int mesh3d_link_graph_stats(mesh3d_link_graph_stats_t* out) {
+    if (!out) return 0;
+    *out = app().link_graph().stats();
+    return 1;
+}
+
+int mesh3d_link_graph_hops(int a, int b) {
+    const LinkGraph& graph = app().link_graph();
+    if (a < 0 || b < 0 || a >= graph.size() || b >= graph.size()) return -1;
+    return graph.hops(a, b);
+}
+
+int mesh3d_link_graph_partition(int node) {
+    const LinkGraph& graph = app().link_graph();
+    if (node < 0 || node >= graph.size()) return -1;
+    return graph.partition(node);
+}
+
+int mesh3d_link_graph_is_articulation(int node) {
+    const LinkGraph& graph = app().link_graph();
+    if (node < 0 || node >= graph.size()) return 0;
+    return graph.articulation(node) ? 1 : 0;
+}
+
+void mesh3d_set_link_min_margin(float db) {
+    app().set_link_min_margin(db);
+}
+
+void mesh3d_set_cpu_threads(int threads) {
+    app().set_cpu_threads(threads);
+}
+
 void mesh3d_set_dsm_dir(const char* dir) {
     app().set_dsm_dir(dir ? dir : "");
 }
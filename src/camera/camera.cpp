@@ -28,6 +28,36 @@ glm::mat4 Camera::projection_matrix(float aspect) const {
     return glm::perspective(glm::radians(fov), aspect, near_plane, far_plane);
 }
 
+Frustum Camera::frustum(float aspect) const {
+    return Frustum::from_matrix(projection_matrix(aspect) * view_matrix());
+}
+
+Frustum Frustum::from_matrix(const glm::mat4& m) {
+    /* Gribb/Hartmann: combine the rows of the clip matrix (glm is
+       column-major, so row i is m[0][i] .. m[3][i]) */
+    auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+    Frustum f;
+    f.planes[0] = r3 + r0;  // left
+    f.planes[1] = r3 - r0;  // right
+    f.planes[2] = r3 + r1;  // bottom
+    f.planes[3] = r3 - r1;  // top
+    f.planes[4] = r3 + r2;  // near
+    f.planes[5] = r3 - r2;  // far
+    return f;
+}
+
+bool Frustum::intersects_aabb(const glm::vec3& mn, const glm::vec3& mx) const {
+    for (auto& p : planes) {
+        /* Corner furthest along the plane normal */
+        glm::vec3 v(p.x >= 0.0f ? mx.x : mn.x,
+                    p.y >= 0.0f ? mx.y : mn.y,
+                    p.z >= 0.0f ? mx.z : mn.z);
+        if (p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
 void Camera::move_forward(float dt, bool sprint) {
     float speed = move_speed * (sprint ? sprint_multiplier : 1.0f);
     position += m_front * speed * dt;
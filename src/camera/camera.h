@@ -4,6 +4,18 @@
 
 namespace mesh3d {
 
+/* Six clip planes (ax + by + cz + d >= 0 inside), extracted from a
+   view-projection matrix */
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum from_matrix(const glm::mat4& view_proj);
+
+    /* Conservative: may accept boxes just outside a corner, never rejects
+       a visible one */
+    bool intersects_aabb(const glm::vec3& mn, const glm::vec3& mx) const;
+};
+
 class Camera {
 public:
     glm::vec3 position{0.0f, 500.0f, 0.0f};
@@ -22,6 +34,7 @@ public:
 
     glm::mat4 view_matrix() const;
     glm::mat4 projection_matrix(float aspect) const;
+    Frustum frustum(float aspect) const;
 
     void move_forward(float dt, bool sprint);
     void move_right(float dt, bool sprint);
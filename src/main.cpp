@@ -1,5 +1,7 @@
 #include "app.h"
+#include "analysis/coverage_disk_cache.h"
 #include "util/log.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -10,6 +12,11 @@ int main(int argc, char* argv[]) {
     int width = 1280, height = 720;
     const char* title = "mesh3d — 3D Terrain Viewer";
     const char* texture_path = nullptr;
+    int cpu_threads = 0;
+    int io_threads = 0;
+    int radials = 0;
+    bool terrain_mesh = false;
+    bool progressive = true;
     double center_lat = 40.3978, center_lon = -105.0750; // Loveland, CO
 
     /* Simple arg parsing */
@@ -26,6 +33,20 @@ int main(int argc, char* argv[]) {
             height = std::atoi(argv[++i]);
         } else if (std::strcmp(argv[i], "--texture") == 0 && i + 1 < argc) {
             texture_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            cpu_threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--io-threads") == 0 && i + 1 < argc) {
+            io_threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--radials") == 0 && i + 1 < argc) {
+            radials = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--terrain-mesh") == 0) {
+            terrain_mesh = true;
+        } else if (std::strcmp(argv[i], "--no-progressive") == 0) {
+            progressive = false;
+        } else if (std::strcmp(argv[i], "--no-coverage-cache") == 0) {
+            coverage_disk_cache().set_enabled(false);
+        } else if (std::strcmp(argv[i], "--coverage-cache-mb") == 0 && i + 1 < argc) {
+            coverage_disk_cache().set_budget(static_cast<uint64_t>(std::max(std::atoi(argv[++i]), 1)) << 20);
         } else if (std::strcmp(argv[i], "--debug") == 0) {
             log_set_level(LogLevel::Debug);
         } else if (std::strcmp(argv[i], "--help") == 0) {
@@ -34,6 +55,13 @@ int main(int argc, char* argv[]) {
                    "  --texture PATH    Load satellite texture from file\n"
                    "  --width W         Window width (default 1280)\n"
                    "  --height H        Window height (default 720)\n"
+                   "  --threads N       CPU viewshed worker threads (default: all cores)\n"
+                   "  --io-threads N    Concurrent tile downloads (default 4)\n"
+                   "  --radials N       ITM/Fresnel on N rays per node, interpolated (default: per cell)\n"
+                   "  --terrain-mesh    Bake tile vertices on the CPU (no GPU heightmap)\n"
+                   "  --no-progressive  Compute tile coverage at full resolution only\n"
+                   "  --no-coverage-cache  Don't read or write ~/.cache/mesh3d/coverage\n"
+                   "  --coverage-cache-mb N  Size cap of that directory (default 2048)\n"
                    "  --debug           Enable debug logging\n"
                    "\nControls:\n"
                    "  WASD        Move camera\n"
@@ -58,6 +86,12 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (cpu_threads > 0) a.set_cpu_threads(cpu_threads);
+    if (io_threads > 0) a.set_io_threads(io_threads);
+    if (radials > 0) a.set_radial_propagation(radials);
+    if (terrain_mesh) a.set_heightmap_terrain(false);
+    if (!progressive) a.set_progressive_viewshed(false);
+
     /* HGT streaming mode (always active) */
     if (!a.init_hgt_mode(center_lat, center_lon)) {
         LOG_ERROR("Failed to initialize HGT mode");
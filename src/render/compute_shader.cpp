@@ -40,6 +40,27 @@ bool ComputeShader::load(const std::string& comp_path) {
     return load_source(src.c_str());
 }
 
+bool ComputeShader::load(const std::string& comp_path,
+                         const std::vector<std::string>& prelude_paths,
+                         const char* defines) {
+    std::string src = read_file(comp_path);
+    if (src.empty()) return false;
+    std::string prelude;
+    for (const auto& path : prelude_paths) {
+        std::string part = read_file(path);
+        if (part.empty()) return false;
+        prelude += part;
+    }
+
+    size_t eol = src.find('\n');
+    if (src.compare(0, 8, "#version") != 0 || eol == std::string::npos) {
+        LOG_ERROR("Compute shader %s must start with #version", comp_path.c_str());
+        return false;
+    }
+    src.insert(eol + 1, std::string(defines) + prelude + "#line 2\n");
+    return load_source(src.c_str());
+}
+
 bool ComputeShader::load_source(const char* comp_src) {
     GLuint cs = glCreateShader(GL_COMPUTE_SHADER);
     glShaderSource(cs, 1, &comp_src, nullptr);
@@ -82,6 +103,10 @@ void ComputeShader::set_int(const char* name, int v) const {
     glUniform1i(glGetUniformLocation(m_program, name), v);
 }
 
+void ComputeShader::set_int_array(const char* name, const int* v, int count) const {
+    glUniform1iv(glGetUniformLocation(m_program, name), count, v);
+}
+
 void ComputeShader::set_ivec2(const char* name, int x, int y) const {
     glUniform2i(glGetUniformLocation(m_program, name), x, y);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <glad/glad.h>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 
 namespace mesh3d {
@@ -11,6 +12,10 @@ public:
     ~ComputeShader();
 
     bool load(const std::string& comp_path);
+    /* Load with `defines` and the contents of each of `prelude_paths`
+       (shared declarations), in order, inserted after the #version line */
+    bool load(const std::string& comp_path, const std::vector<std::string>& prelude_paths,
+              const char* defines = "");
     bool load_source(const char* comp_src);
     void use() const;
     GLuint id() const { return m_program; }
@@ -19,6 +24,7 @@ public:
 
     /* Uniform setters */
     void set_int(const char* name, int v) const;
+    void set_int_array(const char* name, const int* v, int count) const;
     void set_ivec2(const char* name, int x, int y) const;
     void set_float(const char* name, float v) const;
     void set_vec3(const char* name, const glm::vec3& v) const;
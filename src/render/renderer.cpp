@@ -16,6 +16,11 @@ bool Renderer::init(const std::string& shader_dir) {
         LOG_ERROR("Failed to load terrain shader");
         return false;
     }
+    /* Needs GL 4.3 at draw time (multi-draw indirect); compiles on 3.3 */
+    m_has_hm_terrain = terrain_hm_shader.load(shader_dir + "/terrain_hm.vert",
+                                              shader_dir + "/terrain.frag");
+    if (!m_has_hm_terrain)
+        LOG_WARN("Heightmap terrain shader unavailable, tiles use baked vertices");
     if (!flat_shader.load(shader_dir + "/flat.vert", shader_dir + "/flat.frag")) {
         LOG_ERROR("Failed to load flat shader");
         return false;
@@ -49,6 +54,16 @@ void Renderer::setup_common_uniforms(Shader& s, const Camera& cam, float aspect)
     s.set_vec3("uCameraPos", cam.position);
 }
 
+void Renderer::setup_tile_terrain_uniforms(Shader& s, const Scene& scene,
+                                           const Camera& cam, float aspect) {
+    setup_common_uniforms(s, cam, aspect);
+    s.set_int("uOverlayMode", static_cast<int>(scene.overlay_mode));
+    s.set_vec3("uLightDir", glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f)));
+    s.set_float("uRxSensitivity", scene.rf_config.rx_sensitivity_dbm);
+    s.set_float("uDisplayMinDbm", scene.rf_config.display_min_dbm);
+    s.set_float("uDisplayMaxDbm", scene.rf_config.display_max_dbm);
+}
+
 void Renderer::render(const Scene& scene, const Camera& cam, float aspect,
                        int screen_w, int screen_h,
                        Hud* hud, const GeoProjection* proj,
@@ -56,7 +71,7 @@ void Renderer::render(const Scene& scene, const Camera& cam, float aspect,
     glClearColor(0.12f, 0.14f, 0.18f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    opaque_pass(scene, cam, aspect);
+    opaque_pass(scene, cam, aspect, screen_h);
     transparent_pass(scene, cam, aspect);
     hud_pass(scene, cam, screen_w, screen_h, hud, proj, node_placement_mode, show_controls);
 }
@@ -70,37 +85,56 @@ void Renderer::hud_pass(const Scene& scene, const Camera& cam,
                 node_placement_mode, show_controls);
 }
 
-void Renderer::opaque_pass(const Scene& scene, const Camera& cam, float aspect) {
+void Renderer::opaque_pass(const Scene& scene, const Camera& cam, float aspect, int screen_h) {
     glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
 
     /* Terrain or flat plane */
     if (scene.render_mode == MESH3D_MODE_TERRAIN && scene.use_tile_system &&
         scene.tile_manager.has_terrain()) {
-        /* Tile-based terrain rendering */
-        setup_common_uniforms(terrain_shader, cam, aspect);
-        terrain_shader.set_int("uOverlayMode", static_cast<int>(scene.overlay_mode));
-        terrain_shader.set_vec3("uLightDir", glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f)));
-        terrain_shader.set_float("uRxSensitivity", scene.rf_config.rx_sensitivity_dbm);
-        terrain_shader.set_float("uDisplayMinDbm", scene.rf_config.display_min_dbm);
-        terrain_shader.set_float("uDisplayMaxDbm", scene.rf_config.display_max_dbm);
-        const_cast<TileManager&>(scene.tile_manager).render([&](const TileRenderable& tile) {
-            terrain_shader.set_mat4("uModel", tile.model);
-            terrain_shader.set_int("uUseSatelliteTex", tile.texture.valid() ? 1 : 0);
+        /* Tile-based terrain rendering: chunk LOD first, then draw */
+        auto& tiles = const_cast<TileManager&>(scene.tile_manager);
+        tiles.select_lod(cam, aspect, screen_h);
+        /* Tiles built in either format may coexist briefly (e.g. after the
+           format changed); each tile draws with its own shader */
+        if (m_has_hm_terrain)
+            setup_tile_terrain_uniforms(terrain_hm_shader, scene, cam, aspect);
+        setup_tile_terrain_uniforms(terrain_shader, scene, cam, aspect);
+        const Shader* current = &terrain_shader;
+        tiles.render([&](const TileRenderable& tile) {
+            bool hm = tile.mesh.is_heightmap();
+            if (hm && !m_has_hm_terrain) return;
+            const Shader& s = hm ? terrain_hm_shader : terrain_shader;
+            if (&s != current) { s.use(); current = &s; }
+
+            s.set_mat4("uModel", tile.model);
+            s.set_int("uUseSatelliteTex", tile.texture.valid() ? 1 : 0);
             if (tile.texture.valid()) {
                 tile.texture.bind(0);
-                terrain_shader.set_int("uSatelliteTex", 0);
+                s.set_int("uSatelliteTex", 0);
             }
             /* Bind GPU overlay textures if available (avoids mesh rebuild) */
-            terrain_shader.set_int("uUseOverlayTex", tile.overlay_tex_valid ? 1 : 0);
+            s.set_int("uUseOverlayTex", tile.overlay_tex_valid ? 1 : 0);
             if (tile.overlay_tex_valid) {
                 glActiveTexture(GL_TEXTURE1);
                 glBindTexture(GL_TEXTURE_2D, tile.overlay_vis_tex);
-                terrain_shader.set_int("uOverlayVisTex", 1);
+                s.set_int("uOverlayVisTex", 1);
                 glActiveTexture(GL_TEXTURE2);
                 glBindTexture(GL_TEXTURE_2D, tile.overlay_sig_tex);
-                terrain_shader.set_int("uOverlaySigTex", 2);
+                s.set_int("uOverlaySigTex", 2);
+                glActiveTexture(GL_TEXTURE0);
+            }
+            if (hm) {
+                const TerrainHeightmapParams& p = tile.mesh.heightmap_params();
+                glActiveTexture(GL_TEXTURE3);
+                glBindTexture(GL_TEXTURE_2D, tile.mesh.height_texture());
                 glActiveTexture(GL_TEXTURE0);
+                s.set_int("uHeightTex", 3);
+                s.set_ivec2("uGridSize", p.cols, p.rows);
+                s.set_vec2("uOrigin", p.origin);
+                s.set_vec2("uSpacing", p.spacing);
+                s.set_float("uHeightMin", p.height_min);
+                s.set_float("uHeightRange", p.height_range);
             }
             tile.mesh.draw();
         });
@@ -21,23 +21,28 @@ public:
 
     void set_wireframe(bool on);
     bool wireframe() const { return m_wireframe; }
+    bool has_heightmap_terrain() const { return m_has_hm_terrain; }
 
     Shader terrain_shader;
+    /* terrain_hm.vert + terrain.frag for heightmap tiles; optional */
+    Shader terrain_hm_shader;
     Shader flat_shader;
     Shader marker_shader;
     Shader sphere_shader;
 
 private:
     bool m_wireframe = false;
+    bool m_has_hm_terrain = false;
     std::string m_shader_dir;
 
-    void opaque_pass(const Scene& scene, const Camera& cam, float aspect);
+    void opaque_pass(const Scene& scene, const Camera& cam, float aspect, int screen_h);
     void transparent_pass(const Scene& scene, const Camera& cam, float aspect);
     void hud_pass(const Scene& scene, const Camera& cam,
                   int screen_w, int screen_h,
                   Hud* hud, const GeoProjection* proj,
                   bool node_placement_mode, bool show_controls);
     void setup_common_uniforms(Shader& s, const Camera& cam, float aspect);
+    void setup_tile_terrain_uniforms(Shader& s, const Scene& scene, const Camera& cam, float aspect);
 };
 
 } // namespace mesh3d
@@ -93,6 +93,12 @@ void Shader::set_int(const char* name, int v) const {
 void Shader::set_float(const char* name, float v) const {
     glUniform1f(glGetUniformLocation(m_program, name), v);
 }
+void Shader::set_vec2(const char* name, const glm::vec2& v) const {
+    glUniform2f(glGetUniformLocation(m_program, name), v.x, v.y);
+}
+void Shader::set_ivec2(const char* name, int x, int y) const {
+    glUniform2i(glGetUniformLocation(m_program, name), x, y);
+}
 void Shader::set_vec3(const char* name, const glm::vec3& v) const {
     glUniform3fv(glGetUniformLocation(m_program, name), 1, glm::value_ptr(v));
 }
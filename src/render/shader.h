@@ -18,6 +18,8 @@ public:
     /* Uniform setters */
     void set_int(const char* name, int v) const;
     void set_float(const char* name, float v) const;
+    void set_vec2(const char* name, const glm::vec2& v) const;
+    void set_ivec2(const char* name, int x, int y) const;
     void set_vec3(const char* name, const glm::vec3& v) const;
     void set_vec4(const char* name, const glm::vec4& v) const;
     void set_mat4(const char* name, const glm::mat4& m) const;
@@ -1,5 +1,6 @@
 #include "render/texture.h"
 #include "util/log.h"
+#include <algorithm>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -47,6 +48,28 @@ bool Texture::load_rgba(const unsigned char* data, int w, int h) {
     return true;
 }
 
+UploadOp Texture::allocate_rgba(const unsigned char* data, int w, int h) {
+    if (m_tex) glDeleteTextures(1, &m_tex);
+    int levels = 1;
+    while ((std::max(w, h) >> levels) > 0) ++levels;
+    glGenTextures(1, &m_tex);
+    glBindTexture(GL_TEXTURE_2D, m_tex);
+    glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, w, h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return UploadOp::texture(m_tex, data, w, h, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+}
+
+void Texture::generate_mipmaps() {
+    if (!m_tex) return;
+    glBindTexture(GL_TEXTURE_2D, m_tex);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture::bind(GLuint unit) const {
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(GL_TEXTURE_2D, m_tex);
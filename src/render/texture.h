@@ -1,5 +1,6 @@
 #pragma once
 #include <glad/glad.h>
+#include "render/upload_stream.h"
 #include <string>
 
 namespace mesh3d {
@@ -11,6 +12,11 @@ public:
 
     bool load(const std::string& path);
     bool load_rgba(const unsigned char* data, int w, int h);
+    /* Allocate RGBA8 storage with a full mip chain; the returned op fills
+       level 0 from `data` (which must outlive it). Call generate_mipmaps()
+       once it has run. */
+    UploadOp allocate_rgba(const unsigned char* data, int w, int h);
+    void generate_mipmaps();
     void bind(GLuint unit = 0) const;
     GLuint id() const { return m_tex; }
     bool valid() const { return m_tex != 0; }
@@ -0,0 +1,245 @@
+#include "render/upload_stream.h"
+#include "util/log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mesh3d {
+
+static constexpr size_t RING_ALIGN = 256;
+
+UploadOp UploadOp::buffer(GLuint buf, const void* src, size_t bytes, size_t dst_offset) {
+    UploadOp op;
+    op.kind = BUFFER;
+    op.target = buf;
+    op.src = static_cast<const uint8_t*>(src);
+    op.bytes = bytes;
+    op.dst_offset = dst_offset;
+    return op;
+}
+
+UploadOp UploadOp::texture(GLuint tex, const void* src, int w, int h,
+                           GLenum format, GLenum type, int pixel_bytes) {
+    UploadOp op;
+    op.kind = TEXTURE_2D;
+    op.target = tex;
+    op.src = static_cast<const uint8_t*>(src);
+    op.bytes = static_cast<size_t>(w) * h * pixel_bytes;
+    op.width = w;
+    op.height = h;
+    op.format = format;
+    op.type = type;
+    op.pixel_bytes = pixel_bytes;
+    return op;
+}
+
+/* Copy bytes [offset, offset + bytes) of `op` from `src` (a client pointer,
+   or an offset into the bound pixel unpack buffer). Texture slices are
+   whole rows. */
+static void issue_texture_rows(const UploadOp& op, size_t offset, size_t bytes, const void* src) {
+    size_t row_bytes = static_cast<size_t>(op.width) * op.pixel_bytes;
+    int row0 = static_cast<int>(offset / row_bytes);
+    int rows = static_cast<int>(bytes / row_bytes);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, op.target);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row0, op.width, rows, op.format, op.type, src);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void upload_now(const std::vector<UploadOp>& ops) {
+    for (auto& op : ops) {
+        if (op.bytes == 0) continue;
+        if (op.kind == UploadOp::TEXTURE_2D) {
+            issue_texture_rows(op, 0, op.bytes, op.src);
+        } else {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, op.target);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, op.dst_offset, op.bytes, op.src);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+    }
+}
+
+UploadStream::~UploadStream() {
+    for (auto& r : m_regions) glDeleteSync(r.fence);
+    if (m_ring) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_ring);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &m_ring);
+    }
+}
+
+void UploadStream::init() {
+    m_init = true;
+    m_window_start = std::chrono::steady_clock::now();
+    if (!GLAD_GL_ARB_buffer_storage) {
+        LOG_INFO("UploadStream: no buffer storage, uploading with glBufferSubData");
+        return;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &m_ring);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_ring);
+    glBufferStorage(GL_COPY_READ_BUFFER, RING_BYTES, nullptr, flags);
+    m_map = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, RING_BYTES, flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if (!m_map) {
+        LOG_WARN("UploadStream: persistent map failed, uploading with glBufferSubData");
+        glDeleteBuffers(1, &m_ring);
+        m_ring = 0;
+        return;
+    }
+    m_stats.persistent = true;
+    LOG_INFO("UploadStream: %zu MB persistent ring", RING_BYTES >> 20);
+}
+
+UploadStream::JobId UploadStream::submit(std::vector<UploadOp> ops) {
+    Job job;
+    job.id = m_next_id++;
+    job.ops = std::move(ops);
+    for (auto& op : job.ops) m_stats.pending_bytes += op.bytes;
+    m_jobs.push_back(std::move(job));
+    m_stats.pending_jobs = static_cast<int>(m_jobs.size());
+    return m_jobs.back().id;
+}
+
+void UploadStream::cancel(JobId id) {
+    auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [&](const Job& j) { return j.id == id; });
+    if (it == m_jobs.end()) return;
+    for (size_t i = it->op; i < it->ops.size(); ++i)
+        m_stats.pending_bytes -= it->ops[i].bytes - (i == it->op ? it->offset : 0);
+    m_jobs.erase(it);
+    m_stats.pending_jobs = static_cast<int>(m_jobs.size());
+}
+
+void UploadStream::clear() {
+    m_jobs.clear();
+    m_stats.pending_bytes = 0;
+    m_stats.pending_jobs = 0;
+}
+
+bool UploadStream::done(JobId id) const {
+    return std::none_of(m_jobs.begin(), m_jobs.end(), [&](const Job& j) { return j.id == id; });
+}
+
+void UploadStream::retire() {
+    while (!m_regions.empty()) {
+        GLenum r = glClientWaitSync(m_regions.front().fence, 0, 0);
+        if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(m_regions.front().fence);
+        m_in_flight -= m_regions.front().bytes;
+        m_regions.pop_front();
+    }
+}
+
+bool UploadStream::ring_alloc(size_t bytes, size_t& offset) {
+    /* Regions retire in allocation order, so the ring is a FIFO and the
+       free space is everything not in flight */
+    size_t start = (m_head + RING_ALIGN - 1) / RING_ALIGN * RING_ALIGN;
+    size_t consumed;
+    if (start + bytes <= RING_BYTES) {
+        consumed = start - m_head + bytes;
+    } else {
+        start = 0;                                 // wrap; the tail is wasted
+        consumed = RING_BYTES - m_head + bytes;
+    }
+    if (m_in_flight + m_frame_ring + consumed > RING_BYTES) return false;
+    m_frame_ring += consumed;
+    m_head = start + bytes;
+    offset = start;
+    return true;
+}
+
+void UploadStream::issue(const UploadOp& op, size_t offset, size_t bytes, size_t ring_off) {
+    if (!m_map) {
+        if (op.kind == UploadOp::TEXTURE_2D) {
+            issue_texture_rows(op, offset, bytes, op.src + offset);
+        } else {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, op.target);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, op.dst_offset + offset, bytes, op.src + offset);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        return;
+    }
+
+    std::memcpy(m_map + ring_off, op.src + offset, bytes);
+    if (op.kind == UploadOp::TEXTURE_2D) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_ring);
+        issue_texture_rows(op, offset, bytes, reinterpret_cast<const void*>(ring_off));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_ring);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, op.target);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            ring_off, op.dst_offset + offset, bytes);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+}
+
+void UploadStream::pump(size_t budget_bytes) {
+    if (!m_init) init();
+    if (m_map) retire();
+
+    size_t issued = 0;
+    m_frame_ring = 0;
+    while (!m_jobs.empty()) {
+        Job& job = m_jobs.front();
+        if (job.op >= job.ops.size()) {
+            m_jobs.pop_front();
+            continue;
+        }
+        const UploadOp& op = job.ops[job.op];
+        size_t remaining = op.bytes - job.offset;
+        if (remaining == 0) {
+            ++job.op;
+            job.offset = 0;
+            continue;
+        }
+
+        /* Slice size: what is left of the budget (one unit minimum on the
+           first slice), in whole rows for textures, capped by the ring */
+        size_t unit = op.kind == UploadOp::TEXTURE_2D
+                          ? static_cast<size_t>(op.width) * op.pixel_bytes : 1;
+        size_t left = budget_bytes > issued ? budget_bytes - issued : 0;
+        size_t chunk = std::min(remaining, left) / unit * unit;
+        if (chunk == 0 && issued == 0) chunk = std::min(remaining, unit);
+        if (m_map) chunk = std::min(chunk, (RING_BYTES / 2) / unit * unit);
+        if (chunk == 0) break;
+
+        /* Ring full of data the GPU has not consumed yet: next frame */
+        size_t ring_off = 0;
+        if (m_map && !ring_alloc(chunk, ring_off)) break;
+
+        issue(op, job.offset, chunk, ring_off);
+        job.offset += chunk;
+        issued += chunk;
+        m_stats.pending_bytes -= chunk;
+
+        if (job.offset >= op.bytes) {
+            ++job.op;
+            job.offset = 0;
+            if (job.op >= job.ops.size()) m_jobs.pop_front();  // done() from now on
+        }
+    }
+
+    if (m_map && m_frame_ring > 0) {
+        m_regions.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_frame_ring});
+        m_in_flight += m_frame_ring;
+        m_frame_ring = 0;
+    }
+
+    m_stats.frame_bytes = issued;
+    m_stats.total_bytes += issued;
+    m_stats.pending_jobs = static_cast<int>(m_jobs.size());
+    m_window_bytes += issued;
+    auto now = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(now - m_window_start).count();
+    if (secs >= 0.5) {
+        m_stats.mb_per_s = m_window_bytes / (1024.0 * 1024.0) / secs;
+        m_window_bytes = 0;
+        m_window_start = now;
+    }
+}
+
+} // namespace mesh3d
@@ -0,0 +1,115 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* One copy from CPU memory into already-allocated GL storage. `src` is
+   not owned and must stay valid until the op has been issued. */
+struct UploadOp {
+    enum Kind { BUFFER, TEXTURE_2D };
+
+    Kind kind = BUFFER;
+    GLuint target = 0;            // buffer or texture name
+    const uint8_t* src = nullptr;
+    size_t bytes = 0;
+    size_t dst_offset = 0;        // BUFFER: byte offset into target
+    int width = 0, height = 0;    // TEXTURE_2D: level 0, streamed in whole rows
+    GLenum format = 0, type = 0;
+    int pixel_bytes = 0;
+
+    static UploadOp buffer(GLuint buf, const void* src, size_t bytes, size_t dst_offset = 0);
+    static UploadOp texture(GLuint tex, const void* src, int w, int h,
+                            GLenum format, GLenum type, int pixel_bytes);
+};
+
+/* Issue `ops` immediately (the old synchronous behaviour) */
+void upload_now(const std::vector<UploadOp>& ops);
+
+struct UploadStats {
+    size_t frame_bytes = 0;       // copied by the last pump()
+    uint64_t total_bytes = 0;
+    double mb_per_s = 0.0;        // averaged over ~0.5 s windows
+    size_t pending_bytes = 0;
+    int pending_jobs = 0;
+    bool persistent = false;      // ring buffer path in use
+};
+
+/* Time-sliced GPU uploads for the render thread.
+
+   Jobs (lists of UploadOp) are copied in submission order, at most
+   `budget_bytes` per pump() call, so a tile's geometry and textures
+   spread over several frames instead of stalling one. With
+   ARB_buffer_storage (core in GL 4.4) data is staged through a
+   persistently mapped, coherent ring buffer and copied GPU-side
+   (glCopyBufferSubData / glTexSubImage2D from a pixel unpack buffer);
+   each frame's ring region is fenced and reused once the GPU is done
+   with it. Without it, slices go straight through glBufferSubData /
+   glTexSubImage2D.
+
+   A job is done once its last slice has been issued; GL command ordering
+   makes the data visible to any later draw. Main thread only. */
+class UploadStream {
+public:
+    using JobId = uint64_t;
+
+    static constexpr size_t RING_BYTES = 32u << 20;
+    static constexpr size_t DEFAULT_FRAME_BUDGET = 8u << 20;
+
+    UploadStream() = default;
+    ~UploadStream();
+
+    JobId submit(std::vector<UploadOp> ops);
+    /* Drop a job's remaining slices (its targets are about to be deleted) */
+    void cancel(JobId id);
+    void clear();
+    /* True once every slice of `id` has been issued (or it was cancelled) */
+    bool done(JobId id) const;
+
+    /* Copy up to budget_bytes of queued data. Call once per frame. At
+       least one slice is issued per call so oversized rows still progress. */
+    void pump(size_t budget_bytes = DEFAULT_FRAME_BUDGET);
+
+    const UploadStats& stats() const { return m_stats; }
+
+    UploadStream(const UploadStream&) = delete;
+    UploadStream& operator=(const UploadStream&) = delete;
+
+private:
+    struct Job {
+        JobId id;
+        std::vector<UploadOp> ops;
+        size_t op = 0;            // current op
+        size_t offset = 0;        // bytes of the current op already issued
+    };
+    struct Region {
+        GLsync fence;
+        size_t bytes;             // ring bytes (incl. padding) it holds
+    };
+
+    std::deque<Job> m_jobs;
+    JobId m_next_id = 1;
+
+    bool m_init = false;
+    GLuint m_ring = 0;
+    uint8_t* m_map = nullptr;
+    size_t m_head = 0;            // next free ring offset
+    size_t m_in_flight = 0;       // ring bytes not yet retired
+    size_t m_frame_ring = 0;      // ring bytes used by the current pump()
+    std::deque<Region> m_regions;
+
+    UploadStats m_stats;
+    std::chrono::steady_clock::time_point m_window_start{};
+    uint64_t m_window_bytes = 0;
+
+    void init();
+    void retire();
+    bool ring_alloc(size_t bytes, size_t& offset);
+    void issue(const UploadOp& op, size_t offset, size_t bytes, size_t ring_off);
+};
+
+} // namespace mesh3d
@@ -26,6 +26,10 @@ void Scene::clear() {
     viewshed_vis.clear();
     signal_strength.clear();
     overlap_count.clear();
+    coverage_cache.clear();
+    coverage_keys.clear();
+    coverage_queue.clear();
+    link_graph.clear();
     grid_rows = grid_cols = 0;
     tile_manager.clear();
     use_tile_system = false;
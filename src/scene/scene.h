@@ -2,6 +2,8 @@
 #include "render/mesh.h"
 #include "render/texture.h"
 #include "tile/tile_manager.h"
+#include "analysis/coverage_cache.h"
+#include "analysis/link_graph.h"
 #include <mesh3d/types.h>
 #include <glm/glm.hpp>
 #include <vector>
@@ -14,6 +16,12 @@ struct NodeData {
     glm::vec3 world_pos;
 };
 
+/* Node whose coverage an async GPU recompute still has to compute */
+struct PendingCoverage {
+    CoverageCache::Key key;
+    NodeData node;
+};
+
 struct Scene {
     /* Mode */
     mesh3d_render_mode_t  render_mode  = MESH3D_MODE_TERRAIN;
@@ -53,6 +61,16 @@ struct Scene {
     std::vector<float>   signal_strength; // merged signal (dBm)
     std::vector<uint8_t> overlap_count;
 
+    /* Per-node coverage of the elevation grid, so adding or removing a
+       node only computes what changed (see kick_viewshed_recompute) */
+    CoverageCache coverage_cache;
+    uint64_t terrain_hash = 0;                     // CoverageCache::hash_elevation(elevation)
+    std::vector<CoverageCache::Key> coverage_keys; // keys of `nodes` at the last kick
+    std::vector<PendingCoverage> coverage_queue;   // async GPU nodes still to compute
+
+    /* Node-to-node links (App::update_link_graph) */
+    LinkGraph link_graph;
+
     /* Receiver / display config */
     mesh3d_rf_config_t rf_config{-130.0f, 1.0f, 2.0f, 2.0f, -130.0f, -80.0f};
 
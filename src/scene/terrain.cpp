@@ -10,7 +10,7 @@ namespace mesh3d {
    Corrected: pos(3)+normal(3)+uv(2)+viewshed(1)+signal(1) = 10 */
 static constexpr int VERT_FLOATS = 10;
 
-static glm::vec3 calc_normal(const float* elev, int r, int c, int rows, int cols,
+glm::vec3 calc_terrain_normal(const float* elev, int r, int c, int rows, int cols,
                               float dx, float dz, float yscale) {
     auto h = [&](int rr, int cc) -> float {
         rr = std::clamp(rr, 0, rows - 1);
@@ -22,7 +22,7 @@ static glm::vec3 calc_normal(const float* elev, int r, int c, int rows, int cols
     return glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
 }
 
-Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj) {
+TerrainMeshData build_terrain_mesh_data(const TerrainBuildData& data, const GeoProjection& proj) {
     int rows = data.rows;
     int cols = data.cols;
     float w = proj.width_m(data.bounds);
@@ -39,8 +39,11 @@ Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj)
     float x_start = nw.x; // west edge
     float z_start = nw.z; // north edge
 
+    TerrainMeshData md;
+
     /* Vertices */
-    std::vector<float> verts(rows * cols * VERT_FLOATS);
+    std::vector<float>& verts = md.vertices;
+    verts.resize(rows * cols * VERT_FLOATS);
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
             int vi = (r * cols + c) * VERT_FLOATS;
@@ -52,7 +55,7 @@ Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj)
             float z = z_start + r * dz;
             float y = data.elevation[r * cols + c] * yscale;
 
-            glm::vec3 n = calc_normal(data.elevation, r, c, rows, cols, dx, dz, yscale);
+            glm::vec3 n = calc_terrain_normal(data.elevation, r, c, rows, cols, dx, dz, yscale);
 
             float vis = 0.0f;
             float sig = -999.0f;
@@ -73,7 +76,7 @@ Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj)
     }
 
     /* Indices (two triangles per quad) */
-    std::vector<uint32_t> indices;
+    std::vector<uint32_t>& indices = md.indices;
     indices.reserve((rows - 1) * (cols - 1) * 6);
     for (int r = 0; r < rows - 1; ++r) {
         for (int c = 0; c < cols - 1; ++c) {
@@ -89,7 +92,10 @@ Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj)
             indices.push_back(br);
         }
     }
+    return md;
+}
 
+Mesh upload_terrain_mesh(const TerrainMeshData& md) {
     Mesh mesh;
     GLsizei stride = VERT_FLOATS * sizeof(float);
     std::vector<Mesh::Attrib> attribs = {
@@ -99,11 +105,15 @@ Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj)
         {3, 1, GL_FLOAT, stride, 8 * sizeof(float)},        // viewshed
         {4, 1, GL_FLOAT, stride, 9 * sizeof(float)},        // signal_dbm
     };
-    mesh.upload(verts.data(), verts.size() * sizeof(float), attribs,
-                indices.data(), indices.size() * sizeof(uint32_t));
+    mesh.upload(md.vertices.data(), md.vertices.size() * sizeof(float), attribs,
+                md.indices.data(), md.indices.size() * sizeof(uint32_t));
     return mesh;
 }
 
+Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj) {
+    return upload_terrain_mesh(build_terrain_mesh_data(data, proj));
+}
+
 Mesh build_flat_mesh(int rows, int cols, float width_m, float height_m) {
     float dx = width_m / (cols - 1);
     float dz = height_m / (rows - 1);
@@ -1,7 +1,9 @@
 #pragma once
 #include "render/mesh.h"
 #include <mesh3d/types.h>
+#include <glm/glm.hpp>
 #include <vector>
+#include <cstdint>
 
 namespace mesh3d {
 
@@ -28,6 +30,22 @@ struct TerrainBuildData {
     const float*   signal;      // rows x cols (dBm)
 };
 
+/* CPU-side terrain geometry: interleaved vertices (layout above)
+   plus a triangle-list index buffer. Needs no GL context. */
+struct TerrainMeshData {
+    std::vector<float>    vertices;
+    std::vector<uint32_t> indices;
+};
+
+/* Central-difference surface normal at sample (r, c); dx/dz are the
+   sample spacings in meters, edges clamp */
+glm::vec3 calc_terrain_normal(const float* elev, int r, int c, int rows, int cols,
+                              float dx, float dz, float yscale);
+
+TerrainMeshData build_terrain_mesh_data(const TerrainBuildData& data, const GeoProjection& proj);
+Mesh upload_terrain_mesh(const TerrainMeshData& md);
+
+/* build_terrain_mesh_data() + upload_terrain_mesh() */
 Mesh build_terrain_mesh(const TerrainBuildData& data, const GeoProjection& proj);
 Mesh build_flat_mesh(int rows, int cols, float width_m, float height_m);
 
@@ -0,0 +1,586 @@
+#include "scene/terrain_lod.h"
+#include "camera/camera.h"
+#include "util/math_util.h"
+#include "util/log.h"
+#include "util/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace mesh3d {
+
+enum { SIDE_N = 0, SIDE_S = 1, SIDE_W = 2, SIDE_E = 3 };
+
+static constexpr float SKIRT_MARGIN_M = 1.0f; // skirt bottom below the chunk's lowest sample
+
+static uint32_t pack_normal(const glm::vec3& n) {
+    auto q = [](float f) {
+        return static_cast<uint32_t>(std::lrint(std::clamp(f, -1.0f, 1.0f) * 511.0f)) & 0x3FFu;
+    };
+    return q(n.x) | (q(n.y) << 10) | (q(n.z) << 20);
+}
+
+static uint16_t to_unorm16(float f) {
+    return static_cast<uint16_t>(std::lrint(std::clamp(f, 0.0f, 1.0f) * 65535.0f));
+}
+
+/* ── Shared index buffer ─────────────────────────────────────────── */
+
+namespace {
+
+struct IndexRange {
+    uint32_t first = 0, count = 0;
+};
+
+/* Index lists for every (level, stitch mask) patch and every (level, side)
+   skirt of a chunk block, concatenated into one GL buffer. */
+struct LodIndexBuffer {
+    GLuint ebo = 0;
+    IndexRange patch[LOD_LEVELS][16];
+    IndexRange skirt[LOD_LEVELS][4];
+};
+
+uint16_t grid_index(int r, int c) {
+    return static_cast<uint16_t>(r * LOD_CHUNK_VERTS + c);
+}
+
+uint16_t skirt_index(int side, int i) {
+    return static_cast<uint16_t>(LOD_GRID_VERTS + side * LOD_CHUNK_VERTS + i);
+}
+
+/* Triangles of a level-l chunk. A set bit in `mask` (1 << side) means the
+   neighbour on that side is one level coarser: every other edge vertex is
+   collapsed onto its predecessor, so the edge is made of the neighbour's
+   segments and no T-junction is left. */
+void append_patch(int level, int mask, std::vector<uint16_t>& out) {
+    const int s = 1 << level;
+    auto vertex = [&](int r, int c) {
+        if ((mask & (1 << SIDE_N)) && r == 0 && (c / s) % 2) c -= s;
+        if ((mask & (1 << SIDE_S)) && r == LOD_CHUNK_QUADS && (c / s) % 2) c -= s;
+        if ((mask & (1 << SIDE_W)) && c == 0 && (r / s) % 2) r -= s;
+        if ((mask & (1 << SIDE_E)) && c == LOD_CHUNK_QUADS && (r / s) % 2) r -= s;
+        return grid_index(r, c);
+    };
+    auto tri = [&](uint16_t a, uint16_t b, uint16_t c) {
+        if (a == b || b == c || a == c) return;
+        out.push_back(a); out.push_back(b); out.push_back(c);
+    };
+    for (int r = 0; r < LOD_CHUNK_QUADS; r += s) {
+        for (int c = 0; c < LOD_CHUNK_QUADS; c += s) {
+            uint16_t tl = vertex(r, c), tr = vertex(r, c + s);
+            uint16_t bl = vertex(r + s, c), br = vertex(r + s, c + s);
+            tri(tl, bl, tr);
+            tri(tr, bl, br);
+        }
+    }
+}
+
+/* Vertical strip from a chunk edge down to its skirt row, both windings
+   so it is visible from either side with back-face culling on */
+void append_skirt(int level, int side, std::vector<uint16_t>& out) {
+    const int s = 1 << level;
+    auto edge = [&](int i) {
+        switch (side) {
+        case SIDE_N: return grid_index(0, i);
+        case SIDE_S: return grid_index(LOD_CHUNK_QUADS, i);
+        case SIDE_W: return grid_index(i, 0);
+        default:     return grid_index(i, LOD_CHUNK_QUADS);
+        }
+    };
+    for (int i = 0; i < LOD_CHUNK_QUADS; i += s) {
+        uint16_t a = edge(i), b = edge(i + s);
+        uint16_t a2 = skirt_index(side, i), b2 = skirt_index(side, i + s);
+        uint16_t quad[12] = {a, a2, b, b, a2, b2,   a, b, a2, b, b2, a2};
+        out.insert(out.end(), quad, quad + 12);
+    }
+}
+
+/* Created on first use with a current GL context and kept for the process
+   lifetime; it is shared by every tile VAO. */
+const LodIndexBuffer& lod_indices() {
+    static LodIndexBuffer buf;
+    if (buf.ebo) return buf;
+
+    std::vector<uint16_t> all;
+    for (int l = 0; l < LOD_LEVELS; ++l) {
+        for (int mask = 0; mask < 16; ++mask) {
+            buf.patch[l][mask].first = static_cast<uint32_t>(all.size());
+            /* The coarsest level never has a coarser neighbour */
+            append_patch(l, l + 1 < LOD_LEVELS ? mask : 0, all);
+            buf.patch[l][mask].count = static_cast<uint32_t>(all.size()) - buf.patch[l][mask].first;
+        }
+        for (int side = 0; side < 4; ++side) {
+            buf.skirt[l][side].first = static_cast<uint32_t>(all.size());
+            append_skirt(l, side, all);
+            buf.skirt[l][side].count = static_cast<uint32_t>(all.size()) - buf.skirt[l][side].first;
+        }
+    }
+
+    glGenBuffers(1, &buf.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, all.size() * sizeof(uint16_t), all.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    LOG_INFO("Terrain LOD index buffer: %zu indices (%zu KB)",
+             all.size(), all.size() * sizeof(uint16_t) / 1024);
+    return buf;
+}
+
+/* HEIGHTMAP vertices: (local col, local row, skirt flag) for one chunk
+   block, laid out like the LodVertex blocks so the same indices apply.
+   Shared by every heightmap tile; created lazily like lod_indices(). */
+GLuint lod_grid_vbo() {
+    static GLuint vbo = 0;
+    if (vbo) return vbo;
+
+    std::vector<float> grid(static_cast<size_t>(LOD_BLOCK_VERTS) * 3);
+    auto put = [&](int idx, int lc, int lr, float skirt) {
+        grid[idx * 3 + 0] = static_cast<float>(lc);
+        grid[idx * 3 + 1] = static_cast<float>(lr);
+        grid[idx * 3 + 2] = skirt;
+    };
+    for (int lr = 0; lr < LOD_CHUNK_VERTS; ++lr)
+        for (int lc = 0; lc < LOD_CHUNK_VERTS; ++lc)
+            put(grid_index(lr, lc), lc, lr, 0.0f);
+    for (int i = 0; i < LOD_CHUNK_VERTS; ++i) {
+        put(skirt_index(SIDE_N, i), i, 0, 1.0f);
+        put(skirt_index(SIDE_S, i), i, LOD_CHUNK_QUADS, 1.0f);
+        put(skirt_index(SIDE_W, i), 0, i, 1.0f);
+        put(skirt_index(SIDE_E, i), LOD_CHUNK_QUADS, i, 1.0f);
+    }
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return vbo;
+}
+
+} // namespace
+
+/* ── CPU build ───────────────────────────────────────────────────── */
+
+TerrainLodData build_terrain_lod_data(const TerrainBuildData& data, const GeoProjection& proj,
+                                      TerrainLodFormat format, ThreadPool* pool) {
+    TerrainLodData out;
+    out.format = format;
+    const int rows = data.rows, cols = data.cols;
+    if (rows < 2 || cols < 2 || !data.elevation) return out;
+
+    const float w = proj.width_m(data.bounds);
+    const float h = proj.height_m(data.bounds);
+    const float dx = w / (cols - 1);
+    const float dz = h / (rows - 1);
+    const float yscale = data.elevation_scale;
+    auto nw = proj.project(data.bounds.max_lat, data.bounds.min_lon);
+    const float x_start = nw.x; // west edge
+    const float z_start = nw.z; // north edge
+
+    auto parallel_for = [&](int count, const std::function<void(int)>& fn) {
+        if (pool) pool->parallel_for(count, fn);
+        else for (int i = 0; i < count; ++i) fn(i);
+    };
+
+    out.chunks_x = (cols - 2) / LOD_CHUNK_QUADS + 1;
+    out.chunks_z = (rows - 2) / LOD_CHUNK_QUADS + 1;
+    out.chunks.resize(static_cast<size_t>(out.chunks_x) * out.chunks_z);
+    const bool bake = format == TerrainLodFormat::VERTICES;
+    if (bake) {
+        out.vertices.resize(out.chunks.size() * LOD_BLOCK_VERTS);
+    } else {
+        /* Heights as unorm16 over the tile's own range: ~6 cm steps for
+           4 km of relief, half the size of R32F */
+        const int bands = (rows + LOD_CHUNK_QUADS - 1) / LOD_CHUNK_QUADS;
+        auto band_rows = [&](int b, size_t& begin, size_t& end) {
+            begin = static_cast<size_t>(b) * LOD_CHUNK_QUADS * cols;
+            end = static_cast<size_t>(std::min((b + 1) * LOD_CHUNK_QUADS, rows)) * cols;
+        };
+        std::vector<float> band_lo(bands), band_hi(bands);
+        parallel_for(bands, [&](int b) {
+            size_t begin, end;
+            band_rows(b, begin, end);
+            auto [lo, hi] = std::minmax_element(data.elevation + begin, data.elevation + end);
+            band_lo[b] = *lo;
+            band_hi[b] = *hi;
+        });
+        const float lo = *std::min_element(band_lo.begin(), band_lo.end());
+        const float hi = *std::max_element(band_hi.begin(), band_hi.end());
+
+        TerrainHeightmapParams& hm = out.heightmap;
+        hm.rows = rows;
+        hm.cols = cols;
+        hm.origin = glm::vec2(x_start, z_start);
+        hm.spacing = glm::vec2(dx, dz);
+        hm.height_min = lo * yscale;
+        hm.height_range = std::max((hi - lo) * yscale, 1e-3f);
+        out.heights.resize(static_cast<size_t>(rows) * cols);
+        parallel_for(bands, [&](int b) {
+            size_t begin, end;
+            band_rows(b, begin, end);
+            for (size_t i = begin; i < end; ++i)
+                out.heights[i] = to_unorm16((data.elevation[i] * yscale - hm.height_min) /
+                                            hm.height_range);
+        });
+    }
+
+    /* Chunks write disjoint blocks, so whole chunk rows run in parallel */
+    parallel_for(out.chunks_z, [&](int cz) {
+        for (int cx = 0; cx < out.chunks_x; ++cx) {
+            const int r0 = cz * LOD_CHUNK_QUADS, c0 = cx * LOD_CHUNK_QUADS;
+            const int r_last = std::min(r0 + LOD_CHUNK_QUADS, rows - 1);
+            const int c_last = std::min(c0 + LOD_CHUNK_QUADS, cols - 1);
+
+            /* Chunk-local sample with clamp padding past the grid edge */
+            auto sample = [&](int lr, int lc) {
+                int r = std::min(r0 + lr, r_last), c = std::min(c0 + lc, c_last);
+                return data.elevation[static_cast<size_t>(r) * cols + c];
+            };
+
+            size_t ci = static_cast<size_t>(cz) * out.chunks_x + cx;
+            TerrainChunk& chunk = out.chunks[ci];
+            chunk.row = cz;
+            chunk.col = cx;
+
+            float min_h = sample(0, 0), max_h = min_h;
+            for (int r = r0; r <= r_last; ++r) {
+                for (int c = c0; c <= c_last; ++c) {
+                    float e = data.elevation[static_cast<size_t>(r) * cols + c];
+                    min_h = std::min(min_h, e);
+                    max_h = std::max(max_h, e);
+                }
+            }
+            chunk.bbox_min = glm::vec3(x_start + c0 * dx, min_h * yscale, z_start + r0 * dz);
+            chunk.bbox_max = glm::vec3(x_start + c_last * dx, max_h * yscale, z_start + r_last * dz);
+
+            /* Geometric error per level: samples of level l-1 that level l
+               drops, measured against the bilinear surface of level l.
+               Taking the running max keeps the error monotonic. */
+            chunk.error[0] = 0.0f;
+            for (int l = 1; l < LOD_LEVELS; ++l) {
+                const int s = 1 << l, hs = s >> 1;
+                float err = 0.0f;
+                for (int lr = 0; lr <= LOD_CHUNK_QUADS; lr += hs) {
+                    int ra = (lr / s) * s, rb = std::min(ra + s, LOD_CHUNK_QUADS);
+                    float fr = rb > ra ? static_cast<float>(lr - ra) / (rb - ra) : 0.0f;
+                    for (int lc = 0; lc <= LOD_CHUNK_QUADS; lc += hs) {
+                        if (lr % s == 0 && lc % s == 0) continue;
+                        int ca = (lc / s) * s, cb = std::min(ca + s, LOD_CHUNK_QUADS);
+                        float fc = cb > ca ? static_cast<float>(lc - ca) / (cb - ca) : 0.0f;
+                        float top = sample(ra, ca) + fc * (sample(ra, cb) - sample(ra, ca));
+                        float bot = sample(rb, ca) + fc * (sample(rb, cb) - sample(rb, ca));
+                        err = std::max(err, std::fabs(sample(lr, lc) - (top + fr * (bot - top))));
+                    }
+                }
+                chunk.error[l] = std::max(chunk.error[l - 1], err * yscale);
+            }
+
+            if (!bake) continue; // heightmap tiles displace on the GPU
+
+            /* Grid vertices */
+            LodVertex* block = &out.vertices[ci * LOD_BLOCK_VERTS];
+            for (int lr = 0; lr < LOD_CHUNK_VERTS; ++lr) {
+                int r = std::min(r0 + lr, r_last);
+                for (int lc = 0; lc < LOD_CHUNK_VERTS; ++lc) {
+                    int c = std::min(c0 + lc, c_last);
+                    LodVertex& v = block[lr * LOD_CHUNK_VERTS + lc];
+                    v.x = x_start + c * dx;
+                    v.y = data.elevation[static_cast<size_t>(r) * cols + c] * yscale;
+                    v.z = z_start + r * dz;
+                    v.normal = pack_normal(calc_terrain_normal(data.elevation, r, c, rows, cols,
+                                                               dx, dz, yscale));
+                    v.u = to_unorm16(static_cast<float>(c) / (cols - 1));
+                    v.v = to_unorm16(static_cast<float>(r) / (rows - 1));
+                }
+            }
+
+            /* Skirt rows: copies of the edge vertices dropped below the chunk */
+            const float skirt_y = min_h * yscale - SKIRT_MARGIN_M;
+            for (int i = 0; i < LOD_CHUNK_VERTS; ++i) {
+                const int edge[4] = {grid_index(0, i), grid_index(LOD_CHUNK_QUADS, i),
+                                     grid_index(i, 0), grid_index(i, LOD_CHUNK_QUADS)};
+                for (int side = 0; side < 4; ++side) {
+                    LodVertex v = block[edge[side]];
+                    v.y = skirt_y;
+                    block[skirt_index(side, i)] = v;
+                }
+            }
+        }
+    });
+    return out;
+}
+
+/* ── GPU mesh ────────────────────────────────────────────────────── */
+
+TerrainLodMesh::~TerrainLodMesh() {
+    release();
+}
+
+void TerrainLodMesh::release() {
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+    if (m_vbo) glDeleteBuffers(1, &m_vbo);
+    if (m_indirect) glDeleteBuffers(1, &m_indirect);
+    if (m_height_tex) glDeleteTextures(1, &m_height_tex);
+    m_vao = m_vbo = m_indirect = m_height_tex = 0;
+    m_vbo_bytes = 0;
+}
+
+TerrainLodMesh::TerrainLodMesh(TerrainLodMesh&& o) noexcept {
+    *this = std::move(o);
+}
+
+TerrainLodMesh& TerrainLodMesh::operator=(TerrainLodMesh&& o) noexcept {
+    if (this != &o) {
+        release();
+        m_vao = o.m_vao; m_vbo = o.m_vbo; m_vbo_bytes = o.m_vbo_bytes;
+        m_height_tex = o.m_height_tex; m_indirect = o.m_indirect; m_hm = o.m_hm;
+        o.m_vao = o.m_vbo = o.m_indirect = o.m_height_tex = 0; o.m_vbo_bytes = 0;
+        m_chunks_x = o.m_chunks_x; m_chunks_z = o.m_chunks_z;
+        m_chunks = std::move(o.m_chunks);
+        m_levels = std::move(o.m_levels);
+        m_visible = std::move(o.m_visible);
+        m_visible_count = o.m_visible_count;
+        m_bbox_min = o.m_bbox_min;
+        m_bbox_max = o.m_bbox_max;
+        m_counts = std::move(o.m_counts);
+        m_offsets = std::move(o.m_offsets);
+        m_base_vertex = std::move(o.m_base_vertex);
+        m_commands = std::move(o.m_commands);
+        m_selected_indices = o.m_selected_indices;
+    }
+    return *this;
+}
+
+void TerrainLodMesh::upload(const TerrainLodData& data) {
+    upload_now(upload_deferred(data));
+}
+
+std::vector<UploadOp> TerrainLodMesh::upload_deferred(const TerrainLodData& data) {
+    release();
+    if (data.chunks.empty()) return {};
+
+    std::vector<UploadOp> ops;
+    if (data.format == TerrainLodFormat::HEIGHTMAP)
+        ops.push_back(upload_heightmap(data));
+    else
+        ops.push_back(upload_vertices(data));
+
+    m_chunks_x = data.chunks_x;
+    m_chunks_z = data.chunks_z;
+    m_chunks = data.chunks;
+    m_levels.assign(m_chunks.size(), 0);
+    m_visible.assign(m_chunks.size(), 1);
+    m_visible_count = static_cast<int>(m_chunks.size());
+
+    m_bbox_min = m_chunks[0].bbox_min;
+    m_bbox_max = m_chunks[0].bbox_max;
+    for (const TerrainChunk& ch : m_chunks) {
+        m_bbox_min = glm::min(m_bbox_min, ch.bbox_min);
+        m_bbox_max = glm::max(m_bbox_max, ch.bbox_max);
+    }
+    m_bbox_min.y -= SKIRT_MARGIN_M;
+    build_draw_list();
+    return ops;
+}
+
+UploadOp TerrainLodMesh::upload_vertices(const TerrainLodData& data) {
+    const LodIndexBuffer& ib = lod_indices();
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glBindVertexArray(m_vao);
+
+    m_vbo_bytes = data.vertices.size() * sizeof(LodVertex);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_vbo_bytes, nullptr, GL_STATIC_DRAW);
+
+    GLsizei stride = sizeof(LodVertex);
+    glEnableVertexAttribArray(0);  // position
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<const void*>(offsetof(LodVertex, x)));
+    glEnableVertexAttribArray(1);  // normal
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+                          reinterpret_cast<const void*>(offsetof(LodVertex, normal)));
+    glEnableVertexAttribArray(2);  // uv
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                          reinterpret_cast<const void*>(offsetof(LodVertex, u)));
+    /* Attributes 3/4 (viewshed, signal) stay disabled: overlay textures */
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.ebo);
+    glBindVertexArray(0);
+    return UploadOp::buffer(m_vbo, data.vertices.data(), m_vbo_bytes);
+}
+
+UploadOp TerrainLodMesh::upload_heightmap(const TerrainLodData& data) {
+    const LodIndexBuffer& ib = lod_indices();
+    const TerrainHeightmapParams& hm = data.heightmap;
+    m_hm = hm;
+
+    /* Height texture, fetched with texelFetch only */
+    glGenTextures(1, &m_height_tex);
+    glBindTexture(GL_TEXTURE_2D, m_height_tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16, hm.cols, hm.rows);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    /* Per-chunk instance data: sample offset and skirt height. Draw
+       commands select a chunk through base_instance. */
+    std::vector<float> inst(data.chunks.size() * 4);
+    for (size_t i = 0; i < data.chunks.size(); ++i) {
+        const TerrainChunk& ch = data.chunks[i];
+        inst[i * 4 + 0] = static_cast<float>(ch.col * LOD_CHUNK_QUADS);
+        inst[i * 4 + 1] = static_cast<float>(ch.row * LOD_CHUNK_QUADS);
+        inst[i * 4 + 2] = ch.bbox_min.y - SKIRT_MARGIN_M;
+        inst[i * 4 + 3] = 0.0f;
+    }
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_indirect);
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, lod_grid_vbo());
+    glEnableVertexAttribArray(0);  // local col, row, skirt flag
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, inst.size() * sizeof(float), inst.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(5);  // chunk origin + skirt y
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+    glVertexAttribDivisor(5, 1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_vbo_bytes = data.heights.size() * sizeof(uint16_t) + inst.size() * sizeof(float);
+    return UploadOp::texture(m_height_tex, data.heights.data(), hm.cols, hm.rows,
+                             GL_RED, GL_UNSIGNED_SHORT, sizeof(uint16_t));
+}
+
+void TerrainLodMesh::select_lod(const glm::vec3& eye, float pixels_per_radian, float pixel_error,
+                                const Frustum* frustum) {
+    if (m_chunks.empty()) return;
+
+    m_visible_count = 0;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        const TerrainChunk& ch = m_chunks[i];
+        /* Skirts hang below bbox_min; include them so border chunks seen
+           from below the rim are kept */
+        bool vis = !frustum ||
+                   frustum->intersects_aabb(ch.bbox_min - glm::vec3(0.0f, SKIRT_MARGIN_M, 0.0f),
+                                            ch.bbox_max);
+        m_visible[i] = vis ? 1 : 0;
+        m_visible_count += vis ? 1 : 0;
+
+        glm::vec3 d(std::max({ch.bbox_min.x - eye.x, 0.0f, eye.x - ch.bbox_max.x}),
+                    std::max({ch.bbox_min.y - eye.y, 0.0f, eye.y - ch.bbox_max.y}),
+                    std::max({ch.bbox_min.z - eye.z, 0.0f, eye.z - ch.bbox_max.z}));
+        float dist = std::max(glm::length(d), 1.0f);
+
+        /* Errors are monotonic in l: take the coarsest level within budget */
+        int level = 0;
+        for (int l = LOD_LEVELS - 1; l > 0; --l) {
+            if (ch.error[l] * pixels_per_radian / dist <= pixel_error) { level = l; break; }
+        }
+        m_levels[i] = static_cast<uint8_t>(level);
+    }
+
+    /* Neighbours may differ by at most one level so the stitch variants
+       apply; refine the coarser side until that holds */
+    bool changed = true;
+    for (int pass = 0; changed && pass < LOD_LEVELS; ++pass) {
+        changed = false;
+        for (int cz = 0; cz < m_chunks_z; ++cz) {
+            for (int cx = 0; cx < m_chunks_x; ++cx) {
+                uint8_t& lv = m_levels[static_cast<size_t>(cz) * m_chunks_x + cx];
+                auto limit = [&](int nz, int nx) {
+                    if (nz < 0 || nz >= m_chunks_z || nx < 0 || nx >= m_chunks_x) return;
+                    uint8_t n = m_levels[static_cast<size_t>(nz) * m_chunks_x + nx];
+                    if (lv > n + 1) { lv = static_cast<uint8_t>(n + 1); changed = true; }
+                };
+                limit(cz - 1, cx); limit(cz + 1, cx);
+                limit(cz, cx - 1); limit(cz, cx + 1);
+            }
+        }
+    }
+
+    build_draw_list();
+}
+
+void TerrainLodMesh::build_draw_list() {
+    const LodIndexBuffer& ib = lod_indices();
+    m_counts.clear();
+    m_offsets.clear();
+    m_base_vertex.clear();
+    m_commands.clear();
+    m_selected_indices = 0;
+
+    const bool indirect = m_height_tex != 0;
+    auto emit = [&](const IndexRange& range, size_t chunk) {
+        if (range.count == 0) return;
+        m_selected_indices += range.count;
+        if (indirect) {
+            m_commands.push_back({range.count, 1, range.first, 0, static_cast<GLuint>(chunk)});
+            return;
+        }
+        m_counts.push_back(static_cast<GLsizei>(range.count));
+        m_offsets.push_back(reinterpret_cast<const void*>(
+            static_cast<uintptr_t>(range.first) * sizeof(uint16_t)));
+        m_base_vertex.push_back(static_cast<GLint>(chunk * LOD_BLOCK_VERTS));
+    };
+
+    for (int cz = 0; cz < m_chunks_z; ++cz) {
+        for (int cx = 0; cx < m_chunks_x; ++cx) {
+            size_t i = static_cast<size_t>(cz) * m_chunks_x + cx;
+            if (!m_visible[i]) continue;
+            int lv = m_levels[i];
+            auto coarser = [&](int nz, int nx) {
+                return nz >= 0 && nz < m_chunks_z && nx >= 0 && nx < m_chunks_x &&
+                       m_levels[static_cast<size_t>(nz) * m_chunks_x + nx] == lv + 1;
+            };
+            int mask = (coarser(cz - 1, cx) ? 1 << SIDE_N : 0) |
+                       (coarser(cz + 1, cx) ? 1 << SIDE_S : 0) |
+                       (coarser(cz, cx - 1) ? 1 << SIDE_W : 0) |
+                       (coarser(cz, cx + 1) ? 1 << SIDE_E : 0);
+            emit(ib.patch[lv][mask], i);
+
+            /* Skirts only where the chunk touches the tile border */
+            if (cz == 0)              emit(ib.skirt[lv][SIDE_N], i);
+            if (cz == m_chunks_z - 1) emit(ib.skirt[lv][SIDE_S], i);
+            if (cx == 0)              emit(ib.skirt[lv][SIDE_W], i);
+            if (cx == m_chunks_x - 1) emit(ib.skirt[lv][SIDE_E], i);
+        }
+    }
+
+    if (indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commands.size() * sizeof(DrawCommand),
+                     m_commands.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
+
+void TerrainLodMesh::draw() const {
+    if (!m_vao) return;
+    if (m_height_tex) {
+        if (m_commands.empty()) return;
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr,
+                                    static_cast<GLsizei>(m_commands.size()), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+        return;
+    }
+    if (m_counts.empty()) return;
+    glBindVertexArray(m_vao);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_counts.data(), GL_UNSIGNED_SHORT,
+                                  m_offsets.data(), static_cast<GLsizei>(m_counts.size()),
+                                  m_base_vertex.data());
+    glBindVertexArray(0);
+}
+
+} // namespace mesh3d
@@ -0,0 +1,176 @@
+#pragma once
+#include "scene/terrain.h"
+#include "render/upload_stream.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <mesh3d/types.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace mesh3d {
+
+struct GeoProjection;
+struct Frustum;
+class ThreadPool;
+
+/* Chunked geomipmap terrain for tile rendering.
+
+   A tile's elevation grid is cut into chunks of LOD_CHUNK_QUADS x
+   LOD_CHUNK_QUADS quads. Every chunk owns a LOD_CHUNK_VERTS^2 block of
+   full-resolution vertices (edge chunks are padded by clamping, which
+   only produces degenerate triangles) plus one row of skirt vertices per
+   side. Because every block has the same layout, all chunks of all tiles
+   draw from one shared uint16 index buffer: level l uses every 2^l-th
+   vertex, with variants that stitch an edge to a neighbour one level
+   coarser, so chunks inside a tile meet without cracks. Tile borders,
+   where the neighbouring tile may pick any level (or have a different
+   resolution), are closed by skirts hanging below the chunk's lowest
+   sample.
+
+   Each frame, select_lod() picks per chunk the coarsest level whose
+   precomputed geometric error projects to at most `pixel_error` pixels,
+   limits neighbouring chunks to one level apart, and builds the draw list
+   that draw() submits in a single multi-draw call.
+
+   Two storage formats share the chunking, indices and selection:
+   VERTICES bakes every sample into a LodVertex; HEIGHTMAP keeps only an
+   R16 height texture per tile and draws every chunk from one shared grid
+   buffer, with terrain_hm.vert displacing heights and computing normals
+   (about a tenth of the GPU memory and no per-vertex CPU work; GL 4.3). */
+
+constexpr int LOD_CHUNK_QUADS = 64;
+constexpr int LOD_CHUNK_VERTS = LOD_CHUNK_QUADS + 1;
+constexpr int LOD_LEVELS = 7;                              // step 1 .. 64
+constexpr int LOD_GRID_VERTS = LOD_CHUNK_VERTS * LOD_CHUNK_VERTS;
+constexpr int LOD_BLOCK_VERTS = LOD_GRID_VERTS + 4 * LOD_CHUNK_VERTS; // + skirts
+
+/* 20-byte tile vertex: position, packed normal, normalized uv.
+   Viewshed/signal come from overlay textures in tile mode. */
+struct LodVertex {
+    float x, y, z;
+    uint32_t normal;        // GL_INT_2_10_10_10_REV, normalized
+    uint16_t u, v;          // GL_UNSIGNED_SHORT, normalized
+};
+static_assert(sizeof(LodVertex) == 20, "LodVertex must stay tightly packed");
+
+struct TerrainChunk {
+    int row, col;                  // chunk grid position within the tile
+    glm::vec3 bbox_min, bbox_max;  // world space, skirts excluded
+    float error[LOD_LEVELS];       // max vertical error (m) when drawn at level l
+};
+
+enum class TerrainLodFormat {
+    VERTICES,    // baked LodVertex blocks
+    HEIGHTMAP,   // R16 height texture + shared grid, displaced on the GPU
+};
+
+/* Sample-grid placement and height encoding of a HEIGHTMAP tile */
+struct TerrainHeightmapParams {
+    int rows = 0, cols = 0;
+    glm::vec2 origin{0.0f};          // world x, z of sample (0, 0)
+    glm::vec2 spacing{1.0f};         // meters between samples along x, z
+    float height_min = 0.0f;         // world y of texel value 0
+    float height_range = 1.0f;       // world y span of texel values 0..1
+};
+
+/* CPU-side LOD terrain for one tile. Needs no GL context. */
+struct TerrainLodData {
+    TerrainLodFormat format = TerrainLodFormat::VERTICES;
+    int chunks_x = 0, chunks_z = 0;
+    std::vector<TerrainChunk> chunks;     // row-major, chunks_z x chunks_x
+
+    /* VERTICES: chunks_x * chunks_z blocks of LOD_BLOCK_VERTS */
+    std::vector<LodVertex> vertices;
+
+    /* HEIGHTMAP: rows x cols unorm16 heights */
+    std::vector<uint16_t> heights;
+    TerrainHeightmapParams heightmap;
+};
+
+/* Safe to call from any thread. With a pool, chunk rows (and height rows)
+   are built in parallel; nested calls from a pool task run inline. */
+TerrainLodData build_terrain_lod_data(const TerrainBuildData& data, const GeoProjection& proj,
+                                      TerrainLodFormat format = TerrainLodFormat::VERTICES,
+                                      ThreadPool* pool = nullptr);
+
+/* GPU side of TerrainLodData: the tile's VBO or height texture, the
+   shared LOD buffers, and the per-frame chunk selection. Main thread only. */
+class TerrainLodMesh {
+public:
+    TerrainLodMesh() = default;
+    ~TerrainLodMesh();
+
+    void upload(const TerrainLodData& data);
+
+    /* Create all GL objects but leave the vertex buffer / height texture
+       contents to the returned ops (e.g. for UploadStream). They read from
+       `data`, which must outlive them; don't draw until they have run. */
+    std::vector<UploadOp> upload_deferred(const TerrainLodData& data);
+
+    /* Choose a level per chunk for a camera at `eye`. `pixels_per_radian`
+       is viewport_height / (2 * tan(fovy / 2)). Chunks outside `frustum`
+       (if given) still take part in stitching but are not drawn. */
+    void select_lod(const glm::vec3& eye, float pixels_per_radian, float pixel_error,
+                    const Frustum* frustum = nullptr);
+
+    /* Draw the chunks chosen by the last select_lod() (level 0 if never called) */
+    void draw() const;
+
+    bool valid() const { return m_vao != 0; }
+    bool is_heightmap() const { return m_height_tex != 0; }
+    /* HEIGHTMAP only: bind to a sampler feeding terrain_hm.vert */
+    GLuint height_texture() const { return m_height_tex; }
+    const TerrainHeightmapParams& heightmap_params() const { return m_hm; }
+    int chunk_count() const { return static_cast<int>(m_chunks.size()); }
+    /* Chunks drawn by the current selection */
+    int visible_chunk_count() const { return m_visible_count; }
+    /* Whole tile in world space, skirts included */
+    const glm::vec3& bbox_min() const { return m_bbox_min; }
+    const glm::vec3& bbox_max() const { return m_bbox_max; }
+    const std::vector<TerrainChunk>& chunks() const { return m_chunks; }
+    /* Triangles submitted by the current selection (incl. degenerates) */
+    size_t triangle_count() const { return m_selected_indices / 3; }
+    size_t gpu_bytes() const { return m_vbo_bytes; }
+
+    TerrainLodMesh(const TerrainLodMesh&) = delete;
+    TerrainLodMesh& operator=(const TerrainLodMesh&) = delete;
+    TerrainLodMesh(TerrainLodMesh&& o) noexcept;
+    TerrainLodMesh& operator=(TerrainLodMesh&& o) noexcept;
+
+private:
+    GLuint m_vao = 0, m_vbo = 0;
+    size_t m_vbo_bytes = 0;
+
+    /* HEIGHTMAP: m_vbo holds per-chunk instance data, the height texture
+       the samples, and the indirect buffer the per-frame draw commands */
+    GLuint m_height_tex = 0, m_indirect = 0;
+    TerrainHeightmapParams m_hm;
+    int m_chunks_x = 0, m_chunks_z = 0;
+    std::vector<TerrainChunk> m_chunks;
+    std::vector<uint8_t> m_levels;
+    std::vector<uint8_t> m_visible;       // per chunk, from the last select_lod()
+    int m_visible_count = 0;
+    glm::vec3 m_bbox_min{0.0f}, m_bbox_max{0.0f};
+
+    /* glMultiDrawElementsBaseVertex arguments (VERTICES) */
+    std::vector<GLsizei> m_counts;
+    std::vector<const void*> m_offsets;
+    std::vector<GLint> m_base_vertex;
+
+    /* glMultiDrawElementsIndirect commands (HEIGHTMAP) */
+    struct DrawCommand {
+        GLuint count, instance_count, first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+    std::vector<DrawCommand> m_commands;
+    size_t m_selected_indices = 0;
+
+    void release();
+    UploadOp upload_vertices(const TerrainLodData& data);
+    UploadOp upload_heightmap(const TerrainLodData& data);
+    void build_draw_list();
+};
+
+} // namespace mesh3d
@@ -1,6 +1,7 @@
 #include "tile/async_loader.h"
 #include "tile/tile_provider.h"
 #include "util/log.h"
+#include <algorithm>
 
 namespace mesh3d {
 
@@ -11,24 +12,81 @@ AsyncLoader::~AsyncLoader() {
 void AsyncLoader::start() {
     if (m_running.load()) return;
     m_running.store(true);
-    m_thread = std::thread(&AsyncLoader::worker_loop, this);
-    LOG_INFO("AsyncLoader: worker thread started");
+    for (int i = 0; i < m_local_workers; ++i)
+        m_threads.emplace_back(&AsyncLoader::worker_loop, this, LOCAL);
+    for (int i = 0; i < m_network_workers; ++i)
+        m_threads.emplace_back(&AsyncLoader::worker_loop, this, NETWORK);
+    LOG_INFO("AsyncLoader: %d local + %d network workers started",
+             m_local_workers, m_network_workers);
 }
 
 void AsyncLoader::stop() {
     if (!m_running.load()) return;
-    m_running.store(false);
-    m_req_cv.notify_all();
-    if (m_thread.joinable()) m_thread.join();
-    LOG_INFO("AsyncLoader: worker thread stopped");
+    {
+        /* Flip under the lock so no worker misses the wakeup between
+           checking the predicate and going to sleep */
+        std::lock_guard<std::mutex> lock(m_req_mutex);
+        m_running.store(false);
+    }
+    for (auto& cv : m_req_cv) cv.notify_all();
+    for (auto& t : m_threads)
+        if (t.joinable()) t.join();
+    m_threads.clear();
+    LOG_INFO("AsyncLoader: workers stopped");
+}
+
+void AsyncLoader::set_workers(int local_workers, int network_workers) {
+    local_workers = std::max(local_workers, 1);
+    network_workers = std::max(network_workers, 1);
+    if (local_workers == m_local_workers && network_workers == m_network_workers) return;
+
+    bool was_running = m_running.load();
+    stop();
+    m_local_workers = local_workers;
+    m_network_workers = network_workers;
+    if (was_running) start();
+}
+
+void AsyncLoader::set_prepare(PrepareFn fn) {
+    auto p = fn ? std::make_shared<const PrepareFn>(std::move(fn)) : nullptr;
+    std::lock_guard<std::mutex> lock(m_req_mutex);
+    m_prepare = std::move(p);
 }
 
-void AsyncLoader::request(const TileCoord& coord, TileProvider* provider) {
+void AsyncLoader::request(const TileCoord& coord, TileProvider* provider, double priority) {
+    /* Already known: reprioritize if still waiting, else nothing to do */
+    auto known = [&]() {
+        auto queued = m_queued_lane.find(coord);
+        if (queued != m_queued_lane.end()) {
+            for (auto& r : m_requests[queued->second]) {
+                if (r.coord == coord) { r.priority = priority; break; }
+            }
+            return true;
+        }
+        return m_pending_set.count(coord) > 0; // in-flight or awaiting drain
+    };
+    {
+        std::lock_guard<std::mutex> lock(m_req_mutex);
+        if (known()) return;
+    }
+
+    /* Route new requests only, outside the lock: is_local() may touch the
+       filesystem */
+    Lane lane = (!provider || provider->is_local(coord)) ? LOCAL : NETWORK;
+
     std::lock_guard<std::mutex> lock(m_req_mutex);
-    if (m_pending_set.count(coord)) return; // already queued or in-flight
+    if (known()) return;
     m_pending_set.insert(coord);
-    m_requests.push_back({coord, provider});
-    m_req_cv.notify_one();
+    m_queued_lane[coord] = lane;
+    m_requests[lane].push_back({coord, provider, priority, m_next_seq++});
+    m_req_cv[lane].notify_one();
+}
+
+void AsyncLoader::reprepare(TileData data) {
+    std::lock_guard<std::mutex> lock(m_req_mutex);
+    m_pending_set.insert(data.coord);
+    m_reprepare.push_back(std::move(data));
+    m_req_cv[LOCAL].notify_one();
 }
 
 bool AsyncLoader::poll_result(TileData& out) {
@@ -53,25 +111,92 @@ bool AsyncLoader::is_pending(const TileCoord& coord) const {
     return m_pending_set.count(coord) > 0;
 }
 
+size_t AsyncLoader::cancel_except(TileProvider* provider,
+                                  const std::unordered_set<TileCoord>& keep) {
+    std::lock_guard<std::mutex> lock(m_req_mutex);
+    size_t cancelled = 0;
+    for (auto& queue : m_requests) {
+        auto drop = std::remove_if(queue.begin(), queue.end(), [&](const Request& r) {
+            if (r.provider != provider || keep.count(r.coord)) return false;
+            m_pending_set.erase(r.coord);
+            m_queued_lane.erase(r.coord);
+            return true;
+        });
+        cancelled += static_cast<size_t>(queue.end() - drop);
+        queue.erase(drop, queue.end());
+    }
+    if (cancelled)
+        LOG_DEBUG("AsyncLoader: cancelled %zu out-of-view requests", cancelled);
+    return cancelled;
+}
+
 void AsyncLoader::clear_pending() {
     std::lock_guard<std::mutex> lock(m_req_mutex);
-    m_requests.clear();
+    for (auto& queue : m_requests) queue.clear();
+    m_reprepare.clear();
+    m_queued_lane.clear();
     m_pending_set.clear();
 }
 
-void AsyncLoader::worker_loop() {
-    while (m_running.load()) {
+size_t AsyncLoader::queued_local() const {
+    std::lock_guard<std::mutex> lock(m_req_mutex);
+    return m_requests[LOCAL].size();
+}
+
+size_t AsyncLoader::queued_network() const {
+    std::lock_guard<std::mutex> lock(m_req_mutex);
+    return m_requests[NETWORK].size();
+}
+
+void AsyncLoader::worker_loop(Lane lane) {
+    auto& queue = m_requests[lane];
+
+    while (true) {
         Request req;
+        std::shared_ptr<const PrepareFn> prepare;
+        std::optional<TileData> result;
 
         {
             std::unique_lock<std::mutex> lock(m_req_mutex);
-            m_req_cv.wait(lock, [this] {
-                return !m_requests.empty() || !m_running.load();
+            m_req_cv[lane].wait(lock, [&] {
+                return !queue.empty() || (lane == LOCAL && !m_reprepare.empty()) ||
+                       !m_running.load();
             });
-            if (!m_running.load() && m_requests.empty()) break;
-            if (m_requests.empty()) continue;
-            req = std::move(m_requests.front());
-            m_requests.pop_front();
+            if (!m_running.load()) break;
+
+            prepare = m_prepare;
+
+            /* Already fetched: only the prepare hook is left to run */
+            if (lane == LOCAL && !m_reprepare.empty()) {
+                result = std::move(m_reprepare.front());
+                m_reprepare.pop_front();
+            } else {
+                auto best = std::min_element(queue.begin(), queue.end(),
+                    [](const Request& a, const Request& b) {
+                        return a.priority < b.priority ||
+                               (a.priority == b.priority && a.seq < b.seq);
+                    });
+                req = *best;
+                *best = queue.back();
+                queue.pop_back();
+                m_queued_lane.erase(req.coord);
+            }
+        }
+
+        if (result) {
+            try {
+                if (prepare) (*prepare)(*result);
+            } catch (const std::exception& e) {
+                /* Drop it; the tile is requested again while visible */
+                LOG_ERROR("AsyncLoader: prepare failed for z=%d x=%d y=%d: %s",
+                          result->coord.z, result->coord.x, result->coord.y, e.what());
+                std::lock_guard<std::mutex> lock(m_req_mutex);
+                m_pending_set.erase(result->coord);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_result_mutex);
+            m_results.push_back(std::move(*result));
+            continue;
         }
 
         /* Safety: skip if provider was nulled out (e.g. source changed) */
@@ -83,9 +208,9 @@ void AsyncLoader::worker_loop() {
 
         /* Fetch tile (may block on network/disk I/O).
            The provider checks its disk cache before downloading. */
-        std::optional<TileData> result;
         try {
             result = req.provider->fetch_tile(req.coord);
+            if (result && prepare) (*prepare)(*result);
         } catch (const std::exception& e) {
             LOG_ERROR("AsyncLoader: fetch_tile failed for z=%d x=%d y=%d: %s",
                       req.coord.z, req.coord.x, req.coord.y, e.what());
@@ -5,29 +5,68 @@
 #include <mutex>
 #include <condition_variable>
 #include <deque>
+#include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <cstdint>
 
 namespace mesh3d {
 
 class TileProvider;
 
-/* Background I/O thread for tile fetching.
+/* Background I/O workers for tile fetching.
    Main thread enqueues requests and drains results each frame.
-   The worker thread calls TileProvider::fetch_tile() which may do
-   network I/O, disk reads, and decompression. */
+   Workers call TileProvider::fetch_tile(), which may do network I/O,
+   disk reads, and decompression.
+
+   Requests are split into two lanes when enqueued: tiles the provider
+   can serve without the network (TileProvider::is_local()) go to the
+   local lane, everything else to the network lane. Each lane has its own
+   workers, so a slow download never holds up a disk-cache hit. Within a
+   lane the request with the lowest priority value (typically distance
+   from the camera) is fetched first.
+
+   An optional prepare hook runs on the worker after each successful
+   fetch, so CPU post-processing (terrain mesh generation) stays off the
+   main thread too. */
 class AsyncLoader {
 public:
+    static constexpr int DEFAULT_LOCAL_WORKERS = 1;
+    static constexpr int DEFAULT_NETWORK_WORKERS = 4;
+
+    using PrepareFn = std::function<void(TileData&)>;
+
     AsyncLoader() = default;
     ~AsyncLoader();
 
-    /* Launch worker thread */
+    /* Launch worker threads */
     void start();
-    /* Signal worker to stop and join */
+    /* Signal workers to stop and join. Queued requests are kept. */
     void stop();
 
-    /* Enqueue a tile fetch request (thread-safe, non-blocking) */
-    void request(const TileCoord& coord, TileProvider* provider);
+    /* Worker counts per lane (clamped to >= 1). Restarts the workers if
+       they are running; in-flight fetches finish first. */
+    void set_workers(int local_workers, int network_workers);
+    int local_workers() const { return m_local_workers; }
+    int network_workers() const { return m_network_workers; }
+
+    /* Hook run on fetched tiles before they are queued as results
+       (thread-safe). Fetches already past the hook keep the old one. */
+    void set_prepare(PrepareFn fn);
+
+    /* Enqueue a tile fetch request (thread-safe, non-blocking). Lower
+       priority is fetched sooner. Re-requesting a queued tile updates its
+       priority; a tile already in flight or completed is left alone. */
+    void request(const TileCoord& coord, TileProvider* provider, double priority = 0.0);
+
+    /* Hand back a fetched tile to run the current prepare hook on again
+       (e.g. it was prepared with settings that have since changed). It
+       goes ahead of the local lane's fetches and stays pending until its
+       result is drained. */
+    void reprepare(TileData data);
 
     /* Dequeue one completed result. Returns true if a result was available. */
     bool poll_result(TileData& out);
@@ -35,30 +74,52 @@ public:
     /* Check if a tile is already queued or in-flight */
     bool is_pending(const TileCoord& coord) const;
 
+    /* Drop queued (not yet started) requests for `provider` whose coord is
+       not in `keep`, e.g. tiles that fell out of view. Returns the number
+       cancelled. In-flight fetches complete normally. */
+    size_t cancel_except(TileProvider* provider, const std::unordered_set<TileCoord>& keep);
+
     /* Remove all pending requests (e.g. when a provider is about to be destroyed) */
     void clear_pending();
 
+    /* Requests waiting in each lane (for the HUD / logging) */
+    size_t queued_local() const;
+    size_t queued_network() const;
+
     AsyncLoader(const AsyncLoader&) = delete;
     AsyncLoader& operator=(const AsyncLoader&) = delete;
 
 private:
-    std::thread m_thread;
+    enum Lane { LOCAL = 0, NETWORK = 1, LANE_COUNT = 2 };
+
+    std::vector<std::thread> m_threads;
     std::atomic<bool> m_running{false};
+    int m_local_workers = DEFAULT_LOCAL_WORKERS;
+    int m_network_workers = DEFAULT_NETWORK_WORKERS;
 
     struct Request {
         TileCoord coord;
         TileProvider* provider;
+        double priority;
+        uint64_t seq; // FIFO tie-break for equal priorities
     };
 
+    /* Queues hold at most a few dozen tiles, so each lane is a flat vector
+       scanned for the minimum at pop time; that keeps priority updates and
+       cancellation trivial compared to a heap with lazy deletion. */
     mutable std::mutex m_req_mutex;
-    std::condition_variable m_req_cv;
-    std::deque<Request> m_requests;
+    std::condition_variable m_req_cv[LANE_COUNT];
+    std::vector<Request> m_requests[LANE_COUNT];
     std::unordered_set<TileCoord> m_pending_set;
+    std::unordered_map<TileCoord, Lane> m_queued_lane;
+    uint64_t m_next_seq = 0;
+    std::shared_ptr<const PrepareFn> m_prepare;   // guarded by m_req_mutex
+    std::deque<TileData> m_reprepare;             // guarded by m_req_mutex
 
     std::mutex m_result_mutex;
     std::deque<TileData> m_results;
 
-    void worker_loop();
+    void worker_loop(Lane lane);
 };
 
 } // namespace mesh3d
@@ -0,0 +1,134 @@
+#include "tile/composite_elevation.h"
+#include "analysis/coverage_cache.h"
+#include <cstring>
+
+namespace mesh3d {
+
+uint64_t hash_tile_elevation(const std::vector<float>& elevation) {
+    return CoverageCache::hash_elevation(elevation.data(), elevation.size());
+}
+
+CompositeElevation plan_composite_elevation(
+    const TileRenderable& center, TileCache& cache, CompositeTiles& nb)
+{
+    CompositeElevation ce;
+    ce.center_rows = center.elev_rows;
+    ce.center_cols = center.elev_cols;
+
+    const int cr = center.elev_rows;
+    const int cc = center.elev_cols;
+
+    /* Check 3x3 neighborhood for cached tiles with matching resolution.
+       nb[grid_row][grid_col]: grid_row 0 = north (max_lat), 2 = south (min_lat).
+       Tile coord systems:
+         - HGT (z=-1): y = floor(lat), so dy=+1 means NORTH → grid row 0
+         - Slippy map:  y increases southward, so dy=-1 means NORTH → grid row 0 */
+    for (auto& row : nb)
+        for (auto& t : row) t = nullptr;
+    nb[1][1] = &center;
+    bool hgt_mode = (center.coord.z == -1);
+
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dy == 0 && dx == 0) continue;
+            TileCoord nc = {center.coord.z, center.coord.x + dx, center.coord.y + dy};
+            TileRenderable* n = cache.get(nc);
+            if (n && n->elev_rows == cr && n->elev_cols == cc && !n->elevation.empty()) {
+                /* Map tile offset to grid position (north=row 0) */
+                int gr = hgt_mode ? (1 - dy) : (1 + dy); // HGT: +dy=north=0, slippy: -dy=north=0
+                int gc = dx + 1;
+                nb[gr][gc] = n;
+            }
+        }
+    }
+
+    /* Only expand in directions where neighbors exist */
+    int top_rows    = nb[0][0] || nb[0][1] || nb[0][2] ? cr : 0;
+    int bottom_rows = nb[2][0] || nb[2][1] || nb[2][2] ? cr : 0;
+    int left_cols   = nb[0][0] || nb[1][0] || nb[2][0] ? cc : 0;
+    int right_cols  = nb[0][2] || nb[1][2] || nb[2][2] ? cc : 0;
+
+    ce.rows = top_rows + cr + bottom_rows;
+    ce.cols = left_cols + cc + right_cols;
+    ce.center_row_start = top_rows;
+    ce.center_col_start = left_cols;
+
+    /* Expanded geographic bounds. Grid row 0 = north (max_lat). */
+    double lat_span = center.bounds.max_lat - center.bounds.min_lat;
+    double lon_span = center.bounds.max_lon - center.bounds.min_lon;
+
+    ce.bounds.max_lat = center.bounds.max_lat + (top_rows > 0 ? lat_span : 0.0);
+    ce.bounds.min_lat = center.bounds.min_lat - (bottom_rows > 0 ? lat_span : 0.0);
+    ce.bounds.min_lon = center.bounds.min_lon - (left_cols > 0 ? lon_span : 0.0);
+    ce.bounds.max_lon = center.bounds.max_lon + (right_cols > 0 ? lon_span : 0.0);
+
+    /* Tile hashes by position, so equal composites hash equal without
+       touching the samples */
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ static_cast<uint64_t>(ce.rows) << 32 ^
+                 static_cast<uint64_t>(ce.cols);
+    for (int gr = 0; gr < 3; ++gr) {
+        for (int gc = 0; gc < 3; ++gc) {
+            uint64_t th = nb[gr][gc] ? nb[gr][gc]->elevation_hash : 0;
+            h = (h ^ th ^ static_cast<uint64_t>(gr * 3 + gc)) * 0xff51afd7ed558ccdull;
+            h ^= h >> 32;
+        }
+    }
+    ce.elevation_hash = h;
+
+    return ce;
+}
+
+CompositeElevation build_composite_elevation(
+    const TileRenderable& center, TileCache& cache)
+{
+    CompositeTiles nb;
+    CompositeElevation ce = plan_composite_elevation(center, cache, nb);
+    const int cr = ce.center_rows;
+    const int cc = ce.center_cols;
+    const int top_rows = ce.center_row_start;
+    const int left_cols = ce.center_col_start;
+
+    ce.data.assign(ce.rows * ce.cols, 0.0f);
+
+    /* Blit each neighbor's elevation into the composite */
+    for (int gr = 0; gr < 3; ++gr) {
+        for (int gc = 0; gc < 3; ++gc) {
+            if (!nb[gr][gc]) continue;
+            int dst_r = (gr == 0) ? 0 : (gr == 1 ? top_rows : top_rows + cr);
+            int dst_c = (gc == 0) ? 0 : (gc == 1 ? left_cols : left_cols + cc);
+            const auto& elev = nb[gr][gc]->elevation;
+            for (int r = 0; r < cr; ++r) {
+                std::memcpy(&ce.data[(dst_r + r) * ce.cols + dst_c],
+                            &elev[r * cc],
+                            cc * sizeof(float));
+            }
+        }
+    }
+
+    return ce;
+}
+
+void extract_center_results(const CompositeElevation& ce,
+                            const std::vector<uint8_t>& comp_vis,
+                            const std::vector<float>& comp_sig,
+                            std::vector<uint8_t>& tile_vis,
+                            std::vector<float>& tile_sig)
+{
+    int cr = ce.center_rows;
+    int cc = ce.center_cols;
+    int total = cr * cc;
+    tile_vis.resize(total);
+    tile_sig.resize(total);
+
+    for (int r = 0; r < cr; ++r) {
+        int src_row = ce.center_row_start + r;
+        int src_off = src_row * ce.cols + ce.center_col_start;
+        int dst_off = r * cc;
+        for (int c = 0; c < cc; ++c) {
+            tile_vis[dst_off + c] = comp_vis[src_off + c];
+            tile_sig[dst_off + c] = comp_sig[src_off + c];
+        }
+    }
+}
+
+} // namespace mesh3d
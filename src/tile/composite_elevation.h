@@ -0,0 +1,47 @@
+#pragma once
+#include "tile/tile_cache.h"
+#include <mesh3d/types.h>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* Composite elevation grid: a center tile plus its cached neighbors.
+   The center tile occupies a sub-region within the larger composite grid,
+   so ray marching can traverse terrain on neighboring tiles. */
+struct CompositeElevation {
+    std::vector<float> data;
+    mesh3d_bounds_t bounds;
+    int rows = 0, cols = 0;
+    int center_row_start = 0, center_col_start = 0;
+    int center_rows = 0, center_cols = 0;
+    /* Content hash of the composite, from its tiles' elevation_hash and
+       placement (data need not be filled) */
+    uint64_t elevation_hash = 0;
+};
+
+/* The tiles of a composite by position in the 3x3 neighbourhood, row 0 =
+   north, [1][1] = center; null where no neighbor is used */
+using CompositeTiles = const TileRenderable* [3][3];
+
+/* Geometry of the composite around `center`, without filling data: uses
+   whichever of its 8 neighbors are in `cache` with matching resolution
+   and expands only towards neighbors that exist. */
+CompositeElevation plan_composite_elevation(const TileRenderable& center, TileCache& cache,
+                                            CompositeTiles& tiles);
+
+/* Build the composite: plan_composite_elevation() plus a copy of every
+   tile's elevation into `data` */
+CompositeElevation build_composite_elevation(const TileRenderable& center, TileCache& cache);
+
+/* Content hash of a tile's elevation grid, for TileRenderable::elevation_hash */
+uint64_t hash_tile_elevation(const std::vector<float>& elevation);
+
+/* Extract center-tile results from a composite-grid viewshed computation */
+void extract_center_results(const CompositeElevation& ce,
+                            const std::vector<uint8_t>& comp_vis,
+                            const std::vector<float>& comp_sig,
+                            std::vector<uint8_t>& tile_vis,
+                            std::vector<float>& tile_sig);
+
+} // namespace mesh3d
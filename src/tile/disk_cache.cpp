@@ -2,6 +2,9 @@
 #include "util/log.h"
 #include <filesystem>
 #include <fstream>
+#include <atomic>
+#include <random>
+#include <cstdio>
 #include <cstdlib>
 
 namespace fs = std::filesystem;
@@ -61,18 +64,45 @@ bool DiskCache::write(const std::string& key, const uint8_t* data, size_t len) {
         return false;
     }
 
-    std::ofstream f(path, std::ios::binary);
-    if (!f) {
-        LOG_WARN("Failed to open cache file for writing: %s", path.c_str());
-        return false;
+    /* Unique per process and write: two workers (or two instances) may
+       store the same key at once, and each must rename only its own file */
+    static const unsigned process_tag = std::random_device{}();
+    static std::atomic<unsigned> write_counter{0};
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%08x.%u.tmp", process_tag, write_counter++);
+    std::string tmp = path + suffix;
+    {
+        std::ofstream f(tmp, std::ios::binary);
+        if (!f) {
+            LOG_WARN("Failed to open cache file for writing: %s", tmp.c_str());
+            return false;
+        }
+        f.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len));
+        if (!f.good()) {
+            f.close();
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return false;
+        }
     }
 
-    f.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len));
-    return f.good();
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        LOG_WARN("Failed to move cache file into place: %s", path.c_str());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
 }
 
 bool DiskCache::write(const std::string& key, const std::vector<uint8_t>& data) {
     return write(key, data.data(), data.size());
 }
 
+void DiskCache::remove(const std::string& key) {
+    std::error_code ec;
+    fs::remove(key_to_path(key), ec);
+}
+
 } // namespace mesh3d
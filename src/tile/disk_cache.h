@@ -17,10 +17,17 @@ public:
     /* Read cached data. Returns empty vector if not found. */
     std::vector<uint8_t> read(const std::string& key) const;
 
-    /* Write data to cache under key */
+    /* Write data to cache under key. Written to a temporary file and
+       renamed into place, so readers never see a partial entry. */
     bool write(const std::string& key, const uint8_t* data, size_t len);
     bool write(const std::string& key, const std::vector<uint8_t>& data);
 
+    /* Delete a cached entry (no-op if absent) */
+    void remove(const std::string& key);
+
+    /* Filesystem path of a key (whether or not it exists) */
+    std::string path(const std::string& key) const { return key_to_path(key); }
+
     const std::string& cache_dir() const { return m_cache_dir; }
 
 private:
@@ -4,12 +4,20 @@
 #include <filesystem>
 #include <fstream>
 #include <cmath>
+#include <cstdlib>
 #include <algorithm>
 
 namespace mesh3d {
 
+/* Decoded DSM heights are kept to the nearest centimetre */
+static constexpr float DSM_QUANT_STEP = 0.01f;
+
 DSMProvider::DSMProvider()
-    : m_cache("dsm") {}
+    : m_cache([] {
+        const char* home = std::getenv("HOME");
+        if (home) return std::string(home) + "/.cache/mesh3d/dsm";
+        return std::string("/tmp/mesh3d/dsm");
+    }()) {}
 
 mesh3d_bounds_t DSMProvider::coverage() const {
     return {-90.0, 90.0, -180.0, 180.0};
@@ -113,7 +121,63 @@ std::vector<TileCoord> DSMProvider::tiles_in_view(double lat, double lon) const
     return tiles_in_bounds(view_bounds, 0);
 }
 
+std::string DSMProvider::cache_key(const std::string& path) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) return {};
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) return {};
+
+    /* FNV-1a over the absolute path, size and mtime; any edit or move of
+       the source yields a new key and the old entry is simply never read */
+    std::string abs = fs::absolute(path, ec).string();
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* p, size_t n) {
+        const auto* b = static_cast<const uint8_t*>(p);
+        for (size_t i = 0; i < n; ++i) { h ^= b[i]; h *= 1099511628211ull; }
+    };
+    mix(abs.data(), abs.size());
+    uint64_t sz = size;
+    int64_t mt = static_cast<int64_t>(mtime.time_since_epoch().count());
+    mix(&sz, sizeof(sz));
+    mix(&mt, sizeof(mt));
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%016llx.m3dt", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+bool DSMProvider::open_cached(const std::string& path, M3dtReader& reader) {
+    std::string key = cache_key(path);
+    if (key.empty()) return false;
+    if (m_cache.has(key) && reader.open(m_cache.path(key))) return true;
+    if (!load_geotiff(path)) return false;
+    return m_cache.has(key) && reader.open(m_cache.path(key));
+}
+
 std::optional<TileData> DSMProvider::load_geotiff(const std::string& path) {
+    /* Native cache first */
+    {
+        std::string key = cache_key(path);
+        M3dtReader reader;
+        if (!key.empty() && m_cache.has(key) && reader.open(m_cache.path(key))) {
+            auto elev = reader.read_all();
+            if (!elev.empty()) {
+                TileData td;
+                td.elevation = std::move(elev);
+                td.elev_rows = reader.rows();
+                td.elev_cols = reader.cols();
+                td.bounds = reader.bounds();
+                td.coord = latlon_to_dsm_coord(
+                    (td.bounds.min_lat + td.bounds.max_lat) * 0.5,
+                    (td.bounds.min_lon + td.bounds.max_lon) * 0.5);
+                LOG_DEBUG("DSM cache hit: %s", path.c_str());
+                return td;
+            }
+        }
+    }
+
     std::ifstream file(path, std::ios::binary | std::ios::ate);
     if (!file) return std::nullopt;
 
@@ -151,6 +215,14 @@ std::optional<TileData> DSMProvider::load_geotiff(const std::string& path) {
         (td.bounds.min_lat + td.bounds.max_lat) * 0.5,
         (td.bounds.min_lon + td.bounds.max_lon) * 0.5);
 
+    std::string key = cache_key(path);
+    if (!key.empty()) {
+        auto image = m3dt_encode(td.elevation.data(), td.elev_rows, td.elev_cols,
+                                 td.bounds, DSM_QUANT_STEP);
+        if (!image.empty() && m_cache.write(key, image))
+            LOG_INFO("DSM: cached %s as %s (%zu bytes)", path.c_str(), key.c_str(), image.size());
+    }
+
     LOG_INFO("DSM: loaded %s (%dx%d, %.6f-%.6f lat, %.6f-%.6f lon)",
              path.c_str(), info.width, info.height,
              td.bounds.min_lat, td.bounds.max_lat,
@@ -172,4 +244,31 @@ std::optional<TileData> DSMProvider::fetch_tile(const TileCoord& coord) {
     return std::nullopt;
 }
 
+std::optional<TileData> DSMProvider::fetch_tile_region(const TileCoord& coord,
+                                                       const mesh3d_bounds_t& bounds) {
+    scan_directory();
+
+    for (auto& idx : m_index) {
+        if (!(idx.coord == coord)) continue;
+
+        M3dtReader reader;
+        if (!open_cached(idx.filepath, reader))
+            return TileProvider::fetch_tile_region(coord, bounds);
+
+        TileData td;
+        td.coord = coord;
+        int r0, r1, c0, c1;
+        if (!elevation_grid_region(reader.bounds(), reader.rows(), reader.cols(), bounds,
+                                   r0, r1, c0, c1, td.bounds))
+            return std::nullopt;
+        td.elev_rows = r1 - r0;
+        td.elev_cols = c1 - c0;
+        td.elevation.resize(static_cast<size_t>(td.elev_rows) * td.elev_cols);
+        if (!reader.read_region(r0, r1, c0, c1, td.elevation.data(), td.elev_cols))
+            return std::nullopt;
+        return td;
+    }
+    return std::nullopt;
+}
+
 } // namespace mesh3d
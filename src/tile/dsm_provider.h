@@ -1,6 +1,7 @@
 #pragma once
 #include "tile/tile_provider.h"
 #include "tile/disk_cache.h"
+#include "tile/m3dt.h"
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -8,7 +9,9 @@
 namespace mesh3d {
 
 /* Provides high-resolution (1-2m) LiDAR Digital Surface Model tiles.
-   Reads GeoTIFF files from a local directory.
+   Reads GeoTIFF files from a local directory. Decoded grids are cached in
+   ~/.cache/mesh3d/dsm/ as .m3dt at 1 cm precision, keyed by source path,
+   size and mtime, so a re-run skips TIFF decoding entirely.
    TileCoord scheme: z=-2 (sentinel for DSM), x=floor(lon*100), y=floor(lat*100).
    Each tile covers a small area (depends on source data). */
 class DSMProvider : public TileProvider {
@@ -21,6 +24,8 @@ public:
     int max_zoom() const override { return 0; }
 
     std::optional<TileData> fetch_tile(const TileCoord& coord) override;
+    std::optional<TileData> fetch_tile_region(const TileCoord& coord,
+                                              const mesh3d_bounds_t& bounds) override;
     std::vector<TileCoord> tiles_in_bounds(const mesh3d_bounds_t& bounds, int zoom) const override;
 
     /* Get tiles the camera needs based on lat/lon */
@@ -55,6 +60,9 @@ private:
     std::vector<TileIndex> m_index;
 
     std::optional<TileData> load_geotiff(const std::string& path);
+    /* Open (creating if needed) the .m3dt cache entry for a GeoTIFF */
+    bool open_cached(const std::string& path, M3dtReader& reader);
+    static std::string cache_key(const std::string& path);
 };
 
 } // namespace mesh3d
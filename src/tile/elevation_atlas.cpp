@@ -0,0 +1,130 @@
+#include "tile/elevation_atlas.h"
+#include "analysis/gpu_viewshed.h"
+#include "util/log.h"
+#include <algorithm>
+
+namespace mesh3d {
+
+ElevationAtlas::~ElevationAtlas() {
+    clear();
+}
+
+void ElevationAtlas::release() {
+    if (m_texture) glDeleteTextures(1, &m_texture);
+    m_texture = 0;
+    m_tile_rows = m_tile_cols = 0;
+    m_layers = 0;
+    m_slots.clear();
+    m_free.clear();
+}
+
+void ElevationAtlas::clear() {
+    release();
+    m_failed_sizes.clear();
+    m_requests = m_last_hit = 0;
+}
+
+bool ElevationAtlas::allocate(int rows, int cols) {
+    release();
+    m_tile_rows = rows;
+    m_tile_cols = cols;
+
+    GLint max_layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    size_t layer_bytes = static_cast<size_t>(rows) * cols * sizeof(float);
+    m_layers = static_cast<int>(std::clamp<size_t>(m_budget / layer_bytes, 9,
+                                                   std::max<GLint>(max_layers, 9)));
+
+    while (glGetError() != GL_NO_ERROR) {}
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32F, cols, rows, m_layers);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        LOG_WARN("Elevation atlas: could not allocate %d layers of %dx%d, "
+                 "uploading composites instead", m_layers, cols, rows);
+        release();
+        m_failed_sizes.emplace_back(rows, cols);
+        return false;
+    }
+
+    for (int l = m_layers - 1; l >= 0; --l) m_free.push_back(l);
+    LOG_INFO("Elevation atlas: %d layers of %dx%d (%.0f MB)", m_layers, cols, rows,
+             m_layers * layer_bytes / (1024.0 * 1024.0));
+    return true;
+}
+
+int ElevationAtlas::place(const TileRenderable& tile) {
+    auto it = m_slots.find(tile.coord);
+    if (it != m_slots.end() && it->second.elevation_hash == tile.elevation_hash) {
+        it->second.last_use = m_use;
+        return it->second.layer;
+    }
+
+    int layer;
+    if (it != m_slots.end()) {
+        layer = it->second.layer;           // same tile, new data
+    } else if (!m_free.empty()) {
+        layer = m_free.back();
+        m_free.pop_back();
+    } else {
+        auto oldest = m_slots.end();
+        for (auto s = m_slots.begin(); s != m_slots.end(); ++s) {
+            if (s->second.last_use >= m_use) continue;   // in the current frame
+            if (oldest == m_slots.end() || s->second.last_use < oldest->second.last_use)
+                oldest = s;
+        }
+        if (oldest == m_slots.end()) return -1;       // cannot happen with >= 9 layers
+        layer = oldest->second.layer;
+        m_slots.erase(oldest);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_tile_cols, m_tile_rows, 1,
+                    GL_RED, GL_FLOAT, tile.elevation.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    Slot& slot = m_slots[tile.coord];
+    slot.layer = layer;
+    slot.elevation_hash = tile.elevation_hash;
+    slot.last_use = m_use;
+    return layer;
+}
+
+bool ElevationAtlas::frame(const CompositeElevation& ce, const CompositeTiles& tiles,
+                           ElevationFrame& out) {
+    ++m_requests;
+    if (ce.center_rows != m_tile_rows || ce.center_cols != m_tile_cols) {
+        const std::pair<int, int> size(ce.center_rows, ce.center_cols);
+        if (std::find(m_failed_sizes.begin(), m_failed_sizes.end(), size) != m_failed_sizes.end())
+            return false;
+        /* Keep the resident size while it is in use */
+        if (m_texture && m_requests - m_last_hit <= static_cast<uint64_t>(m_layers))
+            return false;
+        if (!allocate(ce.center_rows, ce.center_cols)) return false;
+    }
+    m_last_hit = m_requests;
+
+    ++m_use;
+    out = ElevationFrame();
+    out.texture = m_texture;
+    out.tile_rows = m_tile_rows;
+    out.tile_cols = m_tile_cols;
+    out.row_offset = ce.center_rows - ce.center_row_start;
+    out.col_offset = ce.center_cols - ce.center_col_start;
+    for (int gr = 0; gr < 3; ++gr) {
+        for (int gc = 0; gc < 3; ++gc) {
+            const TileRenderable* t = tiles[gr][gc];
+            if (!t) continue;
+            int layer = place(*t);
+            if (layer < 0) return false;
+            out.layers[gr * 3 + gc] = layer;
+            out.tiles[gr * 3 + gc] = t->elevation.data();
+        }
+    }
+    return true;
+}
+
+} // namespace mesh3d
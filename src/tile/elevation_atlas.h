@@ -0,0 +1,81 @@
+#pragma once
+#include "tile/composite_elevation.h"
+#include "tile/tile_coord.h"
+#include <glad/glad.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh3d {
+
+struct ElevationFrame;
+
+/* Tile elevation kept resident on the GPU for the tile viewshed paths.
+
+   Each cached tile's grid is uploaded once into a layer of an R32F
+   texture array, and a composite is described to the compute shaders as
+   an ElevationFrame (the layers of its 3x3 neighbourhood) instead of
+   being copied into a new grid and uploaded, so a tile is sent to the GPU
+   once rather than once per neighbour it is part of.
+
+   All layers share one size, that of the first tile placed. Composites of
+   another size (DSM next to HGT, SRTM1 next to SRTM3) are refused, so the
+   caller uploads them and the resident layers stay; the array is re-sized
+   only once it has gone unused for as many frames as it has layers. A size
+   that failed to allocate is not tried again until clear(). The layer
+   count follows from the
+   byte budget (at least 9, so any composite fits); when full, the layer
+   used longest ago is replaced. A layer is matched by tile coordinate and
+   elevation hash, so a reloaded tile with other data is uploaded again.
+   Main thread only. */
+class ElevationAtlas {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 1024u << 20;
+
+    ElevationAtlas() = default;
+    ~ElevationAtlas();
+
+    /* Make the tiles of a composite resident and describe them as a frame
+       over the composite `ce` (step 1). False if the array cannot be
+       allocated; the caller then uploads the composite instead. */
+    bool frame(const CompositeElevation& ce, const CompositeTiles& tiles, ElevationFrame& out);
+
+    void set_budget(size_t bytes) { m_budget = bytes; }
+    /* Layers holding a tile */
+    int resident() const { return static_cast<int>(m_slots.size()); }
+
+    /* Free the array and forget every tile and failed size */
+    void clear();
+
+    ElevationAtlas(const ElevationAtlas&) = delete;
+    ElevationAtlas& operator=(const ElevationAtlas&) = delete;
+
+private:
+    struct Slot {
+        int layer = 0;
+        uint64_t elevation_hash = 0;
+        uint64_t last_use = 0;
+    };
+
+    GLuint m_texture = 0;
+    int m_tile_rows = 0, m_tile_cols = 0;
+    int m_layers = 0;
+    size_t m_budget = DEFAULT_BUDGET;
+    uint64_t m_use = 0;              // frames served from the array
+    uint64_t m_requests = 0;         // frame() calls
+    uint64_t m_last_hit = 0;         // m_requests of the last frame served
+    std::vector<std::pair<int, int>> m_failed_sizes;   // (rows, cols) not allocatable
+    std::unordered_map<TileCoord, Slot> m_slots;
+    std::vector<int> m_free;         // unused layers
+
+    /* Free the array and forget its tiles */
+    void release();
+    bool allocate(int rows, int cols);
+    /* Layer of `tile`, uploading it first if needed; never evicts a layer
+       used at m_use */
+    int place(const TileRenderable& tile);
+};
+
+} // namespace mesh3d
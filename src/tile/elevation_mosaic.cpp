@@ -0,0 +1,143 @@
+#include "tile/elevation_mosaic.h"
+#include "util/log.h"
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+namespace mesh3d {
+
+/* Tolerance (in cells) for treating a fractional sample position as a post */
+static constexpr double POST_EPS = 1e-6;
+
+/* Same void rule as the HGT reader: anything this low is nodata */
+static constexpr float VOID_BELOW = -1000.0f;
+
+int ElevationMosaic::lat_to_row(double lat) const {
+    return static_cast<int>(std::lround((bounds.max_lat - lat) * cells_per_degree));
+}
+
+int ElevationMosaic::lon_to_col(double lon) const {
+    return static_cast<int>(std::lround((lon - bounds.min_lon) * cells_per_degree));
+}
+
+static double snap_post(double v) {
+    double r = std::round(v);
+    return std::abs(v - r) < POST_EPS ? r : v;
+}
+
+/* Bilinearly resample one tile onto the mosaic cells it covers */
+static void blit_tile(const TileData& td, ElevationMosaic& m) {
+    const mesh3d_bounds_t& b = td.bounds;
+    const int tr = td.elev_rows;
+    const int tc = td.elev_cols;
+    const double lat_span = b.max_lat - b.min_lat;
+    const double lon_span = b.max_lon - b.min_lon;
+    if (tr < 2 || tc < 2 || lat_span <= 0.0 || lon_span <= 0.0) return;
+
+    const double cpd = m.cells_per_degree;
+    int r_begin = static_cast<int>(std::ceil((m.bounds.max_lat - b.max_lat) * cpd - POST_EPS));
+    int r_end   = static_cast<int>(std::floor((m.bounds.max_lat - b.min_lat) * cpd + POST_EPS)) + 1;
+    int c_begin = static_cast<int>(std::ceil((b.min_lon - m.bounds.min_lon) * cpd - POST_EPS));
+    int c_end   = static_cast<int>(std::floor((b.max_lon - m.bounds.min_lon) * cpd + POST_EPS)) + 1;
+    r_begin = std::max(r_begin, 0);
+    c_begin = std::max(c_begin, 0);
+    r_end = std::min(r_end, m.rows);
+    c_end = std::min(c_end, m.cols);
+
+    for (int r = r_begin; r < r_end; ++r) {
+        double lat = m.bounds.max_lat - r / cpd;
+        double fr = snap_post((b.max_lat - lat) / lat_span * (tr - 1));
+        fr = std::clamp(fr, 0.0, static_cast<double>(tr - 1));
+        int r0 = std::min(static_cast<int>(fr), tr - 2);
+        float wr = static_cast<float>(fr - r0);
+
+        float* dst = &m.data[static_cast<size_t>(r) * m.cols];
+        const float* row0 = &td.elevation[static_cast<size_t>(r0) * tc];
+        const float* row1 = row0 + tc;
+
+        for (int c = c_begin; c < c_end; ++c) {
+            double lon = m.bounds.min_lon + c / cpd;
+            double fc = snap_post((lon - b.min_lon) / lon_span * (tc - 1));
+            fc = std::clamp(fc, 0.0, static_cast<double>(tc - 1));
+            int c0 = std::min(static_cast<int>(fc), tc - 2);
+            float wc = static_cast<float>(fc - c0);
+
+            float h00 = row0[c0], h01 = row0[c0 + 1];
+            float h10 = row1[c0], h11 = row1[c0 + 1];
+            if (!(h00 >= VOID_BELOW && h01 >= VOID_BELOW &&
+                  h10 >= VOID_BELOW && h11 >= VOID_BELOW))
+                continue; // keep whatever an earlier provider wrote
+
+            float h0 = h00 + wc * (h01 - h00);
+            float h1 = h10 + wc * (h11 - h10);
+            dst[c] = h0 + wr * (h1 - h0);
+        }
+    }
+}
+
+bool build_elevation_mosaic(const mesh3d_bounds_t& bounds, int cells_per_degree,
+                            const std::vector<TileProvider*>& providers,
+                            ElevationMosaic& out) {
+    out = ElevationMosaic{};
+    auto t0 = std::chrono::steady_clock::now();
+
+    /* Fetch first: the grid resolution may come from the tiles themselves */
+    std::vector<TileData> tiles;
+    for (TileProvider* p : providers) {
+        if (!p) continue;
+        for (const auto& coord : p->tiles_in_bounds(bounds, 0)) {
+            auto td = p->fetch_tile_region(coord, bounds);
+            if (!td || td->elevation.empty()) {
+                ++out.tiles_missing;
+                continue;
+            }
+            tiles.push_back(std::move(*td));
+        }
+    }
+    out.tiles_loaded = static_cast<int>(tiles.size());
+    auto t1 = std::chrono::steady_clock::now();
+    out.fetch_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (tiles.empty()) {
+        LOG_ERROR("Elevation mosaic: no tiles available for %.4f,%.4f - %.4f,%.4f",
+                  bounds.min_lat, bounds.min_lon, bounds.max_lat, bounds.max_lon);
+        return false;
+    }
+
+    if (cells_per_degree <= 0) {
+        const TileData& t = tiles.front();
+        double span = t.bounds.max_lat - t.bounds.min_lat;
+        cells_per_degree = span > 0.0
+            ? static_cast<int>(std::lround((t.elev_rows - 1) / span)) : 0;
+        if (cells_per_degree <= 0) {
+            LOG_ERROR("Elevation mosaic: cannot infer resolution from %s tile",
+                      t.coord.z == -1 ? "HGT" : "DSM");
+            return false;
+        }
+    }
+    out.cells_per_degree = cells_per_degree;
+
+    /* Snap outward to the post grid */
+    const double cpd = cells_per_degree;
+    long long lat0 = static_cast<long long>(std::floor(bounds.min_lat * cpd + POST_EPS));
+    long long lat1 = static_cast<long long>(std::ceil(bounds.max_lat * cpd - POST_EPS));
+    long long lon0 = static_cast<long long>(std::floor(bounds.min_lon * cpd + POST_EPS));
+    long long lon1 = static_cast<long long>(std::ceil(bounds.max_lon * cpd - POST_EPS));
+    out.rows = static_cast<int>(lat1 - lat0 + 1);
+    out.cols = static_cast<int>(lon1 - lon0 + 1);
+    out.bounds.min_lat = lat0 / cpd;
+    out.bounds.max_lat = lat1 / cpd;
+    out.bounds.min_lon = lon0 / cpd;
+    out.bounds.max_lon = lon1 / cpd;
+
+    out.data.assign(static_cast<size_t>(out.rows) * out.cols, 0.0f);
+    for (const auto& td : tiles)
+        blit_tile(td, out);
+    out.resample_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t1).count();
+
+    LOG_INFO("Elevation mosaic: %dx%d at %d cells/deg from %d tiles (%d missing)",
+             out.rows, out.cols, cells_per_degree, out.tiles_loaded, out.tiles_missing);
+    return true;
+}
+
+} // namespace mesh3d
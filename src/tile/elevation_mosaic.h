@@ -0,0 +1,37 @@
+#pragma once
+#include "tile/tile_provider.h"
+#include <mesh3d/types.h>
+#include <vector>
+
+namespace mesh3d {
+
+/* Regular lat/lon elevation grid assembled from provider tiles.
+   Row 0 = north (max_lat), posts on multiples of 1/cells_per_degree so
+   SRTM tiles land on their own samples without resampling. */
+struct ElevationMosaic {
+    std::vector<float> data;
+    mesh3d_bounds_t bounds{};
+    int rows = 0, cols = 0;
+    int cells_per_degree = 0;
+    int tiles_loaded = 0;
+    int tiles_missing = 0;
+    double fetch_ms = 0.0;     // provider fetch/decode time
+    double resample_ms = 0.0;  // time spent resampling onto the grid
+
+    /* Grid cell nearest to lat/lon (may lie outside the grid) */
+    int lat_to_row(double lat) const;
+    int lon_to_col(double lon) const;
+};
+
+/* Fetch every tile covering `bounds` from `providers` (in order; later
+   providers overwrite earlier ones where they have data, so pass HGT
+   before DSM) and resample them onto one grid.
+
+   bounds are snapped outward to the post spacing. cells_per_degree = 0
+   takes the resolution of the first tile that loads (3600 for SRTM1).
+   Cells no tile covers are 0. Returns false if no tile loaded. */
+bool build_elevation_mosaic(const mesh3d_bounds_t& bounds, int cells_per_degree,
+                            const std::vector<TileProvider*>& providers,
+                            ElevationMosaic& out);
+
+} // namespace mesh3d
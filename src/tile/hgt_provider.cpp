@@ -1,11 +1,17 @@
 #include "tile/hgt_provider.h"
 #include "util/log.h"
+#include "util/mapped_file.h"
+#include "util/http_client.h"
 #include <cmath>
 #include <cstring>
 #include <algorithm>
-#include <curl/curl.h>
 #include <zlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESH3D_HGT_SSE2 1
+#endif
+
 namespace mesh3d {
 
 HgtProvider::HgtProvider()
@@ -108,19 +114,17 @@ std::vector<TileCoord> HgtProvider::tiles_in_bounds(const mesh3d_bounds_t& bound
     return tiles;
 }
 
+bool HgtProvider::is_local(const TileCoord& coord) const {
+    return m_cache.has(m3dt_key(coord)) || m_cache.has(coord_to_filename(coord));
+}
+
 std::optional<TileData> HgtProvider::fetch_tile(const TileCoord& coord) {
     std::string filename = coord_to_filename(coord);
 
-    auto raw = acquire_hgt(filename);
-    if (raw.empty()) {
-        LOG_WARN("HGT: no data for %s", filename.c_str());
-        return std::nullopt;
-    }
-
     int rows = 0, cols = 0;
-    auto elevation = read_hgt(raw, rows, cols);
+    auto elevation = acquire_hgt(coord, rows, cols);
     if (elevation.empty()) {
-        LOG_WARN("HGT: failed to parse %s", filename.c_str());
+        LOG_WARN("HGT: no data for %s", filename.c_str());
         return std::nullopt;
     }
 
@@ -135,37 +139,125 @@ std::optional<TileData> HgtProvider::fetch_tile(const TileCoord& coord) {
     return td;
 }
 
-std::vector<float> HgtProvider::read_hgt(const std::vector<uint8_t>& data, int& rows, int& cols) {
-    size_t samples = data.size() / 2; // int16 samples
+/* Big-endian int16 -> float meters; SRTM voids (-32768) and anything
+   below -1000 m become 0. The SSE2 path swaps and widens 8 samples per
+   step and gives identical results to the scalar loop. */
+static void decode_hgt_samples(const uint8_t* src, float* dst, size_t n) {
+    size_t i = 0;
+#ifdef MESH3D_HGT_SSE2
+    const __m128i floor_v = _mm_set1_epi32(-1000);
+    for (; i + 8 <= n; i += 8) {
+        __m128i be = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i v16 = _mm_or_si128(_mm_slli_epi16(be, 8), _mm_srli_epi16(be, 8));
+        /* Sign-extend to int32 by placing each sample in the high half */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v16, v16), 16);
+        lo = _mm_andnot_si128(_mm_cmplt_epi32(lo, floor_v), lo);
+        hi = _mm_andnot_si128(_mm_cmplt_epi32(hi, floor_v), hi);
+        _mm_storeu_ps(dst + i,     _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        int16_t val = static_cast<int16_t>((src[i * 2] << 8) | src[i * 2 + 1]);
+        if (val < -1000) val = 0;
+        dst[i] = static_cast<float>(val);
+    }
+}
+
+/* Grid size from the byte count; false for anything but SRTM1/SRTM3 */
+static bool hgt_dims(size_t size, int& rows, int& cols) {
+    size_t samples = size / 2; // int16 samples
 
     if (samples == 3601 * 3601) {
         rows = cols = 3601; // SRTM1
     } else if (samples == 1201 * 1201) {
         rows = cols = 1201; // SRTM3
     } else {
-        LOG_WARN("HGT: unexpected size %zu bytes (%zu samples)", data.size(), samples);
-        return {};
+        LOG_WARN("HGT: unexpected size %zu bytes (%zu samples)", size, samples);
+        return false;
     }
+    return true;
+}
+
+std::vector<float> HgtProvider::read_hgt(const uint8_t* data, size_t size, int& rows, int& cols) {
+    if (!hgt_dims(size, rows, cols)) return {};
 
+    size_t samples = static_cast<size_t>(rows) * cols;
     std::vector<float> elev(samples);
-    const uint8_t* p = data.data();
+    decode_hgt_samples(data, elev.data(), samples);
+    return elev;
+}
 
-    for (size_t i = 0; i < samples; ++i) {
-        // Big-endian int16
-        int16_t val = static_cast<int16_t>((p[i * 2] << 8) | p[i * 2 + 1]);
-        // SRTM void = -32768 or very negative values
-        if (val < -1000) val = 0;
-        elev[i] = static_cast<float>(val);
-    }
+std::vector<float> HgtProvider::read_hgt(const std::vector<uint8_t>& data, int& rows, int& cols) {
+    return read_hgt(data.data(), data.size(), rows, cols);
+}
+
+std::vector<float> HgtProvider::load_hgt_file(const std::string& path, int& rows, int& cols) {
+    MappedFile file;
+    if (!file.open(path)) return {};
+    if (!hgt_dims(file.size(), rows, cols)) return {};
 
+    /* Decode in chunks and drop each decoded span of the mapping, so the
+       raw bytes never all sit in the resident set next to the floats */
+    static constexpr size_t CHUNK_SAMPLES = 256 * 1024;
+    size_t samples = static_cast<size_t>(rows) * cols;
+    std::vector<float> elev(samples);
+    for (size_t i = 0; i < samples; i += CHUNK_SAMPLES) {
+        size_t n = std::min(CHUNK_SAMPLES, samples - i);
+        decode_hgt_samples(file.data() + i * 2, elev.data() + i, n);
+        file.discard_through((i + n) * 2);
+    }
     return elev;
 }
 
-std::vector<uint8_t> HgtProvider::acquire_hgt(const std::string& filename) {
-    // Check disk cache first
+std::string HgtProvider::m3dt_key(const TileCoord& coord) {
+    /* "N38W106.hgt" -> "N38W106.m3dt" */
+    std::string name = coord_to_filename(coord);
+    return name.substr(0, name.size() - 4) + ".m3dt";
+}
+
+void HgtProvider::store_m3dt(const TileCoord& coord, const std::vector<float>& elev,
+                             int rows, int cols) {
+    /* HGT heights are integer meters, so a 1 m step is lossless */
+    std::string key = m3dt_key(coord);
+    auto image = m3dt_encode(elev.data(), rows, cols, hgt_tile_bounds(coord), 1.0f);
+    if (!image.empty() && m_cache.write(key, image))
+        LOG_INFO("HGT: cached %s (%zu bytes, %.1fx smaller than raw)",
+                 key.c_str(), image.size(),
+                 static_cast<double>(elev.size()) * 2.0 / image.size());
+}
+
+std::vector<float> HgtProvider::acquire_hgt(const TileCoord& coord, int& rows, int& cols) {
+    std::string filename = coord_to_filename(coord);
+    std::string key = m3dt_key(coord);
+
+    // Native cache first
+    if (m_cache.has(key)) {
+        M3dtReader reader;
+        if (reader.open(m_cache.path(key))) {
+            auto elev = reader.read_all();
+            if (!elev.empty()) {
+                LOG_DEBUG("HGT cache hit: %s", key.c_str());
+                rows = reader.rows();
+                cols = reader.cols();
+                return elev;
+            }
+        }
+        LOG_WARN("HGT: cached %s is unreadable, fetching again", key.c_str());
+        m_cache.remove(key);
+    }
+
+    // Raw .hgt from an older cache: decode, convert, drop the original
     if (m_cache.has(filename)) {
-        LOG_DEBUG("HGT cache hit: %s", filename.c_str());
-        return m_cache.read(filename);
+        auto elev = load_hgt_file(m_cache.path(filename), rows, cols);
+        if (!elev.empty()) {
+            LOG_INFO("HGT: converting cached %s to %s", filename.c_str(), key.c_str());
+            store_m3dt(coord, elev, rows, cols);
+            if (m_cache.has(key)) m_cache.remove(filename);
+            return elev;
+        }
+        LOG_WARN("HGT: cached %s is unreadable, downloading again", filename.c_str());
     }
 
     // Download and decompress
@@ -173,68 +265,81 @@ std::vector<uint8_t> HgtProvider::acquire_hgt(const std::string& filename) {
     if (compressed.empty()) return {};
 
     auto raw = decompress_gz(compressed);
+    compressed = {};
     if (raw.empty()) {
         LOG_WARN("HGT: decompression failed for %s", filename.c_str());
         return {};
     }
 
-    // Cache the uncompressed file
-    m_cache.write(filename, raw);
-    LOG_INFO("HGT: cached %s (%zu bytes)", filename.c_str(), raw.size());
-    return raw;
+    auto elev = read_hgt(raw, rows, cols);
+    raw = {};
+    if (!elev.empty()) store_m3dt(coord, elev, rows, cols);
+    return elev;
 }
 
-/* libcurl write callback */
-static size_t curl_write_cb(void* ptr, size_t size, size_t nmemb, void* userdata) {
-    auto* buf = static_cast<std::vector<uint8_t>*>(userdata);
-    size_t total = size * nmemb;
-    buf->insert(buf->end(),
-                static_cast<uint8_t*>(ptr),
-                static_cast<uint8_t*>(ptr) + total);
-    return total;
-}
+bool HgtProvider::open_cached(const TileCoord& coord, M3dtReader& reader) {
+    std::string key = m3dt_key(coord);
+    if (m_cache.has(key) && reader.open(m_cache.path(key))) return true;
 
-std::vector<uint8_t> HgtProvider::download_hgt(const std::string& filename) {
-    // Build S3 URL: https://s3.amazonaws.com/elevation-tiles-prod/skadi/N38/N38W106.hgt.gz
-    // Extract the lat directory from filename (first 3 chars, e.g. "N38")
-    std::string lat_dir = filename.substr(0, 3);
-    std::string url = "https://s3.amazonaws.com/elevation-tiles-prod/skadi/"
-                    + lat_dir + "/" + filename + ".gz";
+    /* Populate the cache through the full-tile path, then map the result */
+    int rows = 0, cols = 0;
+    if (acquire_hgt(coord, rows, cols).empty()) return false;
+    return m_cache.has(key) && reader.open(m_cache.path(key));
+}
 
-    LOG_INFO("HGT: downloading %s", url.c_str());
+std::optional<TileData> HgtProvider::fetch_tile_region(const TileCoord& coord,
+                                                       const mesh3d_bounds_t& bounds) {
+    std::string filename = coord_to_filename(coord);
+    M3dtReader reader;
+    if (!open_cached(coord, reader))
+        return TileProvider::fetch_tile_region(coord, bounds);
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        LOG_ERROR("HGT: curl_easy_init failed");
-        return {};
-    }
+    TileData td;
+    td.coord = coord;
+    int r0, r1, c0, c1;
+    if (!elevation_grid_region(hgt_tile_bounds(coord), reader.rows(), reader.cols(), bounds,
+                               r0, r1, c0, c1, td.bounds))
+        return std::nullopt;
 
-    std::vector<uint8_t> buffer;
-    buffer.reserve(3 * 1024 * 1024); // ~3MB typical compressed
+    td.elev_rows = r1 - r0;
+    td.elev_cols = c1 - c0;
+    td.elevation.resize(static_cast<size_t>(td.elev_rows) * td.elev_cols);
+    if (!reader.read_region(r0, r1, c0, c1, td.elevation.data(), td.elev_cols))
+        return std::nullopt;
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 15L);
+    LOG_INFO("HGT: loaded %s rows %d-%d cols %d-%d", filename.c_str(), r0, r1, c0, c1);
+    return td;
+}
 
-    CURLcode res = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    curl_easy_cleanup(curl);
+void HgtProvider::set_base_url(const std::string& url) {
+    m_base_url = url;
+    while (!m_base_url.empty() && m_base_url.back() == '/') m_base_url.pop_back();
+}
 
-    if (res != CURLE_OK) {
-        LOG_WARN("HGT: download failed: %s", curl_easy_strerror(res));
+std::vector<uint8_t> HgtProvider::download_hgt(const std::string& filename) {
+    // Build URL: <base>/N38/N38W106.hgt.gz
+    // Extract the lat directory from filename (first 3 chars, e.g. "N38")
+    std::string lat_dir = filename.substr(0, 3);
+    HttpRequest req;
+    req.url = m_base_url + "/" + lat_dir + "/" + filename + ".gz";
+    req.timeout_s = 60;
+    req.connect_timeout_s = 15;
+    req.size_hint = 3 * 1024 * 1024; // ~3MB typical compressed
+    req.max_bytes = 64u << 20;       // an SRTM1 tile is 25 MB uncompressed
+
+    LOG_INFO("HGT: downloading %s", req.url.c_str());
+    auto resp = HttpClient::shared().get(req);
+    if (!resp.error.empty()) {
+        LOG_WARN("HGT: download failed: %s", resp.error.c_str());
         return {};
     }
-    if (http_code != 200) {
-        LOG_WARN("HGT: HTTP %ld for %s", http_code, url.c_str());
+    if (resp.status != 200) {
+        LOG_WARN("HGT: HTTP %ld for %s", resp.status, req.url.c_str());
         return {};
     }
 
-    LOG_INFO("HGT: downloaded %zu bytes", buffer.size());
-    return buffer;
+    LOG_INFO("HGT: downloaded %zu bytes", resp.body.size());
+    return std::move(resp.body);
 }
 
 std::vector<uint8_t> HgtProvider::decompress_gz(const std::vector<uint8_t>& compressed) {
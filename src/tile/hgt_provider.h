@@ -1,6 +1,7 @@
 #pragma once
 #include "tile/tile_provider.h"
 #include "tile/disk_cache.h"
+#include "tile/m3dt.h"
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -8,7 +9,9 @@
 namespace mesh3d {
 
 /* Provides elevation data from SRTM HGT files.
-   Downloads .hgt.gz from AWS S3 on demand, caches to ~/.cache/mesh3d/hgt/.
+   Downloads .hgt.gz from AWS S3 (or set_base_url()) on demand and caches each tile in
+   ~/.cache/mesh3d/hgt/ as a block-compressed .m3dt (see tile/m3dt.h).
+   Raw .hgt files left by older versions are read once and converted.
    Each tile is 1 degree x 1 degree (SRTM1: 3601x3601, SRTM3: 1201x1201).
    TileCoord scheme: z=-1 (sentinel), x=floor(lon), y=floor(lat). */
 class HgtProvider : public TileProvider {
@@ -21,7 +24,16 @@ public:
     int max_zoom() const override { return 0; }
 
     std::optional<TileData> fetch_tile(const TileCoord& coord) override;
+    std::optional<TileData> fetch_tile_region(const TileCoord& coord,
+                                              const mesh3d_bounds_t& bounds) override;
     std::vector<TileCoord> tiles_in_bounds(const mesh3d_bounds_t& bounds, int zoom) const override;
+    bool is_local(const TileCoord& coord) const override;
+
+    /* Server root holding <lat>/<name>.hgt.gz (default: the AWS
+       elevation-tiles-prod skadi bucket). Lets tests and air-gapped
+       installs point at a local mirror. */
+    void set_base_url(const std::string& url);
+    const std::string& base_url() const { return m_base_url; }
 
     /* Get the 1-4 tiles the camera straddles (based on proximity to tile edges) */
     std::vector<TileCoord> tiles_in_view(double lat, double lon) const;
@@ -33,11 +45,26 @@ public:
     /* Get geographic bounds of an HGT tile */
     static mesh3d_bounds_t hgt_tile_bounds(const TileCoord& coord);
 
+    /* Decode raw big-endian int16 HGT bytes (SRTM1 or SRTM3) to meters.
+       Voids become 0. Returns empty on an unexpected size. */
+    static std::vector<float> read_hgt(const uint8_t* data, size_t size, int& rows, int& cols);
+    static std::vector<float> read_hgt(const std::vector<uint8_t>& data, int& rows, int& cols);
+
+    /* Decode an uncompressed .hgt file on disk. The file is mmap'd and
+       decoded straight into the result, so no byte copy is made. */
+    static std::vector<float> load_hgt_file(const std::string& path, int& rows, int& cols);
+
 private:
     DiskCache m_cache;
+    std::string m_base_url = "https://s3.amazonaws.com/elevation-tiles-prod/skadi";
 
-    std::vector<float> read_hgt(const std::vector<uint8_t>& data, int& rows, int& cols);
-    std::vector<uint8_t> acquire_hgt(const std::string& filename);
+    std::vector<float> acquire_hgt(const TileCoord& coord, int& rows, int& cols);
+    /* Open the .m3dt cache entry for `coord`, converting a legacy raw
+       .hgt or downloading as needed. False if no data can be had. */
+    bool open_cached(const TileCoord& coord, M3dtReader& reader);
+    void store_m3dt(const TileCoord& coord, const std::vector<float>& elev,
+                    int rows, int cols);
+    static std::string m3dt_key(const TileCoord& coord);
     std::vector<uint8_t> download_hgt(const std::string& filename);
     static std::vector<uint8_t> decompress_gz(const std::vector<uint8_t>& compressed);
 };
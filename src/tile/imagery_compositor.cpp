@@ -0,0 +1,218 @@
+#include "tile/imagery_compositor.h"
+#include "tile/tile_provider.h"
+#include "util/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mesh3d {
+
+static constexpr int TILE_PX = 256; // standard slippy tile size
+
+int imagery_tile_range(const mesh3d_bounds_t& bounds, int preferred_zoom, int max_dim,
+                       std::vector<TileCoord>& coords) {
+    for (int zoom = preferred_zoom; zoom >= 0; --zoom) {
+        coords = bounds_to_tile_range(bounds, zoom);
+        if (coords.empty()) return -1;
+
+        /* bounds_to_tile_range() walks rows then columns, so the first and
+           last coords are the range corners */
+        int tiles_x = coords.back().x - coords.front().x + 1;
+        int tiles_y = coords.back().y - coords.front().y + 1;
+        if (tiles_x <= max_dim && tiles_y <= max_dim) return zoom;
+    }
+    coords.clear();
+    return -1;
+}
+
+bool composite_imagery(const mesh3d_bounds_t& bounds, int zoom,
+                       const std::vector<TileCoord>& coords,
+                       const std::vector<std::optional<TileData>>& tiles,
+                       ImageryImage& out) {
+    if (coords.empty() || tiles.size() != coords.size()) return false;
+
+    int min_x = coords[0].x, max_x = min_x;
+    int min_y = coords[0].y, max_y = min_y;
+    for (auto& c : coords) {
+        min_x = std::min(min_x, c.x); max_x = std::max(max_x, c.x);
+        min_y = std::min(min_y, c.y); max_y = std::max(max_y, c.y);
+    }
+    int comp_w = (max_x - min_x + 1) * TILE_PX;
+    int comp_h = (max_y - min_y + 1) * TILE_PX;
+
+    /* Crop rectangle in mosaic pixels. The slippy grid is typically larger
+       than the elevation tile; fractional tile coordinates give the exact
+       pixel region. */
+    double fx0 = lon_to_tile_x_frac(bounds.min_lon, zoom) - min_x;
+    double fx1 = lon_to_tile_x_frac(bounds.max_lon, zoom) - min_x;
+    double fy0 = lat_to_tile_y_frac(bounds.max_lat, zoom) - min_y; // north = top
+    double fy1 = lat_to_tile_y_frac(bounds.min_lat, zoom) - min_y; // south = bottom
+
+    int cx0 = std::max(0, static_cast<int>(std::round(fx0 * TILE_PX)));
+    int cy0 = std::max(0, static_cast<int>(std::round(fy0 * TILE_PX)));
+    int cx1 = std::min(comp_w, static_cast<int>(std::round(fx1 * TILE_PX)));
+    int cy1 = std::min(comp_h, static_cast<int>(std::round(fy1 * TILE_PX)));
+    int crop_w = cx1 - cx0;
+    int crop_h = cy1 - cy0;
+    if (crop_w <= 0 || crop_h <= 0) return false;
+
+    out.rgba.assign(static_cast<size_t>(crop_w) * crop_h * 4, 0);
+    out.width = crop_w;
+    out.height = crop_h;
+
+    /* Each tile contributes only its intersection with the crop */
+    int fetched = 0;
+    for (size_t t = 0; t < coords.size(); ++t) {
+        auto& data = tiles[t];
+        if (!data || data->imagery.empty()) continue;
+        if (data->imagery.size() < static_cast<size_t>(data->img_width) * data->img_height * 4)
+            continue;
+        ++fetched;
+
+        int ox = (coords[t].x - min_x) * TILE_PX;
+        int oy = (coords[t].y - min_y) * TILE_PX;
+        int x0 = std::max(ox, cx0);
+        int x1 = std::min(ox + std::min(data->img_width, TILE_PX), cx1);
+        int y0 = std::max(oy, cy0);
+        int y1 = std::min(oy + std::min(data->img_height, TILE_PX), cy1);
+        if (x0 >= x1 || y0 >= y1) continue;
+
+        for (int y = y0; y < y1; ++y) {
+            size_t src = (static_cast<size_t>(y - oy) * data->img_width + (x0 - ox)) * 4;
+            size_t dst = (static_cast<size_t>(y - cy0) * crop_w + (x0 - cx0)) * 4;
+            std::memcpy(&out.rgba[dst], &data->imagery[src], static_cast<size_t>(x1 - x0) * 4);
+        }
+    }
+    if (fetched == 0) {
+        out.rgba.clear();
+        out.width = out.height = 0;
+        return false;
+    }
+
+    LOG_INFO("Composited %d/%zu imagery tiles, cropped %dx%d -> %dx%d px",
+             fetched, coords.size(), comp_w, comp_h, crop_w, crop_h);
+    return true;
+}
+
+ImageryCompositor::~ImageryCompositor() {
+    stop();
+}
+
+void ImageryCompositor::start() {
+    if (m_running.load()) return;
+    m_running.store(true);
+    for (int i = 0; i < DEFAULT_WORKERS; ++i)
+        m_threads.emplace_back(&ImageryCompositor::worker_loop, this);
+    LOG_INFO("ImageryCompositor: %d workers started", DEFAULT_WORKERS);
+}
+
+void ImageryCompositor::stop() {
+    if (!m_running.load()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.store(false);
+    }
+    m_cv.notify_all();
+    for (auto& t : m_threads)
+        if (t.joinable()) t.join();
+    m_threads.clear();
+}
+
+void ImageryCompositor::request(const TileCoord& coord, const mesh3d_bounds_t& bounds,
+                                int zoom, std::shared_ptr<TileProvider> provider) {
+    if (!provider) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pending.count(coord)) return;
+    auto failed = m_failed.find(coord);
+    if (failed != m_failed.end() && std::chrono::steady_clock::now() < failed->second.retry_at)
+        return;
+    m_pending.insert(coord);
+    m_jobs.push_back({coord, bounds, zoom, std::move(provider), m_generation});
+    m_cv.notify_one();
+}
+
+bool ImageryCompositor::poll_result(ImageryImage& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_results.empty()) {
+        out = std::move(m_results.front());
+        m_results.pop_front();
+        if (out.generation != m_generation) continue;
+        /* Pending until drained, so the tile is not requested again while
+           its image waits for upload */
+        m_pending.erase(out.coord);
+        return true;
+    }
+    return false;
+}
+
+bool ImageryCompositor::is_pending(const TileCoord& coord) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.count(coord) > 0;
+}
+
+void ImageryCompositor::invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_jobs.clear();
+    m_results.clear();
+    m_pending.clear();
+    m_failed.clear();
+}
+
+size_t ImageryCompositor::queued() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+void ImageryCompositor::worker_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return !m_jobs.empty() || !m_running.load(); });
+            if (!m_running.load()) break;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        ImageryImage img;
+        img.coord = job.coord;
+        img.generation = job.generation;
+        bool ok = false;
+        try {
+            std::vector<TileCoord> coords;
+            int zoom = imagery_tile_range(job.bounds, job.zoom, MAX_IMAGERY_COMPOSITE_DIM, coords);
+            if (zoom >= 0) {
+                /* One batch: cache misses download concurrently */
+                auto tiles = job.provider->fetch_tiles(coords);
+                ok = composite_imagery(job.bounds, zoom, coords, tiles, img);
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("ImageryCompositor: z=%d x=%d y=%d failed: %s",
+                      job.coord.z, job.coord.x, job.coord.y, e.what());
+        }
+        job.provider.reset();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (job.generation != m_generation) continue; // source changed mid-job
+        if (ok) {
+            m_failed.erase(job.coord);
+            m_results.push_back(std::move(img));
+        } else {
+            /* Retried with backoff rather than on every request (the old
+               synchronous path re-fetched every frame), so a transient
+               network or disk failure does not black the tile out */
+            m_pending.erase(job.coord);
+            Failure& f = m_failed[job.coord];
+            ++f.attempts;
+            auto backoff = std::min<std::chrono::seconds>(
+                RETRY_MIN * (1 << std::min(f.attempts - 1, 8)), RETRY_MAX);
+            f.retry_at = std::chrono::steady_clock::now() + backoff;
+            LOG_DEBUG("ImageryCompositor: z=%d x=%d y=%d failed (%d), retry in %llds",
+                      job.coord.z, job.coord.x, job.coord.y, f.attempts,
+                      static_cast<long long>(backoff.count()));
+        }
+    }
+}
+
+} // namespace mesh3d
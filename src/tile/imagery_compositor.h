@@ -0,0 +1,120 @@
+#pragma once
+#include "tile/tile_coord.h"
+#include "tile/tile_data.h"
+#include <mesh3d/types.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mesh3d {
+
+class TileProvider;
+
+/* RGBA imagery cropped to one elevation tile's bounds */
+struct ImageryImage {
+    TileCoord coord{};          // elevation tile this image drapes over
+    std::vector<uint8_t> rgba;
+    int width = 0, height = 0;
+    uint64_t generation = 0;    // ImageryCompositor::invalidate() epoch
+};
+
+/* Largest composite, in slippy tiles per side (16x16 = 4096x4096 px) */
+constexpr int MAX_IMAGERY_COMPOSITE_DIM = 16;
+
+/* Slippy tiles covering `bounds`, at `preferred_zoom` or the highest lower
+   zoom whose range fits within max_dim x max_dim tiles. Returns the zoom
+   used, or -1 if no zoom fits. */
+int imagery_tile_range(const mesh3d_bounds_t& bounds, int preferred_zoom, int max_dim,
+                       std::vector<TileCoord>& coords);
+
+/* Copy the parts of the decoded slippy `tiles` (parallel to `coords`, all at
+   `zoom`) that fall inside `bounds` straight into a cropped RGBA image.
+   The full tile mosaic is never materialized. Returns false if no tile
+   contributed pixels or the crop is empty. */
+bool composite_imagery(const mesh3d_bounds_t& bounds, int zoom,
+                       const std::vector<TileCoord>& coords,
+                       const std::vector<std::optional<TileData>>& tiles,
+                       ImageryImage& out);
+
+/* Background workers that build imagery textures for elevation tiles.
+   Each job runs the whole CPU pipeline off the render thread: zoom
+   selection, TileProvider::fetch_tiles() (concurrent download + decode),
+   then composite-and-crop. The main thread only drains finished images and
+   uploads them (see TileManager::drain_ready_tiles()).
+
+   Jobs hold a shared_ptr to their provider, so swapping the imagery source
+   never destroys a provider under a running job. invalidate() starts a new
+   generation: queued jobs are dropped and images from older generations
+   are discarded by poll_result(). */
+class ImageryCompositor {
+public:
+    static constexpr int DEFAULT_WORKERS = 2;
+
+    ImageryCompositor() = default;
+    ~ImageryCompositor();
+
+    void start();
+    /* Signal workers to stop and join. Queued jobs are kept. */
+    void stop();
+
+    /* Enqueue a composite for elevation tile `coord` (thread-safe). Ignored
+       if the tile is already queued, in flight or awaiting drain, or if it
+       failed and its retry backoff has not yet expired. */
+    void request(const TileCoord& coord, const mesh3d_bounds_t& bounds, int zoom,
+                 std::shared_ptr<TileProvider> provider);
+
+    /* Dequeue one finished image from the current generation */
+    bool poll_result(ImageryImage& out);
+
+    bool is_pending(const TileCoord& coord) const;
+
+    /* Drop all queued jobs and any results not yet drained; forget failures
+       (e.g. after the imagery source changed) */
+    void invalidate();
+
+    size_t queued() const;
+
+    ImageryCompositor(const ImageryCompositor&) = delete;
+    ImageryCompositor& operator=(const ImageryCompositor&) = delete;
+
+private:
+    struct Job {
+        TileCoord coord;
+        mesh3d_bounds_t bounds;
+        int zoom;
+        std::shared_ptr<TileProvider> provider;
+        uint64_t generation;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running{false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    std::unordered_set<TileCoord> m_pending;  // queued, in flight or awaiting drain
+    /* Failed composites are retried after a backoff that doubles per
+       failure, from RETRY_MIN up to RETRY_MAX */
+    static constexpr std::chrono::seconds RETRY_MIN{5};
+    static constexpr std::chrono::seconds RETRY_MAX{300};
+    struct Failure {
+        int attempts = 0;
+        std::chrono::steady_clock::time_point retry_at;
+    };
+    std::unordered_map<TileCoord, Failure> m_failed;
+    std::deque<ImageryImage> m_results;
+    uint64_t m_generation = 0;
+
+    void worker_loop();
+};
+
+} // namespace mesh3d
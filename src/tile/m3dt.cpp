@@ -0,0 +1,267 @@
+#include "tile/m3dt.h"
+#include "util/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <zlib.h>
+
+namespace mesh3d {
+
+static constexpr uint16_t M3DT_VERSION = 1;
+static constexpr uint32_t CODEC_DEFLATE = 1;
+static constexpr size_t HEADER_SIZE = 64;
+static constexpr size_t INDEX_ENTRY_SIZE = 16;
+
+/* ── Little-endian field helpers ───────────────────────────────────── */
+
+template<typename T>
+static void put_le(uint8_t* p, T v) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &v, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) p[i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+template<typename T>
+static T get_le(const uint8_t* p) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) bits |= static_cast<uint64_t>(p[i]) << (8 * i);
+    T v;
+    std::memcpy(&v, &bits, sizeof(T));
+    return v;
+}
+
+/* ── Block transform ──────────────────────────────────────────────── */
+
+/* Gradient predictor on quantized heights. Arithmetic is done in uint32 so
+   residuals wrap instead of overflowing; the decoder wraps identically. */
+static inline uint32_t predict(const uint32_t* q, int r, int c, int w) {
+    if (r == 0) return c == 0 ? 0u : q[c - 1];
+    if (c == 0) return q[(r - 1) * w];
+    return q[r * w + c - 1] + q[(r - 1) * w + c] - q[(r - 1) * w + c - 1];
+}
+
+static void encode_block(const float* src, int src_stride, int h, int w, float quant,
+                         std::vector<uint8_t>& out) {
+    const int n = h * w;
+    std::vector<uint32_t> q(n);
+    const float inv = 1.0f / quant;
+    for (int r = 0; r < h; ++r) {
+        for (int c = 0; c < w; ++c) {
+            float v = src[r * src_stride + c];
+            if (!std::isfinite(v) || v < -1000.0f) v = M3DT_VOID;
+            q[r * w + c] = static_cast<uint32_t>(static_cast<int32_t>(std::lrintf(v * inv)));
+        }
+    }
+
+    /* Residuals -> zigzag; only as many byte planes as the largest needs */
+    std::vector<uint32_t> zz(n);
+    uint32_t all = 0;
+    for (int r = 0; r < h; ++r) {
+        for (int c = 0; c < w; ++c) {
+            int i = r * w + c;
+            uint32_t res = q[i] - predict(q.data(), r, c, w);
+            zz[i] = (res << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(res) >> 31);
+            all |= zz[i];
+        }
+    }
+    int nplanes = 1;
+    while (nplanes < 4 && (all >> (8 * nplanes)) != 0) ++nplanes;
+
+    std::vector<uint8_t> planes(static_cast<size_t>(n) * nplanes);
+    for (int p = 0; p < nplanes; ++p)
+        for (int i = 0; i < n; ++i)
+            planes[static_cast<size_t>(p) * n + i] = static_cast<uint8_t>(zz[i] >> (8 * p));
+
+    uLongf len = compressBound(static_cast<uLong>(planes.size()));
+    out.resize(1 + len);
+    out[0] = static_cast<uint8_t>(nplanes);
+    compress2(out.data() + 1, &len, planes.data(), static_cast<uLong>(planes.size()), 6);
+    out.resize(1 + len);
+}
+
+std::vector<uint8_t> m3dt_encode(const float* elevation, int rows, int cols,
+                                 const mesh3d_bounds_t& bounds, float quant_step,
+                                 int block_dim) {
+    if (!elevation || rows <= 0 || cols <= 0 || quant_step <= 0.0f || block_dim <= 0)
+        return {};
+
+    const int bx_n = (cols + block_dim - 1) / block_dim;
+    const int by_n = (rows + block_dim - 1) / block_dim;
+    const uint32_t block_count = static_cast<uint32_t>(bx_n * by_n);
+
+    std::vector<std::vector<uint8_t>> payloads(block_count);
+    for (int by = 0; by < by_n; ++by) {
+        for (int bx = 0; bx < bx_n; ++bx) {
+            int r0 = by * block_dim, c0 = bx * block_dim;
+            int h = std::min(block_dim, rows - r0);
+            int w = std::min(block_dim, cols - c0);
+            encode_block(elevation + static_cast<size_t>(r0) * cols + c0, cols, h, w,
+                         quant_step, payloads[by * bx_n + bx]);
+        }
+    }
+
+    size_t total = HEADER_SIZE + block_count * INDEX_ENTRY_SIZE;
+    for (const auto& p : payloads) total += p.size();
+    std::vector<uint8_t> file(total, 0);
+
+    uint8_t* h = file.data();
+    std::memcpy(h, "M3DT", 4);
+    put_le<uint16_t>(h + 4, M3DT_VERSION);
+    put_le<uint16_t>(h + 6, static_cast<uint16_t>(block_dim));
+    put_le<uint32_t>(h + 8, static_cast<uint32_t>(rows));
+    put_le<uint32_t>(h + 12, static_cast<uint32_t>(cols));
+    put_le<float>(h + 16, quant_step);
+    put_le<uint32_t>(h + 20, CODEC_DEFLATE);
+    put_le<double>(h + 24, bounds.min_lat);
+    put_le<double>(h + 32, bounds.max_lat);
+    put_le<double>(h + 40, bounds.min_lon);
+    put_le<double>(h + 48, bounds.max_lon);
+    put_le<uint32_t>(h + 56, block_count);
+
+    size_t offset = HEADER_SIZE + block_count * INDEX_ENTRY_SIZE;
+    for (uint32_t b = 0; b < block_count; ++b) {
+        uint8_t* e = h + HEADER_SIZE + b * INDEX_ENTRY_SIZE;
+        put_le<uint64_t>(e, offset);
+        put_le<uint32_t>(e + 8, static_cast<uint32_t>(payloads[b].size()));
+        std::memcpy(h + offset, payloads[b].data(), payloads[b].size());
+        offset += payloads[b].size();
+    }
+    return file;
+}
+
+/* ── Reader ───────────────────────────────────────────────────────── */
+
+bool M3dtReader::open(const std::string& path) {
+    close();
+    if (!m_file.open(path, false)) return false;
+
+    const uint8_t* h = m_file.data();
+    size_t size = m_file.size();
+    if (size < HEADER_SIZE || std::memcmp(h, "M3DT", 4) != 0 ||
+        get_le<uint16_t>(h + 4) != M3DT_VERSION ||
+        get_le<uint32_t>(h + 20) != CODEC_DEFLATE) {
+        LOG_WARN("M3DT: %s is not a supported tile file", path.c_str());
+        close();
+        return false;
+    }
+
+    m_block_dim = get_le<uint16_t>(h + 6);
+    m_rows = static_cast<int>(get_le<uint32_t>(h + 8));
+    m_cols = static_cast<int>(get_le<uint32_t>(h + 12));
+    m_quant = get_le<float>(h + 16);
+    m_bounds.min_lat = get_le<double>(h + 24);
+    m_bounds.max_lat = get_le<double>(h + 32);
+    m_bounds.min_lon = get_le<double>(h + 40);
+    m_bounds.max_lon = get_le<double>(h + 48);
+    uint32_t block_count = get_le<uint32_t>(h + 56);
+
+    if (m_block_dim <= 0 || m_rows <= 0 || m_cols <= 0 || !(m_quant > 0.0f)) {
+        close();
+        return false;
+    }
+    m_blocks_x = (m_cols + m_block_dim - 1) / m_block_dim;
+    m_blocks_y = (m_rows + m_block_dim - 1) / m_block_dim;
+
+    /* A truncated or inconsistent file (e.g. an interrupted write) is a miss */
+    if (block_count != static_cast<uint32_t>(m_blocks_x * m_blocks_y) ||
+        size < HEADER_SIZE + block_count * INDEX_ENTRY_SIZE) {
+        LOG_WARN("M3DT: %s has a damaged index", path.c_str());
+        close();
+        return false;
+    }
+    m_index.resize(block_count);
+    for (uint32_t b = 0; b < block_count; ++b) {
+        const uint8_t* e = h + HEADER_SIZE + b * INDEX_ENTRY_SIZE;
+        m_index[b].offset = get_le<uint64_t>(e);
+        m_index[b].size = get_le<uint32_t>(e + 8);
+        if (m_index[b].offset + m_index[b].size > size) {
+            LOG_WARN("M3DT: %s is truncated", path.c_str());
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void M3dtReader::close() {
+    m_file.close();
+    m_index.clear();
+    m_rows = m_cols = m_block_dim = 0;
+    m_blocks_x = m_blocks_y = 0;
+}
+
+bool M3dtReader::decode_block(int by, int bx, std::vector<int32_t>& out, int& h, int& w) const {
+    h = std::min(m_block_dim, m_rows - by * m_block_dim);
+    w = std::min(m_block_dim, m_cols - bx * m_block_dim);
+    const int n = h * w;
+    const BlockRef& ref = m_index[by * m_blocks_x + bx];
+
+    const uint8_t* payload = m_file.data() + ref.offset;
+    int nplanes = ref.size > 0 ? payload[0] : 0;
+    if (nplanes < 1 || nplanes > 4) {
+        LOG_WARN("M3DT: block (%d,%d) has a bad header", by, bx);
+        return false;
+    }
+    std::vector<uint8_t> planes(static_cast<size_t>(n) * nplanes);
+    uLongf len = static_cast<uLongf>(planes.size());
+    if (uncompress(planes.data(), &len, payload + 1, ref.size - 1) != Z_OK ||
+        len != planes.size()) {
+        LOG_WARN("M3DT: block (%d,%d) failed to inflate", by, bx);
+        return false;
+    }
+
+    out.resize(n);
+    uint32_t* q = reinterpret_cast<uint32_t*>(out.data());
+    for (int i = 0; i < n; ++i) q[i] = planes[i];
+    for (int p = 1; p < nplanes; ++p) {
+        const uint8_t* plane = &planes[static_cast<size_t>(p) * n];
+        for (int i = 0; i < n; ++i) q[i] |= static_cast<uint32_t>(plane[i]) << (8 * p);
+    }
+
+    /* Undo zigzag, then the predictor; the first row and column only have
+       one neighbour, the interior runs the full gradient */
+    for (int i = 0; i < n; ++i) q[i] = (q[i] >> 1) ^ (0u - (q[i] & 1u));
+    for (int c = 1; c < w; ++c) q[c] += q[c - 1];
+    for (int r = 1; r < h; ++r) {
+        uint32_t* row = q + r * w;
+        const uint32_t* up = row - w;
+        row[0] += up[0];
+        for (int c = 1; c < w; ++c) row[c] += row[c - 1] + up[c] - up[c - 1];
+    }
+    return true;
+}
+
+bool M3dtReader::read_region(int r0, int r1, int c0, int c1, float* dst, int dst_stride) const {
+    if (!m_file.valid()) return false;
+    r0 = std::max(r0, 0); c0 = std::max(c0, 0);
+    r1 = std::min(r1, m_rows); c1 = std::min(c1, m_cols);
+    if (r0 >= r1 || c0 >= c1) return true;
+
+    const int bd = m_block_dim;
+    std::vector<int32_t> q;
+    for (int by = r0 / bd; by <= (r1 - 1) / bd; ++by) {
+        for (int bx = c0 / bd; bx <= (c1 - 1) / bd; ++bx) {
+            int h = 0, w = 0;
+            if (!decode_block(by, bx, q, h, w)) return false;
+
+            int br0 = by * bd, bc0 = bx * bd;
+            int rr0 = std::max(r0, br0), rr1 = std::min(r1, br0 + h);
+            int cc0 = std::max(c0, bc0), cc1 = std::min(c1, bc0 + w);
+            for (int r = rr0; r < rr1; ++r) {
+                const int32_t* src = &q[(r - br0) * w + (cc0 - bc0)];
+                float* out = dst + static_cast<size_t>(r - r0) * dst_stride + (cc0 - c0);
+                for (int c = 0; c < cc1 - cc0; ++c)
+                    out[c] = static_cast<float>(src[c]) * m_quant;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<float> M3dtReader::read_all() const {
+    std::vector<float> out(static_cast<size_t>(m_rows) * m_cols);
+    if (!read_region(0, m_rows, 0, m_cols, out.data(), m_cols)) return {};
+    return out;
+}
+
+} // namespace mesh3d
@@ -0,0 +1,69 @@
+#pragma once
+#include "util/mapped_file.h"
+#include <mesh3d/types.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* .m3dt — native tiled elevation cache.
+
+   A fixed 64-byte header, a block index, then one independently
+   compressed payload per BLOCK_DIM x BLOCK_DIM block (edge blocks are
+   smaller). All integers are little-endian.
+
+     header  "M3DT" u16 version u16 block_dim u32 rows u32 cols
+             f32 quant_step u32 codec f64 min_lat max_lat min_lon max_lon
+             u32 block_count u32 reserved
+     index   block_count x { u64 offset, u32 size, u32 reserved }
+     blocks  row-major by block
+
+   Block encoding: heights are quantized to quant_step (1 m is lossless for
+   HGT), predicted from their left/up/up-left neighbours (gradient
+   predictor), zigzag-mapped, byte-shuffled into planes so like bytes run
+   together, then deflated. A block stores only as many planes (1-4) as its
+   largest residual needs, recorded in a leading byte. Voids (non-finite or below
+   -1000 m) are stored as M3DT_VOID. */
+
+static constexpr int   M3DT_BLOCK_DIM = 256;
+static constexpr float M3DT_VOID = -9999.0f;
+
+/* Encode a row-major grid into a complete .m3dt image */
+std::vector<uint8_t> m3dt_encode(const float* elevation, int rows, int cols,
+                                 const mesh3d_bounds_t& bounds, float quant_step,
+                                 int block_dim = M3DT_BLOCK_DIM);
+
+/* Random-access reader over a mapped .m3dt file. Blocks are decoded on
+   demand, so a region read touches only the blocks it intersects. */
+class M3dtReader {
+public:
+    bool open(const std::string& path);
+    void close();
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int block_dim() const { return m_block_dim; }
+    float quant_step() const { return m_quant; }
+    const mesh3d_bounds_t& bounds() const { return m_bounds; }
+
+    /* Decode rows [r0,r1) x cols [c0,c1) into dst (dst_stride floats per row) */
+    bool read_region(int r0, int r1, int c0, int c1, float* dst, int dst_stride) const;
+
+    /* Whole grid */
+    std::vector<float> read_all() const;
+
+private:
+    struct BlockRef { uint64_t offset; uint32_t size; };
+
+    MappedFile m_file;
+    int m_rows = 0, m_cols = 0, m_block_dim = 0;
+    int m_blocks_x = 0, m_blocks_y = 0;
+    float m_quant = 1.0f;
+    mesh3d_bounds_t m_bounds{};
+    std::vector<BlockRef> m_index;
+
+    bool decode_block(int by, int bx, std::vector<int32_t>& out, int& h, int& w) const;
+};
+
+} // namespace mesh3d
@@ -41,6 +41,11 @@ TileRenderable* TileCache::get(const TileCoord& coord) {
     return &it->second.tile;
 }
 
+const TileRenderable* TileCache::find(const TileCoord& coord) const {
+    auto it = m_map.find(coord);
+    return it != m_map.end() ? &it->second.tile : nullptr;
+}
+
 bool TileCache::has(const TileCoord& coord) const {
     return m_map.find(coord) != m_map.end();
 }
@@ -21,6 +21,9 @@ public:
     /* Get cached tile, or nullptr if not present. Touches (marks as recently used). */
     TileRenderable* get(const TileCoord& coord);
 
+    /* Cached tile without touching the LRU order, or nullptr */
+    const TileRenderable* find(const TileCoord& coord) const;
+
     /* Check if tile is cached */
     bool has(const TileCoord& coord) const;
 
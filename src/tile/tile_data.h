@@ -1,6 +1,6 @@
 #pragma once
 #include "tile/tile_coord.h"
-#include "render/mesh.h"
+#include "scene/terrain_lod.h"
 #include "render/texture.h"
 #include <mesh3d/types.h>
 #include <glm/glm.hpp>
@@ -17,6 +17,7 @@ struct TileData {
     /* Elevation grid */
     std::vector<float> elevation;
     int elev_rows = 0, elev_cols = 0;
+    uint64_t elevation_hash = 0;  // hash_tile_elevation(), set by prepare(); 0 = not yet
 
     /* Imagery (RGBA) */
     std::vector<uint8_t> imagery;
@@ -25,6 +26,11 @@ struct TileData {
     /* Overlay data */
     std::vector<uint8_t> viewshed;
     std::vector<float> signal;
+
+    /* Terrain mesh built on the loader worker (TileTerrainBuilder::prepare()),
+       so the main thread only uploads it. Empty if not prepared. */
+    TerrainLodData lod;
+    uint64_t lod_epoch = 0;  // TileManager settings the mesh was built with
 };
 
 /* GPU-side tile ready for rendering.
@@ -32,13 +38,14 @@ struct TileData {
 struct TileRenderable {
     TileCoord coord;
     mesh3d_bounds_t bounds;
-    Mesh mesh;
+    TerrainLodMesh mesh;     // chunked geomipmap terrain
     Texture texture;
     glm::mat4 model{1.0f};
 
     /* CPU-side elevation retained for sampling */
     std::vector<float> elevation;
     int elev_rows = 0, elev_cols = 0;
+    uint64_t elevation_hash = 0;  // hash_tile_elevation() of `elevation`
 
     /* CPU-side overlay data (populated by viewshed computation) */
     std::vector<uint8_t> viewshed;
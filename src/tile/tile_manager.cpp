@@ -1,17 +1,94 @@
 #include "tile/tile_manager.h"
 #include "tile/hgt_provider.h"
 #include "tile/url_tile_provider.h"
+#include "tile/composite_elevation.h"
+#include "tile/elevation_atlas.h"
 #include "analysis/viewshed.h"
+#include "analysis/viewshed_engine.h"
 #include "analysis/gpu_viewshed.h"
+#include "analysis/coverage_cache.h"
+#include "analysis/coverage_disk_cache.h"
 #include "scene/scene.h"
 #include "camera/camera.h"
 #include "util/log.h"
-#include <cstring>
+#include <cmath>
 #include <algorithm>
+#include <unordered_set>
 #include <chrono>
+#include <utility>
 
 namespace mesh3d {
 
+/* Node-to-tile index for the tile viewshed paths: the nodes whose link
+   budget (node_link_range_m) can reach any cell of `tr`. Nodes beyond it
+   leave every cell of the tile invisible, so dropping them does not
+   change the merged result. */
+static std::vector<uint32_t> nodes_in_range(const TileRenderable& tr,
+                                            const std::vector<NodeData>& nodes,
+                                            const std::vector<float>& ranges_m) {
+    std::vector<uint32_t> idx;
+    for (size_t i = 0; i < nodes.size(); ++i)
+        if (node_reaches_bounds(nodes[i], ranges_m[i], tr.bounds, tr.elev_rows, tr.elev_cols))
+            idx.push_back(static_cast<uint32_t>(i));
+    return idx;
+}
+
+static std::vector<float> link_ranges(const std::vector<NodeData>& nodes,
+                                      const mesh3d_rf_config_t& rf_config) {
+    std::vector<float> ranges;
+    ranges.reserve(nodes.size());
+    for (auto& nd : nodes) ranges.push_back(node_link_range_m(nd, rf_config));
+    return ranges;
+}
+
+static std::vector<NodeData> select_nodes(const std::vector<NodeData>& nodes,
+                                          const std::vector<uint32_t>& idx) {
+    std::vector<NodeData> out;
+    out.reserve(idx.size());
+    for (uint32_t i : idx)
+        if (i < nodes.size()) out.push_back(nodes[i]);
+    return out;
+}
+
+/* Overlay of a tile no node can reach */
+static void set_empty_overlay(TileRenderable& tr) {
+    size_t total = static_cast<size_t>(tr.elev_rows) * tr.elev_cols;
+    tr.viewshed.assign(total, 0);
+    tr.signal.assign(total, -999.0f);
+}
+
+/* Disk-cache key of a tile's merged overlay: the composite it is computed
+   on (content hash and geometry, so `ce` need not hold its data), the center window, the in-range nodes
+   and the propagation settings. `refined` marks progressive results,
+   whose interiors come from a coarser level. */
+static CoverageCache::Key tile_coverage_key(const CompositeElevation& ce,
+                                            const std::vector<NodeData>& nodes,
+                                            const std::vector<uint32_t>& in_range,
+                                            const mesh3d_rf_config_t& rf_config,
+                                            const GpuViewshed* gpu,
+                                            bool refined = false) {
+    CoverageContext ctx = make_coverage_context(ce.rows, ce.cols, ce.bounds,
+                                                ce.elevation_hash, rf_config, gpu);
+    std::vector<CoverageCache::Key> keys;
+    keys.reserve(in_range.size());
+    for (uint32_t i : in_range) keys.push_back(CoverageCache::key(nodes[i].info, ctx));
+    if (refined) keys.push_back(0x70726f6772657373ull);
+    return CoverageCache::merged_key(keys, ce.center_row_start, ce.center_col_start,
+                                     ce.center_rows, ce.center_cols);
+}
+
+static bool load_tile_coverage(TileRenderable& tr, CoverageCache::Key key) {
+    CoverageRect rect;
+    if (!coverage_disk_cache().read(key, rect)) return false;
+    rect.expand(tr.elev_rows, tr.elev_cols, tr.viewshed, tr.signal);
+    return true;
+}
+
+static void store_tile_coverage(const TileRenderable& tr, CoverageCache::Key key) {
+    coverage_disk_cache().write(key, CoverageRect::crop(tr.viewshed, tr.signal,
+                                                        tr.elev_rows, tr.elev_cols));
+}
+
 void TileManager::set_elevation_provider(std::unique_ptr<TileProvider> provider) {
     m_elev_provider = std::move(provider);
     m_elev_loaded = false;
@@ -19,7 +96,9 @@ void TileManager::set_elevation_provider(std::unique_ptr<TileProvider> provider)
 
 void TileManager::set_imagery_provider(std::unique_ptr<TileProvider> provider) {
     m_imagery_provider = std::move(provider);
-    /* Clear cached imagery textures — geometry stays */
+    /* Composites from the old provider are no longer wanted */
+    m_imagery.invalidate();
+    drop_staged_textures();
 }
 
 void TileManager::set_imagery_source(ImagerySource src) {
@@ -38,6 +117,8 @@ void TileManager::set_imagery_source(ImagerySource src) {
         m_imagery_provider.reset();
         break;
     }
+    m_imagery.invalidate();
+    drop_staged_textures();
 
     /* Strip textures from ALL cached tiles so they get new imagery,
        but keep the geometry (meshes) intact to avoid re-reading HGT data. */
@@ -57,6 +138,7 @@ void TileManager::cycle_imagery_source() {
 void TileManager::set_bounds(const mesh3d_bounds_t& bounds) {
     m_bounds = bounds;
     m_proj.init(bounds);
+    m_mesh_settings_dirty = true;
     m_bounds_set = true;
     m_elev_loaded = false;
 }
@@ -76,7 +158,7 @@ void TileManager::ensure_elevation_tiles() {
     bool all_loaded = true;
     for (auto& coord : m_visible_elev) {
         if (m_cache.has(coord)) continue;
-        if (m_loader.is_pending(coord)) {
+        if (m_loader.is_pending(coord) || m_staged_tiles.count(coord)) {
             all_loaded = false;
             continue;
         }
@@ -102,123 +184,61 @@ void TileManager::ensure_imagery_tiles() {
 
     m_visible_imagery = m_selector.select(m_bounds);
 
-    /* Composite imagery for tiles that still need textures.
-       composite_imagery_for_tile calls fetch_tile synchronously per imagery
-       sub-tile; the provider's disk cache prevents redundant downloads. */
+    /* Queue a background composite for each tile still missing its
+       texture; drain_ready_tiles() uploads the finished images */
     for (auto& elev_coord : m_visible_elev) {
         TileRenderable* tr = m_cache.get(elev_coord);
-        if (!tr || tr->texture.valid()) continue;
-        composite_imagery_for_tile(tr);
+        if (!tr || tr->texture.valid() || m_staged_tex.count(elev_coord)) continue;
+        m_imagery.request(elev_coord, tr->bounds, m_selector.fixed_zoom, m_imagery_provider);
     }
 }
 
-void TileManager::composite_imagery_for_tile(TileRenderable* tr) {
-    if (!m_imagery_provider || !tr) return;
-
-    /* Find a zoom level where the tile fits within MAX_COMPOSITE_DIM.
-       Start from the selector's preferred zoom and reduce if needed. */
-    static constexpr int MAX_COMPOSITE_DIM = 16; // 16x16 tiles = 4096x4096
-
-    int zoom = m_selector.fixed_zoom;
-    std::vector<TileCoord> imagery_coords;
-    int min_x, max_x, min_y, max_y, tiles_x, tiles_y;
-
-    while (zoom >= 0) {
-        imagery_coords = bounds_to_tile_range(tr->bounds, zoom);
-        if (imagery_coords.empty()) return;
-
-        min_x = imagery_coords[0].x; max_x = min_x;
-        min_y = imagery_coords[0].y; max_y = min_y;
-        for (auto& c : imagery_coords) {
-            if (c.x < min_x) min_x = c.x;
-            if (c.x > max_x) max_x = c.x;
-            if (c.y < min_y) min_y = c.y;
-            if (c.y > max_y) max_y = c.y;
+void TileManager::select_lod(const Camera& cam, float aspect, int viewport_h) {
+    float ppr = static_cast<float>(std::max(viewport_h, 1)) /
+                (2.0f * std::tan(glm::radians(cam.fov) * 0.5f));
+    const Frustum frustum = cam.frustum(aspect);
+
+    std::vector<std::pair<float, TileCoord>> kept;
+    m_render_stats = TileRenderStats();
+    auto select = [&](TileRenderable& tr) {
+        if (!tr.mesh.valid()) return;
+        const glm::vec3& mn = tr.mesh.bbox_min();
+        const glm::vec3& mx = tr.mesh.bbox_max();
+        if (!frustum.intersects_aabb(mn, mx)) {
+            ++m_render_stats.tiles_culled;
+            return;
         }
-        tiles_x = max_x - min_x + 1;
-        tiles_y = max_y - min_y + 1;
-
-        if (tiles_x <= MAX_COMPOSITE_DIM && tiles_y <= MAX_COMPOSITE_DIM)
-            break;
-        --zoom;
-    }
-    if (zoom < 0) return;
-
-    int tile_px = 256; // standard slippy tile size
-    int comp_w = tiles_x * tile_px;
-    int comp_h = tiles_y * tile_px;
-    std::vector<uint8_t> composite(comp_w * comp_h * 4, 0);
-
-    int fetched = 0;
-    for (auto& coord : imagery_coords) {
-        auto data = m_imagery_provider->fetch_tile(coord);
-        if (!data || data->imagery.empty()) continue;
-
-        int ox = (coord.x - min_x) * tile_px;
-        int oy = (coord.y - min_y) * tile_px;
-
-        /* Copy tile pixels into composite */
-        int tw = std::min(data->img_width, tile_px);
-        int th = std::min(data->img_height, tile_px);
-        for (int row = 0; row < th; ++row) {
-            int src_off = row * data->img_width * 4;
-            int dst_off = ((oy + row) * comp_w + ox) * 4;
-            if (dst_off + tw * 4 <= static_cast<int>(composite.size()) &&
-                src_off + tw * 4 <= static_cast<int>(data->imagery.size())) {
-                std::memcpy(&composite[dst_off], &data->imagery[src_off], tw * 4);
-            }
+        tr.mesh.select_lod(cam.position, ppr, m_lod_pixel_error, &frustum);
+        if (tr.mesh.visible_chunk_count() == 0) {
+            ++m_render_stats.tiles_culled;
+            return;
         }
-        ++fetched;
-    }
+        ++m_render_stats.tiles_drawn;
+        m_render_stats.chunks_drawn += tr.mesh.visible_chunk_count();
+        m_render_stats.chunks_total += tr.mesh.chunk_count();
 
-    if (fetched == 0) return;
-
-    /* Crop composite to match the elevation tile bounds exactly.
-       The composite covers the full slippy map tile grid (min_x..max_x+1,
-       min_y..max_y+1) which is typically larger than the HGT tile.
-       Use fractional tile coordinates to find the pixel region. */
-    double fx0 = lon_to_tile_x_frac(tr->bounds.min_lon, zoom) - min_x;
-    double fx1 = lon_to_tile_x_frac(tr->bounds.max_lon, zoom) - min_x;
-    double fy0 = lat_to_tile_y_frac(tr->bounds.max_lat, zoom) - min_y; // north = top
-    double fy1 = lat_to_tile_y_frac(tr->bounds.min_lat, zoom) - min_y; // south = bottom
-
-    int cx0 = std::max(0, static_cast<int>(std::round(fx0 * tile_px)));
-    int cy0 = std::max(0, static_cast<int>(std::round(fy0 * tile_px)));
-    int cx1 = std::min(comp_w, static_cast<int>(std::round(fx1 * tile_px)));
-    int cy1 = std::min(comp_h, static_cast<int>(std::round(fy1 * tile_px)));
-    int crop_w = cx1 - cx0;
-    int crop_h = cy1 - cy0;
-
-    if (crop_w <= 0 || crop_h <= 0) return;
-
-    std::vector<uint8_t> cropped(crop_w * crop_h * 4);
-    for (int row = 0; row < crop_h; ++row) {
-        int src = ((cy0 + row) * comp_w + cx0) * 4;
-        int dst = row * crop_w * 4;
-        std::memcpy(&cropped[dst], &composite[src], crop_w * 4);
+        /* Distance from the eye to the tile box (0 inside) for early-z */
+        glm::vec3 d = glm::max(glm::max(mn - cam.position, cam.position - mx), glm::vec3(0.0f));
+        kept.emplace_back(glm::dot(d, d), tr.coord);
+    };
+    if (m_hgt_provider) {
+        /* HGT mode: everything in the cache is a candidate */
+        m_cache.for_each_mut(select);
+    } else {
+        for (auto& coord : m_visible_elev)
+            if (TileRenderable* tr = m_cache.get(coord)) select(*tr);
     }
 
-    LOG_INFO("Composited %d/%zu imagery tiles, cropped %dx%d -> %dx%d px",
-             fetched, imagery_coords.size(), comp_w, comp_h, crop_w, crop_h);
-
-    Texture tex;
-    tex.load_rgba(cropped.data(), crop_w, crop_h);
-    tr->texture = std::move(tex);
+    std::sort(kept.begin(), kept.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    m_draw_list.clear();
+    for (auto& k : kept) m_draw_list.push_back(k.second);
 }
 
 void TileManager::render(DrawFn fn) const {
-    if (m_hgt_provider) {
-        /* HGT mode: render everything in the cache */
-        m_cache.for_each([&](const TileRenderable& tr) {
-            if (tr.mesh.valid()) fn(tr);
-        });
-    } else {
-        for (auto& coord : m_visible_elev) {
-            auto it_check = const_cast<TileCache&>(m_cache).get(coord);
-            if (it_check && it_check->mesh.valid()) {
-                fn(*it_check);
-            }
-        }
+    for (auto& coord : m_draw_list) {
+        const TileRenderable* tr = m_cache.find(coord);
+        if (tr && tr->mesh.valid()) fn(*tr);
     }
 }
 
@@ -226,6 +246,12 @@ bool TileManager::has_terrain() const {
     return m_elev_loaded && !m_visible_elev.empty();
 }
 
+void TileManager::for_each_elevation(DrawFn fn) const {
+    m_cache.for_each([&](const TileRenderable& tr) {
+        if (!tr.elevation.empty() && tr.elev_rows >= 2 && tr.elev_cols >= 2) fn(tr);
+    });
+}
+
 void TileManager::set_hgt_provider(std::unique_ptr<HgtProvider> provider) {
     m_hgt_provider = std::move(provider);
     m_elev_loaded = false;
@@ -252,16 +278,25 @@ void TileManager::update(const Camera& cam, const GeoProjection& proj) {
 void TileManager::update_dynamic_tiles(double cam_lat, double cam_lon) {
     auto needed = m_hgt_provider->tiles_in_view(cam_lat, cam_lon);
 
-    /* Enqueue missing tiles to async loader */
+    /* Enqueue missing tiles nearest-first; re-requesting a queued tile
+       refreshes its priority as the camera moves */
+    const double lon_scale = std::cos(cam_lat * M_PI / 180.0);
     for (auto& coord : needed) {
         if (m_cache.has(coord)) {
             m_cache.touch(coord);
             continue;
         }
-        if (m_loader.is_pending(coord)) continue;
-        m_loader.request(coord, m_hgt_provider.get());
+        if (m_staged_tiles.count(coord)) continue;
+        auto b = HgtProvider::hgt_tile_bounds(coord);
+        double dlat = (b.min_lat + b.max_lat) * 0.5 - cam_lat;
+        double dlon = ((b.min_lon + b.max_lon) * 0.5 - cam_lon) * lon_scale;
+        m_loader.request(coord, m_hgt_provider.get(), dlat * dlat + dlon * dlon);
     }
 
+    /* Tiles that fell out of view and have not started yet are dropped */
+    m_loader.cancel_except(m_hgt_provider.get(),
+                           std::unordered_set<TileCoord>(needed.begin(), needed.end()));
+
     /* Drain completed tiles from the loader */
     drain_ready_tiles();
 
@@ -336,147 +371,41 @@ float TileManager::get_elevation_at(float world_x, float world_z,
     return h0 + fr * (h1 - h0);
 }
 
-/* Build a composite elevation grid from a center tile + its cached neighbors.
-   The center tile occupies a sub-region within the larger composite grid,
-   so ray marching can traverse terrain on neighboring tiles. */
-struct CompositeElevation {
-    std::vector<float> data;
-    mesh3d_bounds_t bounds;
-    int rows = 0, cols = 0;
-    int center_row_start = 0, center_col_start = 0;
-    int center_rows = 0, center_cols = 0;
-};
-
-static CompositeElevation build_composite_elevation(
-    const TileRenderable& center, TileCache& cache)
-{
-    CompositeElevation ce;
-    ce.center_rows = center.elev_rows;
-    ce.center_cols = center.elev_cols;
-
-    const int cr = center.elev_rows;
-    const int cc = center.elev_cols;
-
-    /* Check 3x3 neighborhood for cached tiles with matching resolution.
-       nb[grid_row][grid_col]: grid_row 0 = north (max_lat), 2 = south (min_lat).
-       Tile coord systems:
-         - HGT (z=-1): y = floor(lat), so dy=+1 means NORTH → grid row 0
-         - Slippy map:  y increases southward, so dy=-1 means NORTH → grid row 0 */
-    const TileRenderable* nb[3][3] = {};
-    nb[1][1] = &center;
-    bool hgt_mode = (center.coord.z == -1);
-
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            if (dy == 0 && dx == 0) continue;
-            TileCoord nc = {center.coord.z, center.coord.x + dx, center.coord.y + dy};
-            TileRenderable* n = cache.get(nc);
-            if (n && n->elev_rows == cr && n->elev_cols == cc && !n->elevation.empty()) {
-                /* Map tile offset to grid position (north=row 0) */
-                int gr = hgt_mode ? (1 - dy) : (1 + dy); // HGT: +dy=north=0, slippy: -dy=north=0
-                int gc = dx + 1;
-                nb[gr][gc] = n;
-            }
-        }
-    }
-
-    /* Only expand in directions where neighbors exist */
-    int top_rows    = nb[0][0] || nb[0][1] || nb[0][2] ? cr : 0;
-    int bottom_rows = nb[2][0] || nb[2][1] || nb[2][2] ? cr : 0;
-    int left_cols   = nb[0][0] || nb[1][0] || nb[2][0] ? cc : 0;
-    int right_cols  = nb[0][2] || nb[1][2] || nb[2][2] ? cc : 0;
-
-    ce.rows = top_rows + cr + bottom_rows;
-    ce.cols = left_cols + cc + right_cols;
-    ce.center_row_start = top_rows;
-    ce.center_col_start = left_cols;
-
-    ce.data.assign(ce.rows * ce.cols, 0.0f);
-
-    /* Blit each neighbor's elevation into the composite */
-    for (int gr = 0; gr < 3; ++gr) {
-        for (int gc = 0; gc < 3; ++gc) {
-            if (!nb[gr][gc]) continue;
-            int dst_r = (gr == 0) ? 0 : (gr == 1 ? top_rows : top_rows + cr);
-            int dst_c = (gc == 0) ? 0 : (gc == 1 ? left_cols : left_cols + cc);
-            const auto& elev = nb[gr][gc]->elevation;
-            for (int r = 0; r < cr; ++r) {
-                std::memcpy(&ce.data[(dst_r + r) * ce.cols + dst_c],
-                            &elev[r * cc],
-                            cc * sizeof(float));
-            }
-        }
-    }
-
-    /* Expanded geographic bounds. Grid row 0 = north (max_lat). */
-    double lat_span = center.bounds.max_lat - center.bounds.min_lat;
-    double lon_span = center.bounds.max_lon - center.bounds.min_lon;
-
-    ce.bounds.max_lat = center.bounds.max_lat + (top_rows > 0 ? lat_span : 0.0);
-    ce.bounds.min_lat = center.bounds.min_lat - (bottom_rows > 0 ? lat_span : 0.0);
-    ce.bounds.min_lon = center.bounds.min_lon - (left_cols > 0 ? lon_span : 0.0);
-    ce.bounds.max_lon = center.bounds.max_lon + (right_cols > 0 ? lon_span : 0.0);
-
-    return ce;
-}
-
-/* Extract center-tile results from a composite-grid viewshed computation */
-static void extract_center_results(const CompositeElevation& ce,
-                                    const std::vector<uint8_t>& comp_vis,
-                                    const std::vector<float>& comp_sig,
-                                    std::vector<uint8_t>& tile_vis,
-                                    std::vector<float>& tile_sig)
-{
-    int cr = ce.center_rows;
-    int cc = ce.center_cols;
-    int total = cr * cc;
-    tile_vis.resize(total);
-    tile_sig.resize(total);
-
-    for (int r = 0; r < cr; ++r) {
-        int src_row = ce.center_row_start + r;
-        int src_off = src_row * ce.cols + ce.center_col_start;
-        int dst_off = r * cc;
-        for (int c = 0; c < cc; ++c) {
-            tile_vis[dst_off + c] = comp_vis[src_off + c];
-            tile_sig[dst_off + c] = comp_sig[src_off + c];
-        }
-    }
-}
-
 void TileManager::apply_viewshed_overlays(const std::vector<NodeData>& nodes,
                                            const GeoProjection& proj,
                                            const mesh3d_rf_config_t& rf_config) {
     /* Iterate all cached tiles, compute viewshed on composite (tile+neighbors) */
+    const std::vector<float> ranges = link_ranges(nodes, rf_config);
+    size_t from_disk = 0;
     m_cache.for_each_mut([&](TileRenderable& tr) {
         if (tr.elevation.empty() || tr.elev_rows < 2 || tr.elev_cols < 2)
             return;
 
-        int total = tr.elev_rows * tr.elev_cols;
-        tr.viewshed.assign(total, 0);
-        tr.signal.assign(total, -999.0f);
+        auto in_range = nodes_in_range(tr, nodes, ranges);
+        if (in_range.empty()) {
+            set_empty_overlay(tr);
+            return;
+        }
 
         /* Build composite elevation including neighbor tiles */
         auto ce = build_composite_elevation(tr, m_cache);
 
-        for (auto& nd : nodes) {
-            std::vector<uint8_t> vis;
-            std::vector<float> sig;
-            compute_viewshed(ce.data.data(), ce.rows, ce.cols,
-                             ce.bounds, nd, vis, sig, rf_config);
-
-            /* Extract center tile results and merge */
-            std::vector<uint8_t> tile_vis;
-            std::vector<float> tile_sig;
-            extract_center_results(ce, vis, sig, tile_vis, tile_sig);
-
-            for (int i = 0; i < total; ++i) {
-                if (tile_vis[i]) {
-                    tr.viewshed[i] = 1;
-                    if (tile_sig[i] > tr.signal[i])
-                        tr.signal[i] = tile_sig[i];
-                }
-            }
+        /* Rays march across the whole composite, but only the center
+           tile's cells are evaluated and merged */
+        auto key = tile_coverage_key(ce, nodes, in_range, rf_config, nullptr);
+        if (load_tile_coverage(tr, key)) {
+            ++from_disk;
+        } else {
+            GridWindow center;
+            center.row0 = ce.center_row_start;
+            center.col0 = ce.center_col_start;
+            center.rows = ce.center_rows;
+            center.cols = ce.center_cols;
+            cpu_viewshed_engine().compute_merged(ce.data.data(), ce.rows, ce.cols,
+                                                 ce.bounds, select_nodes(nodes, in_range),
+                                                 rf_config, center,
+                                                 tr.viewshed, tr.signal, nullptr);
+            store_tile_coverage(tr, key);
         }
 
         /* Rebuild mesh with overlay data (preserves texture) */
@@ -485,7 +414,8 @@ void TileManager::apply_viewshed_overlays(const std::vector<NodeData>& nodes,
         tr.texture = std::move(saved_tex);
     });
 
-    LOG_INFO("Applied viewshed overlays to cached tiles for %zu nodes", nodes.size());
+    LOG_INFO("Applied viewshed overlays to cached tiles for %zu nodes (%zu tiles from disk cache)",
+             nodes.size(), from_disk);
 }
 
 void TileManager::apply_viewshed_overlays_gpu(const std::vector<NodeData>& nodes,
@@ -497,24 +427,45 @@ void TileManager::apply_viewshed_overlays_gpu(const std::vector<NodeData>& nodes
         return;
     }
 
+    const std::vector<float> ranges = link_ranges(nodes, rf_config);
+    size_t from_disk = 0;
     m_cache.for_each_mut([&](TileRenderable& tr) {
         if (tr.elevation.empty() || tr.elev_rows < 2 || tr.elev_cols < 2)
             return;
 
-        /* Build composite elevation including neighbor tiles */
-        auto ce = build_composite_elevation(tr, m_cache);
+        auto in_range = nodes_in_range(tr, nodes, ranges);
+        if (in_range.empty()) {
+            set_empty_overlay(tr);
+            return;
+        }
 
-        /* Upload composite elevation and compute on GPU */
-        gpu->upload_elevation(ce.data.data(), ce.rows, ce.cols);
-        gpu->set_grid_params(ce.bounds, ce.rows, ce.cols);
-        gpu->compute_all(nodes);
+        /* Composite of the tile and its neighbors, read in place from the
+           elevation atlas when it can hold them */
+        CompositeTiles tiles;
+        auto ce = plan_composite_elevation(tr, m_cache, tiles);
+
+        auto key = tile_coverage_key(ce, nodes, in_range, rf_config, gpu);
+        if (load_tile_coverage(tr, key)) {
+            ++from_disk;
+        } else {
+            ElevationFrame frame;
+            if (m_atlas.frame(ce, tiles, frame)) {
+                gpu->set_elevation_frame(frame, ce.rows, ce.cols);
+            } else {
+                ce = build_composite_elevation(tr, m_cache);
+                gpu->upload_elevation(ce.data.data(), ce.rows, ce.cols);
+            }
+            gpu->set_grid_params(ce.bounds, ce.rows, ce.cols);
+            gpu->compute_all(select_nodes(nodes, in_range));
 
-        std::vector<uint8_t> comp_vis, comp_overlap;
-        std::vector<float> comp_sig;
-        gpu->read_back(comp_vis, comp_sig, comp_overlap);
+            std::vector<uint8_t> comp_vis, comp_overlap;
+            std::vector<float> comp_sig;
+            gpu->read_back(comp_vis, comp_sig, comp_overlap);
 
-        /* Extract center tile results */
-        extract_center_results(ce, comp_vis, comp_sig, tr.viewshed, tr.signal);
+            /* Extract center tile results */
+            extract_center_results(ce, comp_vis, comp_sig, tr.viewshed, tr.signal);
+            store_tile_coverage(tr, key);
+        }
 
         /* Rebuild mesh with overlay data (preserves texture) */
         Texture saved_tex = std::move(tr.texture);
@@ -522,60 +473,352 @@ void TileManager::apply_viewshed_overlays_gpu(const std::vector<NodeData>& nodes
         tr.texture = std::move(saved_tex);
     });
 
-    LOG_INFO("Applied GPU viewshed overlays to cached tiles for %zu nodes", nodes.size());
+    LOG_INFO("Applied GPU viewshed overlays to cached tiles for %zu nodes (%zu tiles from disk cache)",
+             nodes.size(), from_disk);
 }
 
 void TileManager::start_loader() {
+    if (!m_mesh_pool) {
+        /* Leave one core for the render thread */
+        m_mesh_pool = std::make_unique<ThreadPool>(std::max(ThreadPool::hardware_threads() - 1, 1));
+    }
+    sync_mesh_prepare();
     m_loader.start();
+    m_imagery.start();
+}
+
+void TileManager::set_loader_workers(int local_workers, int network_workers) {
+    m_loader.set_workers(local_workers, network_workers);
 }
 
 void TileManager::stop_loader() {
     m_loader.stop();
+    m_imagery.stop();
+}
+
+void TileManager::sync_mesh_prepare() {
+    if (!m_mesh_settings_dirty && m_prepared_builder.same_mesh_settings(m_builder)) return;
+    m_mesh_settings_dirty = false;
+    m_prepared_builder = m_builder;
+    uint64_t epoch = ++m_mesh_epoch;
+
+    /* Workers get their own copies; nothing here is shared with the
+       main thread except the pool */
+    TileTerrainBuilder builder = m_builder;
+    GeoProjection proj = m_proj;
+    ThreadPool* pool = m_mesh_pool.get();
+    m_loader.set_prepare([builder, proj, pool, epoch](TileData& data) {
+        builder.prepare(data, proj, pool);
+        data.lod_epoch = epoch;
+    });
 }
 
 void TileManager::drain_ready_tiles() {
     auto t0 = std::chrono::steady_clock::now();
     constexpr auto BUDGET = std::chrono::milliseconds(4);
 
+    sync_mesh_prepare();
+
+    /* Stage a few results at a time: GL storage is allocated now, the
+       data follows through m_uploads over the next frames */
     TileData data;
-    while (m_loader.poll_result(data)) {
-        if (data.coord.z == -1 || !data.elevation.empty()) {
-            /* Skip if already in GPU cache (race guard) */
-            if (m_cache.has(data.coord)) {
-                LOG_DEBUG("Async: tile z=%d x=%d y=%d already in cache, skipping",
-                          data.coord.z, data.coord.x, data.coord.y);
-            } else {
-                TileRenderable tr = m_builder.build(data, m_proj);
-                m_cache.upload(std::move(tr));
-                LOG_INFO("Async: uploaded tile z=%d x=%d y=%d",
-                         data.coord.z, data.coord.x, data.coord.y);
-            }
+    while (m_staged_tiles.size() < MAX_STAGED_TILES &&
+           std::chrono::steady_clock::now() - t0 < BUDGET &&
+           m_loader.poll_result(data)) {
+        if (data.coord.z != -1 && data.elevation.empty()) continue;
+        /* Skip if already in GPU cache (race guard) */
+        if (m_cache.has(data.coord) || m_staged_tiles.count(data.coord)) {
+            LOG_DEBUG("Async: tile z=%d x=%d y=%d already in cache, skipping",
+                      data.coord.z, data.coord.x, data.coord.y);
+            continue;
+        }
+        /* Settings changed while the tile was in flight: send it back to
+           the loader to be prepared again on the mesh pool rather than
+           rebuilding the mesh here */
+        if (data.lod_epoch != m_mesh_epoch) {
+            data.lod = TerrainLodData();
+            m_loader.reprepare(std::move(data));
+            continue;
+        }
+
+        StagedTile& st = m_staged_tiles[data.coord];
+        st.data = std::move(data);
+        std::vector<UploadOp> ops;
+        st.tile = m_builder.build(st.data, m_proj, &ops);
+        st.data.elevation = std::vector<float>();   // copied into the tile
+        st.job = m_uploads.submit(std::move(ops));
+    }
+
+    /* Imagery composites arrive fully cropped; only the GL upload is left */
+    ImageryImage img;
+    while (m_staged_tex.size() < MAX_STAGED_TEXTURES &&
+           std::chrono::steady_clock::now() - t0 < BUDGET &&
+           m_imagery.poll_result(img)) {
+        TileRenderable* tr = m_cache.get(img.coord);
+        if (!tr || tr->texture.valid() || m_staged_tex.count(img.coord)) continue;
+
+        StagedTexture& st = m_staged_tex[img.coord];
+        st.img = std::move(img);
+        st.job = m_uploads.submit({st.tex.allocate_rgba(st.img.rgba.data(),
+                                                         st.img.width, st.img.height)});
+    }
+
+    m_uploads.pump(m_upload_budget);
+    finish_staged_uploads();
+}
+
+void TileManager::finish_staged_uploads() {
+    for (auto it = m_staged_tiles.begin(); it != m_staged_tiles.end();) {
+        if (!m_uploads.done(it->second.job)) { ++it; continue; }
+        TileRenderable& tr = it->second.tile;
+        if (tr.texture.valid()) tr.texture.generate_mipmaps();
+        LOG_INFO("Async: uploaded tile z=%d x=%d y=%d", tr.coord.z, tr.coord.x, tr.coord.y);
+        m_cache.upload(std::move(tr));
+        it = m_staged_tiles.erase(it);
+    }
+
+    for (auto it = m_staged_tex.begin(); it != m_staged_tex.end();) {
+        if (!m_uploads.done(it->second.job)) { ++it; continue; }
+        /* The tile may have been evicted while its imagery streamed */
+        TileRenderable* tr = m_cache.get(it->first);
+        if (tr && !tr->texture.valid()) {
+            it->second.tex.generate_mipmaps();
+            tr->texture = std::move(it->second.tex);
+        }
+        it = m_staged_tex.erase(it);
+    }
+}
+
+void TileManager::drop_staged_textures() {
+    for (auto& kv : m_staged_tex) m_uploads.cancel(kv.second.job);
+    m_staged_tex.clear();
+}
+
+/* ── Progressive tile viewshed ──────────────────────────────────────── */
+
+/* Downsampling factors, coarse to fine; full resolution always runs last */
+static constexpr int VIEWSHED_LEVELS[] = {8, 4};
+/* Coarse levels with fewer tile cells than this per side are skipped */
+static constexpr int MIN_LEVEL_CELLS = 64;
+/* Visible cells this close to the receive threshold count as a boundary */
+static constexpr float REFINE_SIGNAL_MARGIN_DB = 6.0f;
+
+/* Level grid cell nearest to composite cell `i` */
+static int level_cell(int i, int factor, int level_cells) {
+    return std::min((i + factor / 2) / factor, level_cells - 1);
+}
+
+/* Grid of every factor-th sample of the composite; bounds end on the last
+   sample kept, so cell spacing is exactly `factor` composite cells */
+static void level_grid(const CompositeElevation& ce, int factor,
+                       int& rows, int& cols, mesh3d_bounds_t& bounds) {
+    rows = (ce.rows - 1) / factor + 1;
+    cols = (ce.cols - 1) / factor + 1;
+    double lat_res = (ce.bounds.max_lat - ce.bounds.min_lat) / (ce.rows - 1);
+    double lon_res = (ce.bounds.max_lon - ce.bounds.min_lon) / (ce.cols - 1);
+    bounds = ce.bounds;
+    bounds.min_lat = bounds.max_lat - lat_res * factor * (rows - 1);
+    bounds.max_lon = bounds.min_lon + lon_res * factor * (cols - 1);
+}
+
+/* The samples of level_grid() from a filled composite */
+static std::vector<float> downsample_composite(const CompositeElevation& ce, int factor,
+                                               int rows, int cols) {
+    std::vector<float> out(static_cast<size_t>(rows) * cols);
+    for (int r = 0; r < rows; ++r) {
+        const float* src = &ce.data[static_cast<size_t>(r) * factor * ce.cols];
+        float* dst = &out[static_cast<size_t>(r) * cols];
+        for (int c = 0; c < cols; ++c) dst[c] = src[c * factor];
+    }
+    return out;
+}
+
+/* What a block of tile cells holds after a level */
+static constexpr uint8_t BLOCK_VISIBLE = 1;    // some cell visible
+static constexpr uint8_t BLOCK_HIDDEN = 2;     // some cell not visible
+static constexpr uint8_t BLOCK_MARGINAL = 4;   // a visible cell within the refine margin
+
+/* BLOCK_* flags of REFINE_BLOCK block (br, bc) of the tile's overlay */
+static uint8_t tile_block_flags(const TileRenderable& tr, int br, int bc, float threshold_dbm) {
+    const int B = GpuViewshed::REFINE_BLOCK;
+    const int r1 = std::min((br + 1) * B, tr.elev_rows);
+    const int c1 = std::min((bc + 1) * B, tr.elev_cols);
+    uint8_t flags = 0;
+    for (int r = br * B; r < r1; ++r) {
+        for (int c = bc * B; c < c1; ++c) {
+            size_t i = static_cast<size_t>(r) * tr.elev_cols + c;
+            if (!tr.viewshed[i])
+                flags |= BLOCK_HIDDEN;
+            else if (tr.signal[i] < threshold_dbm + REFINE_SIGNAL_MARGIN_DB)
+                flags |= BLOCK_VISIBLE | BLOCK_MARGINAL;
+            else
+                flags |= BLOCK_VISIBLE;
         }
+    }
+    return flags;
+}
+
+/* Tile blocks where a coarse level is least reliable: on or next to a
+   visibility edge, or visible within the margin of the strictest in-range
+   receiver. One test per block, from the flags left by the last level. */
+static bool refine_tile_block(const std::vector<uint8_t>& blocks, int brows, int bcols,
+                              int br, int bc) {
+    if (blocks[static_cast<size_t>(br) * bcols + bc] & BLOCK_MARGINAL) return true;
+    uint8_t around = 0;
+    for (int r = std::max(br - 1, 0); r <= std::min(br + 1, brows - 1); ++r)
+        for (int c = std::max(bc - 1, 0); c <= std::min(bc + 1, bcols - 1); ++c)
+            around |= blocks[static_cast<size_t>(r) * bcols + c];
+    return (around & BLOCK_VISIBLE) && (around & BLOCK_HIDDEN);
+}
 
-        if (std::chrono::steady_clock::now() - t0 > BUDGET) break;
+/* Highest receive threshold among the tile's nodes (as viewshed_setup
+   resolves it) */
+static float strictest_threshold(const std::vector<NodeData>& nodes,
+                                 const std::vector<uint32_t>& in_range,
+                                 const mesh3d_rf_config_t& rf_config) {
+    float t = -999.0f;
+    for (uint32_t i : in_range) {
+        float s = nodes[i].info.rx_sensitivity_dbm;
+        t = std::max(t, s < 0 ? s : rf_config.rx_sensitivity_dbm);
     }
+    return t;
 }
 
-void TileManager::dispatch_tile_viewshed(size_t tile_idx,
+bool TileManager::dispatch_tile_viewshed(size_t tile_idx,
                                            const std::vector<NodeData>& nodes,
                                            GpuViewshed* gpu) {
-    TileRenderable* tr = m_cache.get(m_tile_vs.tile_list[tile_idx]);
-    if (!tr) return;
-
-    auto ce = build_composite_elevation(*tr, m_cache);
-
-    /* Store composite metadata for extraction at readback time */
-    if (m_tile_vs.comp_info.size() <= tile_idx)
-        m_tile_vs.comp_info.resize(tile_idx + 1);
-    m_tile_vs.comp_info[tile_idx] = {
-        ce.rows, ce.cols,
-        ce.center_row_start, ce.center_col_start,
-        ce.center_rows, ce.center_cols
+    auto& vs = m_tile_vs;
+    TileRenderable* tr = m_cache.get(vs.tile_list[tile_idx]);
+    if (!tr) return false;
+
+    CompositeTiles tiles;
+    vs.composite = plan_composite_elevation(*tr, m_cache, tiles);
+    const CompositeElevation& ce = vs.composite;
+
+    /* Computed before with the same terrain, nodes and settings */
+    const auto& in_range = vs.tile_nodes[tile_idx];
+    vs.tile_keys[tile_idx] = tile_coverage_key(ce, nodes, in_range, gpu->rf_config(), gpu,
+                                               m_progressive_viewshed);
+    if (load_tile_coverage(*tr, vs.tile_keys[tile_idx])) {
+        tr->upload_overlay_textures(tr->viewshed.data(), tr->signal.data(),
+                                    tr->elev_rows, tr->elev_cols);
+        vs.composite = CompositeElevation();
+        return false;
+    }
+
+    vs.levels.clear();
+    if (m_progressive_viewshed) {
+        for (int f : VIEWSHED_LEVELS)
+            if (ce.center_rows / f >= MIN_LEVEL_CELLS && ce.center_cols / f >= MIN_LEVEL_CELLS)
+                vs.levels.push_back(f);
+    }
+    vs.levels.push_back(1);
+    vs.level = 0;
+
+    dispatch_tile_level(*tr, nodes, gpu);
+    return true;
+}
+
+void TileManager::dispatch_tile_level(TileRenderable& tr,
+                                        const std::vector<NodeData>& nodes,
+                                        GpuViewshed* gpu) {
+    auto& vs = m_tile_vs;
+    const auto& in_range = vs.tile_nodes[vs.current_tile];
+    const int f = vs.levels[vs.level];
+
+    /* The tiles are read in place from the elevation atlas, re-planned
+       each level since neighbors may have arrived or left. Only when the
+       atlas cannot be used is the composite copied, once per tile. */
+    ElevationFrame frame;
+    bool use_frame = false;
+    if (vs.composite.data.empty()) {
+        CompositeTiles tiles;
+        vs.composite = plan_composite_elevation(tr, m_cache, tiles);
+        use_frame = m_atlas.frame(vs.composite, tiles, frame);
+        if (!use_frame) vs.composite = build_composite_elevation(tr, m_cache);
+    }
+    const CompositeElevation& ce = vs.composite;
+
+    /* The result is stored under the key of the composite it was computed
+       on; if neighbors changed between levels it matches neither plan */
+    CoverageCache::Key key = tile_coverage_key(ce, nodes, in_range, gpu->rf_config(), gpu,
+                                               m_progressive_viewshed);
+    if (vs.level == 0)
+        vs.plan_changed = false;
+    else if (key != vs.tile_keys[vs.current_tile])
+        vs.plan_changed = true;
+    vs.tile_keys[vs.current_tile] = key;
+
+    mesh3d_bounds_t bounds;
+    level_grid(ce, f, vs.level_rows, vs.level_cols, bounds);
+    std::vector<float> coarse;
+    const float* elev = nullptr;
+    if (use_frame) {
+        frame.step = f;
+        gpu->set_elevation_frame(frame, vs.level_rows, vs.level_cols);
+    } else {
+        elev = ce.data.data();
+        if (f > 1) {
+            coarse = downsample_composite(ce, f, vs.level_rows, vs.level_cols);
+            elev = coarse.data();
+        }
+        gpu->upload_elevation(elev, vs.level_rows, vs.level_cols);
+    }
+    gpu->set_grid_params(bounds, vs.level_rows, vs.level_cols);
+
+    /* Compute only blocks holding tile cells (the rest of the composite is
+       there for the rays) and, past the first level, only those near a
+       boundary of the previous level's result */
+    const int B = GpuViewshed::REFINE_BLOCK;
+    const int bcols = gpu->refine_block_cols();
+    vs.refine_mask.assign(static_cast<size_t>(gpu->refine_block_rows()) * bcols, 0);
+    auto mark = [&](int r0, int r1, int c0, int c1) {   // composite cells, inclusive
+        int lr0 = level_cell(std::max(r0, 0), f, vs.level_rows) / B;
+        int lr1 = level_cell(std::min(r1, ce.rows - 1), f, vs.level_rows) / B;
+        int lc0 = level_cell(std::max(c0, 0), f, vs.level_cols) / B;
+        int lc1 = level_cell(std::min(c1, ce.cols - 1), f, vs.level_cols) / B;
+        for (int br = lr0; br <= lr1; ++br)
+            std::fill_n(&vs.refine_mask[static_cast<size_t>(br) * bcols + lc0], lc1 - lc0 + 1, 1);
     };
 
-    gpu->upload_elevation(ce.data.data(), ce.rows, ce.cols);
-    gpu->set_grid_params(ce.bounds, ce.rows, ce.cols);
-    gpu->compute_all_async(nodes, ce.data.data());
+    const int r0 = ce.center_row_start, c0 = ce.center_col_start;
+    if (vs.level == 0) {
+        mark(r0, r0 + ce.center_rows - 1, c0, c0 + ce.center_cols - 1);
+    } else {
+        /* A boundary may be off by up to one previous-level cell (d < B,
+           so a neighbouring block's edge is caught by refine_tile_block) */
+        const int d = vs.levels[vs.level - 1];
+        const int brows = (tr.elev_rows + B - 1) / B;
+        const int tbcols = (tr.elev_cols + B - 1) / B;
+        for (int br = 0; br < brows; ++br) {
+            for (int bc = 0; bc < tbcols; ++bc) {
+                if (!refine_tile_block(vs.tile_blocks, brows, tbcols, br, bc)) continue;
+                mark(r0 + br * B - d, r0 + std::min((br + 1) * B, tr.elev_rows) - 1 + d,
+                     c0 + bc * B - d, c0 + std::min((bc + 1) * B, tr.elev_cols) - 1 + d);
+            }
+        }
+    }
+    gpu->set_refine_mask(&vs.refine_mask);
+
+    size_t blocks = 0;
+    for (uint8_t m : vs.refine_mask) blocks += m;
+    LOG_INFO("Tile viewshed: tile %zu level 1/%d (%dx%d), %zu of %zu blocks",
+             vs.current_tile, f, vs.level_cols, vs.level_rows, blocks, vs.refine_mask.size());
+
+    gpu->compute_all_async(select_nodes(nodes, in_range), elev);
+}
+
+void TileManager::advance_tile_viewshed(const std::vector<NodeData>& nodes,
+                                          GpuViewshed* gpu) {
+    while (m_tile_vs.current_tile < m_tile_vs.tile_list.size()) {
+        if (dispatch_tile_viewshed(m_tile_vs.current_tile, nodes, gpu)) return;
+        m_tile_vs.current_tile++;
+    }
+
+    /* All tiles done */
+    m_tile_vs.active = false;
+    LOG_INFO("Async tile viewshed complete for %zu tiles, %zu nodes",
+             m_tile_vs.tile_list.size(), nodes.size());
 }
 
 void TileManager::kick_viewshed_gpu(const std::vector<NodeData>& nodes,
@@ -588,22 +831,36 @@ void TileManager::kick_viewshed_gpu(const std::vector<NodeData>& nodes,
         tr.destroy_overlay_textures();
     });
 
-    /* Collect all tiles that have elevation data */
+    /* Collect the tiles with elevation data that some node can reach,
+       each with the nodes that reach it */
     m_tile_vs.tile_list.clear();
-    m_tile_vs.comp_info.clear();
-    m_cache.for_each([&](const TileRenderable& tr) {
-        if (!tr.elevation.empty() && tr.elev_rows >= 2 && tr.elev_cols >= 2)
-            m_tile_vs.tile_list.push_back(tr.coord);
+    m_tile_vs.tile_nodes.clear();
+    const std::vector<float> ranges = link_ranges(nodes, gpu->rf_config());
+    size_t tiles = 0, pairs = 0;
+    m_cache.for_each_mut([&](TileRenderable& tr) {
+        if (tr.elevation.empty() || tr.elev_rows < 2 || tr.elev_cols < 2)
+            return;
+        ++tiles;
+        auto in_range = nodes_in_range(tr, nodes, ranges);
+        if (in_range.empty()) {
+            set_empty_overlay(tr);
+            return;
+        }
+        pairs += in_range.size();
+        m_tile_vs.tile_list.push_back(tr.coord);
+        m_tile_vs.tile_nodes.push_back(std::move(in_range));
     });
 
+    LOG_INFO("Tile viewshed: %zu of %zu tiles in range, %zu of %zu node/tile pairs",
+             m_tile_vs.tile_list.size(), tiles, pairs, tiles * nodes.size());
     if (m_tile_vs.tile_list.empty()) return;
 
     m_tile_vs.current_tile = 0;
     m_tile_vs.active = true;
-    m_tile_vs.comp_info.resize(m_tile_vs.tile_list.size());
+    m_tile_vs.tile_keys.assign(m_tile_vs.tile_list.size(), 0);
 
-    /* Dispatch first tile with composite elevation */
-    dispatch_tile_viewshed(0, nodes, gpu);
+    /* Dispatch the first tile not in the disk cache */
+    advance_tile_viewshed(nodes, gpu);
 }
 
 void TileManager::poll_viewshed_gpu(const std::vector<NodeData>& nodes,
@@ -612,63 +869,130 @@ void TileManager::poll_viewshed_gpu(const std::vector<NodeData>& nodes,
     if (!gpu || !m_tile_vs.active) return;
     if (gpu->poll_state() != ComputeState::READY) return;
 
-    /* Read back composite results and extract center tile portion */
-    size_t idx = m_tile_vs.current_tile;
-    if (idx < m_tile_vs.tile_list.size()) {
-        TileRenderable* tr = m_cache.get(m_tile_vs.tile_list[idx]);
-        if (tr) {
-            auto t0 = std::chrono::steady_clock::now();
+    auto& vs = m_tile_vs;
+    size_t idx = vs.current_tile;
+    TileRenderable* tr = idx < vs.tile_list.size() ? m_cache.get(vs.tile_list[idx]) : nullptr;
 
-            /* Read back full composite results */
-            std::vector<uint8_t> comp_vis, comp_overlap;
-            std::vector<float> comp_sig;
-            gpu->read_back_async(comp_vis, comp_sig, comp_overlap);
-            auto t1 = std::chrono::steady_clock::now();
-
-            /* Extract center tile portion */
-            auto& ci = m_tile_vs.comp_info[idx];
-            CompositeElevation ce;
-            ce.rows = ci.comp_rows;
-            ce.cols = ci.comp_cols;
-            ce.center_row_start = ci.center_row_start;
-            ce.center_col_start = ci.center_col_start;
-            ce.center_rows = ci.center_rows;
-            ce.center_cols = ci.center_cols;
-            extract_center_results(ce, comp_vis, comp_sig,
-                                    tr->viewshed, tr->signal);
-
-            /* Upload as GPU overlay textures */
-            tr->upload_overlay_textures(tr->viewshed.data(), tr->signal.data(),
-                                         tr->elev_rows, tr->elev_cols);
-            auto t2 = std::chrono::steady_clock::now();
-
-            auto ms = [](auto a, auto b) {
-                return std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
-            };
-            LOG_INFO("poll_viewshed_gpu tile %zu: readback=%lldms upload=%lldms",
-                     idx, (long long)ms(t0,t1), (long long)ms(t1,t2));
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<uint8_t> lvl_vis, lvl_overlap;
+    std::vector<float> lvl_sig;
+    gpu->read_back_async(lvl_vis, lvl_sig, lvl_overlap);
+    auto t1 = std::chrono::steady_clock::now();
+
+    if (tr) {
+        /* Level result resampled onto the tile cells: visibility from the
+           nearest level cell, signal bilinear between the four around it
+           when all of them are visible, so interiors a finer level leaves
+           alone are smooth rather than blocky. Past the first level, cells
+           outside the refined blocks keep the coarser result, and tile
+           blocks with none of those are not visited. */
+        const CompositeElevation& ce = vs.composite;
+        const int f = vs.levels[vs.level];
+        const int B = GpuViewshed::REFINE_BLOCK;
+        const int bcols = (vs.level_cols + B - 1) / B;
+        const bool keep_coarse = vs.level > 0 &&
+                                 gpu->propagation_model() != MESH3D_PROP_SWEEP;
+        auto refined = [&](int lr, int lc) {
+            return !keep_coarse || vs.refine_mask[static_cast<size_t>(lr / B) * bcols + lc / B];
+        };
+        auto resample = [&](int r, int c) {
+            int lr = level_cell(ce.center_row_start + r, f, vs.level_rows);
+            int lc = level_cell(ce.center_col_start + c, f, vs.level_cols);
+            if (!refined(lr, lc)) return;
+            size_t src = static_cast<size_t>(lr) * vs.level_cols + lc;
+            size_t dst = static_cast<size_t>(r) * tr->elev_cols + c;
+            tr->viewshed[dst] = lvl_vis[src];
+            tr->signal[dst] = lvl_sig[src];
+            if (f == 1) return;
+
+            int y0 = std::min((ce.center_row_start + r) / f, vs.level_rows - 1);
+            int y1 = std::min(y0 + 1, vs.level_rows - 1);
+            float ty = std::min(static_cast<float>(ce.center_row_start + r - y0 * f) / f, 1.0f);
+            int x0 = std::min((ce.center_col_start + c) / f, vs.level_cols - 1);
+            int x1 = std::min(x0 + 1, vs.level_cols - 1);
+            float tx = std::min(static_cast<float>(ce.center_col_start + c - x0 * f) / f, 1.0f);
+            size_t i00 = static_cast<size_t>(y0) * vs.level_cols + x0;
+            size_t i01 = static_cast<size_t>(y0) * vs.level_cols + x1;
+            size_t i10 = static_cast<size_t>(y1) * vs.level_cols + x0;
+            size_t i11 = static_cast<size_t>(y1) * vs.level_cols + x1;
+            if (lvl_vis[i00] && lvl_vis[i01] && lvl_vis[i10] && lvl_vis[i11]) {
+                float top = lvl_sig[i00] + (lvl_sig[i01] - lvl_sig[i00]) * tx;
+                float bottom = lvl_sig[i10] + (lvl_sig[i11] - lvl_sig[i10]) * tx;
+                tr->signal[dst] = top + (bottom - top) * ty;
+            }
+        };
+
+        const int brows = (tr->elev_rows + B - 1) / B;
+        const int tbcols = (tr->elev_cols + B - 1) / B;
+        const float threshold = strictest_threshold(nodes, vs.tile_nodes[idx], gpu->rf_config());
+        if (vs.level == 0) {
+            set_empty_overlay(*tr);
+            vs.tile_blocks.assign(static_cast<size_t>(brows) * tbcols, 0);
         }
+        for (int br = 0; br < brows; ++br) {
+            const int tr0 = br * B, tr1 = std::min(tr0 + B, tr->elev_rows);
+            const int lbr0 = level_cell(ce.center_row_start + tr0, f, vs.level_rows) / B;
+            const int lbr1 = level_cell(ce.center_row_start + tr1 - 1, f, vs.level_rows) / B;
+            for (int bc = 0; bc < tbcols; ++bc) {
+                const int tc0 = bc * B, tc1 = std::min(tc0 + B, tr->elev_cols);
+                const int lbc0 = level_cell(ce.center_col_start + tc0, f, vs.level_cols) / B;
+                const int lbc1 = level_cell(ce.center_col_start + tc1 - 1, f, vs.level_cols) / B;
+                bool any = false;
+                for (int lbr = lbr0; lbr <= lbr1 && !any; ++lbr)
+                    for (int lbc = lbc0; lbc <= lbc1 && !any; ++lbc)
+                        any = refined(lbr * B, lbc * B);
+                if (!any) continue;
+
+                for (int r = tr0; r < tr1; ++r)
+                    for (int c = tc0; c < tc1; ++c) resample(r, c);
+                vs.tile_blocks[static_cast<size_t>(br) * tbcols + bc] =
+                    tile_block_flags(*tr, br, bc, threshold);
+            }
+        }
+
+        /* Upload as GPU overlay textures */
+        tr->upload_overlay_textures(tr->viewshed.data(), tr->signal.data(),
+                                     tr->elev_rows, tr->elev_cols);
+        auto t2 = std::chrono::steady_clock::now();
+
+        auto ms = [](auto a, auto b) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+        };
+        LOG_INFO("poll_viewshed_gpu tile %zu level 1/%d: readback=%lldms upload=%lldms",
+                 idx, f, (long long)ms(t0,t1), (long long)ms(t1,t2));
+
+        /* Refine */
+        if (vs.level + 1 < vs.levels.size()) {
+            vs.level++;
+            dispatch_tile_level(*tr, nodes, gpu);
+            return;
+        }
+        if (!vs.plan_changed)
+            store_tile_coverage(*tr, vs.tile_keys[idx]);
     }
 
     /* Advance to next tile */
-    m_tile_vs.current_tile++;
-    if (m_tile_vs.current_tile < m_tile_vs.tile_list.size()) {
-        dispatch_tile_viewshed(m_tile_vs.current_tile, nodes, gpu);
-    } else {
-        /* All tiles done */
-        m_tile_vs.active = false;
-        LOG_INFO("Async tile viewshed complete for %zu tiles, %zu nodes",
-                 m_tile_vs.tile_list.size(), nodes.size());
-    }
+    vs.composite = CompositeElevation();
+    vs.current_tile++;
+    advance_tile_viewshed(nodes, gpu);
 }
 
 void TileManager::clear() {
     m_loader.stop();
+    m_imagery.stop();
+    m_imagery.invalidate();
+    m_uploads.clear();
+    m_staged_tiles.clear();
+    m_staged_tex.clear();
     m_cache.clear();
+    m_draw_list.clear();
+    m_render_stats = TileRenderStats();
     m_elev_loaded = false;
     m_visible_elev.clear();
     m_visible_imagery.clear();
     m_tile_vs.active = false;
+    m_tile_vs.composite = CompositeElevation();
+    m_atlas.clear();
 }
 
 } // namespace mesh3d
@@ -7,12 +7,19 @@
 #include "tile/hgt_provider.h"
 #include "tile/dsm_provider.h"
 #include "tile/async_loader.h"
+#include "tile/imagery_compositor.h"
+#include "tile/composite_elevation.h"
+#include "tile/elevation_atlas.h"
+#include "render/upload_stream.h"
 #include "util/math_util.h"
+#include "util/thread_pool.h"
 #include <mesh3d/types.h>
 #include <memory>
+#include <unordered_map>
 #include <functional>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
 namespace mesh3d {
 
@@ -21,6 +28,12 @@ struct NodeData;
 
 enum class ImagerySource { SATELLITE, STREET, NONE };
 
+/* Frustum culling results of the last TileManager::select_lod() */
+struct TileRenderStats {
+    int tiles_drawn = 0, tiles_culled = 0;
+    int chunks_drawn = 0, chunks_total = 0;   // over drawn tiles
+};
+
 /* Orchestrates the tile system: providers, selector, builder, cache.
    Two providers: elevation (SingleTileProvider) + imagery (UrlTileProvider).
    When HGT provider is set, supports camera-driven dynamic loading. */
@@ -54,10 +67,24 @@ public:
        Converts camera world pos -> lat/lon, loads nearby HGT tiles. */
     void update(const Camera& cam, const GeoProjection& proj);
 
-    /* Iterate visible tiles for rendering */
+    /* Cull tiles, then chunks, against the camera frustum, choose each
+       remaining chunk's terrain LOD, and order the draw list front to
+       back. Call once per frame before render(); viewport_h is in pixels. */
+    void select_lod(const Camera& cam, float aspect, int viewport_h);
+    const TileRenderStats& render_stats() const { return m_render_stats; }
+
+    /* Screen-space geometric error (pixels) a chunk may show before a
+       finer level is drawn */
+    void set_lod_pixel_error(float px) { m_lod_pixel_error = std::max(px, 0.1f); }
+    float lod_pixel_error() const { return m_lod_pixel_error; }
+
+    /* Iterate the tiles kept by the last select_lod(), nearest first */
     void render(DrawFn fn) const;
 
     bool has_terrain() const;
+
+    /* Iterate every cached tile holding CPU-side elevation */
+    void for_each_elevation(DrawFn fn) const;
     bool has_hgt_provider() const { return m_hgt_provider != nullptr; }
 
     /* Query terrain elevation at a world position.
@@ -76,14 +103,31 @@ public:
                                       class GpuViewshed* gpu,
                                       const mesh3d_rf_config_t& rf_config);
 
-    /* Start/stop the background I/O thread */
+    /* Start/stop the background I/O workers */
     void start_loader();
     void stop_loader();
+    /* Worker counts for the loader's disk and network lanes */
+    void set_loader_workers(int local_workers, int network_workers);
 
-    /* Drain completed async tile results (budget-capped per frame) */
+    /* Drain completed async tile results and finished imagery composites
+       into the upload stream, copy at most the upload budget to the GPU,
+       and hand tiles/textures whose copies have all been issued to the
+       cache. Tile meshes arrive prepared by the loader workers. */
     void drain_ready_tiles();
 
-    /* Async viewshed for tile mode (non-blocking) */
+    /* Bytes of tile geometry and imagery copied to the GPU per frame */
+    void set_upload_budget(size_t bytes) { m_upload_budget = std::max<size_t>(bytes, 64u << 10); }
+    size_t upload_budget() const { return m_upload_budget; }
+    const UploadStats& upload_stats() const { return m_uploads.stats(); }
+
+    /* Async viewshed for tile mode (non-blocking). Progressive (the
+       default): each tile runs at 1/8 and 1/4 resolution first, uploading
+       its overlay after every level, and the finer levels only recompute
+       blocks near visibility or receive-threshold boundaries. Otherwise
+       one full-resolution pass per tile. Either way only the tile's own
+       cells of the composite are computed. */
+    void set_progressive_viewshed(bool on) { m_progressive_viewshed = on; }
+    bool progressive_viewshed() const { return m_progressive_viewshed; }
     void kick_viewshed_gpu(const std::vector<NodeData>& nodes,
                             const GeoProjection& proj,
                             class GpuViewshed* gpu);
@@ -99,49 +143,105 @@ public:
 
 private:
     std::unique_ptr<TileProvider> m_elev_provider;
-    std::unique_ptr<TileProvider> m_imagery_provider;
+    std::shared_ptr<TileProvider> m_imagery_provider; // shared with in-flight composites
     std::unique_ptr<HgtProvider> m_hgt_provider;
     std::unique_ptr<DSMProvider> m_dsm_provider;
     ImagerySource m_imagery_source = ImagerySource::NONE;
 
+    /* Parallel mesh builds for loader workers; declared before m_loader so
+       it outlives the workers that use it */
+    std::unique_ptr<ThreadPool> m_mesh_pool;
     AsyncLoader m_loader;
+    ImageryCompositor m_imagery;
     TileSelector m_selector;
     TileTerrainBuilder m_builder;
     TileCache m_cache;
 
+    /* Tiles and textures whose GL storage exists but whose data is still
+       being streamed; they join the cache once their job is done. The
+       source data is kept here because the upload ops point into it. */
+    struct StagedTile {
+        TileData data;
+        TileRenderable tile;
+        UploadStream::JobId job = 0;
+    };
+    struct StagedTexture {
+        ImageryImage img;
+        Texture tex;
+        UploadStream::JobId job = 0;
+    };
+    static constexpr size_t MAX_STAGED_TILES = 2;
+    static constexpr size_t MAX_STAGED_TEXTURES = 4;
+    UploadStream m_uploads;
+    size_t m_upload_budget = UploadStream::DEFAULT_FRAME_BUDGET;
+    std::unordered_map<TileCoord, StagedTile> m_staged_tiles;
+    std::unordered_map<TileCoord, StagedTexture> m_staged_tex;
+
     mesh3d_bounds_t m_bounds{};
     GeoProjection m_proj;
     bool m_bounds_set = false;
     bool m_elev_loaded = false;
+    float m_lod_pixel_error = 2.0f;
+
+    /* Builder settings and projection handed to the loader's prepare hook.
+       Bumping the epoch marks meshes prepared with older settings stale. */
+    TileTerrainBuilder m_prepared_builder;
+    uint64_t m_mesh_epoch = 0;
+    bool m_mesh_settings_dirty = true;
 
     /* Currently visible tile coords */
     std::vector<TileCoord> m_visible_elev;
     std::vector<TileCoord> m_visible_imagery;
+    /* Of those, the frustum-culled tiles for render(), sorted front to back */
+    std::vector<TileCoord> m_draw_list;
+    TileRenderStats m_render_stats;
 
     void ensure_elevation_tiles();
+    /* Promote staged tiles/textures whose uploads have all been issued */
+    void finish_staged_uploads();
+    void drop_staged_textures();
+    /* Re-arm the loader's prepare hook if projection or builder changed */
+    void sync_mesh_prepare();
     void ensure_imagery_tiles();
-    void composite_imagery_for_tile(TileRenderable* tr);
 
     /* Camera-driven dynamic tile selection */
     void update_dynamic_tiles(double cam_lat, double cam_lon);
 
     /* Tile-mode viewshed state: tracks per-tile GPU compute progress */
-    struct CompositeInfo {
-        int comp_rows = 0, comp_cols = 0;
-        int center_row_start = 0, center_col_start = 0;
-        int center_rows = 0, center_cols = 0;
-    };
     struct TileViewshedState {
         bool active = false;
         size_t current_tile = 0;
-        std::vector<TileCoord> tile_list;
-        std::vector<CompositeInfo> comp_info; // one per tile
+        std::vector<TileCoord> tile_list;     // tiles at least one node can reach
+        std::vector<std::vector<uint32_t>> tile_nodes; // per tile: indices of those nodes
+        std::vector<uint64_t> tile_keys;      // per tile: coverage disk-cache key
+
+        /* Current tile: its full-resolution composite (data only filled
+           when the elevation atlas is unavailable) and the level
+           (downsampling factor) being computed */
+        CompositeElevation composite;
+        std::vector<int> levels;              // factors, coarse to fine, ending in 1
+        size_t level = 0;
+        int level_rows = 0, level_cols = 0;   // grid dispatched for that level
+        std::vector<uint8_t> refine_mask;     // its GpuViewshed::REFINE_BLOCK blocks
+        std::vector<uint8_t> tile_blocks;     // BLOCK_* flags per REFINE_BLOCK block of tile cells
+        bool plan_changed = false;            // levels ran on different composites
     };
     TileViewshedState m_tile_vs;
+    bool m_progressive_viewshed = true;
+
+    /* Cached tiles' elevation on the GPU for the GPU tile viewshed paths */
+    ElevationAtlas m_atlas;
 
-    /* Helper: dispatch async viewshed for a tile using composite elevation */
-    void dispatch_tile_viewshed(size_t tile_idx, const std::vector<NodeData>& nodes,
+    /* Helper: dispatch async viewshed for a tile using composite elevation.
+       Returns false if nothing was dispatched because the tile's overlay
+       came from the coverage disk cache (or the tile is gone). */
+    bool dispatch_tile_viewshed(size_t tile_idx, const std::vector<NodeData>& nodes,
                                  GpuViewshed* gpu);
+    /* Dispatch from m_tile_vs.current_tile on, skipping disk-cache hits */
+    void advance_tile_viewshed(const std::vector<NodeData>& nodes, GpuViewshed* gpu);
+    /* Dispatch the current tile's current level */
+    void dispatch_tile_level(TileRenderable& tr, const std::vector<NodeData>& nodes,
+                             GpuViewshed* gpu);
 };
 
 } // namespace mesh3d
@@ -1,4 +1,6 @@
 #include "tile/tile_provider.h"
+#include <algorithm>
+#include <cmath>
 
 namespace mesh3d {
 
@@ -6,4 +8,59 @@ std::vector<TileCoord> TileProvider::tiles_in_bounds(const mesh3d_bounds_t& boun
     return bounds_to_tile_range(bounds, zoom);
 }
 
+std::vector<std::optional<TileData>> TileProvider::fetch_tiles(const std::vector<TileCoord>& coords) {
+    std::vector<std::optional<TileData>> out;
+    out.reserve(coords.size());
+    for (const auto& c : coords) out.push_back(fetch_tile(c));
+    return out;
+}
+
+std::optional<TileData> TileProvider::fetch_tile_region(const TileCoord& coord,
+                                                        const mesh3d_bounds_t& bounds) {
+    auto td = fetch_tile(coord);
+    if (!td || td->elevation.empty()) return td;
+
+    int r0, r1, c0, c1;
+    mesh3d_bounds_t region;
+    if (!elevation_grid_region(td->bounds, td->elev_rows, td->elev_cols, bounds,
+                               r0, r1, c0, c1, region))
+        return std::nullopt;
+    if (r0 == 0 && c0 == 0 && r1 == td->elev_rows && c1 == td->elev_cols)
+        return td;
+
+    std::vector<float> crop(static_cast<size_t>(r1 - r0) * (c1 - c0));
+    for (int r = r0; r < r1; ++r)
+        std::copy_n(&td->elevation[static_cast<size_t>(r) * td->elev_cols + c0], c1 - c0,
+                    &crop[static_cast<size_t>(r - r0) * (c1 - c0)]);
+    td->elevation = std::move(crop);
+    td->elev_rows = r1 - r0;
+    td->elev_cols = c1 - c0;
+    td->bounds = region;
+    return td;
+}
+
+bool elevation_grid_region(const mesh3d_bounds_t& grid, int rows, int cols,
+                           const mesh3d_bounds_t& want,
+                           int& r0, int& r1, int& c0, int& c1,
+                           mesh3d_bounds_t& region) {
+    if (rows < 2 || cols < 2) return false;
+    const double lat_step = (grid.max_lat - grid.min_lat) / (rows - 1);
+    const double lon_step = (grid.max_lon - grid.min_lon) / (cols - 1);
+    if (lat_step <= 0.0 || lon_step <= 0.0) return false;
+
+    r0 = static_cast<int>(std::floor((grid.max_lat - want.max_lat) / lat_step)) - 1;
+    r1 = static_cast<int>(std::ceil((grid.max_lat - want.min_lat) / lat_step)) + 2;
+    c0 = static_cast<int>(std::floor((want.min_lon - grid.min_lon) / lon_step)) - 1;
+    c1 = static_cast<int>(std::ceil((want.max_lon - grid.min_lon) / lon_step)) + 2;
+    r0 = std::max(r0, 0); c0 = std::max(c0, 0);
+    r1 = std::min(r1, rows); c1 = std::min(c1, cols);
+    if (r1 - r0 < 2 || c1 - c0 < 2) return false;
+
+    region.max_lat = grid.max_lat - r0 * lat_step;
+    region.min_lat = grid.max_lat - (r1 - 1) * lat_step;
+    region.min_lon = grid.min_lon + c0 * lon_step;
+    region.max_lon = grid.min_lon + (c1 - 1) * lon_step;
+    return true;
+}
+
 } // namespace mesh3d
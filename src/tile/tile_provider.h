@@ -19,9 +19,34 @@ public:
     /* Fetch tile data. Returns nullopt if tile not available. */
     virtual std::optional<TileData> fetch_tile(const TileCoord& coord) = 0;
 
+    /* Fetch several tiles; results are in `coords` order. Default calls
+       fetch_tile() for each; network providers override it to download
+       all misses concurrently. */
+    virtual std::vector<std::optional<TileData>> fetch_tiles(const std::vector<TileCoord>& coords);
+
+    /* Fetch only the elevation posts of a tile that cover `bounds`.
+       Default implementation fetches the whole tile and crops it;
+       providers with a block-addressable cache decode just those blocks. */
+    virtual std::optional<TileData> fetch_tile_region(const TileCoord& coord,
+                                                      const mesh3d_bounds_t& bounds);
+
+    /* True if fetch_tile(coord) can be served without network I/O (local
+       files, disk cache). AsyncLoader uses this to keep cheap loads out
+       of the queue behind slow downloads. Called from the main thread. */
+    virtual bool is_local(const TileCoord& /*coord*/) const { return true; }
+
     /* Get all tile coordinates covering bounds at given zoom.
        Default implementation uses bounds_to_tile_range(). */
     virtual std::vector<TileCoord> tiles_in_bounds(const mesh3d_bounds_t& bounds, int zoom) const;
 };
 
+/* Post range [r0,r1) x [c0,c1) of a rows x cols elevation grid spanning
+   `grid` that covers `want`, widened by one post on each side so bilinear
+   sampling at the edges has both neighbours. `region` receives the bounds
+   of that sub-grid. Returns false if they do not overlap. */
+bool elevation_grid_region(const mesh3d_bounds_t& grid, int rows, int cols,
+                           const mesh3d_bounds_t& want,
+                           int& r0, int& r1, int& c0, int& c1,
+                           mesh3d_bounds_t& region);
+
 } // namespace mesh3d
@@ -1,57 +1,85 @@
 #include "tile/tile_terrain_builder.h"
-#include "scene/terrain.h"
+#include "tile/composite_elevation.h"
+#include "scene/terrain_lod.h"
 #include "util/math_util.h"
 #include "util/log.h"
 
 namespace mesh3d {
 
-TileRenderable TileTerrainBuilder::build(const TileData& data, const GeoProjection& proj) const {
+static TerrainBuildData make_build_data(const std::vector<float>& elevation, int rows, int cols,
+                                        const mesh3d_bounds_t& bounds, float elevation_scale) {
+    TerrainBuildData td;
+    td.elevation = elevation.data();
+    td.rows = rows;
+    td.cols = cols;
+    td.bounds = bounds;
+    td.elevation_scale = elevation_scale;
+    /* Viewshed/signal use overlay textures in tile mode — don't bake into vertices */
+    td.viewshed = nullptr;
+    td.signal = nullptr;
+    return td;
+}
+
+void TileTerrainBuilder::prepare(TileData& data, const GeoProjection& proj, ThreadPool* pool) const {
+    if (data.elev_rows < 2 || data.elev_cols < 2 || data.elevation.empty()) return;
+    auto td = make_build_data(data.elevation, data.elev_rows, data.elev_cols,
+                              data.bounds, elevation_scale);
+    data.lod = build_terrain_lod_data(td, proj, format, pool);
+    /* Off the main thread, for the viewshed cache keys */
+    if (!data.elevation_hash) data.elevation_hash = hash_tile_elevation(data.elevation);
+}
+
+TileRenderable TileTerrainBuilder::build(const TileData& data, const GeoProjection& proj,
+                                         std::vector<UploadOp>* deferred) const {
     TileRenderable tr;
     tr.coord = data.coord;
     tr.bounds = data.bounds;
     tr.model = glm::mat4(1.0f);
 
     if (data.elev_rows >= 2 && data.elev_cols >= 2 && !data.elevation.empty()) {
-        tr.mesh = build_mesh(data, proj);
+        if (data.lod.chunks.empty()) {
+            tr.mesh = build_mesh(data, proj);
+        } else if (deferred) {
+            auto ops = tr.mesh.upload_deferred(data.lod);
+            deferred->insert(deferred->end(), ops.begin(), ops.end());
+        } else {
+            tr.mesh.upload(data.lod);
+        }
         /* Retain CPU-side elevation for runtime queries */
         tr.elevation = data.elevation;
         tr.elev_rows = data.elev_rows;
         tr.elev_cols = data.elev_cols;
+        tr.elevation_hash = data.elevation_hash ? data.elevation_hash
+                                                : hash_tile_elevation(data.elevation);
     }
 
     if (!data.imagery.empty() && data.img_width > 0 && data.img_height > 0) {
-        tr.texture = build_texture(data);
+        if (deferred)
+            deferred->push_back(tr.texture.allocate_rgba(data.imagery.data(),
+                                                         data.img_width, data.img_height));
+        else
+            tr.texture = build_texture(data);
     }
 
     return tr;
 }
 
-Mesh TileTerrainBuilder::build_mesh(const TileData& data, const GeoProjection& proj) const {
-    TerrainBuildData td;
-    td.elevation = data.elevation.data();
-    td.rows = data.elev_rows;
-    td.cols = data.elev_cols;
-    td.bounds = data.bounds;
-    td.elevation_scale = elevation_scale;
-    /* Viewshed/signal use overlay textures in tile mode — don't bake into vertices */
-    td.viewshed = nullptr;
-    td.signal = nullptr;
+TerrainLodMesh TileTerrainBuilder::build_mesh(const TileData& data, const GeoProjection& proj) const {
+    auto td = make_build_data(data.elevation, data.elev_rows, data.elev_cols,
+                              data.bounds, elevation_scale);
 
-    return build_terrain_mesh(td, proj);
+    TerrainLodMesh mesh;
+    mesh.upload(build_terrain_lod_data(td, proj, format));
+    return mesh;
 }
 
-Mesh TileTerrainBuilder::rebuild_mesh(const TileRenderable& tr, const GeoProjection& proj) const {
-    TerrainBuildData td;
-    td.elevation = tr.elevation.data();
-    td.rows = tr.elev_rows;
-    td.cols = tr.elev_cols;
-    td.bounds = tr.bounds;
-    td.elevation_scale = elevation_scale;
-    /* Viewshed/signal use overlay textures in tile mode — don't bake into vertices */
-    td.viewshed = nullptr;
-    td.signal = nullptr;
+TerrainLodMesh TileTerrainBuilder::rebuild_mesh(const TileRenderable& tr, const GeoProjection& proj) const {
+    auto td = make_build_data(tr.elevation, tr.elev_rows, tr.elev_cols,
+                              tr.bounds, elevation_scale);
 
-    return build_terrain_mesh(td, proj);
+    TerrainLodMesh mesh;
+    mesh.upload(build_terrain_lod_data(td, proj, format));
+    return mesh;
 }
 
 Texture TileTerrainBuilder::build_texture(const TileData& data) const {
@@ -4,23 +4,40 @@
 namespace mesh3d {
 
 struct GeoProjection;
+class ThreadPool;
 
 /* Converts TileData (CPU) -> TileRenderable (GPU).
-   Uses build_terrain_mesh() for geometry, uploads imagery as Texture. */
+   Uses build_terrain_lod_data() for chunked LOD geometry, uploads imagery
+   as Texture. */
 class TileTerrainBuilder {
 public:
     float elevation_scale = 1.0f;
+    /* HEIGHTMAP needs GL 4.3 and the terrain_hm shader (see App::init) */
+    TerrainLodFormat format = TerrainLodFormat::VERTICES;
+
+    /* CPU half of build(): fill data.lod from the elevation grid. Safe on
+       any thread; `pool` parallelises the build across chunk rows. */
+    void prepare(TileData& data, const GeoProjection& proj, ThreadPool* pool = nullptr) const;
 
     /* Build a renderable tile from raw data.
-       If tile has elevation, builds terrain mesh.
-       If tile has imagery, uploads as texture. */
-    TileRenderable build(const TileData& data, const GeoProjection& proj) const;
+       If tile has elevation, uploads data.lod (building it first if the
+       tile was not prepared). If tile has imagery, uploads as texture.
+       With `deferred`, GL storage is allocated but the copies are appended
+       there instead (see UploadStream); they read from `data`, and the
+       texture needs generate_mipmaps() once they have run. */
+    TileRenderable build(const TileData& data, const GeoProjection& proj,
+                         std::vector<UploadOp>* deferred = nullptr) const;
+
+    /* Whether meshes built by `o` match ours */
+    bool same_mesh_settings(const TileTerrainBuilder& o) const {
+        return elevation_scale == o.elevation_scale && format == o.format;
+    }
 
     /* Build mesh-only from elevation data (no imagery) */
-    Mesh build_mesh(const TileData& data, const GeoProjection& proj) const;
+    TerrainLodMesh build_mesh(const TileData& data, const GeoProjection& proj) const;
 
     /* Rebuild mesh from a TileRenderable's retained elevation + overlay data */
-    Mesh rebuild_mesh(const TileRenderable& tr, const GeoProjection& proj) const;
+    TerrainLodMesh rebuild_mesh(const TileRenderable& tr, const GeoProjection& proj) const;
 
     /* Upload imagery data as texture */
     Texture build_texture(const TileData& data) const;
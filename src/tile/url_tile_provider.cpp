@@ -1,6 +1,5 @@
 #include "tile/url_tile_provider.h"
 #include "util/log.h"
-#include <curl/curl.h>
 #include <stb_image.h>
 #include <algorithm>
 #include <sstream>
@@ -45,79 +44,26 @@ std::string UrlTileProvider::cache_key(const TileCoord& coord) const {
     return ss.str();
 }
 
-/* libcurl write callback */
-static size_t curl_write_cb(void* ptr, size_t size, size_t nmemb, void* userdata) {
-    auto* buf = static_cast<std::vector<uint8_t>*>(userdata);
-    size_t total = size * nmemb;
-    auto* bytes = static_cast<uint8_t*>(ptr);
-    buf->insert(buf->end(), bytes, bytes + total);
-    return total;
+HttpRequest UrlTileProvider::make_request(const TileCoord& coord) const {
+    HttpRequest req;
+    req.url = build_url(coord);
+    req.user_agent = m_user_agent;
+    req.timeout_s = 15;
+    req.connect_timeout_s = 10;
+    req.size_hint = 64 * 1024; // typical 256px JPEG/PNG tile
+    req.max_bytes = 16u << 20;
+    return req;
 }
 
-std::vector<uint8_t> UrlTileProvider::download(const std::string& url) const {
-    std::vector<uint8_t> data;
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        LOG_ERROR("curl_easy_init failed");
-        return data;
-    }
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
-
-    if (!m_user_agent.empty()) {
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, m_user_agent.c_str());
-    }
-
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        LOG_WARN("Download failed: %s -> %s", url.c_str(), curl_easy_strerror(res));
-        data.clear();
-    } else {
-        long http_code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-        if (http_code != 200) {
-            LOG_WARN("HTTP %ld for %s", http_code, url.c_str());
-            data.clear();
-        }
-    }
-
-    curl_easy_cleanup(curl);
-    return data;
-}
-
-std::optional<TileData> UrlTileProvider::fetch_tile(const TileCoord& coord) {
-    std::string key = cache_key(coord);
-
-    /* Try disk cache first */
-    std::vector<uint8_t> raw;
-    if (m_cache.has(key)) {
-        raw = m_cache.read(key);
-        LOG_DEBUG("Cache hit: %s", key.c_str());
-    }
-
-    /* Download if not cached */
-    if (raw.empty()) {
-        std::string url = build_url(coord);
-        LOG_INFO("Downloading tile %s", url.c_str());
-        raw = download(url);
-        if (raw.empty()) return std::nullopt;
-
-        /* Cache to disk */
-        m_cache.write(key, raw);
-    }
-
+std::optional<TileData> UrlTileProvider::decode(const TileCoord& coord,
+                                                const std::vector<uint8_t>& raw) const {
     /* Decode image with stb_image */
     int w, h, ch;
     stbi_set_flip_vertically_on_load(false); // tiles are top-left origin
     unsigned char* pixels = stbi_load_from_memory(raw.data(), static_cast<int>(raw.size()),
                                                    &w, &h, &ch, 4); // force RGBA
     if (!pixels) {
-        LOG_WARN("Failed to decode tile image: %s", key.c_str());
+        LOG_WARN("Failed to decode tile image: %s", cache_key(coord).c_str());
         return std::nullopt;
     }
 
@@ -132,6 +78,56 @@ std::optional<TileData> UrlTileProvider::fetch_tile(const TileCoord& coord) {
     return td;
 }
 
+bool UrlTileProvider::is_local(const TileCoord& coord) const {
+    return m_cache.has(cache_key(coord));
+}
+
+std::optional<TileData> UrlTileProvider::fetch_tile(const TileCoord& coord) {
+    return std::move(fetch_tiles({coord}).front());
+}
+
+std::vector<std::optional<TileData>> UrlTileProvider::fetch_tiles(const std::vector<TileCoord>& coords) {
+    std::vector<std::optional<TileData>> out(coords.size());
+
+    /* Disk cache first; collect the misses */
+    std::vector<size_t> missing;
+    std::vector<HttpRequest> requests;
+    for (size_t i = 0; i < coords.size(); ++i) {
+        std::string key = cache_key(coords[i]);
+        std::vector<uint8_t> raw;
+        if (m_cache.has(key)) {
+            raw = m_cache.read(key);
+            LOG_DEBUG("Cache hit: %s", key.c_str());
+        }
+        if (!raw.empty()) {
+            out[i] = decode(coords[i], raw);
+        } else {
+            missing.push_back(i);
+            requests.push_back(make_request(coords[i]));
+        }
+    }
+    if (missing.empty()) return out;
+
+    /* Download every miss concurrently over pooled connections */
+    LOG_INFO("Downloading %zu %s tiles", requests.size(), m_name.c_str());
+    auto responses = HttpClient::shared().get_all(requests);
+    for (size_t k = 0; k < missing.size(); ++k) {
+        auto& resp = responses[k];
+        if (!resp.ok()) {
+            if (!resp.error.empty())
+                LOG_WARN("Download failed: %s -> %s", requests[k].url.c_str(), resp.error.c_str());
+            else
+                LOG_WARN("HTTP %ld for %s", resp.status, requests[k].url.c_str());
+            continue;
+        }
+        /* Cache to disk */
+        size_t i = missing[k];
+        m_cache.write(cache_key(coords[i]), resp.body);
+        out[i] = decode(coords[i], resp.body);
+    }
+    return out;
+}
+
 std::unique_ptr<UrlTileProvider> UrlTileProvider::satellite() {
     return std::make_unique<UrlTileProvider>(
         "esri_satellite",
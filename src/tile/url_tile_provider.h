@@ -1,13 +1,15 @@
 #pragma once
 #include "tile/tile_provider.h"
 #include "tile/disk_cache.h"
+#include "util/http_client.h"
 #include <string>
 #include <memory>
 
 namespace mesh3d {
 
 /* Fetches imagery tiles from a URL template (slippy map {z}/{x}/{y}).
-   Downloads via libcurl, decodes with stb_image, caches to disk. */
+   Downloads through the shared HttpClient, decodes with stb_image,
+   caches to disk. */
 class UrlTileProvider : public TileProvider {
 public:
     UrlTileProvider(const std::string& name,
@@ -22,6 +24,8 @@ public:
     int max_zoom() const override { return m_max_zoom; }
 
     std::optional<TileData> fetch_tile(const TileCoord& coord) override;
+    std::vector<std::optional<TileData>> fetch_tiles(const std::vector<TileCoord>& coords) override;
+    bool is_local(const TileCoord& coord) const override;
 
     /* Predefined source factories */
     static std::unique_ptr<UrlTileProvider> satellite();
@@ -38,8 +42,9 @@ private:
     std::string build_url(const TileCoord& coord) const;
     std::string cache_key(const TileCoord& coord) const;
 
-    /* Download raw bytes from URL. Returns empty on failure. */
-    std::vector<uint8_t> download(const std::string& url) const;
+    HttpRequest make_request(const TileCoord& coord) const;
+    /* Decode an encoded tile image to RGBA */
+    std::optional<TileData> decode(const TileCoord& coord, const std::vector<uint8_t>& raw) const;
 };
 
 } // namespace mesh3d
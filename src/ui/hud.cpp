@@ -619,6 +619,36 @@ void Hud::render(int screen_w, int screen_h,
                      overlay_name, has_data ? "" : " (no data)");
         }
         draw_text_shadowed(buf, 10, 10, glm::vec4(0.85f, 0.85f, 0.85f, 0.95f), 1.0f, screen_w, screen_h);
+        float info_y = 10 + m_line_height;
+
+        /* Mesh connectivity, red when the network is split */
+        const mesh3d_link_graph_stats_t& ls = scene.link_graph.stats();
+        if (ls.nodes >= 2) {
+            snprintf(buf, sizeof(buf), "Mesh: %d links  %d partition%s  %d cut node%s  max %d hops",
+                     ls.links, ls.partitions, ls.partitions == 1 ? "" : "s",
+                     ls.articulation_points, ls.articulation_points == 1 ? "" : "s",
+                     ls.max_hops);
+            glm::vec4 color = ls.partitions > 1 ? glm::vec4(1.0f, 0.45f, 0.4f, 0.95f)
+                                                : glm::vec4(0.7f, 0.9f, 0.7f, 0.9f);
+            draw_text_shadowed(buf, 10, info_y, color, 0.9f, screen_w, screen_h);
+            info_y += m_line_height;
+        }
+
+        /* Frustum culling savings in tile mode */
+        if (scene.use_tile_system) {
+            const TileRenderStats& rs = scene.tile_manager.render_stats();
+            snprintf(buf, sizeof(buf), "Tiles: %d drawn / %d culled  Chunks: %d/%d",
+                     rs.tiles_drawn, rs.tiles_culled, rs.chunks_drawn, rs.chunks_total);
+            draw_text_shadowed(buf, 10, info_y,
+                               glm::vec4(0.7f, 0.7f, 0.7f, 0.9f), 0.9f, screen_w, screen_h);
+
+            const UploadStats& us = scene.tile_manager.upload_stats();
+            snprintf(buf, sizeof(buf), "Upload: %.1f MB/s  %.1f MB queued%s",
+                     us.mb_per_s, us.pending_bytes / (1024.0 * 1024.0),
+                     us.persistent ? "" : "  (no buffer storage)");
+            draw_text_shadowed(buf, 10, info_y + m_line_height,
+                               glm::vec4(0.7f, 0.7f, 0.7f, 0.9f), 0.9f, screen_w, screen_h);
+        }
     }
 
     /* Restore GL state */
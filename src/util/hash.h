@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace mesh3d {
+
+/* FNV-1a over individual fields, so struct padding never reaches the
+   hash. Keys start from FNV_OFFSET and fold in one field at a time. */
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+
+template <typename T>
+inline void hash_field(uint64_t& h, const T& v) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &v, sizeof(T));
+    for (unsigned char b : bytes) {
+        h ^= b;
+        h *= 0x100000001b3ull;
+    }
+}
+
+} // namespace mesh3d
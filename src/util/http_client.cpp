@@ -0,0 +1,228 @@
+#include "util/http_client.h"
+#include "util/log.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+namespace mesh3d {
+
+HttpClient::HttpClient() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    m_multi = curl_multi_init();
+    if (!m_multi) {
+        LOG_ERROR("HttpClient: curl_multi_init failed");
+        return;
+    }
+    m_thread = std::thread(&HttpClient::event_loop, this);
+}
+
+HttpClient::~HttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    if (m_multi) curl_multi_wakeup(static_cast<CURLM*>(m_multi));
+    if (m_thread.joinable()) m_thread.join();
+    if (m_multi) curl_multi_cleanup(static_cast<CURLM*>(m_multi));
+}
+
+HttpClient& HttpClient::shared() {
+    static HttpClient client;
+    return client;
+}
+
+void HttpClient::set_limits(int max_per_host, int max_total) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_per_host = std::max(max_per_host, 1);
+    m_max_total = std::max(max_total, m_max_per_host);
+    m_limits_dirty = true;
+}
+
+/* Append to the response body; a short return aborts the transfer */
+size_t HttpClient::write_cb(void* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* t = static_cast<Transfer*>(userdata);
+    std::vector<uint8_t>& body = t->resp->body;
+    size_t total = size * nmemb;
+    if (t->req->max_bytes && body.size() + total > t->req->max_bytes) {
+        t->too_large = true;
+        return 0;
+    }
+    auto* bytes = static_cast<uint8_t*>(ptr);
+    body.insert(body.end(), bytes, bytes + total);
+    return total;
+}
+
+/* Reserve the advertised Content-Length before the first body chunk, so
+   large bodies (HGT tiles) are not grown repeatedly; a length over the
+   request's limit fails it before any body is read */
+size_t HttpClient::header_cb(char* buffer, size_t size, size_t nitems, void* userdata) {
+    size_t total = size * nitems;
+    static const char KEY[] = "content-length:";
+    const size_t key_len = sizeof(KEY) - 1;
+    if (total > key_len) {
+        bool match = true;
+        for (size_t i = 0; i < key_len && match; ++i)
+            match = std::tolower(static_cast<unsigned char>(buffer[i])) == KEY[i];
+        if (match) {
+            unsigned long long len = std::strtoull(std::string(buffer + key_len, total - key_len).c_str(),
+                                                   nullptr, 10);
+            auto* t = static_cast<Transfer*>(userdata);
+            if (t->req->max_bytes && len > t->req->max_bytes) {
+                t->too_large = true;
+                return 0;
+            }
+            std::vector<uint8_t>& body = t->resp->body;
+            if (len > body.capacity() && len < (1ull << 31)) body.reserve(static_cast<size_t>(len));
+        }
+    }
+    return total;
+}
+
+HttpResponse HttpClient::get(const HttpRequest& req) {
+    return std::move(get_all({req}).front());
+}
+
+std::vector<HttpResponse> HttpClient::get_all(const std::vector<HttpRequest>& reqs) {
+    std::vector<HttpResponse> responses(reqs.size());
+    if (reqs.empty()) return responses;
+    if (!m_multi) {
+        for (auto& r : responses) r.error = "HTTP client unavailable";
+        return responses;
+    }
+
+    Batch batch;
+    std::vector<Transfer> transfers(reqs.size());
+    std::vector<Transfer*> pending;
+    for (size_t i = 0; i < reqs.size(); ++i) {
+        Transfer& t = transfers[i];
+        t.req = &reqs[i];
+        t.resp = &responses[i];
+        t.batch = &batch;
+        t.too_large = false;
+        t.errbuf[0] = '\0';
+        if (reqs[i].size_hint) responses[i].body.reserve(reqs[i].size_hint);
+
+        CURL* easy = curl_easy_init();
+        t.easy = easy;
+        if (!easy) {
+            responses[i].error = "curl_easy_init failed";
+            continue;
+        }
+        curl_easy_setopt(easy, CURLOPT_URL, reqs[i].url.c_str());
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_cb);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &t);
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, header_cb);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, &t);
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT, reqs[i].timeout_s);
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, reqs[i].connect_timeout_s);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, t.errbuf);
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, &t);
+        if (!reqs[i].user_agent.empty())
+            curl_easy_setopt(easy, CURLOPT_USERAGENT, reqs[i].user_agent.c_str());
+        pending.push_back(&t);
+    }
+
+    batch.remaining = pending.size();
+    if (pending.empty()) return responses;
+    if (!submit(pending)) {
+        for (Transfer* t : pending) {
+            curl_easy_cleanup(static_cast<CURL*>(t->easy));
+            t->resp->error = "HTTP client shut down";
+        }
+        return responses;
+    }
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.cv.wait(lock, [&] { return batch.remaining == 0; });
+    return responses;
+}
+
+bool HttpClient::submit(const std::vector<Transfer*>& transfers) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return false;
+        for (Transfer* t : transfers) m_incoming.push_back(t);
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(m_multi));
+    return true;
+}
+
+void HttpClient::finish(void* easy, int result) {
+    Transfer* t = nullptr;
+    curl_easy_getinfo(static_cast<CURL*>(easy), CURLINFO_PRIVATE, reinterpret_cast<char**>(&t));
+    curl_multi_remove_handle(static_cast<CURLM*>(m_multi), static_cast<CURL*>(easy));
+    m_active.erase(std::remove(m_active.begin(), m_active.end(), easy), m_active.end());
+
+    HttpResponse& resp = *t->resp;
+    if (t->too_large) {
+        resp.error = "response larger than " + std::to_string(t->req->max_bytes) + " bytes";
+        resp.body.clear();
+    } else if (result != CURLE_OK) {
+        resp.error = t->errbuf[0] ? t->errbuf : curl_easy_strerror(static_cast<CURLcode>(result));
+        resp.body.clear();
+    } else {
+        curl_easy_getinfo(static_cast<CURL*>(easy), CURLINFO_RESPONSE_CODE, &resp.status);
+        if (resp.status != 200) resp.body.clear();
+    }
+    curl_easy_cleanup(static_cast<CURL*>(easy));
+
+    /* Notify under the lock: the waiter owns `batch` and may return as
+       soon as it sees remaining == 0 */
+    Batch* batch = t->batch;
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    if (--batch->remaining == 0) batch->cv.notify_all();
+}
+
+void HttpClient::event_loop() {
+    CURLM* multi = static_cast<CURLM*>(m_multi);
+    int running = 0;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) break;
+            if (m_limits_dirty) {
+                curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(m_max_per_host));
+                curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_max_total));
+                /* Idle connections kept for reuse */
+                curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(m_max_total));
+                m_limits_dirty = false;
+            }
+            /* Transfers over the per-host cap wait inside libcurl's
+               pending queue until a connection frees up */
+            while (!m_incoming.empty()) {
+                void* easy = m_incoming.front()->easy;
+                curl_multi_add_handle(multi, static_cast<CURL*>(easy));
+                m_active.push_back(easy);
+                m_incoming.pop_front();
+            }
+        }
+
+        curl_multi_perform(multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg == CURLMSG_DONE)
+                finish(msg->easy_handle, msg->data.result);
+        }
+
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+
+    /* Shutdown: fail anything still queued or in flight so no caller hangs */
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Transfer* t : m_incoming) {
+            curl_multi_add_handle(multi, static_cast<CURL*>(t->easy));
+            m_active.push_back(t->easy);
+        }
+        m_incoming.clear();
+    }
+    while (!m_active.empty()) finish(m_active.back(), CURLE_ABORTED_BY_CALLBACK);
+}
+
+} // namespace mesh3d
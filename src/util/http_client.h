@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace mesh3d {
+
+struct HttpRequest {
+    std::string url;
+    std::string user_agent;      // empty = libcurl default
+    long timeout_s = 15;
+    long connect_timeout_s = 10;
+    size_t size_hint = 0;        // expected body size; the buffer is reserved up front
+    size_t max_bytes = 0;        // larger bodies fail the request; 0 = no limit
+};
+
+struct HttpResponse {
+    long status = 0;             // HTTP status, 0 if the transfer failed
+    std::vector<uint8_t> body;
+    std::string error;           // libcurl error text on transport failure
+
+    bool ok() const { return error.empty() && status == 200; }
+};
+
+/* Shared download engine on top of one curl multi handle.
+   A single event thread drives every transfer, so connections (and TLS
+   sessions) stay in the multi handle's pool and are reused across
+   requests, and concurrent requests to a host are capped at
+   max_per_host. Thread-safe: any number of threads may block in get()
+   or get_all() at once. */
+class HttpClient {
+public:
+    static constexpr int DEFAULT_MAX_PER_HOST = 6;
+    static constexpr int DEFAULT_MAX_TOTAL = 32;
+
+    HttpClient();
+    ~HttpClient();
+
+    /* Process-wide instance used by the tile providers */
+    static HttpClient& shared();
+
+    /* Blocking single GET */
+    HttpResponse get(const HttpRequest& req);
+
+    /* Issue all requests concurrently and wait for every one to finish.
+       Results are in request order. */
+    std::vector<HttpResponse> get_all(const std::vector<HttpRequest>& reqs);
+
+    /* Connection limits; apply to transfers started afterwards */
+    void set_limits(int max_per_host, int max_total);
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+private:
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t remaining = 0;
+    };
+    struct Transfer {
+        void* easy;              // CURL*
+        const HttpRequest* req;
+        HttpResponse* resp;
+        Batch* batch;
+        bool too_large;          // body passed req->max_bytes
+        char errbuf[256];
+    };
+
+    void* m_multi = nullptr;     // CURLM*, kept opaque to avoid curl.h here
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::deque<Transfer*> m_incoming;
+    std::vector<void*> m_active; // easy handles in the multi; event thread only
+    bool m_stop = false;
+    int m_max_per_host = DEFAULT_MAX_PER_HOST;
+    int m_max_total = DEFAULT_MAX_TOTAL;
+    bool m_limits_dirty = true;
+
+    bool submit(const std::vector<Transfer*>& transfers);
+    void event_loop();
+    void finish(void* easy, int result);
+
+    /* libcurl callbacks; userdata is the Transfer */
+    static size_t write_cb(void* ptr, size_t size, size_t nmemb, void* userdata);
+    static size_t header_cb(char* buffer, size_t size, size_t nitems, void* userdata);
+};
+
+} // namespace mesh3d
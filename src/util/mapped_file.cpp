@@ -0,0 +1,107 @@
+#include "util/mapped_file.h"
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mesh3d {
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& o) noexcept
+    : m_data(o.m_data), m_size(o.m_size), m_mapped(o.m_mapped),
+      m_fallback(std::move(o.m_fallback))
+{
+    o.m_data = nullptr;
+    o.m_size = 0;
+    o.m_mapped = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+        close();
+        m_data = o.m_data;
+        m_size = o.m_size;
+        m_mapped = o.m_mapped;
+        m_fallback = std::move(o.m_fallback);
+        o.m_data = nullptr;
+        o.m_size = 0;
+        o.m_mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path, bool sequential) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference
+    if (p != MAP_FAILED) {
+        if (sequential) madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(p);
+        m_size = static_cast<size_t>(st.st_size);
+        m_mapped = true;
+        return true;
+    }
+#else
+    (void)sequential;
+#endif
+
+    /* Fallback: plain read */
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    auto size = f.tellg();
+    if (size <= 0) return false;
+    m_fallback.resize(static_cast<size_t>(size));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(m_fallback.data()), size);
+    if (!f) {
+        m_fallback.clear();
+        return false;
+    }
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+    return true;
+}
+
+void MappedFile::discard_through(size_t end) {
+#ifndef _WIN32
+    if (!m_mapped || !m_data) return;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t len = std::min(end, m_size) / page * page;
+    if (len > 0)
+        madvise(const_cast<uint8_t*>(m_data), len, MADV_DONTNEED);
+#else
+    (void)end;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_mapped && m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_fallback.clear();
+    m_fallback.shrink_to_fit();
+}
+
+} // namespace mesh3d
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh3d {
+
+/* Read-only view of a whole file. On POSIX the file is mmap'd, so pages
+   come straight from the page cache with no heap copy; elsewhere (or if
+   mmap fails) it falls back to reading into an owned buffer. */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    /* Map `path`. sequential = hint that the file will be read front to
+       back once (readahead, early page reclaim). */
+    bool open(const std::string& path, bool sequential = true);
+    void close();
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool valid() const { return m_data != nullptr; }
+
+    /* Drop [0, end) from this process's resident set once it has been
+       consumed (the pages stay in the page cache). No-op for the read
+       fallback. */
+    void discard_through(size_t end);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept;
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;          // true: munmap on close, false: m_fallback owns data
+    std::vector<uint8_t> m_fallback;
+};
+
+} // namespace mesh3d
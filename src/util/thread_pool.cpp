@@ -0,0 +1,127 @@
+#include "util/thread_pool.h"
+#include <algorithm>
+
+namespace mesh3d {
+
+/* Set while a thread is executing pool tasks; nested parallel_for calls
+   from inside a task run inline instead of waiting on the pool. */
+static thread_local bool t_in_pool = false;
+
+int ThreadPool::hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+ThreadPool::ThreadPool(int threads) {
+    int n = threads > 0 ? threads : hardware_threads();
+    m_queues.reserve(n);
+    for (int i = 0; i < n; ++i)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+
+    /* Participant 0 is the caller of parallel_for; spawn the rest */
+    for (int i = 1; i < n; ++i)
+        m_workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        m_shutdown = true;
+    }
+    m_wake_cv.notify_all();
+    for (auto& t : m_workers)
+        if (t.joinable()) t.join();
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)>& fn) {
+    if (count <= 0) return;
+
+    if (t_in_pool || size() == 1 || count == 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(m_submit_mtx);
+
+    /* Seed each participant with a contiguous run of task indices so
+       neighbouring tasks (adjacent grid blocks) start on the same thread. */
+    int n = size();
+    for (int q = 0; q < n; ++q) {
+        int begin = static_cast<int>(static_cast<long long>(count) * q / n);
+        int end   = static_cast<int>(static_cast<long long>(count) * (q + 1) / n);
+        std::lock_guard<std::mutex> lk(m_queues[q]->mtx);
+        for (int i = begin; i < end; ++i)
+            m_queues[q]->tasks.push_back(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        m_fn = &fn;
+        m_remaining.store(count);
+        m_active = static_cast<int>(m_workers.size());
+        ++m_generation;
+    }
+    m_wake_cv.notify_all();
+
+    t_in_pool = true;
+    run_tasks(0);
+    t_in_pool = false;
+
+    /* Wait until every worker has left the job before fn goes out of scope */
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_done_cv.wait(lk, [&] { return m_active == 0; });
+    m_fn = nullptr;
+}
+
+void ThreadPool::worker_loop(int id) {
+    t_in_pool = true;
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_mtx);
+            m_wake_cv.wait(lk, [&] { return m_shutdown || m_generation != seen; });
+            if (m_shutdown) return;
+            seen = m_generation;
+        }
+
+        run_tasks(id);
+
+        std::lock_guard<std::mutex> lk(m_mtx);
+        if (--m_active == 0) m_done_cv.notify_all();
+    }
+}
+
+void ThreadPool::run_tasks(int id) {
+    const auto& fn = *m_fn;
+    int task;
+    while (m_remaining.load(std::memory_order_acquire) > 0) {
+        if (!pop_local(id, task) && !steal(id, task))
+            break; // no queued work left anywhere; stragglers finish on their own
+        fn(task);
+        m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+bool ThreadPool::pop_local(int id, int& task) {
+    auto& q = *m_queues[id];
+    std::lock_guard<std::mutex> lk(q.mtx);
+    if (q.tasks.empty()) return false;
+    task = q.tasks.front();
+    q.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(int id, int& task) {
+    int n = size();
+    for (int k = 1; k < n; ++k) {
+        auto& q = *m_queues[(id + k) % n];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        if (q.tasks.empty()) continue;
+        task = q.tasks.back();
+        q.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+} // namespace mesh3d
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mesh3d {
+
+/* Fixed-size work-stealing thread pool for data-parallel loops.
+
+   parallel_for(count, fn) splits [0, count) into contiguous runs, one per
+   participant, and pushes them onto per-worker deques. Each participant
+   pops work from the front of its own deque; when that runs dry it steals
+   from the back of another worker's deque, so uneven task costs (e.g.
+   viewshed blocks near vs. far from a node) balance out automatically.
+
+   The calling thread participates as one of the workers, so a pool of
+   size 1 spawns no threads and runs everything inline. Calls made from
+   inside a pool task run serially to avoid deadlocking on the pool. */
+class ThreadPool {
+public:
+    /* threads <= 0 uses std::thread::hardware_concurrency() */
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /* Number of participants (spawned workers + calling thread) */
+    int size() const { return static_cast<int>(m_queues.size()); }
+
+    /* Run fn(i) for every i in [0, count). Blocks until all tasks finish. */
+    void parallel_for(int count, const std::function<void(int)>& fn);
+
+    static int hardware_threads();
+
+private:
+    struct WorkQueue {
+        std::mutex mtx;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submit_mtx;               // one parallel_for at a time
+    std::mutex m_mtx;
+    std::condition_variable m_wake_cv;
+    std::condition_variable m_done_cv;
+    const std::function<void(int)>* m_fn = nullptr;
+    uint64_t m_generation = 0;
+    std::atomic<int> m_remaining{0};
+    int m_active = 0;                      // workers still inside the job
+    bool m_shutdown = false;
+
+    void worker_loop(int id);
+    void run_tasks(int id);
+    bool pop_local(int id, int& task);
+    bool steal(int id, int& task);
+};
+
+} // namespace mesh3d
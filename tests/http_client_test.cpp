@@ -0,0 +1,163 @@
+/* http_client_test — HttpClient against a loopback HTTP stand-in.
+
+   A minimal HTTP/1.1 server on 127.0.0.1 (an ephemeral port, one thread
+   per connection, "Connection: close") serves fixed responses by path, so
+   the test needs no network access:
+
+     /ok         200, 100 kB body with Content-Length
+     /big        200, Content-Length over the request limit
+     /chunked    200, chunked body over the request limit (no length)
+     /missing    404
+
+   Exits non-zero on the first failed check. */
+
+#include "util/http_client.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mesh3d;
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failures; \
+    } \
+} while (0)
+
+static const size_t OK_BYTES = 100 * 1024;
+static const size_t LIMIT = 4096;
+
+static void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;  // client gave up (e.g. size limit)
+        sent += static_cast<size_t>(n);
+    }
+}
+
+static std::string body_of(size_t n) {
+    std::string body(n, '\0');
+    for (size_t i = 0; i < n; ++i) body[i] = static_cast<char>('a' + i % 26);
+    return body;
+}
+
+static void serve(int fd) {
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) { ::close(fd); return; }
+        request.append(buf, static_cast<size_t>(n));
+    }
+    std::string path = request.substr(4, request.find(' ', 4) - 4);  // "GET <path> ..."
+
+    if (path == "/ok") {
+        send_all(fd, "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(OK_BYTES) +
+                     "\r\nConnection: close\r\n\r\n" + body_of(OK_BYTES));
+    } else if (path == "/big") {
+        send_all(fd, "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(LIMIT * 4) +
+                     "\r\nConnection: close\r\n\r\n" + body_of(LIMIT * 4));
+    } else if (path == "/chunked") {
+        std::string out = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n";
+        char size_line[32];
+        for (int i = 0; i < 8; ++i) {
+            std::snprintf(size_line, sizeof(size_line), "%zx\r\n", LIMIT);
+            out += size_line + body_of(LIMIT) + "\r\n";
+        }
+        send_all(fd, out + "0\r\n\r\n");
+    } else {
+        send_all(fd, "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\nConnection: close\r\n\r\nnot found");
+    }
+    ::close(fd);
+}
+
+int main() {
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener, 16) != 0 ||
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+        std::perror("http_client_test: loopback listener");
+        return 1;
+    }
+    const std::string base = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+
+    std::atomic<bool> stop{false};
+    std::thread server([&] {
+        while (!stop) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) break;
+            std::thread(serve, fd).detach();
+        }
+    });
+
+    {
+        HttpClient client;
+        auto request = [&](const char* path, size_t max_bytes) {
+            HttpRequest req;
+            req.url = base + path;
+            req.timeout_s = 10;
+            req.max_bytes = max_bytes;
+            return req;
+        };
+
+        /* Success, single and concurrent */
+        HttpResponse ok = client.get(request("/ok", 0));
+        CHECK(ok.ok());
+        CHECK(ok.body.size() == OK_BYTES);
+        CHECK(ok.body.size() == OK_BYTES && std::memcmp(ok.body.data(), body_of(OK_BYTES).data(), OK_BYTES) == 0);
+
+        std::vector<HttpRequest> batch(8, request("/ok", OK_BYTES));
+        std::vector<HttpResponse> all = client.get_all(batch);
+        CHECK(all.size() == batch.size());
+        for (const HttpResponse& r : all) CHECK(r.ok() && r.body.size() == OK_BYTES);
+
+        /* Size limit, from Content-Length and while streaming */
+        HttpResponse big = client.get(request("/big", LIMIT));
+        CHECK(!big.ok());
+        CHECK(!big.error.empty());
+        CHECK(big.body.empty());
+
+        HttpResponse chunked = client.get(request("/chunked", LIMIT));
+        CHECK(!chunked.ok());
+        CHECK(!chunked.error.empty());
+        CHECK(chunked.body.empty());
+
+        HttpResponse unlimited = client.get(request("/chunked", 0));
+        CHECK(unlimited.ok() && unlimited.body.size() == LIMIT * 8);
+
+        /* Error status: reported, no transport error, body dropped */
+        HttpResponse missing = client.get(request("/missing", 0));
+        CHECK(!missing.ok());
+        CHECK(missing.status == 404);
+        CHECK(missing.error.empty());
+        CHECK(missing.body.empty());
+    }
+
+    stop = true;
+    ::shutdown(listener, SHUT_RDWR);
+    ::close(listener);
+    server.join();
+
+    if (g_failures) {
+        std::fprintf(stderr, "http_client_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("http_client_test: all checks passed\n");
+    return 0;
+}
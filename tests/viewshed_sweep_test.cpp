@@ -0,0 +1,147 @@
+/* viewshed_sweep_test — MESH3D_PROP_SWEEP against the ray march.
+
+   viewshed_sweep() and viewshed_block() run the same FSPL + knife-edge
+   model, but the sweep takes each cell's obstructions from the sweep ray
+   through it rather than the exact node-to-cell ray, so results differ
+   where those rays cross different terrain. This checks the tolerance
+   documented on MESH3D_PROP_SWEEP (include/mesh3d/types.h) on the same
+   terrains it was measured on: 801x801 diamond-square fractals, ~30 m
+   posts, -110 dBm sensitivity, three node placements each.
+
+   Exits non-zero on the first failed check. */
+
+#include "analysis/viewshed_kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace mesh3d;
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_failures; \
+    } \
+} while (0)
+
+static const int DIM = 801;   // 2^k + 1 for diamond-square
+
+/* Tolerance of one terrain, as documented on MESH3D_PROP_SWEEP */
+struct Tolerance {
+    const char* name;
+    float relief_m;       // amplitude of the first octave
+    float roughness;      // amplitude factor per octave
+    double min_agree_pct;
+    float p50_db, p90_db, p99_db, max_db;
+};
+
+static const Tolerance TERRAINS[] = {
+    {"moderate", 100.0f, 0.45f, 89.0, 0.05f, 8.0f, 15.0f, 42.0f},
+    {"rugged", 1000.0f, 0.5f, 91.0, 0.1f, 13.0f, 25.0f, 61.0f},
+};
+
+/* Diamond-square heightmap from a fixed LCG, so every run sees the same
+   terrain */
+static void fractal_terrain(std::vector<float>& elev, float relief, float roughness) {
+    uint32_t state = 12345;
+    auto noise = [&]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f * 2.0f - 1.0f;
+    };
+
+    const int n = DIM;
+    elev.assign(static_cast<size_t>(n) * n, 0.0f);
+    int step = n - 1;
+    float amp = relief;
+    elev[0] = noise() * amp;
+    elev[step] = noise() * amp;
+    elev[step * n] = noise() * amp;
+    elev[step * n + step] = noise() * amp;
+    while (step > 1) {
+        int h = step / 2;
+        for (int r = h; r < n; r += step)
+            for (int c = h; c < n; c += step)
+                elev[r * n + c] = (elev[(r - h) * n + c - h] + elev[(r - h) * n + c + h] +
+                                   elev[(r + h) * n + c - h] + elev[(r + h) * n + c + h]) * 0.25f +
+                                  noise() * amp;
+        for (int r = 0; r < n; r += h) {
+            for (int c = (r / h) % 2 == 0 ? h : 0; c < n; c += step) {
+                float sum = 0.0f;
+                int count = 0;
+                if (r >= h)    { sum += elev[(r - h) * n + c]; ++count; }
+                if (r + h < n) { sum += elev[(r + h) * n + c]; ++count; }
+                if (c >= h)    { sum += elev[r * n + c - h]; ++count; }
+                if (c + h < n) { sum += elev[r * n + c + h]; ++count; }
+                elev[r * n + c] = sum / count + noise() * amp;
+            }
+        }
+        step = h;
+        amp *= roughness;
+    }
+    for (float& e : elev) e += 2.0f * relief;
+}
+
+int main() {
+    /* ~30 m posts at 45 N */
+    const mesh3d_bounds_t bounds{45.0, 45.216, -120.0, -119.695};
+    mesh3d_rf_config_t rf{};
+    rf.rx_sensitivity_dbm = -110.0f;
+    rf.rx_height_agl_m = 1.0f;
+    rf.rx_antenna_gain_dbi = 2.0f;
+    rf.rx_cable_loss_db = 2.0f;
+
+    /* Node placements as (row, col) fractions of the grid */
+    const double placements[][2] = {{0.5, 0.5}, {0.2, 0.3}, {0.85, 0.1}};
+
+    const size_t total = static_cast<size_t>(DIM) * DIM;
+    std::vector<float> elev;
+    std::vector<uint8_t> ref_vis(total), sweep_vis(total);
+    std::vector<float> ref_sig(total), sweep_sig(total), diff(total);
+
+    for (const Tolerance& t : TERRAINS) {
+        fractal_terrain(elev, t.relief_m, t.roughness);
+
+        for (const auto& p : placements) {
+            NodeData node{};
+            node.info.lat = bounds.max_lat - (bounds.max_lat - bounds.min_lat) * p[0];
+            node.info.lon = bounds.min_lon + (bounds.max_lon - bounds.min_lon) * p[1];
+            node.info.antenna_height_m = 10.0f;
+            node.info.rx_sensitivity_dbm = -110.0f;
+            ViewshedSetup vs = viewshed_setup(elev.data(), DIM, DIM, bounds, node, rf);
+
+            std::fill(sweep_vis.begin(), sweep_vis.end(), 0);
+            std::fill(sweep_sig.begin(), sweep_sig.end(), -999.0f);
+            viewshed_block(vs, 0, DIM, 0, DIM, ref_vis.data(), ref_sig.data(), DIM);
+            viewshed_sweep(vs, 0, DIM, 0, DIM, sweep_vis.data(), sweep_sig.data(), DIM);
+
+            size_t agree = 0;
+            for (size_t i = 0; i < total; ++i) {
+                agree += ref_vis[i] == sweep_vis[i];
+                /* equal covers the -inf both kernels give deep behind ridges */
+                diff[i] = ref_sig[i] == sweep_sig[i] ? 0.0f : std::fabs(ref_sig[i] - sweep_sig[i]);
+            }
+            std::sort(diff.begin(), diff.end());
+            auto pct = [&](double f) { return diff[static_cast<size_t>(f * (total - 1))]; };
+            double agree_pct = 100.0 * agree / total;
+
+            std::printf("%-8s node (%.2f, %.2f): agree %.2f%%  |dsig| p50 %.2f  p90 %.2f  "
+                        "p99 %.2f  max %.1f dB\n",
+                        t.name, p[0], p[1], agree_pct, pct(0.5), pct(0.9), pct(0.99), diff.back());
+            CHECK(agree_pct >= t.min_agree_pct);
+            CHECK(pct(0.5) <= t.p50_db);
+            CHECK(pct(0.9) <= t.p90_db);
+            CHECK(pct(0.99) <= t.p99_db);
+            CHECK(diff.back() <= t.max_db);
+        }
+    }
+
+    if (g_failures) {
+        std::fprintf(stderr, "viewshed_sweep_test: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("viewshed_sweep_test: all checks passed\n");
+    return 0;
+}